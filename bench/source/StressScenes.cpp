@@ -0,0 +1,341 @@
+#include "StressScenes.hpp"
+
+using namespace Cortex;
+
+static const std::vector<std::string> stressSceneNames = {
+    "viking",       // the testbed's model, a single realistic draw
+    "instances",    // N entities sharing one mesh
+    "unique",       // N entities, each with its own mesh and buffers
+    "materials",    // N entities sharing one mesh, each with its own material
+    "hierarchy",    // chains of STRESS_HIERARCHY_DEPTH parented entities, every link animated
+    "overdraw",     // N overlapping quads drawn back to front, each covering a sixteenth of the view
+    "occluded",     // N entities sharing one mesh, mostly hidden behind a wall marked as an occluder
+    "spheres",      // N detailed spheres sharing one mesh, receding from the camera across its levels of detail
+    "mixed"         // a few meshes and materials, STRESS_MIXED_DYNAMIC_FRACTION of entities animated
+};
+
+const std::vector<std::string>& stress_scene_names() {
+    return stressSceneNames;
+}
+
+// A unit cube with per-face normals and texture coordinates. A random generator makes the mesh unique
+// by scaling and shearing it, which keeps the faces closed.
+static std::shared_ptr<Model> stress_create_cube(GraphicsContext& context, StressRandom* random) {
+    glm::mat3 shape(1.0f);
+    if (random) {
+        shape[0] = {random->Range(0.6f, 1.4f), random->Range(-0.2f, 0.2f), random->Range(-0.2f, 0.2f)};
+        shape[1] = {random->Range(-0.2f, 0.2f), random->Range(0.6f, 1.4f), random->Range(-0.2f, 0.2f)};
+        shape[2] = {random->Range(-0.2f, 0.2f), random->Range(-0.2f, 0.2f), random->Range(0.6f, 1.4f)};
+    }
+    const glm::vec3 normals[6] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+    const glm::vec2 corners[4] = {{-1, -1}, {1, -1}, {1, 1}, {-1, 1}};
+
+    std::vector<VulkanVertex> vertices;
+    std::vector<VulkanIndex> indices;
+    for (const glm::vec3& normal : normals) {
+        // (u, v, normal) is right handed, so corners in order wind counter-clockwise seen from outside.
+        glm::vec3 u = {normal.y, normal.z, normal.x};
+        glm::vec3 v = glm::cross(normal, u);
+        VulkanIndex base = (VulkanIndex)vertices.size();
+        for (const glm::vec2& corner : corners) {
+            VulkanVertex vertex = {};
+            vertex.Position = shape * (0.5f * (normal + corner.x * u + corner.y * v));
+            vertex.Normal = glm::normalize(glm::transpose(glm::inverse(shape)) * normal);
+            vertex.Color = {1.0f, 1.0f, 1.0f};
+            vertex.TexCoord = 0.5f * (corner + 1.0f);
+            vertices.push_back(vertex);
+        }
+        indices.insert(indices.end(), {base, base + 1, base + 2, base + 2, base + 3, base});
+    }
+    return context.LoadModel(vertices, indices);
+}
+
+static std::shared_ptr<Model> stress_create_quad(GraphicsContext& context) {
+    std::vector<VulkanVertex> vertices = {
+        {.Position = {-.5f, -.5f, .0f}, .Normal = {0.0f, 0.0f, 1.0f}, .Color = {1.0f, 1.0f, 1.0f}, .TexCoord = {0.0f, 0.0f}},
+        {.Position = {+.5f, -.5f, .0f}, .Normal = {0.0f, 0.0f, 1.0f}, .Color = {1.0f, 1.0f, 1.0f}, .TexCoord = {1.0f, 0.0f}},
+        {.Position = {+.5f, +.5f, .0f}, .Normal = {0.0f, 0.0f, 1.0f}, .Color = {1.0f, 1.0f, 1.0f}, .TexCoord = {1.0f, 1.0f}},
+        {.Position = {-.5f, +.5f, .0f}, .Normal = {0.0f, 0.0f, 1.0f}, .Color = {1.0f, 1.0f, 1.0f}, .TexCoord = {0.0f, 1.0f}},
+    };
+    std::vector<VulkanIndex> indices = {0, 1, 2, 2, 3, 0};
+    return context.LoadModel(vertices, indices);
+}
+
+// A UV sphere of unit diameter, seamed where the texture coordinates wrap.
+static std::shared_ptr<Model> stress_create_sphere(GraphicsContext& context) {
+    std::vector<VulkanVertex> vertices;
+    std::vector<VulkanIndex> indices;
+    for (u32 ring = 0; ring <= STRESS_SPHERE_RINGS; ring++) {
+        f32 theta = glm::pi<f32>() * (f32)ring / STRESS_SPHERE_RINGS;
+        for (u32 segment = 0; segment <= STRESS_SPHERE_SEGMENTS; segment++) {
+            f32 phi = glm::two_pi<f32>() * (f32)segment / STRESS_SPHERE_SEGMENTS;
+            VulkanVertex vertex = {};
+            vertex.Normal = {std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta)};
+            vertex.Position = 0.5f * vertex.Normal;
+            vertex.Color = {1.0f, 1.0f, 1.0f};
+            vertex.TexCoord = {(f32)segment / STRESS_SPHERE_SEGMENTS, (f32)ring / STRESS_SPHERE_RINGS};
+            vertices.push_back(vertex);
+        }
+    }
+    // The poles are rows of coincident vertices, so the first and last rings are fans.
+    for (u32 ring = 0; ring < STRESS_SPHERE_RINGS; ring++) {
+        for (u32 segment = 0; segment < STRESS_SPHERE_SEGMENTS; segment++) {
+            VulkanIndex a = ring * (STRESS_SPHERE_SEGMENTS + 1) + segment;
+            VulkanIndex b = a + STRESS_SPHERE_SEGMENTS + 1;
+            if (ring != 0) {
+                indices.insert(indices.end(), {a, b, a + 1});
+            }
+            if (ring != STRESS_SPHERE_RINGS - 1) {
+                indices.insert(indices.end(), {a + 1, b, b + 1});
+            }
+        }
+    }
+    return context.LoadModel(vertices, indices);
+}
+
+// The quad's own two triangles, for when it stands in front of other things.
+static std::shared_ptr<OccluderMesh> stress_create_quad_occluder() {
+    auto occluder = std::make_shared<OccluderMesh>();
+    occluder->Positions = {{-.5f, -.5f, .0f}, {+.5f, -.5f, .0f}, {+.5f, +.5f, .0f}, {-.5f, +.5f, .0f}};
+    occluder->Indices = {0, 1, 2, 2, 3, 0};
+    return occluder;
+}
+
+static u32 stress_grid_side(u32 count) {
+    return std::max(1u, (u32)std::ceil(std::sqrt((f64)count)));
+}
+
+// Entities are laid out on a square grid in the XY plane, centred on the origin.
+static glm::vec3 stress_grid_position(u32 index, u32 side, f32 spacing) {
+    f32 offset = 0.5f * (f32)(side - 1);
+    return {((f32)(index % side) - offset) * spacing, ((f32)(index / side) - offset) * spacing, 0.0f};
+}
+
+static glm::mat4 stress_random_orientation(StressRandom& random) {
+    glm::vec3 axis = {random.Range(-1.0f, 1.0f), random.Range(-1.0f, 1.0f), random.Range(-1.0f, 1.0f)};
+    if (glm::dot(axis, axis) < 1e-4f) {
+        axis = {0.0f, 0.0f, 1.0f};
+    }
+    return glm::rotate(glm::mat4(1.0f), random.Range(0.0f, glm::two_pi<f32>()), glm::normalize(axis));
+}
+
+// Looks down -Z from far enough back that a grid of the given width fits the view, with room for
+// geometry rising up to height towards the camera.
+static void stress_frame_grid(Scene& scene, f32 width, f32 height, f32 aspectRatio) {
+    f32 fovy = glm::radians(70.0f);
+    f32 distance = 0.5f * width / std::tan(0.5f * fovy) / std::min(aspectRatio, 1.0f) + height + 1.0f;
+    scene.MainCamera.SetView({0.0f, 0.0f, distance}, {0.0f, 0.0f, -1.0f}, {0.0f, 1.0f, 0.0f});
+    scene.MainCamera.SetPerspectiveProjection(fovy, aspectRatio, 0.1f, 2.0f * distance + height);
+}
+
+static void stress_add_dynamic(StressScene& scene, u32 entity) {
+    const Transform& transform = scene.Scene.Entities[entity].Transform;
+    scene.Dynamic.push_back(entity);
+    scene.DynamicBase.push_back(transform.Parent == TRANSFORM_NO_PARENT ? transform.ModelMatrix : transform.LocalMatrix);
+}
+
+static void stress_build_grid(GraphicsContext& context, const StressSceneDesc& desc, StressRandom& random, StressScene& outScene) {
+    bool uniqueMeshes = desc.Name == "unique";
+    bool uniqueMaterials = desc.Name == "materials";
+    bool mixed = desc.Name == "mixed";
+
+    std::vector<std::shared_ptr<Model>> models;
+    std::vector<std::shared_ptr<Material>> materials;
+    if (mixed) {
+        for (u32 i = 0; i < STRESS_MIXED_MODEL_COUNT; i++) {
+            models.push_back(stress_create_cube(context, &random));
+            materials.push_back(Material::Create({random.Float(), random.Float(), random.Float(), 1.0f}));
+        }
+    } else if (!uniqueMeshes) {
+        models.push_back(stress_create_cube(context, nullptr));
+    }
+
+    u32 side = stress_grid_side(desc.Count);
+    f32 spacing = 2.0f;
+    outScene.Scene.Entities.reserve(desc.Count);
+    for (u32 i = 0; i < desc.Count; i++) {
+        Entity entity = Entity::Create();
+        entity.Transform.ModelMatrix = glm::translate(glm::mat4(1.0f), stress_grid_position(i, side, spacing)) * stress_random_orientation(random);
+        if (uniqueMeshes) {
+            entity.Mesh.Model = stress_create_cube(context, &random);
+        } else if (mixed) {
+            u32 pick = (u32)(random.Next() % STRESS_MIXED_MODEL_COUNT);
+            entity.Mesh.Model = models[pick];
+            entity.Mesh.Material = materials[pick];
+        } else {
+            entity.Mesh.Model = models[0];
+        }
+        if (uniqueMaterials) {
+            entity.Mesh.Material = Material::Create({random.Float(), random.Float(), random.Float(), 1.0f});
+        }
+        outScene.Scene.Entities.push_back(entity);
+
+        if (mixed && random.Float() < STRESS_MIXED_DYNAMIC_FRACTION) {
+            stress_add_dynamic(outScene, i);
+        }
+    }
+    stress_frame_grid(outScene.Scene, (f32)side * spacing, 1.0f, desc.AspectRatio);
+}
+
+static void stress_build_hierarchy(GraphicsContext& context, const StressSceneDesc& desc, StressRandom& random, StressScene& outScene) {
+    std::shared_ptr<Model> cube = stress_create_cube(context, nullptr);
+    u32 chains = (desc.Count + STRESS_HIERARCHY_DEPTH - 1) / STRESS_HIERARCHY_DEPTH;
+    u32 side = stress_grid_side(chains);
+    f32 spacing = 3.0f;
+    f32 linkOffset = 0.6f;
+    f32 linkScale = 0.95f;
+
+    // Each chain is a tower rising towards the camera; every link is offset, shrunk and turned
+    // relative to the one below it, so animating any link moves everything above it.
+    outScene.Hierarchy = true;
+    outScene.Scene.Entities.reserve(desc.Count);
+    for (u32 chain = 0; chain < chains; chain++) {
+        u32 root = (u32)outScene.Scene.Entities.size();
+        u32 links = std::min((u32)STRESS_HIERARCHY_DEPTH, desc.Count - root);
+        for (u32 link = 0; link < links; link++) {
+            Entity entity = Entity::Create();
+            entity.Mesh.Model = cube;
+            if (link == 0) {
+                entity.Transform.ModelMatrix = glm::translate(glm::mat4(1.0f), stress_grid_position(chain, side, spacing));
+            } else {
+                entity.Transform.Parent = root + link - 1;
+                entity.Transform.LocalMatrix = glm::translate(glm::mat4(1.0f), {0.0f, 0.0f, linkOffset})
+                    * glm::rotate(glm::mat4(1.0f), random.Range(-0.3f, 0.3f), {1.0f, 0.0f, 0.0f})
+                    * glm::scale(glm::mat4(1.0f), glm::vec3(linkScale));
+            }
+            outScene.Scene.Entities.push_back(entity);
+            stress_add_dynamic(outScene, root + link);
+        }
+    }
+    outScene.Scene.UpdateTransforms();
+
+    f32 towerHeight = linkOffset * (1.0f - std::pow(linkScale, (f32)STRESS_HIERARCHY_DEPTH)) / (1.0f - linkScale);
+    stress_frame_grid(outScene.Scene, (f32)side * spacing, towerHeight, desc.AspectRatio);
+}
+
+static void stress_build_overdraw(GraphicsContext& context, const StressSceneDesc& desc, StressRandom& random, StressScene& outScene) {
+    std::shared_ptr<Model> quad = stress_create_quad(context);
+    std::shared_ptr<Material> material = Material::Create({1.0f, 1.0f, 1.0f, 1.0f});
+
+    // Quads are scattered over a 2x2 square that the camera frames, each a quarter of its width. They are ordered far to near so every one passes the depth test and gets shaded.
+    f32 viewSize = 2.0f;
+    f32 quadSize = 0.25f * viewSize;
+    f32 depthRange = 10.0f;
+    outScene.Scene.Entities.reserve(desc.Count);
+    for (u32 i = 0; i < desc.Count; i++) {
+        f32 limit = 0.5f * (viewSize - quadSize);
+        glm::vec3 position = {random.Range(-limit, limit), random.Range(-limit, limit), -depthRange * (1.0f - ((f32)i + 0.5f) / (f32)desc.Count)};
+        Entity entity = Entity::Create();
+        entity.Mesh = {quad, material, nullptr};
+        entity.Transform.ModelMatrix = glm::translate(glm::mat4(1.0f), position) * glm::scale(glm::mat4(1.0f), glm::vec3(quadSize));
+        outScene.Scene.Entities.push_back(entity);
+    }
+    stress_frame_grid(outScene.Scene, viewSize, 0.0f, desc.AspectRatio);
+}
+
+static void stress_build_occluded(GraphicsContext& context, const StressSceneDesc& desc, StressRandom& random, StressScene& outScene) {
+    std::shared_ptr<Model> cube = stress_create_cube(context, nullptr);
+    u32 side = stress_grid_side(desc.Count);
+    f32 spacing = 2.0f;
+    f32 width = (f32)side * spacing;
+    f32 wallHeight = 2.0f;
+
+    // The wall comes first so it is drawn first; it covers STRESS_OCCLUDED_WALL_FRACTION of the grid's
+    // width, and a little more of the view for being nearer the camera.
+    outScene.Scene.Entities.reserve(desc.Count + 1);
+    Entity wall = Entity::Create();
+    wall.Mesh = {stress_create_quad(context), Material::Create({0.5f, 0.5f, 0.5f, 1.0f}), stress_create_quad_occluder()};
+    wall.Transform.ModelMatrix = glm::translate(glm::mat4(1.0f), {0.0f, 0.0f, wallHeight}) * glm::scale(glm::mat4(1.0f), glm::vec3(STRESS_OCCLUDED_WALL_FRACTION * width));
+    outScene.Scene.Entities.push_back(wall);
+
+    for (u32 i = 0; i < desc.Count; i++) {
+        Entity entity = Entity::Create();
+        entity.Mesh.Model = cube;
+        entity.Transform.ModelMatrix = glm::translate(glm::mat4(1.0f), stress_grid_position(i, side, spacing)) * stress_random_orientation(random);
+        outScene.Scene.Entities.push_back(entity);
+    }
+    stress_frame_grid(outScene.Scene, width, wallHeight, desc.AspectRatio);
+}
+
+static void stress_build_spheres(GraphicsContext& context, const StressSceneDesc& desc, StressRandom& random, StressScene& outScene) {
+    std::shared_ptr<Model> sphere = stress_create_sphere(context);
+    u32 side = stress_grid_side(desc.Count);
+    f32 spacing = 1.5f;
+    f32 width = (f32)side * spacing;
+
+    // The grid lies on the ground and stretches away from a camera standing at its near edge, so the
+    // nearest rows draw at full detail and the farthest at the coarsest level.
+    outScene.Scene.Entities.reserve(desc.Count);
+    for (u32 i = 0; i < desc.Count; i++) {
+        glm::vec3 position = stress_grid_position(i, side, spacing);
+        position.y += 0.5f * width;
+        Entity entity = Entity::Create();
+        entity.Mesh.Model = sphere;
+        entity.Transform.ModelMatrix = glm::translate(glm::mat4(1.0f), position) * stress_random_orientation(random);
+        outScene.Scene.Entities.push_back(entity);
+    }
+    f32 height = 0.1f * width + 1.0f;
+    outScene.Scene.MainCamera.SetView({0.0f, -spacing, height}, glm::normalize(glm::vec3(0.0f, 0.5f * width + spacing, -height)), {0.0f, 0.0f, 1.0f});
+    outScene.Scene.MainCamera.SetPerspectiveProjection(glm::radians(70.0f), desc.AspectRatio, 0.1f, 2.0f * width + height);
+}
+
+static void stress_build_viking(GraphicsContext& context, const StressSceneDesc& desc, StressScene& outScene) {
+    Entity room = Entity::Create();
+    room.Mesh = {context.LoadModelFromOBJ("../../testbed/assets/models/viking/viking_room.obj"), nullptr, nullptr};
+    room.Transform.ModelMatrix = glm::mat4(1.0f);
+    outScene.Scene.Entities.push_back(room);
+    stress_add_dynamic(outScene, 0);
+    outScene.Scene.MainCamera.SetView({1.2f, 1.2f, 1.2f}, {-1.0f, -1.0f, -1.0f}, {0.0f, 0.0f, 1.0f});
+    outScene.Scene.MainCamera.SetPerspectiveProjection(glm::radians(70.0f), desc.AspectRatio, 0.01f, 1000.0f);
+}
+
+bool stress_build_scene(GraphicsContext& context, const StressSceneDesc& desc, StressScene& outScene, std::string& outError) {
+    if (std::find(stressSceneNames.begin(), stressSceneNames.end(), desc.Name) == stressSceneNames.end()) {
+        outError = "unknown scene";
+        return false;
+    }
+    if (desc.Name != "viking" && desc.Count == 0) {
+        outError = "no entities";
+        return false;
+    }
+    // Every mesh owns a vertex and an index buffer, each its own allocation, and drivers may cap the
+    // number of live allocations as low as 4096.
+    if (desc.Name == "unique") {
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(context.GetDevice()->PhysicalDevice, &properties);
+        u64 allocations = 2ull * desc.Count + 256;
+        if (allocations > properties.limits.maxMemoryAllocationCount) {
+            outError = "needs " + std::to_string(allocations) + " memory allocations, the device allows " + std::to_string(properties.limits.maxMemoryAllocationCount);
+            return false;
+        }
+    }
+
+    outScene = {};
+    StressRandom random = {desc.Seed};
+    if (desc.Name == "viking") {
+        stress_build_viking(context, desc, outScene);
+    } else if (desc.Name == "hierarchy") {
+        stress_build_hierarchy(context, desc, random, outScene);
+    } else if (desc.Name == "overdraw") {
+        stress_build_overdraw(context, desc, random, outScene);
+    } else if (desc.Name == "occluded") {
+        stress_build_occluded(context, desc, random, outScene);
+    } else if (desc.Name == "spheres") {
+        stress_build_spheres(context, desc, random, outScene);
+    } else {
+        stress_build_grid(context, desc, random, outScene);
+    }
+    return true;
+}
+
+void stress_update_scene(StressScene& scene, u32 frame) {
+    glm::mat4 spin = glm::rotate(glm::mat4(1.0f), 0.01f * (f32)frame, {0.0f, 0.0f, 1.0f});
+    for (u32 i = 0; i < scene.Dynamic.size(); i++) {
+        Transform& transform = scene.Scene.Entities[scene.Dynamic[i]].Transform;
+        glm::mat4& matrix = transform.Parent == TRANSFORM_NO_PARENT ? transform.ModelMatrix : transform.LocalMatrix;
+        matrix = scene.DynamicBase[i] * spin;
+    }
+    if (scene.Hierarchy) {
+        scene.Scene.UpdateTransforms();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Cortex/Base/Base.hpp"
+#include "Cortex/Core/Scene.hpp"
+#include "Cortex/Entities/Entity.hpp"
+#include "Cortex/Graphics/GraphicsContext.hpp"
+
+// Procedural scenes for measuring how the renderer scales with entity count. Everything is derived
+// from the seed with our own generator rather than <random>, whose distributions differ between
+// standard libraries, so a given seed and size builds the same scene on every platform.
+
+#define STRESS_HIERARCHY_DEPTH 32       // links per chain in the hierarchy scene
+#define STRESS_MIXED_MODEL_COUNT 8
+#define STRESS_MIXED_DYNAMIC_FRACTION 0.1f
+#define STRESS_OCCLUDED_WALL_FRACTION 0.8f
+#define STRESS_SPHERE_SEGMENTS 48       // 2208 triangles at full detail
+#define STRESS_SPHERE_RINGS 24
+
+struct StressRandom {
+    u64 State;
+
+    // splitmix64
+    inline u64 Next() {
+        u64 z = (State += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+    inline f32 Float() { return (f32)(Next() >> 40) / (f32)(1ull << 24); } // [0, 1)
+    inline f32 Range(f32 min, f32 max) { return min + (max - min) * Float(); }
+};
+
+struct StressSceneDesc {
+    std::string Name;
+    u32 Count;      // entities; ignored by "viking"
+    u64 Seed;
+    f32 AspectRatio;
+};
+
+struct StressScene {
+    Cortex::Scene Scene;
+    std::vector<u32> Dynamic;           // entities animated every frame
+    std::vector<glm::mat4> DynamicBase; // their matrices at frame 0
+    bool Hierarchy = false;             // entities have parents, so transforms are resolved every frame
+};
+
+const std::vector<std::string>& stress_scene_names();
+// Returns false, with the reason in outError, when the scene is unknown or cannot be built at this
+// size on this device.
+bool stress_build_scene(Cortex::GraphicsContext& context, const StressSceneDesc& desc, StressScene& outScene, std::string& outError);
+// Poses the dynamic entities for the given frame; a pure function of the frame, not of elapsed time.
+void stress_update_scene(StressScene& scene, u32 frame);
\ No newline at end of file
@@ -0,0 +1,484 @@
+#include "Cortex/Base/Base.hpp"
+#include "Cortex/Graphics/GraphicsContext.hpp"
+#include "Cortex/Graphics/Renderer.hpp"
+
+#include "StressScenes.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+#if defined(PLATFORM_LINUX)
+    #include <unistd.h>
+#elif defined(PLATFORM_MACOS)
+    #include <mach/mach.h>
+#endif
+
+// Renders scenes headless for a set number of frames and writes frame-time percentiles as JSON, so
+// runs can be compared between commits. A sweep renders every requested scene at every requested
+// size, for plotting how the renderer scales. Run it from a directory inside the build tree, like
+// the testbed, so the renderer's relative asset paths resolve.
+
+using namespace Cortex;
+
+struct BenchOptions {
+    std::vector<std::string> Scenes = {"viking"};
+    std::vector<u32> Sizes = {1000, 10000, 100000, 1000000};
+    u64 Seed = 1;
+    u32 Frames = 1000;
+    u32 Warmup = 100;   // frames rendered before sampling starts: pipeline caches, uploads, first-use costs
+    f64 MaxSeconds = 30.0; // per run; large sizes stop sampling early rather than running for hours
+    u32 Width = 1280;
+    u32 Height = 720;
+    u32 MSAA = 4;
+    bool PipelineStatistics = false;
+    std::vector<bool> DepthPrepass = {false};   // "both" runs every scene and size without, then with
+    bool OcclusionCulling = false;
+    bool CpuOcclusionCulling = false;
+    f32 LodError = LodSelectionSettings{}.ErrorPixels;
+    std::string Output = "cortex_bench.json";
+};
+
+struct BenchSummary {
+    u64 Count = 0;
+    f64 Mean = 0.0;
+    f64 P50 = 0.0;
+    f64 P95 = 0.0;
+    f64 P99 = 0.0;
+    f64 Max = 0.0;
+};
+
+struct BenchRun {
+    std::string Scene;
+    u32 Entities = 0;
+    std::string Skipped;    // why the run did not happen, empty if it did
+    f64 BuildTime = 0.0;    // milliseconds to generate the scene and upload its meshes
+    u64 DrawCalls = 0;      // in the last frame
+    u64 Triangles = 0;
+    u64 CpuMemory = 0;      // resident bytes after the run
+    u64 GpuMemory = 0;      // device memory in use after the run, 0 without VK_EXT_memory_budget
+    BenchSummary Frame;
+    BenchSummary Update;
+    BenchSummary Record;
+    BenchSummary Gpu;
+    bool DepthPrepass = false;
+    BenchSummary Fragments;     // fragment shader invocations per frame, with pipeline statistics only
+    bool Compared = false;      // a run without the prepass preceded this one, so the fields below are set
+    f64 FragmentReduction = 0.0;    // fraction of fragment invocations the prepass removed
+    f64 GpuChange = 0.0;            // relative change in GPU p50
+    bool OcclusionCulling = false;
+    OcclusionStats Occlusion;       // from the last frame read back
+    bool CpuOcclusionCulling = false;
+    SoftwareOcclusionStats CpuOcclusion;    // from the last frame
+    BenchSummary CpuCull;                   // milliseconds rasterizing occluders and testing bounds
+    f32 LodError = 0.0f;
+    std::array<u64, MESH_MAX_LODS> LodInstances = {};   // in the last frame, direct draws only
+    std::array<u64, MESH_MAX_LODS> LodTriangles = {};
+    std::map<std::string, BenchSummary> GpuScopes;
+};
+
+static void bench_print_usage() {
+    LOG_INFO("Usage: CortexBench [--scene name[,name...]|all] [--sizes N[,N...]] [--seed N] [--frames N] [--warmup N] [--max-seconds S] [--width N] [--height N] [--msaa 1|2|4|8] [--statistics] [--depth-prepass off|on|both] [--occlusion] [--cpu-occlusion] [--lod-error pixels] [--output path]");
+    std::string names;
+    for (const std::string& name : stress_scene_names()) {
+        names += " " + name;
+    }
+    LOG_INFO("Scenes:%s", names.c_str());
+}
+
+static std::vector<std::string> bench_split(const std::string& list) {
+    std::vector<std::string> items;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+static bool bench_parse_options(i32 argc, char** argv, BenchOptions& options) {
+    for (i32 i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--statistics") {
+            options.PipelineStatistics = true;
+            continue;
+        }
+        if (arg == "--occlusion") {
+            options.OcclusionCulling = true;
+            continue;
+        }
+        if (arg == "--cpu-occlusion") {
+            options.CpuOcclusionCulling = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            LOG_ERROR("Missing value for %s.", arg.c_str());
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--scene") {
+            options.Scenes = value == "all" ? stress_scene_names() : bench_split(value);
+        } else if (arg == "--sizes") {
+            options.Sizes.clear();
+            for (const std::string& size : bench_split(value)) {
+                options.Sizes.push_back((u32)std::stoul(size));
+            }
+        } else if (arg == "--lod-error") {
+            options.LodError = std::stof(value);
+        } else if (arg == "--seed") {
+            options.Seed = std::stoull(value);
+        } else if (arg == "--frames") {
+            options.Frames = (u32)std::stoul(value);
+        } else if (arg == "--warmup") {
+            options.Warmup = (u32)std::stoul(value);
+        } else if (arg == "--max-seconds") {
+            options.MaxSeconds = std::stod(value);
+        } else if (arg == "--width") {
+            options.Width = (u32)std::stoul(value);
+        } else if (arg == "--height") {
+            options.Height = (u32)std::stoul(value);
+        } else if (arg == "--msaa") {
+            options.MSAA = (u32)std::stoul(value);
+        } else if (arg == "--depth-prepass") {
+            if (value == "off") {
+                options.DepthPrepass = {false};
+            } else if (value == "on") {
+                options.DepthPrepass = {true};
+            } else if (value == "both") {
+                options.DepthPrepass = {false, true};
+            } else {
+                LOG_ERROR("--depth-prepass takes off, on or both.");
+                return false;
+            }
+        } else if (arg == "--output") {
+            options.Output = value;
+        } else {
+            LOG_ERROR("Unknown option %s.", arg.c_str());
+            return false;
+        }
+    }
+    return options.Frames > 0 && options.Width > 0 && options.Height > 0 && !options.Scenes.empty() && !options.Sizes.empty();
+}
+
+static u64 bench_resident_memory() {
+#if defined(PLATFORM_LINUX)
+    std::ifstream statm("/proc/self/statm");
+    u64 pages = 0, resident = 0;
+    statm >> pages >> resident;
+    return resident * (u64)sysconf(_SC_PAGESIZE);
+#elif defined(PLATFORM_MACOS)
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) != KERN_SUCCESS) {
+        return 0;
+    }
+    return info.resident_size;
+#else
+    return 0;
+#endif
+}
+
+// Nearest-rank percentiles, so every reported value is one that was actually measured.
+static BenchSummary bench_summarise(std::vector<f64> samples) {
+    BenchSummary summary;
+    if (samples.empty()) {
+        return summary;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&](f64 p) {
+        u64 rank = (u64)std::ceil(p * (f64)samples.size());
+        return samples[std::clamp<u64>(rank, 1, samples.size()) - 1];
+    };
+    f64 sum = 0.0;
+    for (f64 sample : samples) {
+        sum += sample;
+    }
+    summary.Count = samples.size();
+    summary.Mean = sum / (f64)samples.size();
+    summary.P50 = percentile(0.50);
+    summary.P95 = percentile(0.95);
+    summary.P99 = percentile(0.99);
+    summary.Max = samples.back();
+    return summary;
+}
+
+static f64 bench_milliseconds(std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point end) {
+    return std::chrono::duration<f64, std::milli>(end - begin).count();
+}
+
+// Frame: wall time from one frame starting to the next, i.e. throughput with the GPU as the limit.
+// Update: posing the scene. Record: DrawScene and EndFrame only, the CPU cost of building and
+// submitting a frame without the wait for a free frame slot. GPU: the profiler's root scope and every
+// scope under it, resolved a few frames late.
+static BenchRun bench_run_scene(GraphicsContext& context, Renderer& renderer, const BenchOptions& options, const std::string& sceneName, u32 size, bool depthPrepass) {
+    BenchRun run;
+    run.Scene = sceneName;
+    run.Entities = size;
+    run.DepthPrepass = depthPrepass;
+    run.OcclusionCulling = renderer.GetSettings().OcclusionCulling;
+    run.CpuOcclusionCulling = renderer.GetSettings().CpuOcclusionCulling;
+    run.LodError = renderer.GetSettings().LodSelection.ErrorPixels;
+
+    StressSceneDesc desc = {sceneName, size, options.Seed, (f32)options.Width / (f32)options.Height};
+    StressScene scene;
+    auto buildStart = std::chrono::steady_clock::now();
+    if (!stress_build_scene(context, desc, scene, run.Skipped)) {
+        LOG_WARN("Skipping %s at %u entities: %s.", sceneName.c_str(), size, run.Skipped.c_str());
+        return run;
+    }
+    scene.Scene.DepthPrepass = depthPrepass;
+    run.Entities = (u32)scene.Scene.Entities.size();
+    run.BuildTime = bench_milliseconds(buildStart, std::chrono::steady_clock::now());
+    LOG_INFO("Running %s with %u entities%s (built in %.1f ms).", sceneName.c_str(), run.Entities, depthPrepass ? " and a depth prepass" : "", run.BuildTime);
+
+    std::vector<f64> frameTimes;
+    std::vector<f64> updateTimes;
+    std::vector<f64> recordTimes;
+    std::vector<f64> gpuTimes;
+    std::vector<f64> fragments;
+    std::vector<f64> cpuCullTimes;
+    std::map<std::string, std::vector<f64>> scopeTimes;
+    u64 firstSampledFrame = context.GetFrameNumber() + options.Warmup;
+    u64 lastGpuFrame = renderer.GetGpuTimings().FrameNumber;
+
+    u32 totalFrames = options.Warmup + options.Frames;
+    auto runStart = std::chrono::steady_clock::now();
+    auto frameStart = runStart;
+    for (u32 frame = 0; frame < totalFrames; frame++) {
+        auto updateStart = std::chrono::steady_clock::now();
+        stress_update_scene(scene, frame);
+        auto updateEnd = std::chrono::steady_clock::now();
+
+        VkCommandBuffer commandBuffer;
+        if (!context.BeginFrame(commandBuffer)) {
+            continue;
+        }
+        auto recordStart = std::chrono::steady_clock::now();
+        renderer.DrawScene(commandBuffer, scene.Scene);
+        context.EndFrame();
+        auto frameEnd = std::chrono::steady_clock::now();
+
+        if (frame >= options.Warmup) {
+            updateTimes.push_back(bench_milliseconds(updateStart, updateEnd));
+            recordTimes.push_back(bench_milliseconds(recordStart, frameEnd));
+            frameTimes.push_back(bench_milliseconds(frameStart, frameEnd));
+            if (run.CpuOcclusionCulling) {
+                const SoftwareOcclusionStats& cpu = renderer.GetFrameStats().CpuOcclusion;
+                cpuCullTimes.push_back(cpu.RasterMilliseconds + cpu.TestMilliseconds);
+            }
+        }
+        frameStart = frameEnd;
+
+        const GpuFrameTimings& timings = renderer.GetGpuTimings();
+        if (timings.FrameNumber != lastGpuFrame && !timings.Scopes.empty()) {
+            lastGpuFrame = timings.FrameNumber;
+            if (timings.FrameNumber > firstSampledFrame) {
+                // Scopes are depth-first, so a parent's path is always built before its children's.
+                std::vector<std::string> paths(timings.Scopes.size());
+                for (u32 i = 0; i < timings.Scopes.size(); i++) {
+                    const GpuScopeTiming& scope = timings.Scopes[i];
+                    paths[i] = scope.Parent == GPU_PROFILER_NO_PARENT ? scope.Name : paths[scope.Parent] + "/" + scope.Name;
+                    scopeTimes[paths[i]].push_back(scope.Time);
+                }
+                gpuTimes.push_back(timings.Scopes[0].Time);
+                if (options.PipelineStatistics) {
+                    fragments.push_back((f64)timings.Statistics.FragmentShaderInvocations);
+                }
+            }
+        }
+
+        if (frame >= options.Warmup && bench_milliseconds(runStart, frameEnd) > 1000.0 * options.MaxSeconds) {
+            LOG_WARN("%s at %u entities hit the %.0f s limit after %zu sampled frames.", sceneName.c_str(), run.Entities, options.MaxSeconds, frameTimes.size());
+            break;
+        }
+    }
+    vkDeviceWaitIdle(context.GetDevice()->Device);
+
+    const FrameStats& stats = renderer.GetFrameStats();
+    run.DrawCalls = stats.Counters.DrawCalls;
+    run.Triangles = stats.Counters.Triangles;
+    run.Occlusion = stats.Occlusion;
+    run.CpuOcclusion = stats.CpuOcclusion;
+    run.LodInstances = stats.Counters.LodInstances;
+    run.LodTriangles = stats.Counters.LodTriangles;
+    run.CpuMemory = bench_resident_memory();
+    if (context.GetDevice()->Details.MemoryBudgetSupported) {
+        run.GpuMemory = vulkan_get_memory_usage(context.GetDevice()->PhysicalDevice);
+    }
+    run.Frame = bench_summarise(frameTimes);
+    run.Update = bench_summarise(updateTimes);
+    run.Record = bench_summarise(recordTimes);
+    run.Gpu = bench_summarise(gpuTimes);
+    run.Fragments = bench_summarise(fragments);
+    run.CpuCull = bench_summarise(cpuCullTimes);
+    for (const auto& [path, samples] : scopeTimes) {
+        run.GpuScopes[path] = bench_summarise(samples);
+    }
+
+    LOG_INFO("%s, %u entities: frame p50 %.3f / p99 %.3f ms, record p50 %.3f ms, GPU p50 %.3f ms, %llu draws, %.1f MiB resident.",
+        sceneName.c_str(), run.Entities, run.Frame.P50, run.Frame.P99, run.Record.P50, run.Gpu.P50, run.DrawCalls, (f64)run.CpuMemory / (1024.0 * 1024.0));
+    if (run.OcclusionCulling) {
+        LOG_INFO("%s, %u entities: %u outside the frustum, %u occluded, %u drawn early, %u drawn late.",
+            sceneName.c_str(), run.Entities, run.Occlusion.FrustumCulled, run.Occlusion.OcclusionCulled, run.Occlusion.DrawnEarly, run.Occlusion.DrawnLate);
+    }
+    if (run.CpuOcclusionCulling) {
+        LOG_INFO("%s, %u entities: CPU culled %u outside the frustum and %u behind %u occluders in p50 %.3f ms.",
+            sceneName.c_str(), run.Entities, run.CpuOcclusion.FrustumCulled, run.CpuOcclusion.OcclusionCulled, run.CpuOcclusion.Occluders, run.CpuCull.P50);
+    }
+    return run;
+}
+
+// Whether the prepass pays off for this content: the fragment work it saved against the GPU time it
+// cost or saved overall, since it also doubles the vertex work.
+static void bench_compare_depth_prepass(const BenchRun& without, BenchRun& with) {
+    if (!without.Skipped.empty() || !with.Skipped.empty() || without.Fragments.Mean <= 0.0 || without.Gpu.P50 <= 0.0) {
+        return;
+    }
+    with.Compared = true;
+    with.FragmentReduction = 1.0 - with.Fragments.Mean / without.Fragments.Mean;
+    with.GpuChange = with.Gpu.P50 / without.Gpu.P50 - 1.0;
+    LOG_INFO("Depth prepass on %s, %u entities: %.1f%% fewer fragment invocations, GPU p50 %.3f -> %.3f ms (%+.1f%%).",
+        with.Scene.c_str(), with.Entities, 100.0 * with.FragmentReduction, without.Gpu.P50, with.Gpu.P50, 100.0 * with.GpuChange);
+}
+
+static void bench_write_summary(std::ofstream& out, const BenchSummary& summary) {
+    out << "{\"count\": " << summary.Count
+        << ", \"mean\": " << summary.Mean
+        << ", \"p50\": " << summary.P50
+        << ", \"p95\": " << summary.P95
+        << ", \"p99\": " << summary.P99
+        << ", \"max\": " << summary.Max << "}";
+}
+
+static void bench_write_run(std::ofstream& out, const BenchRun& run) {
+    out << "    {\n";
+    out << "      \"scene\": \"" << run.Scene << "\",\n";
+    out << "      \"entities\": " << run.Entities << ",\n";
+    out << "      \"depth_prepass\": " << (run.DepthPrepass ? "true" : "false") << ",\n";
+    out << "      \"occlusion_culling\": " << (run.OcclusionCulling ? "true" : "false") << ",\n";
+    out << "      \"cpu_occlusion_culling\": " << (run.CpuOcclusionCulling ? "true" : "false") << ",\n";
+    out << "      \"lod_error_pixels\": " << run.LodError << ",\n";
+    if (!run.Skipped.empty()) {
+        out << "      \"skipped\": \"" << run.Skipped << "\"\n";
+        out << "    }";
+        return;
+    }
+    out << "      \"build_ms\": " << run.BuildTime << ",\n";
+    out << "      \"draw_calls\": " << run.DrawCalls << ",\n";
+    out << "      \"triangles\": " << run.Triangles << ",\n";
+    out << "      \"lod_instances\": [";
+    for (u32 lod = 0; lod < MESH_MAX_LODS; lod++) {
+        out << (lod > 0 ? ", " : "") << run.LodInstances[lod];
+    }
+    out << "],\n";
+    out << "      \"lod_triangles\": [";
+    for (u32 lod = 0; lod < MESH_MAX_LODS; lod++) {
+        out << (lod > 0 ? ", " : "") << run.LodTriangles[lod];
+    }
+    out << "],\n";
+    out << "      \"cpu_memory_bytes\": " << run.CpuMemory << ",\n";
+    out << "      \"gpu_memory_bytes\": " << run.GpuMemory << ",\n";
+    out << "      \"frame_ms\": "; bench_write_summary(out, run.Frame); out << ",\n";
+    out << "      \"update_ms\": "; bench_write_summary(out, run.Update); out << ",\n";
+    out << "      \"cpu_record_ms\": "; bench_write_summary(out, run.Record); out << ",\n";
+    out << "      \"gpu_ms\": "; bench_write_summary(out, run.Gpu); out << ",\n";
+    if (run.Fragments.Count > 0) {
+        out << "      \"fragment_invocations\": "; bench_write_summary(out, run.Fragments); out << ",\n";
+    }
+    if (run.OcclusionCulling) {
+        const OcclusionStats& o = run.Occlusion;
+        out << "      \"occlusion\": {\"tested\": " << o.Tested << ", \"frustum_culled\": " << o.FrustumCulled
+            << ", \"occlusion_culled\": " << o.OcclusionCulled << ", \"drawn_early\": " << o.DrawnEarly << ", \"drawn_late\": " << o.DrawnLate << "},\n";
+    }
+    if (run.CpuOcclusionCulling) {
+        const SoftwareOcclusionStats& c = run.CpuOcclusion;
+        out << "      \"cpu_occlusion\": {\"occluders\": " << c.Occluders << ", \"occluder_triangles\": " << c.TrianglesRasterized << ", \"tested\": " << c.Tested
+            << ", \"frustum_culled\": " << c.FrustumCulled << ", \"occlusion_culled\": " << c.OcclusionCulled << "},\n";
+        out << "      \"cpu_cull_ms\": "; bench_write_summary(out, run.CpuCull); out << ",\n";
+    }
+    if (run.Compared) {
+        out << "      \"fragment_reduction\": " << run.FragmentReduction << ",\n";
+        out << "      \"gpu_change\": " << run.GpuChange << ",\n";
+    }
+    out << "      \"gpu_scopes_ms\": {";
+    bool first = true;
+    for (const auto& [path, summary] : run.GpuScopes) {
+        out << (first ? "\n" : ",\n") << "        \"" << path << "\": ";
+        bench_write_summary(out, summary);
+        first = false;
+    }
+    out << "\n      }\n";
+    out << "    }";
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    if (!bench_parse_options(argc, argv, options)) {
+        bench_print_usage();
+        return EXIT_FAILURE;
+    }
+
+    std::unique_ptr<GraphicsContext> context = GraphicsContext::Create(VkExtent2D{options.Width, options.Height});
+    std::unique_ptr<Renderer> renderer = Renderer::Create(context);
+    renderer->SetMSAASamples((VkSampleCountFlagBits)options.MSAA);
+    if (options.DepthPrepass.size() > 1 && !options.PipelineStatistics) {
+        LOG_INFO("Comparing depth prepass runs needs fragment counts, enabling pipeline statistics.");
+        options.PipelineStatistics = true;
+    }
+    renderer->SetPipelineStatistics(options.PipelineStatistics);
+    renderer->SetOcclusionCulling(options.OcclusionCulling);
+    renderer->SetCpuOcclusionCulling(options.CpuOcclusionCulling);
+    LodSelectionSettings lodSelection = renderer->GetSettings().LodSelection;
+    lodSelection.ErrorPixels = options.LodError;
+    renderer->SetLodSelection(lodSelection);
+
+    // Smallest sizes first within each scene, so a sweep produces its cheap points before its slow ones.
+    std::vector<u32> sizes = options.Sizes;
+    std::sort(sizes.begin(), sizes.end());
+    std::vector<BenchRun> runs;
+    for (const std::string& sceneName : options.Scenes) {
+        std::vector<u32> sceneSizes = sceneName == "viking" ? std::vector<u32>{1} : sizes;
+        for (u32 size : sceneSizes) {
+            for (u32 i = 0; i < options.DepthPrepass.size(); i++) {
+                runs.push_back(bench_run_scene(*context, *renderer, options, sceneName, size, options.DepthPrepass[i]));
+                if (i > 0) {
+                    bench_compare_depth_prepass(runs[runs.size() - 2], runs.back());
+                }
+            }
+        }
+    }
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(context->GetDevice()->PhysicalDevice, &properties);
+    const FrameStats& stats = renderer->GetFrameStats();
+
+    std::ofstream out(options.Output);
+    if (!out) {
+        LOG_ERROR("Could not open %s for writing.", options.Output.c_str());
+        return EXIT_FAILURE;
+    }
+    out.setf(std::ios::fixed);
+    out.precision(4);
+    out << "{\n";
+    out << "  \"device\": \"" << properties.deviceName << "\",\n";
+    out << "  \"width\": " << options.Width << ",\n";
+    out << "  \"height\": " << options.Height << ",\n";
+    out << "  \"msaa\": " << (u32)stats.MSAASamples << ",\n";
+    out << "  \"frames_in_flight\": " << stats.FramesInFlight << ",\n";
+    out << "  \"seed\": " << options.Seed << ",\n";
+    out << "  \"warmup\": " << options.Warmup << ",\n";
+    out << "  \"frames\": " << options.Frames << ",\n";
+    out << "  \"runs\": [";
+    for (u32 i = 0; i < runs.size(); i++) {
+        out << (i == 0 ? "\n" : ",\n");
+        bench_write_run(out, runs[i]);
+    }
+    out << "\n  ]\n";
+    out << "}\n";
+
+    LOG_INFO("%zu runs on %s written to %s.", runs.size(), properties.deviceName, options.Output.c_str());
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "Cortex/Base/Defines.hpp"
 #include "Cortex/Base/Logging.hpp"
 #include "Cortex/Base/Asserts.hpp"
+#include "Cortex/Base/Profiler.hpp"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
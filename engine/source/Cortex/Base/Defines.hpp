@@ -41,6 +41,8 @@ STATIC_ASSERT(sizeof(f64) == 8, "Expected f64 to be 8 byte(s).");
     #else
         #error "Cortex only supports MacOS Desktops at this time."
     #endif
+#elif defined(__linux__)
+    #define PLATFORM_LINUX 1
 #else
-    #error "Cortex only supports Apple platforms at this time."
+    #error "Cortex only supports MacOS and Linux at this time."
 #endif
\ No newline at end of file
@@ -1,5 +1,8 @@
 #include "Cortex/Base/Logging.hpp"
 
+#include <cstdarg>
+#include <cstring>
+
 static const char *logLevelLabels[6] = {
     "[FATAL]",
     "[ERROR]",
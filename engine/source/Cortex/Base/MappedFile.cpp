@@ -0,0 +1,57 @@
+#include "Cortex/Base/MappedFile.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Cortex {
+    bool file_get_info(const std::string& path, FileInfo& outInfo) {
+        struct stat status;
+        if (stat(path.c_str(), &status) != 0) {
+            return false;
+        }
+        outInfo.Size = static_cast<u64>(status.st_size);
+        #ifdef PLATFORM_APPLE
+            outInfo.Modified = static_cast<i64>(status.st_mtimespec.tv_sec) * 1000000000 + status.st_mtimespec.tv_nsec;
+        #else
+            outInfo.Modified = static_cast<i64>(status.st_mtim.tv_sec) * 1000000000 + status.st_mtim.tv_nsec;
+        #endif
+        return true;
+    }
+
+    std::unique_ptr<MappedFile> MappedFile::Open(const std::string& path) {
+        int file = open(path.c_str(), O_RDONLY);
+        if (file < 0) {
+            return nullptr;
+        }
+        struct stat status;
+        if (fstat(file, &status) != 0) {
+            close(file);
+            return nullptr;
+        }
+        u64 size = static_cast<u64>(status.st_size);
+        // mmap refuses empty ranges, and an empty file has nothing to map anyway.
+        void* data = nullptr;
+        if (size > 0) {
+            data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+        }
+        // The mapping holds its own reference to the file.
+        close(file);
+        if (data == MAP_FAILED) {
+            return nullptr;
+        }
+        return std::make_unique<MappedFile>(static_cast<const u8*>(data), size);
+    }
+
+    MappedFile::MappedFile(const u8* data, u64 size) {
+        m_Data = data;
+        m_Size = size;
+    }
+
+    MappedFile::~MappedFile() {
+        if (m_Data) {
+            munmap(const_cast<u8*>(m_Data), m_Size);
+        }
+    }
+}
\ No newline at end of file
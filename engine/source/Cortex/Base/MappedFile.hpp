@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Cortex/Base/Defines.hpp"
+
+#include <memory>
+#include <string>
+
+namespace Cortex {
+    struct FileInfo {
+        u64 Size = 0;
+        i64 Modified = 0;   // nanoseconds since the epoch
+    };
+
+    // False if path cannot be examined.
+    bool file_get_info(const std::string& path, FileInfo& outInfo);
+
+    // A whole file mapped read-only. Pages are read in on first touch, so bytes never looked at cost
+    // nothing, and the mapping is shared with the page cache rather than copied out of it.
+    class MappedFile {
+        public:
+            // Null if path cannot be opened or mapped.
+            static std::unique_ptr<MappedFile> Open(const std::string& path);
+            MappedFile(const u8* data, u64 size);
+            ~MappedFile();
+            MappedFile(const MappedFile&) = delete;
+            MappedFile &operator=(const MappedFile&) = delete;
+            inline const u8* GetData() const { return m_Data; }
+            inline u64 GetSize() const { return m_Size; }
+        private:
+            const u8* m_Data;
+            u64 m_Size;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include "Cortex/Base/Profiler.hpp"
+#include "Cortex/Base/Logging.hpp"
+#include "Cortex/Base/Asserts.hpp"
+
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Cortex {
+    std::atomic<bool> Profiler::s_Active(false);
+    thread_local ProfilerThreadBuffer* Profiler::t_Buffer = nullptr;
+
+    // Everything below is touched by the flush thread or once per thread, never per zone.
+    static std::mutex s_RegistryMutex;
+    static std::vector<std::unique_ptr<ProfilerThreadBuffer>> s_Buffers;
+
+    static std::mutex s_SessionMutex;
+    static std::condition_variable s_SessionStop;
+    static std::thread s_FlushThread;
+    static FILE* s_File = nullptr;
+    static bool s_FirstEvent = true;
+    static u64 s_StartTicks = 0;
+    static std::chrono::steady_clock::time_point s_StartTime;
+
+    // Ticks per microsecond, measured over the whole session so far; on x86 the TSC rate is otherwise
+    // unknown, and the estimate only gets better the longer the session runs.
+    static f64 profiler_ticks_per_microsecond() {
+        f64 elapsed = std::chrono::duration<f64, std::micro>(std::chrono::steady_clock::now() - s_StartTime).count();
+        u64 ticks = profiler_read_ticks() - s_StartTicks;
+        return elapsed > 0.0 && ticks > 0 ? static_cast<f64>(ticks) / elapsed : 1.0;
+    }
+
+    static void profiler_write_event(const char* format, ...) {
+        fputs(s_FirstEvent ? "\n" : ",\n", s_File);
+        s_FirstEvent = false;
+        va_list args;
+        va_start(args, format);
+        vfprintf(s_File, format, args);
+        va_end(args);
+    }
+
+    static void profiler_drain() {
+        f64 ticksPerMicrosecond = profiler_ticks_per_microsecond();
+        std::lock_guard<std::mutex> lock(s_RegistryMutex);
+        for (auto& buffer : s_Buffers) {
+            u64 tail = buffer->Tail.load(std::memory_order_relaxed);
+            u64 head = buffer->Head.load(std::memory_order_acquire);
+            for (; tail < head; tail++) {
+                const ProfilerEvent& event = buffer->Events[tail & (PROFILER_BUFFER_CAPACITY - 1)];
+                f64 begin = static_cast<f64>(event.Begin - s_StartTicks) / ticksPerMicrosecond;
+                f64 duration = static_cast<f64>(event.End - event.Begin) / ticksPerMicrosecond;
+                profiler_write_event("{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                                     event.Name, buffer->ThreadId, begin, duration);
+            }
+            buffer->Tail.store(tail, std::memory_order_release);
+        }
+        fflush(s_File);
+    }
+
+    static void profiler_flush_loop() {
+        std::unique_lock<std::mutex> lock(s_SessionMutex);
+        while (Profiler::IsActive()) {
+            s_SessionStop.wait_for(lock, std::chrono::milliseconds(PROFILER_FLUSH_INTERVAL_MS));
+            profiler_drain();
+        }
+    }
+
+    void Profiler::BeginSession(const std::string& path) {
+        ASSERT(!IsActive(), "A profiling session is already running.");
+        s_File = fopen(path.c_str(), "w");
+        if (!s_File) {
+            LOG_ERROR("Could not open %s for the profiler trace.", path.c_str());
+            return;
+        }
+        fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", s_File);
+        s_FirstEvent = true;
+
+        {
+            // Zones left over from an earlier session would land before this one's start. Only the
+            // consumer's side moves: Head and CachedTail belong to producers that may be recording, and
+            // a stale CachedTail only sends a producer to reload Tail.
+            std::lock_guard<std::mutex> lock(s_RegistryMutex);
+            for (auto& buffer : s_Buffers) {
+                buffer->Tail.store(buffer->Head.load(std::memory_order_acquire), std::memory_order_release);
+                buffer->Dropped.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        s_StartTime = std::chrono::steady_clock::now();
+        s_StartTicks = profiler_read_ticks();
+        s_Active.store(true, std::memory_order_release);
+        s_FlushThread = std::thread(profiler_flush_loop);
+        LOG_INFO("Profiling to %s.", path.c_str());
+    }
+
+    void Profiler::EndSession() {
+        if (!IsActive()) { return; }
+        {
+            std::lock_guard<std::mutex> lock(s_SessionMutex);
+            s_Active.store(false, std::memory_order_release);
+        }
+        s_SessionStop.notify_one();
+        s_FlushThread.join();
+
+        // Catches zones closed after the flush thread's last pass. Zones still open now are discarded
+        // when the next session starts.
+        profiler_drain();
+        u64 dropped = 0;
+        {
+            std::lock_guard<std::mutex> lock(s_RegistryMutex);
+            for (auto& buffer : s_Buffers) {
+                profiler_write_event("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                                     buffer->ThreadId, buffer->ThreadName.c_str());
+                dropped += buffer->Dropped.load(std::memory_order_relaxed);
+            }
+        }
+        fputs("\n]}\n", s_File);
+        fclose(s_File);
+        s_File = nullptr;
+
+        if (dropped > 0) {
+            LOG_WARN("Profiler dropped %llu zones; raise PROFILER_BUFFER_CAPACITY or flush more often.", static_cast<unsigned long long>(dropped));
+        }
+    }
+
+    void Profiler::SetThreadName(const std::string& name) {
+        ProfilerThreadBuffer* buffer = t_Buffer ? t_Buffer : RegisterThread();
+        std::lock_guard<std::mutex> lock(s_RegistryMutex);
+        buffer->ThreadName = name;
+    }
+
+    ProfilerThreadBuffer* Profiler::RegisterThread() {
+        // Buffers belong to the registry rather than the thread, so zones from a thread that has
+        // exited are still written out.
+        auto buffer = std::make_unique<ProfilerThreadBuffer>();
+        buffer->Head.store(0, std::memory_order_relaxed);
+        buffer->Tail.store(0, std::memory_order_relaxed);
+        buffer->Dropped.store(0, std::memory_order_relaxed);
+        buffer->CachedTail = 0;
+
+        std::lock_guard<std::mutex> lock(s_RegistryMutex);
+        buffer->ThreadId = static_cast<u32>(s_Buffers.size()) + 1;
+        buffer->ThreadName = "Thread " + std::to_string(buffer->ThreadId);
+        t_Buffer = buffer.get();
+        s_Buffers.push_back(std::move(buffer));
+        return t_Buffer;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "Cortex/Base/Defines.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <string>
+
+// Compiled in for debug builds, or any build configured with CORTEX_PROFILING=ON. Otherwise every
+// macro below expands to nothing and no profiler code is referenced.
+#if defined(_DEBUG) || defined(CORTEX_ENABLE_PROFILING)
+    #define USE_PROFILING
+#endif
+
+namespace Cortex {
+    #define PROFILER_BUFFER_CAPACITY 16384 // zones per thread between flushes, must be a power of two
+    #define PROFILER_FLUSH_INTERVAL_MS 100
+
+    // Zone names are stored by pointer, so they must outlive the session (string literals or __func__).
+    struct ProfilerEvent {
+        const char* Name;
+        u64 Begin;
+        u64 End;
+    };
+
+    // Single producer (the owning thread), single consumer (the flush thread). The producer only ever
+    // advances Head and the consumer only Tail, so neither side takes a lock.
+    struct ProfilerThreadBuffer {
+        std::array<ProfilerEvent, PROFILER_BUFFER_CAPACITY> Events;
+        std::atomic<u64> Head;
+        std::atomic<u64> Tail;
+        std::atomic<u64> Dropped;
+        u64 CachedTail; // producer's last view of Tail, so the shared line is only read when it looks full; only the producer touches it
+        u32 ThreadId;
+        std::string ThreadName;
+    };
+
+    // Raw timestamp counter: the invariant TSC on x86 and the virtual counter on arm64, both a few
+    // cycles to read. Ticks are converted to time against steady_clock when the trace is written.
+    inline u64 profiler_read_ticks() {
+    #if defined(__x86_64__) || defined(__i386__)
+        return __builtin_ia32_rdtsc();
+    #elif defined(__aarch64__)
+        u64 ticks;
+        asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+        return ticks;
+    #else
+        return std::chrono::steady_clock::now().time_since_epoch().count();
+    #endif
+    }
+
+    // Scoped CPU zones written to per-thread ring buffers and streamed by a background thread to a
+    // Chrome trace JSON file, which chrome://tracing and ui.perfetto.dev both open.
+    class Profiler {
+        public:
+            static void BeginSession(const std::string& path);
+            static void EndSession();
+            static void SetThreadName(const std::string& name);
+            static inline bool IsActive() { return s_Active.load(std::memory_order_relaxed); }
+
+            static inline void Record(const char* name, u64 begin, u64 end) {
+                ProfilerThreadBuffer* buffer = t_Buffer ? t_Buffer : RegisterThread();
+                u64 head = buffer->Head.load(std::memory_order_relaxed);
+                if (head - buffer->CachedTail >= PROFILER_BUFFER_CAPACITY) {
+                    buffer->CachedTail = buffer->Tail.load(std::memory_order_acquire);
+                    if (head - buffer->CachedTail >= PROFILER_BUFFER_CAPACITY) {
+                        buffer->Dropped.fetch_add(1, std::memory_order_relaxed);
+                        return;
+                    }
+                }
+                buffer->Events[head & (PROFILER_BUFFER_CAPACITY - 1)] = {name, begin, end};
+                buffer->Head.store(head + 1, std::memory_order_release);
+            }
+        private:
+            static ProfilerThreadBuffer* RegisterThread();
+
+            static std::atomic<bool> s_Active;
+            static thread_local ProfilerThreadBuffer* t_Buffer;
+    };
+
+    class ProfileZone {
+        public:
+            inline ProfileZone(const char* name)
+                : m_Name(Profiler::IsActive() ? name : nullptr), m_Begin(m_Name ? profiler_read_ticks() : 0) {}
+            inline ~ProfileZone() {
+                if (m_Name) { Profiler::Record(m_Name, m_Begin, profiler_read_ticks()); }
+            }
+            ProfileZone(const ProfileZone&) = delete;
+            ProfileZone &operator=(const ProfileZone&) = delete;
+        private:
+            const char* m_Name;
+            u64 m_Begin;
+    };
+}
+
+#ifdef USE_PROFILING
+    #define CORTEX_PROFILE_CONCAT_INNER(a, b) a##b
+    #define CORTEX_PROFILE_CONCAT(a, b) CORTEX_PROFILE_CONCAT_INNER(a, b)
+    #define CORTEX_PROFILE_SCOPE(name) ::Cortex::ProfileZone CORTEX_PROFILE_CONCAT(profileZone, __LINE__)(name)
+    #define CORTEX_PROFILE_FUNCTION() CORTEX_PROFILE_SCOPE(__func__)
+    #define CORTEX_PROFILE_THREAD(name) ::Cortex::Profiler::SetThreadName(name)
+    #define CORTEX_PROFILE_BEGIN_SESSION(path) ::Cortex::Profiler::BeginSession(path)
+    #define CORTEX_PROFILE_END_SESSION() ::Cortex::Profiler::EndSession()
+#else
+    #define CORTEX_PROFILE_SCOPE(name)
+    #define CORTEX_PROFILE_FUNCTION()
+    #define CORTEX_PROFILE_THREAD(name)
+    #define CORTEX_PROFILE_BEGIN_SESSION(path)
+    #define CORTEX_PROFILE_END_SESSION()
+#endif
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include "Cortex/Base/WorkerPool.hpp"
+#include "Cortex/Base/Profiler.hpp"
+
+namespace Cortex {
+    WorkerPool::WorkerPool(u32 threadCount, const std::string& name)
+        : m_Name(name), m_Job(nullptr), m_JobCount(0), m_NextJob(0), m_Busy(0), m_Batch(0), m_Stopping(false) {
+        m_Threads.reserve(threadCount);
+        for (u32 i = 0; i < threadCount; i++) {
+            m_Threads.emplace_back(&WorkerPool::WorkerLoop, this, i);
+        }
+    }
+
+    WorkerPool::~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Stopping = true;
+        }
+        m_Wake.notify_all();
+        for (auto& thread : m_Threads) {
+            thread.join();
+        }
+    }
+
+    u32 WorkerPool::DefaultThreadCount() {
+        u32 hardware = std::thread::hardware_concurrency();
+        return hardware > 1 ? hardware - 1 : 0;
+    }
+
+    void WorkerPool::Run(u32 jobCount, const std::function<void(u32)>& job) {
+        if (jobCount == 0) {
+            return;
+        }
+        if (m_Threads.empty() || jobCount == 1) {
+            for (u32 i = 0; i < jobCount; i++) {
+                job(i);
+            }
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Job = &job;
+            m_JobCount = jobCount;
+            m_NextJob.store(0, std::memory_order_relaxed);
+            m_Busy = static_cast<u32>(m_Threads.size());
+            m_Batch++;
+        }
+        m_Wake.notify_all();
+        Work();
+
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Done.wait(lock, [this]() { return m_Busy == 0; });
+        m_Job = nullptr;
+    }
+
+    void WorkerPool::WorkerLoop([[maybe_unused]] u32 index) {
+        CORTEX_PROFILE_THREAD(m_Name + " " + std::to_string(index));
+        u64 seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                m_Wake.wait(lock, [this, seen]() { return m_Stopping || m_Batch != seen; });
+                if (m_Stopping) {
+                    return;
+                }
+                seen = m_Batch;
+            }
+            Work();
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                if (--m_Busy == 0) {
+                    m_Done.notify_one();
+                }
+            }
+        }
+    }
+
+    void WorkerPool::Work() {
+        for (u32 i = m_NextJob.fetch_add(1, std::memory_order_relaxed); i < m_JobCount; i = m_NextJob.fetch_add(1, std::memory_order_relaxed)) {
+            (*m_Job)(i);
+        }
+    }
+}
\ No newline at end of file
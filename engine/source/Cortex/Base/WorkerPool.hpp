@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Cortex/Base/Defines.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Cortex {
+    // A fixed set of threads that work through batches of indexed jobs. The thread calling Run takes
+    // jobs too, so a pool of zero threads runs everything inline.
+    class WorkerPool {
+        public:
+            WorkerPool(u32 threadCount, const std::string& name = "Worker");
+            ~WorkerPool();
+            WorkerPool(const WorkerPool&) = delete;
+            WorkerPool &operator=(const WorkerPool&) = delete;
+            // One thread per hardware thread, less the one that will be calling Run.
+            static u32 DefaultThreadCount();
+            inline u32 GetThreadCount() const { return static_cast<u32>(m_Threads.size()); }
+            // Calls job(i) once for every i below jobCount and returns when they have all finished. Jobs
+            // are handed out in order but run concurrently, so they must not depend on one another.
+            void Run(u32 jobCount, const std::function<void(u32)>& job);
+        private:
+            void WorkerLoop(u32 index);
+            void Work();
+
+            std::string m_Name;
+            std::vector<std::thread> m_Threads;
+            std::mutex m_Mutex;
+            std::condition_variable m_Wake;
+            std::condition_variable m_Done;
+            const std::function<void(u32)>* m_Job;
+            u32 m_JobCount;
+            std::atomic<u32> m_NextJob;
+            u32 m_Busy;     // workers yet to finish the current batch
+            u64 m_Batch;    // bumped for every Run, so workers can tell a new batch from a spurious wake
+            bool m_Stopping;
+    };
+}
\ No newline at end of file
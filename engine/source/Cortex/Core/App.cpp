@@ -5,8 +5,11 @@
 namespace Cortex
 {
     App::App()
-        : m_Running(true)
+        : m_Running(true), m_DepthPrepass(false)
     {
+        CORTEX_PROFILE_THREAD("Main");
+        CORTEX_PROFILE_BEGIN_SESSION("cortex_trace.json");
+
         m_Window = std::make_unique<Window>();
         m_Window->SetEventCallback(std::bind(&App::OnEvent, this, std::placeholders::_1));
 
@@ -18,7 +21,7 @@ namespace Cortex
 
     App::~App()
     {
-        
+        CORTEX_PROFILE_END_SESSION();
     }
 
     bool App::Run()
@@ -78,10 +81,10 @@ namespace Cortex
         std::shared_ptr<Model> testModel = m_GraphicsContext->LoadModelFromOBJ("../../testbed/assets/models/viking/viking_room.obj");
 
         Entity cube = Entity::Create();
-        cube.Mesh = {cubeModel};
+        cube.Mesh = {cubeModel, nullptr, nullptr};
 
         Entity quad = Entity::Create();
-        quad.Mesh = {quadModel};
+        quad.Mesh = {quadModel, nullptr, nullptr};
         
         Scene scene;
 
@@ -96,7 +99,7 @@ namespace Cortex
         // }
 
         Entity test = Entity::Create();
-        test.Mesh = {testModel};
+        test.Mesh = {testModel, nullptr, nullptr};
         test.Transform.ModelMatrix = glm::translate(glm::mat4(1.0f), {0.0f, 0.0f, 0.0f});
         scene.Entities.push_back(test);
 
@@ -104,32 +107,71 @@ namespace Cortex
 
         f64 dt = 0.0;
         f64 elapsed = 0.0;
+        f64 statsTimer = 0.0;
         auto now = std::chrono::high_resolution_clock::now();
         while (m_Running) {    
+            CORTEX_PROFILE_SCOPE("Frame");
             m_Window->Update(dt);
 
-            scene.MainCamera.SetPerspectiveProjection(glm::radians(70.0f), m_AspectRatio, 0.01f, 1000.0f);
+            {
+                CORTEX_PROFILE_SCOPE("Scene::Update");
+                scene.MainCamera.SetPerspectiveProjection(glm::radians(70.0f), m_AspectRatio, 0.01f, 1000.0f);
+                scene.DepthPrepass = m_DepthPrepass;
 
-            for (auto& e : scene.Entities) {
-                if (e.Mesh.Model == testModel) {
-                    e.Transform.ModelMatrix = glm::rotate(e.Transform.ModelMatrix, 0.1f * (f32)dt * (f32)glm::sin(0.5*elapsed), {0.0f, 0.0f, 1.0f});
+                for (auto& e : scene.Entities) {
+                    if (e.Mesh.Model == testModel) {
+                        e.Transform.ModelMatrix = glm::rotate(e.Transform.ModelMatrix, 0.1f * (f32)dt * (f32)glm::sin(0.5*elapsed), {0.0f, 0.0f, 1.0f});
+                    }
                 }
             }
 
             VkCommandBuffer cmd;
             u32 frameIndex;
             if (m_GraphicsContext->BeginFrame(cmd)) {
-                m_GraphicsContext->BeginRenderPass(cmd);
                 m_Renderer->DrawScene(cmd, scene);
-                m_GraphicsContext->EndRenderPass(cmd);
                 m_GraphicsContext->EndFrame();
             }
+            m_FrameLimiter.Wait();
 
             auto next = std::chrono::high_resolution_clock::now();
             dt = std::chrono::duration<f64, std::chrono::seconds::period>(next - now).count();
             elapsed += dt;
             now = next;
 
+            statsTimer += dt;
+            if (statsTimer >= 1.0) {
+                const FrameStats& stats = m_Renderer->GetFrameStats();
+                LOG_INFO("Frame %llu: %.2f ms (mean %.2f, stddev %.2f, max %.2f) GPU %.2f ms, %ux%u (scale %.2f), MSAA x%u, %s, %u in flight",
+                    stats.FrameNumber, stats.FrameTime, stats.FrameTimeMean, stats.FrameTimeStdDev, stats.FrameTimeMax, stats.GpuTime,
+                    stats.RenderExtent.width, stats.RenderExtent.height, stats.RenderScale, (u32)stats.MSAASamples, string_VkPresentModeKHR(stats.PresentMode), stats.FramesInFlight);
+                LOG_INFO("  %llu draws, %llu triangles, %llu pipeline / %llu descriptor binds, %llu bytes uploaded",
+                    stats.Counters.DrawCalls, stats.Counters.Triangles, stats.Counters.PipelineBinds, stats.Counters.DescriptorBinds, stats.Counters.BytesUploaded);
+                if (m_Renderer->GetSettings().PipelineStatistics) {
+                    LOG_INFO("  %llu primitives rasterized, %llu fragment invocations, overdraw %.2f, depth prepass %s",
+                        stats.PipelineStatistics.ClippingPrimitives, stats.PipelineStatistics.FragmentShaderInvocations, stats.Overdraw, stats.DepthPrepass ? "on" : "off");
+                }
+                if (stats.OcclusionCulling) {
+                    LOG_INFO("  occlusion: %u tested, %u outside the frustum, %u occluded, %u drawn early, %u drawn late",
+                        stats.Occlusion.Tested, stats.Occlusion.FrustumCulled, stats.Occlusion.OcclusionCulled, stats.Occlusion.DrawnEarly, stats.Occlusion.DrawnLate);
+                }
+                if (stats.CpuOcclusionCulling) {
+                    const SoftwareOcclusionStats& cpu = stats.CpuOcclusion;
+                    LOG_INFO("  cpu occlusion: %u occluders (%u triangles), %u tested, %u outside the frustum, %u occluded, %.3f ms raster, %.3f ms test",
+                        cpu.Occluders, cpu.TrianglesRasterized, cpu.Tested, cpu.FrustumCulled, cpu.OcclusionCulled, cpu.RasterMilliseconds, cpu.TestMilliseconds);
+                }
+                std::string lods;
+                for (u32 lod = 0; lod < MESH_MAX_LODS; lod++) {
+                    if (stats.Counters.LodInstances[lod] > 0) {
+                        lods += " " + std::to_string(lod) + ": " + std::to_string(stats.Counters.LodInstances[lod]) + " (" + std::to_string(stats.Counters.LodTriangles[lod]) + " triangles)";
+                    }
+                }
+                if (!lods.empty()) {
+                    LOG_INFO("  lods:%s", lods.c_str());
+                }
+                LOG_DEBUG("%s", m_Renderer->GetGpuProfiler().Dump().c_str());
+                statsTimer = 0.0;
+            }
+
         }
 
         vkDeviceWaitIdle(m_GraphicsContext->GetDevice()->Device);
@@ -146,6 +188,58 @@ namespace Cortex
             break;
         case EventTag::KeyEvent:
             LOG_INFO("Key Press: %i", e.KeyEvent.KeyCode);
+            if (e.KeyEvent.Action == KEY_PRESS) {
+                switch (e.KeyEvent.KeyCode) {
+                    case GLFW_KEY_1: m_Renderer->SetMSAASamples(VK_SAMPLE_COUNT_1_BIT); break;
+                    case GLFW_KEY_2: m_Renderer->SetMSAASamples(VK_SAMPLE_COUNT_2_BIT); break;
+                    case GLFW_KEY_4: m_Renderer->SetMSAASamples(VK_SAMPLE_COUNT_4_BIT); break;
+                    case GLFW_KEY_8: m_Renderer->SetMSAASamples(VK_SAMPLE_COUNT_8_BIT); break;
+                    case GLFW_KEY_P: {
+                        // Cycle FIFO -> MAILBOX -> IMMEDIATE.
+                        auto config = m_GraphicsContext->GetPresentConfig();
+                        switch (config.PresentMode) {
+                            case VK_PRESENT_MODE_FIFO_KHR: config.PresentMode = VK_PRESENT_MODE_MAILBOX_KHR; break;
+                            case VK_PRESENT_MODE_MAILBOX_KHR: config.PresentMode = VK_PRESENT_MODE_IMMEDIATE_KHR; break;
+                            default: config.PresentMode = VK_PRESENT_MODE_FIFO_KHR; break;
+                        }
+                        m_GraphicsContext->SetPresentConfig(config);
+                        break;
+                    }
+                    case GLFW_KEY_W: {
+                        auto config = m_GraphicsContext->GetPresentConfig();
+                        config.PresentWait = !config.PresentWait;
+                        m_GraphicsContext->SetPresentConfig(config);
+                        break;
+                    }
+                    case GLFW_KEY_I: m_GraphicsContext->SetFramesInFlight(m_GraphicsContext->GetFramesInFlight() % MAX_FRAMES_IN_FLIGHT_LIMIT + 1); break;
+                    case GLFW_KEY_L: m_FrameLimiter.SetTargetFPS(m_FrameLimiter.GetTargetFPS() > 0.0 ? 0.0 : 60.0); break;
+                    case GLFW_KEY_S: m_Renderer->SetPipelineStatistics(!m_Renderer->GetSettings().PipelineStatistics); break;
+                    case GLFW_KEY_C: m_Renderer->WriteFrameStatsCSV("cortex_frame_stats.csv"); break;
+                    case GLFW_KEY_D: m_DepthPrepass = !m_DepthPrepass; break;
+                    case GLFW_KEY_O: m_Renderer->SetOcclusionCulling(!m_Renderer->GetSettings().OcclusionCulling); break;
+                    case GLFW_KEY_K: m_Renderer->SetCpuOcclusionCulling(!m_Renderer->GetSettings().CpuOcclusionCulling); break;
+                    case GLFW_KEY_J: {
+                        // Steps through forcing each level the models were imported with, then back to selecting by error.
+                        auto settings = m_Renderer->GetSettings().LodSelection;
+                        settings.ForcedLevel = settings.ForcedLevel + 1 < static_cast<i32>(MeshLodSettings{}.MaxLevels) ? settings.ForcedLevel + 1 : -1;
+                        m_Renderer->SetLodSelection(settings);
+                        break;
+                    }
+                    case GLFW_KEY_R: {
+                        auto settings = m_Renderer->GetSettings().DynamicResolution;
+                        settings.Enabled = !settings.Enabled;
+                        m_Renderer->SetDynamicResolution(settings);
+                        break;
+                    }
+                    case GLFW_KEY_F: {
+                        auto settings = m_Renderer->GetSettings().DynamicResolution;
+                        settings.Filter = settings.Filter == UpscaleFilter::Bilinear ? UpscaleFilter::Sharpened : UpscaleFilter::Bilinear;
+                        m_Renderer->SetDynamicResolution(settings);
+                        break;
+                    }
+                    default: break;
+                }
+            }
             break;
         case EventTag::WindowFramebufferSizeEvent:
             m_GraphicsContext->OnFramebufferResize(e.WindowFramebufferSizeEvent.Width, e.WindowFramebufferSizeEvent.Height);
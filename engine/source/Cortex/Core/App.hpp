@@ -3,6 +3,7 @@
 #include "Cortex/Base/Base.hpp"
 #include "Cortex/Core/Window.hpp"
 #include "Cortex/Core/Events.hpp"
+#include "Cortex/Core/FrameLimiter.hpp"
 
 #include "Cortex/Graphics/GraphicsContext.hpp"
 #include "Cortex/Graphics/Renderer.hpp"
@@ -29,7 +30,9 @@ namespace Cortex
         std::unique_ptr<Window> m_Window;
         std::unique_ptr<GraphicsContext> m_GraphicsContext;
         std::unique_ptr<Renderer> m_Renderer;
+        FrameLimiter m_FrameLimiter;
         f32 m_AspectRatio;
+        bool m_DepthPrepass;
     };
 
     App *CreateApp();
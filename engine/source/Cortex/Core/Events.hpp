@@ -85,12 +85,12 @@ namespace Cortex
         EventTag Tag;
         union
         {
-            KeyEvent KeyEvent;
-            MouseButtonEvent MouseButtonEvent;
-            MouseMoveEvent MouseMoveEvent;
-            WindowCloseEvent WindowCloseEvent;
-            WindowFramebufferSizeEvent WindowFramebufferSizeEvent;
-            WindowSizeEvent WindowSizeEvent;
+            Cortex::KeyEvent KeyEvent;
+            Cortex::MouseButtonEvent MouseButtonEvent;
+            Cortex::MouseMoveEvent MouseMoveEvent;
+            Cortex::WindowCloseEvent WindowCloseEvent;
+            Cortex::WindowFramebufferSizeEvent WindowFramebufferSizeEvent;
+            Cortex::WindowSizeEvent WindowSizeEvent;
         };
     };
 }
\ No newline at end of file
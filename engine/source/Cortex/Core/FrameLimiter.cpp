@@ -0,0 +1,46 @@
+#include "Cortex/Core/FrameLimiter.hpp"
+
+#include <thread>
+
+namespace Cortex {
+    FrameLimiter::FrameLimiter() {
+        m_TargetFPS = 0.0;
+        m_SpinThreshold = std::chrono::microseconds(1500);
+        m_LastDeadline = std::chrono::steady_clock::now();
+    }
+
+    void FrameLimiter::SetTargetFPS(f64 fps) {
+        m_TargetFPS = fps > 0.0 ? fps : 0.0;
+        m_LastDeadline = std::chrono::steady_clock::now();
+        if (m_TargetFPS > 0.0) {
+            LOG_INFO("Frame rate limited to %.1f FPS.", m_TargetFPS);
+        } else {
+            LOG_INFO("Frame rate limiter disabled.");
+        }
+    }
+
+    void FrameLimiter::Wait() {
+        if (m_TargetFPS <= 0.0) { return; }
+        CORTEX_PROFILE_SCOPE("FrameLimiter::Wait");
+
+        using clock = std::chrono::steady_clock;
+        auto period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<f64>(1.0 / m_TargetFPS));
+        auto deadline = m_LastDeadline + period;
+        auto now = clock::now();
+
+        // Deadlines advance by whole periods so the average rate stays exact, but after a long hitch we
+        // resynchronise rather than racing through a burst of short frames to catch up.
+        if (now > deadline + period) {
+            m_LastDeadline = now;
+            return;
+        }
+
+        if (deadline - now > m_SpinThreshold) {
+            std::this_thread::sleep_for(deadline - now - m_SpinThreshold);
+        }
+        while (clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+        m_LastDeadline = deadline;
+    }
+}
\ No newline at end of file
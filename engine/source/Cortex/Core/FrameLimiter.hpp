@@ -0,0 +1,21 @@
+#pragma once
+
+#include "Cortex/Base/Base.hpp"
+
+#include <chrono>
+
+namespace Cortex {
+    // Caps the main loop to a target frame rate. Sleeps for the bulk of the remaining frame time and
+    // spins for the last stretch, since OS sleeps routinely overshoot by a millisecond or more.
+    class FrameLimiter {
+        public:
+            FrameLimiter();
+            void SetTargetFPS(f64 fps);
+            inline f64 GetTargetFPS() { return m_TargetFPS; }
+            void Wait();
+        private:
+            f64 m_TargetFPS;
+            std::chrono::steady_clock::duration m_SpinThreshold;
+            std::chrono::steady_clock::time_point m_LastDeadline;
+    };
+}
\ No newline at end of file
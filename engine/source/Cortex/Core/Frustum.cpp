@@ -0,0 +1,57 @@
+#include "Cortex/Core/Frustum.hpp"
+
+namespace Cortex {
+    Frustum Frustum::FromMatrix(const glm::mat4& worldToClip) {
+        // glm is column-major, so row i of the matrix is m[0][i], m[1][i], m[2][i], m[3][i].
+        glm::vec4 rows[4];
+        for (u32 i = 0; i < 4; i++) {
+            rows[i] = {worldToClip[0][i], worldToClip[1][i], worldToClip[2][i], worldToClip[3][i]};
+        }
+
+        Frustum frustum;
+        frustum.Planes[Left] = rows[3] + rows[0];
+        frustum.Planes[Right] = rows[3] - rows[0];
+        frustum.Planes[Bottom] = rows[3] + rows[1];
+        frustum.Planes[Top] = rows[3] - rows[1];
+        frustum.Planes[Near] = rows[2];
+        frustum.Planes[Far] = rows[3] - rows[2];
+
+        for (auto& plane : frustum.Planes) {
+            plane /= glm::length(glm::vec3(plane));
+        }
+        return frustum;
+    }
+
+    bool Frustum::ContainsPoint(const glm::vec3& point) const {
+        for (const auto& plane : Planes) {
+            if (glm::dot(glm::vec3(plane), point) + plane.w < 0.0f) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool Frustum::IntersectsSphere(const glm::vec3& center, f32 radius) const {
+        for (const auto& plane : Planes) {
+            if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool Frustum::IntersectsBox(const glm::vec3& min, const glm::vec3& max) const {
+        for (const auto& plane : Planes) {
+            // The corner furthest along the plane normal; if even that is behind, the whole box is.
+            glm::vec3 corner = {
+                plane.x >= 0.0f ? max.x : min.x,
+                plane.y >= 0.0f ? max.y : min.y,
+                plane.z >= 0.0f ? max.z : min.z
+            };
+            if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
\ No newline at end of file
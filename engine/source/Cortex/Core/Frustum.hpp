@@ -0,0 +1,20 @@
+#pragma once
+
+#include "Cortex/Base/Base.hpp"
+
+namespace Cortex {
+    // The six planes bounding a view volume, facing inwards, so a point p is inside a plane when
+    // dot(plane.xyz, p) + plane.w >= 0. Planes are normalised, so that value is a signed distance.
+    struct Frustum {
+        enum Side { Left = 0, Right, Bottom, Top, Near, Far };
+        glm::vec4 Planes[6];
+
+        // Extracts the planes from a world-to-clip matrix, expecting the 0..1 clip depth we build with.
+        static Frustum FromMatrix(const glm::mat4& worldToClip);
+
+        bool ContainsPoint(const glm::vec3& point) const;
+        bool IntersectsSphere(const glm::vec3& center, f32 radius) const;
+        // Conservative: a box straddling two planes outside a corner of the frustum still passes.
+        bool IntersectsBox(const glm::vec3& min, const glm::vec3& max) const;
+    };
+}
\ No newline at end of file
@@ -1,5 +1,15 @@
 #include "Cortex/Core/Scene.hpp"
 
 namespace Cortex {
-    
+    void Scene::UpdateTransforms() {
+        CORTEX_PROFILE_FUNCTION();
+        for (u32 i = 0; i < Entities.size(); i++) {
+            Transform& transform = Entities[i].Transform;
+            if (transform.Parent == TRANSFORM_NO_PARENT) {
+                continue;
+            }
+            DEBUGASSERT(transform.Parent < i, "Scene entities must come after their parents.");
+            transform.ModelMatrix = Entities[transform.Parent].Transform.ModelMatrix * transform.LocalMatrix;
+        }
+    }
 }
\ No newline at end of file
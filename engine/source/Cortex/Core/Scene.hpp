@@ -13,5 +13,12 @@ namespace Cortex {
     {
         Camera MainCamera;
         std::vector<Entity> Entities;
+        // Lay down depth for every entity before shading, so the forward pass runs the fragment shader
+        // once per pixel. Pays off with heavy overdraw; otherwise it is only extra vertex work.
+        bool DepthPrepass = false;
+
+        // Recomputes the model matrix of every entity with a parent from its local matrix. Parents must
+        // come before their children in Entities, so a single pass in order resolves any depth.
+        void UpdateTransforms();
     };
 }
\ No newline at end of file
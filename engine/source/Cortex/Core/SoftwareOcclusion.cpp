@@ -0,0 +1,430 @@
+#include "Cortex/Core/SoftwareOcclusion.hpp"
+#include "Cortex/Core/Frustum.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+// CORTEX_SCALAR_OCCLUSION keeps the portable lanes on any CPU, so tests can check the SIMD paths against them.
+#if defined(CORTEX_SCALAR_OCCLUSION)
+#elif defined(__AVX2__)
+    #include <immintrin.h>
+    #define SOFTWARE_OCCLUSION_AVX2
+#elif defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define SOFTWARE_OCCLUSION_SSE2
+#endif
+
+namespace Cortex {
+    #define SOFTWARE_OCCLUSION_TILES_X (SOFTWARE_OCCLUSION_WIDTH / SOFTWARE_OCCLUSION_TILE_WIDTH)
+    #define SOFTWARE_OCCLUSION_TILES_Y (SOFTWARE_OCCLUSION_HEIGHT / SOFTWARE_OCCLUSION_TILE_HEIGHT)
+    #define SOFTWARE_OCCLUSION_LANES 8
+    #define SOFTWARE_OCCLUSION_MIN_AREA 1e-6f   // twice the pixel area below which a triangle is skipped
+
+    // Eight f32 lanes. AVX2 builds use one 256-bit register and other x86-64 builds two SSE2 registers;
+    // anywhere else it is a plain array, left to the compiler to vectorize. Masks come from comparisons
+    // and are only ever combined, selected with or tested.
+#if defined(SOFTWARE_OCCLUSION_AVX2)
+    struct Lanes { __m256 V; };
+    static inline Lanes lanes_set(f32 value) { return {_mm256_set1_ps(value)}; }
+    static inline Lanes lanes_ramp() { return {_mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f)}; }
+    static inline Lanes lanes_load(const f32* source) { return {_mm256_loadu_ps(source)}; }
+    static inline void lanes_store(f32* destination, Lanes a) { _mm256_storeu_ps(destination, a.V); }
+    static inline Lanes lanes_add(Lanes a, Lanes b) { return {_mm256_add_ps(a.V, b.V)}; }
+    static inline Lanes lanes_sub(Lanes a, Lanes b) { return {_mm256_sub_ps(a.V, b.V)}; }
+    static inline Lanes lanes_mul(Lanes a, Lanes b) { return {_mm256_mul_ps(a.V, b.V)}; }
+    static inline Lanes lanes_div(Lanes a, Lanes b) { return {_mm256_div_ps(a.V, b.V)}; }
+    static inline Lanes lanes_min(Lanes a, Lanes b) { return {_mm256_min_ps(a.V, b.V)}; }
+    static inline Lanes lanes_max(Lanes a, Lanes b) { return {_mm256_max_ps(a.V, b.V)}; }
+    static inline Lanes lanes_greater_equal(Lanes a, Lanes b) { return {_mm256_cmp_ps(a.V, b.V, _CMP_GE_OQ)}; }
+    static inline Lanes lanes_and(Lanes a, Lanes b) { return {_mm256_and_ps(a.V, b.V)}; }
+    static inline Lanes lanes_select(Lanes mask, Lanes a, Lanes b) { return {_mm256_blendv_ps(b.V, a.V, mask.V)}; }
+    static inline bool lanes_any(Lanes mask) { return _mm256_movemask_ps(mask.V) != 0; }
+    #define SOFTWARE_OCCLUSION_INSTRUCTION_SET "AVX2"
+#elif defined(SOFTWARE_OCCLUSION_SSE2)
+    struct Lanes { __m128 Lo; __m128 Hi; };
+    static inline Lanes lanes_set(f32 value) { return {_mm_set1_ps(value), _mm_set1_ps(value)}; }
+    static inline Lanes lanes_ramp() { return {_mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f), _mm_setr_ps(4.0f, 5.0f, 6.0f, 7.0f)}; }
+    static inline Lanes lanes_load(const f32* source) { return {_mm_loadu_ps(source), _mm_loadu_ps(source + 4)}; }
+    static inline void lanes_store(f32* destination, Lanes a) { _mm_storeu_ps(destination, a.Lo); _mm_storeu_ps(destination + 4, a.Hi); }
+    static inline Lanes lanes_add(Lanes a, Lanes b) { return {_mm_add_ps(a.Lo, b.Lo), _mm_add_ps(a.Hi, b.Hi)}; }
+    static inline Lanes lanes_sub(Lanes a, Lanes b) { return {_mm_sub_ps(a.Lo, b.Lo), _mm_sub_ps(a.Hi, b.Hi)}; }
+    static inline Lanes lanes_mul(Lanes a, Lanes b) { return {_mm_mul_ps(a.Lo, b.Lo), _mm_mul_ps(a.Hi, b.Hi)}; }
+    static inline Lanes lanes_div(Lanes a, Lanes b) { return {_mm_div_ps(a.Lo, b.Lo), _mm_div_ps(a.Hi, b.Hi)}; }
+    static inline Lanes lanes_min(Lanes a, Lanes b) { return {_mm_min_ps(a.Lo, b.Lo), _mm_min_ps(a.Hi, b.Hi)}; }
+    static inline Lanes lanes_max(Lanes a, Lanes b) { return {_mm_max_ps(a.Lo, b.Lo), _mm_max_ps(a.Hi, b.Hi)}; }
+    static inline Lanes lanes_greater_equal(Lanes a, Lanes b) { return {_mm_cmpge_ps(a.Lo, b.Lo), _mm_cmpge_ps(a.Hi, b.Hi)}; }
+    static inline Lanes lanes_and(Lanes a, Lanes b) { return {_mm_and_ps(a.Lo, b.Lo), _mm_and_ps(a.Hi, b.Hi)}; }
+    static inline Lanes lanes_select(Lanes mask, Lanes a, Lanes b) {
+        return {_mm_or_ps(_mm_and_ps(mask.Lo, a.Lo), _mm_andnot_ps(mask.Lo, b.Lo)), _mm_or_ps(_mm_and_ps(mask.Hi, a.Hi), _mm_andnot_ps(mask.Hi, b.Hi))};
+    }
+    static inline bool lanes_any(Lanes mask) { return (_mm_movemask_ps(mask.Lo) | _mm_movemask_ps(mask.Hi)) != 0; }
+    #define SOFTWARE_OCCLUSION_INSTRUCTION_SET "SSE2"
+#else
+    struct Lanes { f32 V[SOFTWARE_OCCLUSION_LANES]; };
+    #define SOFTWARE_OCCLUSION_LANEWISE(expression) Lanes r; for (u32 i = 0; i < SOFTWARE_OCCLUSION_LANES; i++) { r.V[i] = (expression); } return r
+    static inline Lanes lanes_set(f32 value) { SOFTWARE_OCCLUSION_LANEWISE(value); }
+    static inline Lanes lanes_ramp() { SOFTWARE_OCCLUSION_LANEWISE(static_cast<f32>(i)); }
+    static inline Lanes lanes_load(const f32* source) { SOFTWARE_OCCLUSION_LANEWISE(source[i]); }
+    static inline void lanes_store(f32* destination, Lanes a) { std::copy(a.V, a.V + SOFTWARE_OCCLUSION_LANES, destination); }
+    static inline Lanes lanes_add(Lanes a, Lanes b) { SOFTWARE_OCCLUSION_LANEWISE(a.V[i] + b.V[i]); }
+    static inline Lanes lanes_sub(Lanes a, Lanes b) { SOFTWARE_OCCLUSION_LANEWISE(a.V[i] - b.V[i]); }
+    static inline Lanes lanes_mul(Lanes a, Lanes b) { SOFTWARE_OCCLUSION_LANEWISE(a.V[i] * b.V[i]); }
+    static inline Lanes lanes_div(Lanes a, Lanes b) { SOFTWARE_OCCLUSION_LANEWISE(a.V[i] / b.V[i]); }
+    static inline Lanes lanes_min(Lanes a, Lanes b) { SOFTWARE_OCCLUSION_LANEWISE(std::min(a.V[i], b.V[i])); }
+    static inline Lanes lanes_max(Lanes a, Lanes b) { SOFTWARE_OCCLUSION_LANEWISE(std::max(a.V[i], b.V[i])); }
+    static inline Lanes lanes_greater_equal(Lanes a, Lanes b) { SOFTWARE_OCCLUSION_LANEWISE(a.V[i] >= b.V[i] ? 1.0f : 0.0f); }
+    static inline Lanes lanes_and(Lanes a, Lanes b) { SOFTWARE_OCCLUSION_LANEWISE(a.V[i] != 0.0f && b.V[i] != 0.0f ? 1.0f : 0.0f); }
+    static inline Lanes lanes_select(Lanes mask, Lanes a, Lanes b) { SOFTWARE_OCCLUSION_LANEWISE(mask.V[i] != 0.0f ? a.V[i] : b.V[i]); }
+    static inline bool lanes_any(Lanes mask) { return std::any_of(mask.V, mask.V + SOFTWARE_OCCLUSION_LANES, [](f32 m) { return m != 0.0f; }); }
+    #define SOFTWARE_OCCLUSION_INSTRUCTION_SET "scalar"
+#endif
+
+    static inline f32 lanes_reduce_max(Lanes a) {
+        f32 values[SOFTWARE_OCCLUSION_LANES];
+        lanes_store(values, a);
+        return *std::max_element(values, values + SOFTWARE_OCCLUSION_LANES);
+    }
+
+    SoftwareOcclusionCuller::SoftwareOcclusionCuller(u32 threadCount)
+        : m_Workers(std::make_unique<WorkerPool>(threadCount, "Occlusion")),
+          m_Depth(SOFTWARE_OCCLUSION_WIDTH * SOFTWARE_OCCLUSION_HEIGHT, 1.0f),
+          m_TileMaxDepth(SOFTWARE_OCCLUSION_TILES_X * SOFTWARE_OCCLUSION_TILES_Y, 1.0f) {
+        static_assert(SOFTWARE_OCCLUSION_TILE_WIDTH % SOFTWARE_OCCLUSION_LANES == 0, "Tiles must be whole spans of lanes.");
+        static_assert(SOFTWARE_OCCLUSION_WIDTH % SOFTWARE_OCCLUSION_TILE_WIDTH == 0, "The buffer must be whole tiles wide.");
+        static_assert(SOFTWARE_OCCLUSION_HEIGHT % SOFTWARE_OCCLUSION_TILE_HEIGHT == 0, "The buffer must be whole tiles high.");
+        LOG_INFO("Software occlusion culling on %u worker threads plus the caller (%s).", threadCount, GetInstructionSet());
+    }
+
+    const char* SoftwareOcclusionCuller::GetInstructionSet() {
+        return SOFTWARE_OCCLUSION_INSTRUCTION_SET;
+    }
+
+    void SoftwareOcclusionCuller::Cull(const glm::mat4& worldToClip, const std::vector<SoftwareOccluder>& occluders, const std::vector<glm::vec4>& spheres, std::vector<u8>& visible) {
+        CORTEX_PROFILE_FUNCTION();
+        auto start = std::chrono::steady_clock::now();
+
+        TransformOccluders(worldToClip, occluders);
+        SetupTriangles();
+        m_Workers->Run(SOFTWARE_OCCLUSION_TILES_Y, [this](u32 row) { RasterizeTileRow(row); });
+        auto rasterized = std::chrono::steady_clock::now();
+
+        u32 count = static_cast<u32>(spheres.size());
+        u32 jobCount = (count + SOFTWARE_OCCLUSION_TEST_BATCH - 1) / SOFTWARE_OCCLUSION_TEST_BATCH;
+        visible.assign(count, 0);
+        m_FrustumCulled.assign(jobCount, 0);
+        m_OcclusionCulled.assign(jobCount, 0);
+        Frustum frustum = Frustum::FromMatrix(worldToClip);
+        m_Workers->Run(jobCount, [&](u32 job) {
+            CORTEX_PROFILE_SCOPE("SoftwareOcclusionCuller::TestBatch");
+            u32 end = std::min(count, (job + 1) * SOFTWARE_OCCLUSION_TEST_BATCH);
+            for (u32 i = job * SOFTWARE_OCCLUSION_TEST_BATCH; i < end; i++) {
+                const glm::vec4& sphere = spheres[i];
+                if (!frustum.IntersectsSphere(glm::vec3(sphere), sphere.w)) {
+                    m_FrustumCulled[job]++;
+                } else if (!TestSphere(worldToClip, sphere)) {
+                    m_OcclusionCulled[job]++;
+                } else {
+                    visible[i] = 1;
+                }
+            }
+        });
+        auto tested = std::chrono::steady_clock::now();
+
+        m_Stats.Occluders = static_cast<u32>(occluders.size());
+        m_Stats.TrianglesRasterized = static_cast<u32>(m_Triangles.size());
+        m_Stats.Tested = count;
+        m_Stats.FrustumCulled = 0;
+        m_Stats.OcclusionCulled = 0;
+        for (u32 job = 0; job < jobCount; job++) {
+            m_Stats.FrustumCulled += m_FrustumCulled[job];
+            m_Stats.OcclusionCulled += m_OcclusionCulled[job];
+        }
+        m_Stats.RasterMilliseconds = std::chrono::duration<f64, std::milli>(rasterized - start).count();
+        m_Stats.TestMilliseconds = std::chrono::duration<f64, std::milli>(tested - rasterized).count();
+    }
+
+    void SoftwareOcclusionCuller::TransformOccluders(const glm::mat4& worldToClip, const std::vector<SoftwareOccluder>& occluders) {
+        CORTEX_PROFILE_FUNCTION();
+        m_ScreenVertices.clear();
+        for (const auto& occluder : occluders) {
+            const OccluderMesh& mesh = *occluder.Mesh;
+            glm::mat4 modelToClip = worldToClip * occluder.ModelToWorld;
+            m_ClipPositions.resize(mesh.Positions.size());
+            for (size_t i = 0; i < mesh.Positions.size(); i++) {
+                m_ClipPositions[i] = modelToClip * glm::vec4(mesh.Positions[i], 1.0f);
+            }
+
+            for (size_t i = 0; i + 2 < mesh.Indices.size(); i += 3) {
+                const glm::vec4 corners[3] = {m_ClipPositions[mesh.Indices[i]], m_ClipPositions[mesh.Indices[i + 1]], m_ClipPositions[mesh.Indices[i + 2]]};
+
+                // Skip triangles wholly outside one of the planes; the rest are clipped to the near plane
+                // only, since everything else is handled by clamping to the buffer.
+                bool outside = false;
+                for (u32 axis = 0; axis < 3 && !outside; axis++) {
+                    outside = (corners[0][axis] > corners[0].w && corners[1][axis] > corners[1].w && corners[2][axis] > corners[2].w) ||
+                              (axis < 2 && corners[0][axis] < -corners[0].w && corners[1][axis] < -corners[1].w && corners[2][axis] < -corners[2].w);
+                }
+                if (outside || (corners[0].z < 0.0f && corners[1].z < 0.0f && corners[2].z < 0.0f)) {
+                    continue;
+                }
+                if (corners[0].z >= 0.0f && corners[1].z >= 0.0f && corners[2].z >= 0.0f) {
+                    AddTriangle(corners[0], corners[1], corners[2]);
+                    continue;
+                }
+
+                // One or two corners are in front of the near plane: the clipped polygon has three or four.
+                glm::vec4 clipped[4];
+                u32 clippedCount = 0;
+                for (u32 j = 0; j < 3; j++) {
+                    const glm::vec4& from = corners[j];
+                    const glm::vec4& to = corners[(j + 1) % 3];
+                    if (from.z >= 0.0f) {
+                        clipped[clippedCount++] = from;
+                    }
+                    if ((from.z >= 0.0f) != (to.z >= 0.0f)) {
+                        clipped[clippedCount++] = from + (to - from) * (from.z / (from.z - to.z));
+                    }
+                }
+                for (u32 j = 1; j + 1 < clippedCount; j++) {
+                    AddTriangle(clipped[0], clipped[j], clipped[j + 1]);
+                }
+            }
+        }
+    }
+
+    void SoftwareOcclusionCuller::AddTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c) {
+        for (const glm::vec4* corner : {&a, &b, &c}) {
+            glm::vec3 ndc = glm::vec3(*corner) / corner->w;
+            m_ScreenVertices.push_back({
+                (ndc.x * 0.5f + 0.5f) * SOFTWARE_OCCLUSION_WIDTH,
+                (ndc.y * 0.5f + 0.5f) * SOFTWARE_OCCLUSION_HEIGHT,
+                ndc.z
+            });
+        }
+    }
+
+    void SoftwareOcclusionCuller::SetupTriangles() {
+        CORTEX_PROFILE_FUNCTION();
+        u32 count = static_cast<u32>(m_ScreenVertices.size() / 3);
+        m_Triangles.clear();
+        m_Triangles.reserve(count);
+
+        // Eight triangles at a time, gathered into one array per corner and component. The last batch
+        // repeats its final triangle into the spare lanes and ignores them afterwards.
+        for (u32 first = 0; first < count; first += SOFTWARE_OCCLUSION_LANES) {
+            f32 gathered[3][3][SOFTWARE_OCCLUSION_LANES];
+            for (u32 lane = 0; lane < SOFTWARE_OCCLUSION_LANES; lane++) {
+                u32 triangle = std::min(first + lane, count - 1);
+                for (u32 corner = 0; corner < 3; corner++) {
+                    const glm::vec3& vertex = m_ScreenVertices[triangle * 3 + corner];
+                    gathered[corner][0][lane] = vertex.x;
+                    gathered[corner][1][lane] = vertex.y;
+                    gathered[corner][2][lane] = vertex.z;
+                }
+            }
+            Lanes x[3], y[3], z[3];
+            for (u32 corner = 0; corner < 3; corner++) {
+                x[corner] = lanes_load(gathered[corner][0]);
+                y[corner] = lanes_load(gathered[corner][1]);
+                z[corner] = lanes_load(gathered[corner][2]);
+            }
+
+            // Twice the signed area; edges are flipped to be positive inside whichever the winding.
+            Lanes x10 = lanes_sub(x[1], x[0]), y10 = lanes_sub(y[1], y[0]);
+            Lanes x20 = lanes_sub(x[2], x[0]), y20 = lanes_sub(y[2], y[0]);
+            Lanes area = lanes_sub(lanes_mul(x10, y20), lanes_mul(y10, x20));
+            Lanes zero = lanes_set(0.0f);
+            Lanes sign = lanes_select(lanes_greater_equal(area, zero), lanes_set(1.0f), lanes_set(-1.0f));
+
+            f32 edgeA[3][SOFTWARE_OCCLUSION_LANES], edgeB[3][SOFTWARE_OCCLUSION_LANES], edgeC[3][SOFTWARE_OCCLUSION_LANES];
+            for (u32 edge = 0; edge < 3; edge++) {
+                u32 from = edge, to = (edge + 1) % 3;
+                Lanes a = lanes_mul(lanes_sub(y[from], y[to]), sign);
+                Lanes b = lanes_mul(lanes_sub(x[to], x[from]), sign);
+                Lanes c = lanes_sub(zero, lanes_add(lanes_mul(a, x[from]), lanes_mul(b, y[from])));
+                lanes_store(edgeA[edge], a);
+                lanes_store(edgeB[edge], b);
+                lanes_store(edgeC[edge], c);
+            }
+
+            // Depth over NDC is linear in screen space, so it is a plane through the three corners.
+            Lanes z10 = lanes_sub(z[1], z[0]), z20 = lanes_sub(z[2], z[0]);
+            Lanes safeArea = lanes_select(lanes_greater_equal(lanes_mul(area, sign), lanes_set(SOFTWARE_OCCLUSION_MIN_AREA)), area, lanes_set(1.0f));
+            Lanes depthA = lanes_div(lanes_sub(lanes_mul(z10, y20), lanes_mul(z20, y10)), safeArea);
+            Lanes depthB = lanes_div(lanes_sub(lanes_mul(z20, x10), lanes_mul(z10, x20)), safeArea);
+            Lanes depthC = lanes_sub(z[0], lanes_add(lanes_mul(depthA, x[0]), lanes_mul(depthB, y[0])));
+
+            f32 absArea[SOFTWARE_OCCLUSION_LANES], planeA[SOFTWARE_OCCLUSION_LANES], planeB[SOFTWARE_OCCLUSION_LANES], planeC[SOFTWARE_OCCLUSION_LANES];
+            f32 minX[SOFTWARE_OCCLUSION_LANES], minY[SOFTWARE_OCCLUSION_LANES], maxX[SOFTWARE_OCCLUSION_LANES], maxY[SOFTWARE_OCCLUSION_LANES];
+            lanes_store(absArea, lanes_mul(area, sign));
+            lanes_store(planeA, depthA);
+            lanes_store(planeB, depthB);
+            lanes_store(planeC, depthC);
+            lanes_store(minX, lanes_min(x[0], lanes_min(x[1], x[2])));
+            lanes_store(minY, lanes_min(y[0], lanes_min(y[1], y[2])));
+            lanes_store(maxX, lanes_max(x[0], lanes_max(x[1], x[2])));
+            lanes_store(maxY, lanes_max(y[0], lanes_max(y[1], y[2])));
+
+            u32 lanes = std::min<u32>(SOFTWARE_OCCLUSION_LANES, count - first);
+            for (u32 lane = 0; lane < lanes; lane++) {
+                if (!(absArea[lane] >= SOFTWARE_OCCLUSION_MIN_AREA)) {
+                    continue;
+                }
+                Triangle triangle;
+                triangle.MinX = static_cast<i32>(std::max(0.0f, std::floor(minX[lane])));
+                triangle.MinY = static_cast<i32>(std::max(0.0f, std::floor(minY[lane])));
+                triangle.MaxX = static_cast<i32>(std::min<f32>(SOFTWARE_OCCLUSION_WIDTH - 1, std::floor(maxX[lane])));
+                triangle.MaxY = static_cast<i32>(std::min<f32>(SOFTWARE_OCCLUSION_HEIGHT - 1, std::floor(maxY[lane])));
+                if (triangle.MinX > triangle.MaxX || triangle.MinY > triangle.MaxY) {
+                    continue;
+                }
+                for (u32 edge = 0; edge < 3; edge++) {
+                    triangle.EdgeA[edge] = edgeA[edge][lane];
+                    triangle.EdgeB[edge] = edgeB[edge][lane];
+                    triangle.EdgeC[edge] = edgeC[edge][lane];
+                }
+                triangle.DepthA = planeA[lane];
+                triangle.DepthB = planeB[lane];
+                triangle.DepthC = planeC[lane];
+                m_Triangles.push_back(triangle);
+            }
+        }
+    }
+
+    void SoftwareOcclusionCuller::RasterizeTileRow(u32 row) {
+        CORTEX_PROFILE_FUNCTION();
+        i32 top = row * SOFTWARE_OCCLUSION_TILE_HEIGHT;
+        i32 bottom = top + SOFTWARE_OCCLUSION_TILE_HEIGHT - 1;
+        f32* rows = m_Depth.data() + top * SOFTWARE_OCCLUSION_WIDTH;
+        std::fill(rows, rows + SOFTWARE_OCCLUSION_TILE_HEIGHT * SOFTWARE_OCCLUSION_WIDTH, 1.0f);
+
+        Lanes ramp = lanes_add(lanes_ramp(), lanes_set(0.5f));
+        Lanes zero = lanes_set(0.0f);
+        for (const auto& triangle : m_Triangles) {
+            if (triangle.MaxY < top || triangle.MinY > bottom) {
+                continue;
+            }
+            Lanes edgeA[3] = {lanes_set(triangle.EdgeA[0]), lanes_set(triangle.EdgeA[1]), lanes_set(triangle.EdgeA[2])};
+            Lanes depthA = lanes_set(triangle.DepthA);
+            i32 spanStart = triangle.MinX & ~(SOFTWARE_OCCLUSION_LANES - 1);
+            for (i32 y = std::max(top, triangle.MinY); y <= std::min(bottom, triangle.MaxY); y++) {
+                // Pixels are sampled at their centres.
+                f32 py = y + 0.5f;
+                Lanes rowEdge[3];
+                for (u32 edge = 0; edge < 3; edge++) {
+                    rowEdge[edge] = lanes_set(triangle.EdgeB[edge] * py + triangle.EdgeC[edge]);
+                }
+                Lanes rowDepth = lanes_set(triangle.DepthB * py + triangle.DepthC);
+                f32* depthRow = m_Depth.data() + y * SOFTWARE_OCCLUSION_WIDTH;
+
+                for (i32 x = spanStart; x <= triangle.MaxX; x += SOFTWARE_OCCLUSION_LANES) {
+                    Lanes px = lanes_add(lanes_set(static_cast<f32>(x)), ramp);
+                    Lanes inside = lanes_greater_equal(lanes_add(lanes_mul(edgeA[0], px), rowEdge[0]), zero);
+                    inside = lanes_and(inside, lanes_greater_equal(lanes_add(lanes_mul(edgeA[1], px), rowEdge[1]), zero));
+                    inside = lanes_and(inside, lanes_greater_equal(lanes_add(lanes_mul(edgeA[2], px), rowEdge[2]), zero));
+                    if (!lanes_any(inside)) {
+                        continue;
+                    }
+                    Lanes depth = lanes_add(lanes_mul(depthA, px), rowDepth);
+                    Lanes current = lanes_load(depthRow + x);
+                    lanes_store(depthRow + x, lanes_select(inside, lanes_min(current, depth), current));
+                }
+            }
+        }
+
+        for (u32 tile = 0; tile < SOFTWARE_OCCLUSION_TILES_X; tile++) {
+            Lanes farthest = zero;
+            for (u32 y = 0; y < SOFTWARE_OCCLUSION_TILE_HEIGHT; y++) {
+                const f32* span = rows + y * SOFTWARE_OCCLUSION_WIDTH + tile * SOFTWARE_OCCLUSION_TILE_WIDTH;
+                for (u32 x = 0; x < SOFTWARE_OCCLUSION_TILE_WIDTH; x += SOFTWARE_OCCLUSION_LANES) {
+                    farthest = lanes_max(farthest, lanes_load(span + x));
+                }
+            }
+            m_TileMaxDepth[row * SOFTWARE_OCCLUSION_TILES_X + tile] = lanes_reduce_max(farthest);
+        }
+    }
+
+    bool SoftwareOcclusionCuller::TestSphere(const glm::mat4& worldToClip, const glm::vec4& sphere) const {
+        // The screen rectangle and nearest depth of the sphere's bounding box, so a sphere is never
+        // culled for being partly hidden. Clip space is linear, so the box's eight corners, one per
+        // lane, are the center's clip position plus or minus the radius along the first three columns.
+        static const f32 cornerSigns[3][SOFTWARE_OCCLUSION_LANES] = {
+            {-1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f},
+            {-1.0f, -1.0f, 1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f},
+            {-1.0f, -1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f, 1.0f}
+        };
+        glm::vec4 center = worldToClip * glm::vec4(glm::vec3(sphere), 1.0f);
+        glm::vec4 axes[3] = {worldToClip[0] * sphere.w, worldToClip[1] * sphere.w, worldToClip[2] * sphere.w};
+        Lanes signs[3] = {lanes_load(cornerSigns[0]), lanes_load(cornerSigns[1]), lanes_load(cornerSigns[2])};
+        Lanes clip[4];
+        for (u32 component = 0; component < 4; component++) {
+            clip[component] = lanes_set(center[component]);
+            for (u32 axis = 0; axis < 3; axis++) {
+                clip[component] = lanes_add(clip[component], lanes_mul(signs[axis], lanes_set(axes[axis][component])));
+            }
+        }
+
+        f32 depth[SOFTWARE_OCCLUSION_LANES], x[SOFTWARE_OCCLUSION_LANES], y[SOFTWARE_OCCLUSION_LANES];
+        lanes_store(depth, clip[2]);
+        for (u32 corner = 0; corner < SOFTWARE_OCCLUSION_LANES; corner++) {
+            if (depth[corner] < 0.0f) {
+                return true;    // reaches past the near plane, so nothing can be in front of all of it
+            }
+        }
+        Lanes halfWidth = lanes_set(0.5f * SOFTWARE_OCCLUSION_WIDTH), halfHeight = lanes_set(0.5f * SOFTWARE_OCCLUSION_HEIGHT);
+        lanes_store(x, lanes_mul(lanes_add(lanes_div(clip[0], clip[3]), lanes_set(1.0f)), halfWidth));
+        lanes_store(y, lanes_mul(lanes_add(lanes_div(clip[1], clip[3]), lanes_set(1.0f)), halfHeight));
+        lanes_store(depth, lanes_div(clip[2], clip[3]));
+        f32 minimumX = x[0], maximumX = x[0], minimumY = y[0], maximumY = y[0], nearest = depth[0];
+        for (u32 corner = 1; corner < SOFTWARE_OCCLUSION_LANES; corner++) {
+            minimumX = std::min(minimumX, x[corner]);
+            maximumX = std::max(maximumX, x[corner]);
+            minimumY = std::min(minimumY, y[corner]);
+            maximumY = std::max(maximumY, y[corner]);
+            nearest = std::min(nearest, depth[corner]);
+        }
+
+        i32 minX = static_cast<i32>(std::max(0.0f, std::floor(minimumX)));
+        i32 minY = static_cast<i32>(std::max(0.0f, std::floor(minimumY)));
+        i32 maxX = static_cast<i32>(std::min<f32>(SOFTWARE_OCCLUSION_WIDTH - 1, std::floor(maximumX)));
+        i32 maxY = static_cast<i32>(std::min<f32>(SOFTWARE_OCCLUSION_HEIGHT - 1, std::floor(maximumY)));
+        if (minX > maxX || minY > maxY) {
+            return true;    // passed the frustum test but rounds off screen; leave it to the GPU
+        }
+        return TestRect(minX, minY, maxX, maxY, nearest);
+    }
+
+    bool SoftwareOcclusionCuller::TestRect(i32 minX, i32 minY, i32 maxX, i32 maxY, f32 depth) const {
+        Lanes nearest = lanes_set(depth);
+        Lanes ramp = lanes_ramp();
+        for (i32 tileY = minY / SOFTWARE_OCCLUSION_TILE_HEIGHT; tileY <= maxY / SOFTWARE_OCCLUSION_TILE_HEIGHT; tileY++) {
+            for (i32 tileX = minX / SOFTWARE_OCCLUSION_TILE_WIDTH; tileX <= maxX / SOFTWARE_OCCLUSION_TILE_WIDTH; tileX++) {
+                // Every pixel of the tile is nearer than the bounds: nothing to look at.
+                if (depth > m_TileMaxDepth[tileY * SOFTWARE_OCCLUSION_TILES_X + tileX]) {
+                    continue;
+                }
+                i32 left = tileX * SOFTWARE_OCCLUSION_TILE_WIDTH, top = tileY * SOFTWARE_OCCLUSION_TILE_HEIGHT;
+                i32 x0 = std::max(minX, left), x1 = std::min(maxX, left + SOFTWARE_OCCLUSION_TILE_WIDTH - 1);
+                i32 y0 = std::max(minY, top), y1 = std::min(maxY, top + SOFTWARE_OCCLUSION_TILE_HEIGHT - 1);
+                // Covering the whole tile, the bounds reach its farthest pixel, which is at least as far.
+                if (x0 == left && y0 == top && x1 == left + SOFTWARE_OCCLUSION_TILE_WIDTH - 1 && y1 == top + SOFTWARE_OCCLUSION_TILE_HEIGHT - 1) {
+                    return true;
+                }
+
+                Lanes first = lanes_set(static_cast<f32>(x0)), last = lanes_set(static_cast<f32>(x1));
+                for (i32 y = y0; y <= y1; y++) {
+                    const f32* depthRow = m_Depth.data() + y * SOFTWARE_OCCLUSION_WIDTH;
+                    for (i32 x = x0 & ~(SOFTWARE_OCCLUSION_LANES - 1); x <= x1; x += SOFTWARE_OCCLUSION_LANES) {
+                        Lanes px = lanes_add(lanes_set(static_cast<f32>(x)), ramp);
+                        Lanes covered = lanes_and(lanes_greater_equal(px, first), lanes_greater_equal(last, px));
+                        if (lanes_any(lanes_and(covered, lanes_greater_equal(lanes_load(depthRow + x), nearest)))) {
+                            return true;
+                        }
+                    }
+                }
+            }
+        }
+        return false;
+    }
+}
\ No newline at end of file
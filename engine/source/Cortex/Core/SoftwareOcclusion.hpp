@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Cortex/Base/Base.hpp"
+#include "Cortex/Base/WorkerPool.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace Cortex {
+    #define SOFTWARE_OCCLUSION_WIDTH 256
+    #define SOFTWARE_OCCLUSION_HEIGHT 128
+    #define SOFTWARE_OCCLUSION_TILE_WIDTH 32     // four 8-pixel spans
+    #define SOFTWARE_OCCLUSION_TILE_HEIGHT 8     // one row of tiles is one rasterization job
+    #define SOFTWARE_OCCLUSION_TEST_BATCH 256    // bounds per test job
+
+    // Triangles an entity hides others with. Usually far fewer than the mesh it stands in for, and
+    // never bigger than it, or things behind its silhouette get culled.
+    struct OccluderMesh {
+        std::vector<glm::vec3> Positions;
+        std::vector<u32> Indices;
+    };
+
+    struct SoftwareOccluder {
+        const OccluderMesh* Mesh;
+        glm::mat4 ModelToWorld;
+    };
+
+    struct SoftwareOcclusionStats {
+        u32 Occluders = 0;
+        u32 TrianglesRasterized = 0;
+        u32 Tested = 0;
+        u32 FrustumCulled = 0;
+        u32 OcclusionCulled = 0;
+        f64 RasterMilliseconds = 0.0;
+        f64 TestMilliseconds = 0.0;
+    };
+
+    // Occlusion culling on the CPU, ahead of recording. Occluders are rasterized into a small depth
+    // buffer, with triangle setup eight triangles at a time and pixels eight at a time; each tile keeps
+    // its farthest depth, so most bounds are settled without looking at pixels. Both stages are split
+    // across a worker pool, rasterization by rows of tiles and testing by batches of bounds.
+    class SoftwareOcclusionCuller {
+        public:
+            // threadCount workers besides the calling thread.
+            SoftwareOcclusionCuller(u32 threadCount = WorkerPool::DefaultThreadCount());
+            // visible[i] is left 0 for spheres (world space center and radius) outside the frustum or
+            // entirely behind the occluders, and set to 1 otherwise.
+            void Cull(const glm::mat4& worldToClip, const std::vector<SoftwareOccluder>& occluders, const std::vector<glm::vec4>& spheres, std::vector<u8>& visible);
+            inline const SoftwareOcclusionStats& GetStats() const { return m_Stats; }
+            // Row-major depth left by the last Cull: 0 at the near plane, 1 where nothing was drawn.
+            inline const std::vector<f32>& GetDepth() const { return m_Depth; }
+            static const char* GetInstructionSet();
+        private:
+            void TransformOccluders(const glm::mat4& worldToClip, const std::vector<SoftwareOccluder>& occluders);
+            void AddTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c);
+            void SetupTriangles();
+            void RasterizeTileRow(u32 row);
+            bool TestSphere(const glm::mat4& worldToClip, const glm::vec4& sphere) const;
+            bool TestRect(i32 minX, i32 minY, i32 maxX, i32 maxY, f32 depth) const;
+
+            struct Triangle {
+                f32 EdgeA[3];
+                f32 EdgeB[3];
+                f32 EdgeC[3];   // edge i is EdgeA[i] * x + EdgeB[i] * y + EdgeC[i], >= 0 inside
+                f32 DepthA;
+                f32 DepthB;
+                f32 DepthC;     // depth is DepthA * x + DepthB * y + DepthC
+                i32 MinX;
+                i32 MinY;
+                i32 MaxX;
+                i32 MaxY;       // inclusive pixel bounds, clamped to the buffer
+            };
+
+            std::unique_ptr<WorkerPool> m_Workers;
+            std::vector<glm::vec4> m_ClipPositions;     // scratch for the occluder being transformed
+            std::vector<glm::vec3> m_ScreenVertices;    // three per triangle: pixel x, pixel y, depth
+            std::vector<Triangle> m_Triangles;
+            std::vector<f32> m_Depth;
+            std::vector<f32> m_TileMaxDepth;
+            std::vector<u32> m_FrustumCulled;           // per test job, summed afterwards
+            std::vector<u32> m_OcclusionCulled;
+            SoftwareOcclusionStats m_Stats;
+    };
+}
\ No newline at end of file
@@ -89,6 +89,7 @@ namespace Cortex {
     }
 
     void Window::Update(f64 dt) {
+        CORTEX_PROFILE_SCOPE("Window::PollEvents");
         glfwSwapBuffers(m_WindowHandle);
         glfwPollEvents();
     }
@@ -8,7 +8,7 @@
 namespace Cortex {
     struct Entity {
         u32 Identifier; // Make a GUID at some point
-        Transform Transform;
+        Cortex::Transform Transform;
         MeshInstance Mesh;
         static Entity Create() { return Entity {.Identifier=0}; }
     };
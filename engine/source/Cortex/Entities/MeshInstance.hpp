@@ -3,9 +3,13 @@
 #include "Cortex/Graphics/Model.hpp"
 #include "Cortex/Graphics/Material.hpp"
 
+#include "Cortex/Core/SoftwareOcclusion.hpp"
+
 namespace Cortex {
     struct MeshInstance {
-        std::shared_ptr<Model> Model;
-        std::shared_ptr<Material> Material;
+        std::shared_ptr<Cortex::Model> Model;
+        std::shared_ptr<Cortex::Material> Material;
+        // Set on the few entities that should hide others from the CPU occlusion culler.
+        std::shared_ptr<OccluderMesh> Occluder;
     };
 }
\ No newline at end of file
@@ -3,7 +3,11 @@
 #include "Cortex/Base/Base.hpp"
 
 namespace Cortex {
+    #define TRANSFORM_NO_PARENT std::numeric_limits<u32>::max()
+
     struct Transform {
-        glm::mat4 ModelMatrix;
+        glm::mat4 ModelMatrix;          // model to world, what gets drawn; set directly on root entities
+        glm::mat4 LocalMatrix {1.0f};   // relative to the parent, only used when there is one
+        u32 Parent = TRANSFORM_NO_PARENT; // index of the parent in the scene's entities
     };
 }
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include "Cortex/Graphics/CommandAllocator.hpp"
+#include "Cortex/Graphics/VulkanHelpers.hpp"
+
+namespace Cortex {
+    #define COMMAND_ALLOCATOR_BATCH_SIZE 4
+
+    std::atomic<u64> CommandAllocator::s_NextId(1);
+    thread_local std::array<CommandAllocatorThreadCache, COMMAND_ALLOCATOR_THREAD_CACHE_SIZE> CommandAllocator::t_Caches;
+    thread_local u32 CommandAllocator::t_NextCache = 0;
+
+    std::shared_ptr<CommandAllocator> CommandAllocator::Create(VkDevice device, u32 queueFamily, u32 slotCount) {
+        return std::make_shared<CommandAllocator>(device, queueFamily, slotCount);
+    }
+
+    CommandAllocator::CommandAllocator(VkDevice device, u32 queueFamily, u32 slotCount) {
+        m_Id = s_NextId.fetch_add(1, std::memory_order_relaxed);
+        m_Device = device;
+        m_QueueFamily = queueFamily;
+        m_Slots.resize(slotCount);
+    }
+
+    CommandAllocator::~CommandAllocator() {
+        // Destroying a pool frees its buffers with it.
+        for (auto& slot : m_Slots) {
+            for (auto& entry : slot) {
+                vkDestroyCommandPool(m_Device, entry.second.CommandPool, nullptr);
+            }
+        }
+    }
+
+    VkCommandBuffer CommandAllocator::Allocate(u32 slot, VkCommandBufferLevel level) {
+        CommandAllocatorPool& pool = GetThreadPool(slot);
+        bool primary = level == VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        std::vector<VkCommandBuffer>& buffers = primary ? pool.Primary : pool.Secondary;
+        u32& used = primary ? pool.PrimaryUsed : pool.SecondaryUsed;
+
+        if (used == buffers.size()) {
+            // Grow in small batches so a slot settles on its peak count within a frame or two.
+            VkCommandBufferAllocateInfo allocInfo = {};
+            allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocInfo.commandPool = pool.CommandPool;
+            allocInfo.level = level;
+            allocInfo.commandBufferCount = COMMAND_ALLOCATOR_BATCH_SIZE;
+            buffers.resize(used + COMMAND_ALLOCATOR_BATCH_SIZE);
+            VkResult result = vkAllocateCommandBuffers(m_Device, &allocInfo, buffers.data() + used);
+            ASSERT(result == VK_SUCCESS, "Failed to allocate Vulkan command buffers.");
+        }
+        return buffers[used++];
+    }
+
+    void CommandAllocator::Reset(u32 slot) {
+        ASSERT(slot < m_Slots.size(), "Command allocator slot out of range.");
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        for (auto& entry : m_Slots[slot]) {
+            ResetPool(entry.second);
+        }
+    }
+
+    void CommandAllocator::ResetThread(u32 slot) {
+        ResetPool(GetThreadPool(slot));
+    }
+
+    CommandAllocatorPool& CommandAllocator::GetThreadPool(u32 slot) {
+        ASSERT(slot < m_Slots.size(), "Command allocator slot out of range.");
+        // Pools live until the allocator does and Reset rewinds them in place, so a cached pointer
+        // stays valid; only its first lookup needs the lock.
+        CommandAllocatorThreadCache* cache = nullptr;
+        for (auto& entry : t_Caches) {
+            if (entry.AllocatorId == m_Id) {
+                cache = &entry;
+                break;
+            }
+        }
+        if (!cache) {
+            cache = &t_Caches[t_NextCache];
+            t_NextCache = (t_NextCache + 1) % COMMAND_ALLOCATOR_THREAD_CACHE_SIZE;
+            cache->AllocatorId = m_Id;
+            cache->Pools.assign(m_Slots.size(), nullptr);
+        }
+        if (!cache->Pools[slot]) {
+            cache->Pools[slot] = &FindThreadPool(slot);
+        }
+        return *cache->Pools[slot];
+    }
+
+    CommandAllocatorPool& CommandAllocator::FindThreadPool(u32 slot) {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        // Map nodes are never moved, so the reference stays valid after the lock is released.
+        auto& pools = m_Slots[slot];
+        auto it = pools.find(std::this_thread::get_id());
+        if (it != pools.end()) {
+            return it->second;
+        }
+
+        CommandAllocatorPool pool = {};
+        pool.CommandPool = vulkan_create_command_pool(m_Device, m_QueueFamily, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+        pool.PrimaryUsed = 0;
+        pool.SecondaryUsed = 0;
+        return pools.emplace(std::this_thread::get_id(), pool).first->second;
+    }
+
+    void CommandAllocator::ResetPool(CommandAllocatorPool& pool) {
+        if (pool.PrimaryUsed == 0 && pool.SecondaryUsed == 0) { return; }
+        vkResetCommandPool(m_Device, pool.CommandPool, 0);
+        pool.PrimaryUsed = 0;
+        pool.SecondaryUsed = 0;
+    }
+}
\ No newline at end of file
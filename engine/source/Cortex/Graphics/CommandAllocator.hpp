@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Cortex/Graphics/VulkanTypes.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+namespace Cortex {
+    // One VkCommandPool with the buffers it has handed out. Buffers are never freed individually: the
+    // pool is reset as a whole and the same handles are handed out again from the start of each list.
+    struct CommandAllocatorPool {
+        VkCommandPool CommandPool;
+        std::vector<VkCommandBuffer> Primary;
+        std::vector<VkCommandBuffer> Secondary;
+        u32 PrimaryUsed;
+        u32 SecondaryUsed;
+    };
+
+    #define COMMAND_ALLOCATOR_THREAD_CACHE_SIZE 4   // allocators a thread remembers its pools for
+
+    // A thread's pools in one allocator, by slot; null until the thread first allocates from the slot.
+    struct CommandAllocatorThreadCache {
+        u64 AllocatorId = 0;
+        std::vector<CommandAllocatorPool*> Pools;
+    };
+
+    // Hands out command buffers from per-slot, per-thread pools. A slot is typically a frame in flight:
+    // once the GPU is done with it, Reset() rewinds all of its pools in one vkResetCommandPool each, so
+    // steady-state allocation is an index bump into a recycled list. Each recording thread gets its own
+    // pool per slot, as Vulkan requires. The lock is taken only the first time a thread uses a slot;
+    // after that the thread finds its pool in a thread_local cache.
+    class CommandAllocator {
+        public:
+            static std::shared_ptr<CommandAllocator> Create(VkDevice device, u32 queueFamily, u32 slotCount);
+            CommandAllocator(VkDevice device, u32 queueFamily, u32 slotCount);
+            ~CommandAllocator();
+            CommandAllocator(const CommandAllocator&) = delete;
+            CommandAllocator &operator=(const CommandAllocator&) = delete;
+
+            VkCommandBuffer Allocate(u32 slot, VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+            // Every buffer allocated from the slot, on any thread, must have finished executing.
+            void Reset(u32 slot);
+            // Resets only the calling thread's pool, for one-shot work the thread has already waited on.
+            void ResetThread(u32 slot);
+            inline u32 GetSlotCount() { return static_cast<u32>(m_Slots.size()); }
+        private:
+            CommandAllocatorPool& GetThreadPool(u32 slot);
+            CommandAllocatorPool& FindThreadPool(u32 slot);
+            void ResetPool(CommandAllocatorPool& pool);
+
+            static std::atomic<u64> s_NextId;
+            static thread_local std::array<CommandAllocatorThreadCache, COMMAND_ALLOCATOR_THREAD_CACHE_SIZE> t_Caches;
+            static thread_local u32 t_NextCache;
+
+            u64 m_Id; // never reused, so a cache entry cannot outlive its allocator into a new one
+            VkDevice m_Device;
+            u32 m_QueueFamily;
+            std::mutex m_Mutex;
+            std::vector<std::unordered_map<std::thread::id, CommandAllocatorPool>> m_Slots;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#include "Cortex/Graphics/DeletionQueue.hpp"
+
+namespace Cortex {
+    DeletionQueue::DeletionQueue() {
+        m_Sync = nullptr;
+    }
+
+    DeletionQueue::~DeletionQueue() {
+        ASSERT(m_Entries.empty(), "Deletion queue destroyed with pending entries, Flush() must run before the device is destroyed.");
+    }
+
+    void DeletionQueue::SetQueueSync(QueueSync* sync) {
+        m_Sync = sync;
+    }
+
+    void DeletionQueue::Push(std::function<void()> destroy) {
+        ASSERT(m_Sync != nullptr, "Deletion queue has no queue timelines to stamp entries with.");
+        QueueValues stamp = m_Sync->GetSubmittedValues();
+        for (auto& value : stamp) {
+            value++;
+        }
+        m_Entries.push_back({stamp, std::move(destroy)});
+    }
+
+    bool DeletionQueue::IsRetired(const DeletionQueueEntry& entry) {
+        // The stamp is the first value each queue could signal after the push. If that submission has
+        // happened it may use the object, so it must complete; if not, everything submitted so far must.
+        for (u32 i = 0; i < QUEUE_TYPE_COUNT; i++) {
+            QueueType queue = (QueueType)i;
+            u64 required = std::min(entry.Stamp[i], m_Sync->GetSubmittedValue(queue));
+            if (!m_Sync->IsComplete({queue, required})) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void DeletionQueue::Collect() {
+        // Stamps only ever increase, so the retired entries are always at the front.
+        while (!m_Entries.empty() && IsRetired(m_Entries.front())) {
+            auto destroy = std::move(m_Entries.front().Destroy);
+            m_Entries.pop_front();
+            destroy();
+        }
+    }
+
+    void DeletionQueue::Flush() {
+        // Destroying one object can release others (e.g. a retired Swapchain), so drain until empty.
+        while (!m_Entries.empty()) {
+            auto destroy = std::move(m_Entries.front().Destroy);
+            m_Entries.pop_front();
+            destroy();
+        }
+    }
+}
\ No newline at end of file
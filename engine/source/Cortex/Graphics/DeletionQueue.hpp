@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Cortex/Graphics/VulkanTypes.hpp"
+#include "Cortex/Graphics/QueueSync.hpp"
+
+#include <deque>
+#include <functional>
+
+namespace Cortex {
+    struct DeletionQueueEntry {
+        QueueValues Stamp;
+        std::function<void()> Destroy;
+    };
+
+    // Defers destruction of GPU objects until every submission that may reference them has completed.
+    // Entries are stamped with the next value on each queue's timeline when they are pushed, so work
+    // still being recorded is covered, and run once the queues have caught up. Releasing a resource
+    // mid-frame therefore never needs to idle the device.
+    class DeletionQueue {
+        public:
+            DeletionQueue();
+            ~DeletionQueue();
+            DeletionQueue(const DeletionQueue&) = delete;
+            DeletionQueue &operator=(const DeletionQueue&) = delete;
+
+            void SetQueueSync(QueueSync* sync);
+            void Push(std::function<void()> destroy);
+            void Collect();
+            void Flush();
+            inline u64 GetPendingCount() { return m_Entries.size(); }
+        private:
+            bool IsRetired(const DeletionQueueEntry& entry);
+
+            QueueSync* m_Sync;
+            std::deque<DeletionQueueEntry> m_Entries;
+    };
+}
\ No newline at end of file
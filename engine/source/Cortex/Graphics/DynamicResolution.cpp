@@ -0,0 +1,60 @@
+#include "Cortex/Graphics/DynamicResolution.hpp"
+
+namespace Cortex {
+    DynamicResolution::DynamicResolution() {
+        m_Scale = 1.0f;
+        m_FilteredGpuTime = 0.0;
+        m_FramesSinceChange = 0;
+    }
+
+    void DynamicResolution::SetSettings(const DynamicResolutionSettings& settings) {
+        ASSERT(settings.MinScale > 0.0f && settings.MinScale <= settings.MaxScale, "Dynamic resolution scale range is invalid.");
+        m_Settings = settings;
+        m_Scale = settings.Enabled ? glm::clamp(m_Scale, settings.MinScale, settings.MaxScale) : 1.0f;
+        m_FramesSinceChange = 0;
+    }
+
+    f32 DynamicResolution::Update(f64 gpuTime) {
+        if (!m_Settings.Enabled || gpuTime <= 0.0) {
+            return m_Scale;
+        }
+
+        m_FilteredGpuTime = m_FilteredGpuTime == 0.0 ? gpuTime : glm::mix(m_FilteredGpuTime, gpuTime, 0.1);
+        m_FramesSinceChange++;
+        if (m_FramesSinceChange < m_Settings.CooldownFrames) {
+            return m_Scale;
+        }
+
+        // GPU cost is roughly proportional to pixel count, i.e. to scale squared.
+        f64 target = m_Settings.TargetGpuTime;
+        f32 desired = m_Scale;
+        if (m_FilteredGpuTime > target) {
+            desired = m_Scale * (f32)glm::sqrt(target / m_FilteredGpuTime);
+        } else if (m_FilteredGpuTime < target * m_Settings.IncreaseThreshold) {
+            desired = glm::min(m_Scale * (f32)glm::sqrt(target * m_Settings.IncreaseThreshold / m_FilteredGpuTime), m_Scale + 4.0f * m_Settings.ScaleStep);
+        }
+
+        desired = glm::round(desired / m_Settings.ScaleStep) * m_Settings.ScaleStep;
+        desired = glm::clamp(desired, m_Settings.MinScale, m_Settings.MaxScale);
+        if (desired != m_Scale) {
+            m_Scale = desired;
+            m_FramesSinceChange = 0;
+        }
+        return m_Scale;
+    }
+
+    VkExtent2D DynamicResolution::GetRenderExtent(VkExtent2D outputExtent) {
+        VkExtent2D extent;
+        extent.width = glm::max(1u, (u32)glm::round(outputExtent.width * m_Scale));
+        extent.height = glm::max(1u, (u32)glm::round(outputExtent.height * m_Scale));
+        return extent;
+    }
+
+    VkExtent2D DynamicResolution::GetMaxRenderExtent(VkExtent2D outputExtent, const DynamicResolutionSettings& settings) {
+        f32 scale = settings.Enabled ? settings.MaxScale : 1.0f;
+        VkExtent2D extent;
+        extent.width = glm::max(1u, (u32)glm::ceil(outputExtent.width * scale));
+        extent.height = glm::max(1u, (u32)glm::ceil(outputExtent.height * scale));
+        return extent;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Cortex/Graphics/VulkanTypes.hpp"
+
+namespace Cortex {
+    enum class UpscaleFilter {
+        Bilinear,
+        Sharpened
+    };
+
+    struct DynamicResolutionSettings {
+        bool Enabled = false;
+        f32 TargetGpuTime = 16.0f;      // milliseconds
+        f32 MinScale = 0.5f;
+        f32 MaxScale = 1.0f;
+        f32 IncreaseThreshold = 0.85f;  // only scale up once GPU time drops below this fraction of the target
+        u32 CooldownFrames = 8;         // frames to wait after a change before judging its effect
+        f32 ScaleStep = 0.025f;         // scales are quantised so tiny fluctuations don't churn the extent
+        UpscaleFilter Filter = UpscaleFilter::Sharpened;
+        f32 Sharpness = 0.5f;
+    };
+
+    // Chooses a per-axis render scale from measured GPU frame time. The scale drops quickly when over
+    // budget and creeps back up when there is clear headroom, with a dead band in between so it settles.
+    class DynamicResolution {
+        public:
+            DynamicResolution();
+            void SetSettings(const DynamicResolutionSettings& settings);
+            f32 Update(f64 gpuTime);
+            inline f32 GetScale() { return m_Scale; }
+            inline f64 GetFilteredGpuTime() { return m_FilteredGpuTime; }
+            VkExtent2D GetRenderExtent(VkExtent2D outputExtent);
+            static VkExtent2D GetMaxRenderExtent(VkExtent2D outputExtent, const DynamicResolutionSettings& settings);
+        private:
+            DynamicResolutionSettings m_Settings;
+            f32 m_Scale;
+            f64 m_FilteredGpuTime;
+            u32 m_FramesSinceChange;
+    };
+}
\ No newline at end of file
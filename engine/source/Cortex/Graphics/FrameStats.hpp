@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Cortex/Graphics/VulkanTypes.hpp"
+#include "Cortex/Graphics/MeshSimplifier.hpp"
+
+#include "Cortex/Core/SoftwareOcclusion.hpp"
+
+namespace Cortex {
+    #define FRAME_TIME_HISTORY_LENGTH 120
+    #define FRAME_STATS_HISTORY_LENGTH 600
+
+    // Counted on the CPU as commands are recorded and data is copied to the GPU. Uploads made between
+    // frames (asset loading) are attributed to the next frame.
+    struct RenderCounters {
+        u64 DrawCalls = 0;
+        u64 Instances = 0;
+        u64 Triangles = 0;
+        u64 PipelineBinds = 0;
+        u64 DescriptorBinds = 0;
+        u64 BytesUploaded = 0;
+        std::array<u64, MESH_MAX_LODS> LodInstances = {};   // direct draws only, like Triangles
+        std::array<u64, MESH_MAX_LODS> LodTriangles = {};
+    };
+
+    // VK_QUERY_TYPE_PIPELINE_STATISTICS results, in the order the flags are requested.
+    struct GpuPipelineStatistics {
+        u64 InputVertices = 0;
+        u64 InputPrimitives = 0;
+        u64 VertexShaderInvocations = 0;
+        u64 ClippingInvocations = 0;
+        u64 ClippingPrimitives = 0;         // primitives that survived clipping and reached the rasterizer
+        u64 FragmentShaderInvocations = 0;
+        u64 ComputeShaderInvocations = 0;
+    };
+
+    // Written by the occlusion culling shaders and read back once the frame slot comes round again, so
+    // it lags by the number of frames in flight.
+    struct OcclusionStats {
+        u32 Tested = 0;
+        u32 FrustumCulled = 0;
+        u32 OcclusionCulled = 0;    // inside the frustum but behind this frame's depth pyramid
+        u32 DrawnEarly = 0;         // visible last frame, drawn before the pyramid was built
+        u32 DrawnLate = 0;          // newly visible, drawn after passing the pyramid test
+    };
+
+    struct FrameStats {
+        u64 FrameNumber = 0;
+        f64 FrameTime = 0.0; // milliseconds between consecutive frames on the CPU
+        f64 FrameTimeMean = 0.0;    // over the last FRAME_TIME_HISTORY_LENGTH frames
+        f64 FrameTimeStdDev = 0.0;  // pacing jitter; what present modes and limiters should shrink
+        f64 FrameTimeMax = 0.0;
+        VkPresentModeKHR PresentMode = VK_PRESENT_MODE_FIFO_KHR;
+        u32 FramesInFlight = 0;
+        VkSampleCountFlagBits MSAASamples = VK_SAMPLE_COUNT_1_BIT;
+        f64 GpuTime = 0.0;   // milliseconds spent executing the render graph, from timestamp queries
+        VkExtent2D RenderExtent = {0, 0};
+        f32 RenderScale = 1.0f;
+        bool DepthPrepass = false;
+        bool OcclusionCulling = false;
+        bool CpuOcclusionCulling = false;
+        RenderCounters Counters;
+        OcclusionStats Occlusion;   // all zero unless occlusion culling is on
+        SoftwareOcclusionStats CpuOcclusion;    // this frame's, all zero unless CPU occlusion culling is on
+        // Summed over every pass of the latest frame the GPU profiler resolved, so it lags a few frames.
+        // All zero unless pipeline statistics are enabled and supported.
+        GpuPipelineStatistics PipelineStatistics;
+        f64 Overdraw = 0.0; // fragment shader invocations per pixel of the render extent
+    };
+}
\ No newline at end of file
@@ -0,0 +1,281 @@
+#include "Cortex/Graphics/GpuProfiler.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <numeric>
+
+namespace Cortex {
+    #define GPU_PROFILER_STATISTICS_COUNT 7
+    static const VkQueryPipelineStatisticFlags s_StatisticsFlags =
+        VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT |
+        VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+        VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+        VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT |
+        VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+        VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT |
+        VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+
+    static void gpu_add_statistics(GpuPipelineStatistics& total, const GpuPipelineStatistics& add) {
+        total.InputVertices += add.InputVertices;
+        total.InputPrimitives += add.InputPrimitives;
+        total.VertexShaderInvocations += add.VertexShaderInvocations;
+        total.ClippingInvocations += add.ClippingInvocations;
+        total.ClippingPrimitives += add.ClippingPrimitives;
+        total.FragmentShaderInvocations += add.FragmentShaderInvocations;
+        total.ComputeShaderInvocations += add.ComputeShaderInvocations;
+    }
+
+    std::unique_ptr<GpuProfiler> GpuProfiler::Create(std::shared_ptr<GraphicsDevice> device, u32 slotCount) {
+        return std::make_unique<GpuProfiler>(device, slotCount);
+    }
+
+    GpuProfiler::GpuProfiler(std::shared_ptr<GraphicsDevice> device, u32 slotCount) {
+        m_GraphicsDevice = device;
+        m_Enabled = device->Details.TimestampsSupported;
+        u32 validBits = device->Details.TimestampValidBits;
+        m_TimestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+        m_StatisticsSupported = m_Enabled && device->Details.PipelineStatisticsSupported;
+        m_StatisticsEnabled = false;
+        m_StatisticsActive = false;
+        m_CurrentSlot = 0;
+        m_OverflowWarned = false;
+        m_DroppedFrames = 0;
+        m_Slots.resize(slotCount);
+
+        for (auto& slot : m_Slots) {
+            slot.QueryPool = VK_NULL_HANDLE;
+            slot.StatisticsPool = VK_NULL_HANDLE;
+            slot.FrameNumber = 0;
+            slot.Pending = false;
+            if (!m_Enabled) { continue; }
+
+            VkQueryPoolCreateInfo queryInfo = {};
+            queryInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            queryInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+            queryInfo.queryCount = 2 * GPU_PROFILER_MAX_SCOPES;
+            VkResult result = vkCreateQueryPool(device->Device, &queryInfo, nullptr, &slot.QueryPool);
+            ASSERT(result == VK_SUCCESS, "Failed to create timestamp query pool.");
+
+            if (!m_StatisticsSupported) { continue; }
+            VkQueryPoolCreateInfo statisticsInfo = {};
+            statisticsInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            statisticsInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+            statisticsInfo.queryCount = GPU_PROFILER_MAX_SCOPES;
+            statisticsInfo.pipelineStatistics = s_StatisticsFlags;
+            result = vkCreateQueryPool(device->Device, &statisticsInfo, nullptr, &slot.StatisticsPool);
+            ASSERT(result == VK_SUCCESS, "Failed to create pipeline statistics query pool.");
+        }
+    }
+
+    GpuProfiler::~GpuProfiler() {
+        VkDevice device = m_GraphicsDevice->Device;
+        std::vector<VkQueryPool> pools;
+        for (const auto& slot : m_Slots) {
+            if (slot.QueryPool != VK_NULL_HANDLE) {
+                pools.push_back(slot.QueryPool);
+            }
+            if (slot.StatisticsPool != VK_NULL_HANDLE) {
+                pools.push_back(slot.StatisticsPool);
+            }
+        }
+        m_GraphicsDevice->PendingDeletions.Push([=]() {
+            for (auto pool : pools) {
+                vkDestroyQueryPool(device, pool, nullptr);
+            }
+        });
+    }
+
+    bool GpuProfiler::BeginFrame(VkCommandBuffer commandBuffer, u32 slotIndex, u64 frameNumber) {
+        if (!m_Enabled) { return false; }
+        ASSERT(slotIndex < m_Slots.size(), "GPU profiler slot out of range.");
+        ASSERT(m_ScopeStack.empty(), "GPU profiler frame begun with scopes still open.");
+
+        m_CurrentSlot = slotIndex;
+        GpuProfilerSlot& slot = m_Slots[slotIndex];
+        bool resolved = slot.Pending && Resolve(slot);
+
+        slot.Scopes.clear();
+        slot.FrameNumber = frameNumber;
+        slot.Pending = false;
+        vkCmdResetQueryPool(commandBuffer, slot.QueryPool, 0, 2 * GPU_PROFILER_MAX_SCOPES);
+        if (slot.StatisticsPool != VK_NULL_HANDLE) {
+            vkCmdResetQueryPool(commandBuffer, slot.StatisticsPool, 0, GPU_PROFILER_MAX_SCOPES);
+        }
+        BeginScope(commandBuffer, "Frame");
+        return resolved;
+    }
+
+    void GpuProfiler::EndFrame(VkCommandBuffer commandBuffer) {
+        if (!m_Enabled) { return; }
+        EndScope(commandBuffer);
+        ASSERT(m_ScopeStack.empty(), "GPU profiler frame ended with scopes still open.");
+        m_Slots[m_CurrentSlot].Pending = true;
+    }
+
+    void GpuProfiler::BeginScope(VkCommandBuffer commandBuffer, const std::string& name, bool statistics) {
+        if (!m_Enabled) { return; }
+        GpuProfilerSlot& slot = m_Slots[m_CurrentSlot];
+        if (slot.Scopes.size() >= GPU_PROFILER_MAX_SCOPES) {
+            if (!m_OverflowWarned) {
+                LOG_WARN("GPU profiler ran out of queries, scopes past %u per frame are not timed.", GPU_PROFILER_MAX_SCOPES);
+                m_OverflowWarned = true;
+            }
+            m_ScopeStack.push_back(GPU_PROFILER_NO_PARENT);
+            return;
+        }
+
+        GpuProfilerScopeRecord record = {};
+        record.Name = name;
+        record.Parent = m_ScopeStack.empty() ? GPU_PROFILER_NO_PARENT : m_ScopeStack.back();
+        record.Depth = static_cast<u32>(m_ScopeStack.size());
+        record.Statistics = statistics && m_StatisticsEnabled && !m_StatisticsActive;
+        u32 index = static_cast<u32>(slot.Scopes.size());
+        slot.Scopes.push_back(record);
+        m_ScopeStack.push_back(index);
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, slot.QueryPool, 2 * index);
+        if (record.Statistics) {
+            vkCmdBeginQuery(commandBuffer, slot.StatisticsPool, index, 0);
+            m_StatisticsActive = true;
+        }
+    }
+
+    void GpuProfiler::EndScope(VkCommandBuffer commandBuffer) {
+        if (!m_Enabled) { return; }
+        ASSERT(!m_ScopeStack.empty(), "GPU profiler scope ended without being begun.");
+        u32 index = m_ScopeStack.back();
+        m_ScopeStack.pop_back();
+        if (index == GPU_PROFILER_NO_PARENT) { return; }
+        GpuProfilerSlot& slot = m_Slots[m_CurrentSlot];
+        if (slot.Scopes[index].Statistics) {
+            vkCmdEndQuery(commandBuffer, slot.StatisticsPool, index);
+            m_StatisticsActive = false;
+        }
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, slot.QueryPool, 2 * index + 1);
+    }
+
+    bool GpuProfiler::Resolve(GpuProfilerSlot& slot) {
+        // Each query comes back as a (value, availability) pair. No WAIT flag: if the driver has not
+        // made the results visible yet the frame is dropped rather than blocking on it.
+        u32 queryCount = 2 * static_cast<u32>(slot.Scopes.size());
+        std::vector<u64> results(2 * queryCount, 0);
+        VkResult result = vkGetQueryPoolResults(m_GraphicsDevice->Device, slot.QueryPool, 0, queryCount,
+                                                results.size() * sizeof(u64), results.data(), 2 * sizeof(u64),
+                                                VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+        if (result != VK_SUCCESS && result != VK_NOT_READY) {
+            m_DroppedFrames++;
+            return false;
+        }
+        for (u32 q = 0; q < queryCount; q++) {
+            if (results[2 * q + 1] == 0) {
+                m_DroppedFrames++;
+                return false;
+            }
+        }
+
+        // Statistics come back as GPU_PROFILER_STATISTICS_COUNT counters plus availability per query.
+        // Queries of scopes that did not collect statistics were never begun and read as unavailable.
+        const u32 statisticsStride = GPU_PROFILER_STATISTICS_COUNT + 1;
+        std::vector<u64> statistics;
+        if (slot.StatisticsPool != VK_NULL_HANDLE) {
+            u32 scopeCount = static_cast<u32>(slot.Scopes.size());
+            statistics.assign(statisticsStride * scopeCount, 0);
+            result = vkGetQueryPoolResults(m_GraphicsDevice->Device, slot.StatisticsPool, 0, scopeCount,
+                                           statistics.size() * sizeof(u64), statistics.data(), statisticsStride * sizeof(u64),
+                                           VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+            if (result != VK_SUCCESS && result != VK_NOT_READY) {
+                statistics.clear();
+            }
+        }
+
+        f64 msPerTick = m_GraphicsDevice->Details.TimestampPeriod / 1000000.0;
+        m_Latest.FrameNumber = slot.FrameNumber;
+        m_Latest.Statistics = {};
+        m_Latest.Scopes.resize(slot.Scopes.size());
+        std::vector<std::string> paths(slot.Scopes.size());
+        for (u32 i = 0; i < slot.Scopes.size(); i++) {
+            const auto& record = slot.Scopes[i];
+            // Bits above timestampValidBits are undefined; masked, the difference is right across a wrap.
+            u64 begin = results[4 * i] & m_TimestampMask;
+            u64 end = results[4 * i + 2] & m_TimestampMask;
+
+            GpuScopeTiming& timing = m_Latest.Scopes[i];
+            timing.Name = record.Name;
+            timing.Parent = record.Parent;
+            timing.Depth = record.Depth;
+            timing.Time = static_cast<f64>((end - begin) & m_TimestampMask) * msPerTick;
+
+            timing.HasStatistics = false;
+            timing.Statistics = {};
+            if (record.Statistics && !statistics.empty() && statistics[statisticsStride * i + GPU_PROFILER_STATISTICS_COUNT] != 0) {
+                const u64* values = &statistics[statisticsStride * i];
+                timing.HasStatistics = true;
+                timing.Statistics.InputVertices = values[0];
+                timing.Statistics.InputPrimitives = values[1];
+                timing.Statistics.VertexShaderInvocations = values[2];
+                timing.Statistics.ClippingInvocations = values[3];
+                timing.Statistics.ClippingPrimitives = values[4];
+                timing.Statistics.FragmentShaderInvocations = values[5];
+                timing.Statistics.ComputeShaderInvocations = values[6];
+                gpu_add_statistics(m_Latest.Statistics, timing.Statistics);
+            }
+
+            // History is keyed by the full path, so a pass name reused under two parents stays separate.
+            paths[i] = record.Parent == GPU_PROFILER_NO_PARENT ? record.Name : paths[record.Parent] + "/" + record.Name;
+            UpdateHistory(paths[i], timing);
+        }
+        return true;
+    }
+
+    void GpuProfiler::UpdateHistory(const std::string& path, GpuScopeTiming& timing) {
+        GpuScopeHistory& history = m_History[path];
+        if (history.Samples.size() < GPU_PROFILER_HISTORY_LENGTH) {
+            history.Samples.push_back(timing.Time);
+        } else {
+            history.Samples[history.Cursor] = timing.Time;
+            history.Cursor = (history.Cursor + 1) % GPU_PROFILER_HISTORY_LENGTH;
+        }
+
+        std::vector<f64> sorted = history.Samples;
+        std::sort(sorted.begin(), sorted.end());
+        auto percentile = [&](f64 p) {
+            u32 index = static_cast<u32>(p * (sorted.size() - 1) + 0.5);
+            return sorted[index];
+        };
+        timing.Average = std::accumulate(sorted.begin(), sorted.end(), 0.0) / sorted.size();
+        timing.P50 = percentile(0.50);
+        timing.P95 = percentile(0.95);
+        timing.P99 = percentile(0.99);
+        timing.Max = sorted.back();
+    }
+
+    std::string GpuProfiler::Dump() {
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(3);
+        ss << "GPU frame " << m_Latest.FrameNumber << " (ms: time / avg / p50 / p95 / p99 / max)\n";
+        for (const auto& scope : m_Latest.Scopes) {
+            ss << std::string(2 * (scope.Depth + 1), ' ') << scope.Name << ": " << scope.Time << " / " << scope.Average << " / "
+               << scope.P50 << " / " << scope.P95 << " / " << scope.P99 << " / " << scope.Max;
+            if (scope.HasStatistics) {
+                ss << " [" << scope.Statistics.InputPrimitives << " prims in, " << scope.Statistics.ClippingPrimitives << " rasterized, "
+                   << scope.Statistics.VertexShaderInvocations << " vs, " << scope.Statistics.FragmentShaderInvocations << " fs, "
+                   << scope.Statistics.ComputeShaderInvocations << " cs]";
+            }
+            ss << "\n";
+        }
+        return ss.str();
+    }
+
+    GpuProfileScope::GpuProfileScope(GpuProfiler* profiler, VkCommandBuffer commandBuffer, const std::string& name, bool statistics) {
+        m_Profiler = profiler;
+        m_CommandBuffer = commandBuffer;
+        if (m_Profiler) {
+            m_Profiler->BeginScope(m_CommandBuffer, name, statistics);
+        }
+    }
+
+    GpuProfileScope::~GpuProfileScope() {
+        if (m_Profiler) {
+            m_Profiler->EndScope(m_CommandBuffer);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "Cortex/Graphics/VulkanTypes.hpp"
+#include "Cortex/Graphics/GraphicsDevice.hpp"
+
+namespace Cortex {
+    #define GPU_PROFILER_MAX_SCOPES 128
+    #define GPU_PROFILER_HISTORY_LENGTH 120
+    #define GPU_PROFILER_NO_PARENT std::numeric_limits<u32>::max()
+
+    struct GpuScopeTiming {
+        std::string Name;
+        u32 Parent;     // index into the frame's scope list, GPU_PROFILER_NO_PARENT for the root
+        u32 Depth;
+        f64 Time;       // milliseconds, this frame
+        f64 Average;    // the rest are over the last GPU_PROFILER_HISTORY_LENGTH frames the scope appeared in
+        f64 P50;
+        f64 P95;
+        f64 P99;
+        f64 Max;
+        bool HasStatistics;
+        GpuPipelineStatistics Statistics;
+    };
+
+    struct GpuFrameTimings {
+        u64 FrameNumber = 0;                // frame the timings were recorded in, 0 until one resolves
+        std::vector<GpuScopeTiming> Scopes; // depth-first, so children follow their parent; [0] is the frame
+        GpuPipelineStatistics Statistics;   // summed over the scopes that collected statistics
+    };
+
+    struct GpuProfilerScopeRecord {
+        std::string Name;
+        u32 Parent;
+        u32 Depth;
+        bool Statistics;
+    };
+
+    struct GpuProfilerSlot {
+        VkQueryPool QueryPool;
+        VkQueryPool StatisticsPool; // scope i owns query i, when it collected statistics
+        std::vector<GpuProfilerScopeRecord> Scopes; // scope i owns queries 2i and 2i + 1
+        u64 FrameNumber;
+        bool Pending;
+    };
+
+    struct GpuScopeHistory {
+        std::vector<f64> Samples;
+        u32 Cursor = 0;
+    };
+
+    // Brackets the frame and any nested scopes inside it with timestamp queries, one query pool per frame
+    // slot. A slot's results are read back when the slot comes round again, after the frame that wrote
+    // them has been waited on, so reading never stalls; timings therefore lag by the frames in flight.
+    // Scopes can only be opened on the frame's graphics command buffer.
+    //
+    // Scopes can also collect pipeline statistics. Statistics queries of one pool cannot be active at
+    // the same time, so only the outermost such scope at any point gets them; the render graph asks for
+    // them per pass.
+    class GpuProfiler {
+        public:
+            static std::unique_ptr<GpuProfiler> Create(std::shared_ptr<GraphicsDevice> device, u32 slotCount);
+            GpuProfiler(std::shared_ptr<GraphicsDevice> device, u32 slotCount);
+            ~GpuProfiler();
+            GpuProfiler(const GpuProfiler&) = delete;
+            GpuProfiler &operator=(const GpuProfiler&) = delete;
+
+            // Resolves whatever the slot recorded last time, then opens the root scope. Returns true when
+            // that produced a new set of timings.
+            bool BeginFrame(VkCommandBuffer commandBuffer, u32 slot, u64 frameNumber);
+            void EndFrame(VkCommandBuffer commandBuffer);
+            void BeginScope(VkCommandBuffer commandBuffer, const std::string& name, bool statistics = false);
+            void EndScope(VkCommandBuffer commandBuffer);
+
+            inline bool IsEnabled() { return m_Enabled; }
+            // Takes effect from the next scope; ignored when the device lacks pipelineStatisticsQuery.
+            inline void SetPipelineStatisticsEnabled(bool enabled) { m_StatisticsEnabled = enabled && m_StatisticsSupported; }
+            inline bool IsPipelineStatisticsEnabled() { return m_StatisticsEnabled; }
+            inline const GpuFrameTimings& GetLatest() { return m_Latest; }
+            inline f64 GetFrameTime() { return m_Latest.Scopes.empty() ? 0.0 : m_Latest.Scopes[0].Time; }
+            inline u64 GetDroppedFrameCount() { return m_DroppedFrames; }
+            std::string Dump();
+        private:
+            bool Resolve(GpuProfilerSlot& slot);
+            void UpdateHistory(const std::string& path, GpuScopeTiming& timing);
+
+            std::shared_ptr<GraphicsDevice> m_GraphicsDevice;
+            bool m_Enabled;
+            u64 m_TimestampMask; // the valid bits of a timestamp, so differences wrap with the counter
+            bool m_StatisticsSupported;
+            bool m_StatisticsEnabled;
+            bool m_StatisticsActive;
+            std::vector<GpuProfilerSlot> m_Slots;
+            u32 m_CurrentSlot;
+            std::vector<u32> m_ScopeStack; // GPU_PROFILER_NO_PARENT marks a scope dropped for lack of queries
+            bool m_OverflowWarned;
+            GpuFrameTimings m_Latest;
+            std::unordered_map<std::string, GpuScopeHistory> m_History;
+            u64 m_DroppedFrames;
+    };
+
+    // Opens a scope for the lifetime of the object. A null profiler makes it a no-op, so call sites do
+    // not need to check whether profiling is on.
+    class GpuProfileScope {
+        public:
+            GpuProfileScope(GpuProfiler* profiler, VkCommandBuffer commandBuffer, const std::string& name, bool statistics = false);
+            ~GpuProfileScope();
+            GpuProfileScope(const GpuProfileScope&) = delete;
+            GpuProfileScope &operator=(const GpuProfileScope&) = delete;
+        private:
+            GpuProfiler* m_Profiler;
+            VkCommandBuffer m_CommandBuffer;
+    };
+}
\ No newline at end of file
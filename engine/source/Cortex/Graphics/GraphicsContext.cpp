@@ -6,141 +6,239 @@ namespace Cortex {
             "VK_LAYER_KHRONOS_validation"
             },
         .DeviceExtensions = {
-            "VK_KHR_portability_subset", 
             VK_KHR_SWAPCHAIN_EXTENSION_NAME
             }
         };
+
+    // Headless sessions exist to be measured, and validation would dominate their CPU times.
+    static const VulkanSessionConfig headlessVulkanConfig = {
+        .ValidationLayers = {},
+        .DeviceExtensions = {}
+        };
     
     std::unique_ptr<GraphicsContext> GraphicsContext::Create(const std::unique_ptr<Window>& window) {
         return std::make_unique<GraphicsContext>(window);
     }
 
+    std::unique_ptr<GraphicsContext> GraphicsContext::Create(VkExtent2D extent) {
+        return std::make_unique<GraphicsContext>(extent);
+    }
+
     GraphicsContext::GraphicsContext(const std::unique_ptr<Window>& window) {
         m_CurrentFrameIndex = 0;
+        m_FrameNumber = 0;
+        m_CompletedFrameCount = 0;
+        m_PresentId = 0;
         m_GraphicsDevice = GraphicsDevice::Create(defaultVulkanConfig, window);
         m_SwapchainSuboptimal = false;
+        m_SwapchainGeneration = 0;
         m_SwapchainSpec = vulkan_create_swapchain_spec(
                                                 m_GraphicsDevice->PhysicalDevice, 
                                                 m_GraphicsDevice->Device, 
-                                                m_GraphicsDevice->Details.MaxMultisamplingCount,
                                                 m_GraphicsDevice->Details.DepthFormat,
                                                 m_GraphicsDevice->Surface,
-                                                (u32)window->GetFramebufferWidth(), (u32)window->GetFramebufferHeight()
+                                                (u32)window->GetFramebufferWidth(), (u32)window->GetFramebufferHeight(),
+                                                m_PresentConfig
                                             );
-        m_RenderPass = {vulkan_create_renderpass(m_GraphicsDevice->PhysicalDevice, m_GraphicsDevice->Device, m_SwapchainSpec)};
-        m_Swapchain = Swapchain::Create(m_GraphicsDevice, m_SwapchainSpec, m_RenderPass);
-        m_FrameResources = vulkan_create_frame_resources(m_GraphicsDevice->Device, MAX_FRAMES_IN_FLIGHT, m_GraphicsDevice->QueueIndices.Graphics);
+        m_Swapchain = Swapchain::Create(m_GraphicsDevice, m_SwapchainSpec);
+        m_Headless = false;
+        m_FramesInFlight = DEFAULT_FRAMES_IN_FLIGHT;
+        m_RequestedFramesInFlight = DEFAULT_FRAMES_IN_FLIGHT;
+        m_FrameResources = vulkan_create_frame_resources(m_GraphicsDevice->Device, m_FramesInFlight);
+        m_CommandAllocator = CommandAllocator::Create(m_GraphicsDevice->Device, m_GraphicsDevice->QueueIndices.Graphics, m_FramesInFlight);
+        m_CommandBuffer = VK_NULL_HANDLE;
+        m_SlotFrameNumbers.assign(m_FramesInFlight, 0);
+        m_SlotTimelineValues.assign(m_FramesInFlight, 0);
+    }
+
+    GraphicsContext::GraphicsContext(VkExtent2D extent) {
+        m_CurrentFrameIndex = 0;
+        m_FrameNumber = 0;
+        m_CompletedFrameCount = 0;
+        m_PresentId = 0;
+        m_GraphicsDevice = GraphicsDevice::Create(headlessVulkanConfig);
+        m_SwapchainSuboptimal = false;
+        m_SwapchainGeneration = 0;
+        m_Headless = true;
+        m_FramesInFlight = DEFAULT_FRAMES_IN_FLIGHT;
+        m_RequestedFramesInFlight = DEFAULT_FRAMES_IN_FLIGHT;
+        m_SwapchainSpec = vulkan_create_offscreen_spec(m_GraphicsDevice->Details.DepthFormat, extent.width, extent.height, m_FramesInFlight);
+        m_OffscreenTargets = vulkan_create_offscreen_targets(m_GraphicsDevice->Device, m_GraphicsDevice->PhysicalDevice, m_SwapchainSpec);
+        m_FrameResources = vulkan_create_frame_resources(m_GraphicsDevice->Device, m_FramesInFlight);
+        m_CommandAllocator = CommandAllocator::Create(m_GraphicsDevice->Device, m_GraphicsDevice->QueueIndices.Graphics, m_FramesInFlight);
+        m_CommandBuffer = VK_NULL_HANDLE;
+        m_SlotFrameNumbers.assign(m_FramesInFlight, 0);
+        m_SlotTimelineValues.assign(m_FramesInFlight, 0);
     }
 
     GraphicsContext::~GraphicsContext() {
-        vkDeviceWaitIdle(m_GraphicsDevice->Device);
-        vulkan_destroy_frame_resources(m_GraphicsDevice->Device, m_FrameResources);
-        vkDestroyRenderPass(m_GraphicsDevice->Device, m_RenderPass.Pass, nullptr);
+        VkDevice device = m_GraphicsDevice->Device;
+        std::vector<VulkanFrameResources> frameResources = m_FrameResources;
+        std::vector<VulkanOffscreenTarget> offscreenTargets = m_OffscreenTargets;
+        std::shared_ptr<CommandAllocator> commandAllocator = m_CommandAllocator;
+        m_GraphicsDevice->PendingDeletions.Push([=]() mutable {
+            vulkan_destroy_frame_resources(device, frameResources);
+            vulkan_destroy_offscreen_targets(device, offscreenTargets);
+            commandAllocator.reset();
+        });
     }
 
     bool GraphicsContext::BeginFrame(VkCommandBuffer& commandBuffer) {
+        CORTEX_PROFILE_FUNCTION();
+        // Recreate before acquiring: an image acquired from a swapchain that is about to be replaced
+        // would leave its semaphore signalled with nothing ever waiting on it.
+        if (m_SwapchainSuboptimal && !RecreateSwapchain()) {
+            return false;
+        }
+
+        // Present-id pacing: block until all but the last few presents have reached the display, which
+        // bounds latency far more tightly than the in-flight fences alone.
+        if (IsPresentWaitActive() && m_PresentId > m_PresentConfig.PresentWaitLag) {
+            CORTEX_PROFILE_SCOPE("WaitForPresent");
+            u64 timeout = 100000000; // 100ms, so a stalled compositor can't hang the loop
+            m_GraphicsDevice->WaitForPresentKHR(m_GraphicsDevice->Device, m_Swapchain->GetHandle(), m_PresentId - m_PresentConfig.PresentWaitLag, timeout);
+        }
+
+        // The graphics timeline reaching this slot's last value frees its command pools and semaphores, and
+        // means the frame that last used it and everything before it is done.
         VulkanFrameResources frameData = m_FrameResources[m_CurrentFrameIndex];
+        {
+            CORTEX_PROFILE_SCOPE("WaitForFrameSlot");
+            m_GraphicsDevice->Sync->Wait({QueueType::Graphics, m_SlotTimelineValues[m_CurrentFrameIndex]});
+        }
+        m_CompletedFrameCount = std::max(m_CompletedFrameCount, m_SlotFrameNumbers[m_CurrentFrameIndex]);
+        m_GraphicsDevice->PendingDeletions.Collect();
+
+        // Headless frames render into the slot's own offscreen image, which the wait above has freed.
+        VkResult result = VK_SUCCESS;
+        if (!m_Headless) {
+            CORTEX_PROFILE_SCOPE("AcquireImage");
+            result = m_Swapchain->SwapBuffers(frameData.ImageAvailableSemaphore);
+        }
 
-        VkResult result = m_Swapchain->SwapBuffers(frameData.InFlightFence, frameData.ImageAvailableSemaphore);
-        
         if (result == VK_ERROR_OUT_OF_DATE_KHR) {
             LOG_WARN("Swapchain out of date!");
             m_SwapchainSuboptimal = true;
+            return false;
         } else if (result == VK_SUBOPTIMAL_KHR) {
+            // The acquired image is still presentable, so use it and recreate before the next acquire.
             LOG_WARN("Swapchain suboptimal!");
-            // m_SwapchainSuboptimal = true;
+            m_SwapchainSuboptimal = true;
         } else if (result != VK_SUCCESS) {
             LOG_WARN("Couldn't retrieve image from swapchain!");
             m_SwapchainSuboptimal = true;
-        }
-
-        if (m_SwapchainSuboptimal) {
-            RecreateSwapchain();
             return false;
         }
 
-        vkResetFences(m_GraphicsDevice->Device, 1, &frameData.InFlightFence);
-        vkResetCommandBuffer(frameData.CommandBuffer, 0);
-    
+        // One reset for everything the slot recorded last time, instead of resetting buffers one by one.
+        m_CommandAllocator->Reset(m_CurrentFrameIndex);
+        m_CommandBuffer = m_CommandAllocator->Allocate(m_CurrentFrameIndex);
+
         VkCommandBufferBeginInfo beginInfo = {};
         beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
-        result = vkBeginCommandBuffer(frameData.CommandBuffer, &beginInfo);
+        result = vkBeginCommandBuffer(m_CommandBuffer, &beginInfo);
         ASSERT(result == VK_SUCCESS, "Failed to begin recording a Vulkan command buffer!");
 
-        commandBuffer = frameData.CommandBuffer;
+        commandBuffer = m_CommandBuffer;
         return true;
     }
 
-    bool GraphicsContext::BeginRenderPass(VkCommandBuffer commandBuffer) {
-        
-        std::array<VkClearValue, 2> clearValues{};
-        clearValues[0].color = {{0.8f, 0.8f, 0.8f, 1.0f}};
-        clearValues[1].depthStencil = {1.0f, 0};
-
-        VkRenderPassBeginInfo passBeginInfo = {};
-        passBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-        passBeginInfo.renderPass = m_RenderPass.Pass;
-        passBeginInfo.framebuffer = m_Swapchain->GetCurrentFramebuffer();
-        passBeginInfo.renderArea.offset = {0, 0};
-        passBeginInfo.renderArea.extent = m_SwapchainSpec.Extent;
-        passBeginInfo.clearValueCount = static_cast<u32>(clearValues.size());
-        passBeginInfo.pClearValues = clearValues.data();
-
-        vkCmdBeginRenderPass(commandBuffer, &passBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-
-        VkViewport viewport {};
-        viewport.x = 0.0f;
-        viewport.y = 0.0f;
-        viewport.width = m_SwapchainSpec.Extent.width;
-        viewport.height = m_SwapchainSpec.Extent.height;
-        viewport.minDepth = 0.0f;
-        viewport.maxDepth = 1.0f;
-        vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
-
-        VkRect2D scissor {};
-        scissor.offset = {0, 0};
-        scissor.extent = m_SwapchainSpec.Extent;
-        vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+    bool GraphicsContext::EndFrame() {
+        VulkanFrameResources frameData = m_FrameResources[m_CurrentFrameIndex];
 
+        VkResult result = vkEndCommandBuffer(m_CommandBuffer);
+        ASSERT(result == VK_SUCCESS, "Failed to finish recording a Vulkan command buffer.");
+
+        QueueSubmitInfo submitInfo = {};
+        submitInfo.CommandBuffers = { m_CommandBuffer };
+        submitInfo.Waits = m_FrameWaits;
+        if (!m_Headless) {
+            submitInfo.WaitBinary = frameData.ImageAvailableSemaphore;
+            submitInfo.WaitBinaryStages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+            submitInfo.SignalBinary = frameData.RenderFinishSemaphore;
+        }
+        QueuePoint framePoint;
+        {
+            CORTEX_PROFILE_SCOPE("Submit");
+            framePoint = m_GraphicsDevice->Sync->Submit(QueueType::Graphics, submitInfo);
+        }
+        m_FrameWaits.clear();
+
+        if (!m_Headless) {
+            u64 presentId = 0;
+            if (IsPresentWaitActive()) {
+                presentId = ++m_PresentId;
+            }
+            {
+                CORTEX_PROFILE_SCOPE("Present");
+                result = m_Swapchain->PresentImage(m_GraphicsDevice->Queues.Present, frameData.RenderFinishSemaphore, presentId);
+            }
+            if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
+                m_SwapchainSuboptimal = true;
+            } else {
+                ASSERT(result == VK_SUCCESS, "Failed to present new swapchain image!");
+            }
+        }
+
+        m_SlotFrameNumbers[m_CurrentFrameIndex] = m_FrameNumber + 1;
+        m_SlotTimelineValues[m_CurrentFrameIndex] = framePoint.Value;
+        m_CurrentFrameIndex = (m_CurrentFrameIndex + 1) % m_FramesInFlight;
+        m_FrameNumber++;
         return true;
     }
+    
+    void GraphicsContext::AddFrameDependency(const QueuePoint& point, VkPipelineStageFlags stages) {
+        m_FrameWaits.push_back({point, stages});
+    }
 
-    bool GraphicsContext::EndRenderPass(VkCommandBuffer commandBuffer) {
-        vkCmdEndRenderPass(commandBuffer);
-        return true;
+    void GraphicsContext::SetPresentConfig(const VulkanPresentConfig& config) {
+        if (config.PresentWait && !m_GraphicsDevice->Details.PresentWaitSupported) {
+            LOG_WARN("VK_KHR_present_wait is not supported, pacing on fences only.");
+        }
+        m_PresentConfig = config;
+        m_SwapchainSuboptimal = true;
     }
 
-    bool GraphicsContext::EndFrame() {
-        VulkanFrameResources frameData = m_FrameResources[m_CurrentFrameIndex];
+    bool GraphicsContext::IsPresentWaitActive() {
+        return m_PresentConfig.PresentWait && m_GraphicsDevice->Details.PresentWaitSupported;
+    }
 
-        VkResult result = vkEndCommandBuffer(frameData.CommandBuffer);
-        ASSERT(result == VK_SUCCESS, "Failed to finish recording a Vulkan command buffer.");
+    void GraphicsContext::SetFramesInFlight(u32 count) {
+        u32 clamped = std::clamp(count, 1u, (u32)MAX_FRAMES_IN_FLIGHT_LIMIT);
+        if (clamped != count) {
+            LOG_WARN("%u frames in flight is out of range, using %u.", count, clamped);
+        }
+        // Applied with the next swapchain rebuild, which is already a point where per-frame state changes.
+        m_RequestedFramesInFlight = clamped;
+        m_SwapchainSuboptimal = true;
+    }
 
-        VkSemaphore waitSemaphores[] = { frameData.ImageAvailableSemaphore };
-        VkSemaphore signalSemaphores[] = { frameData.RenderFinishSemaphore };
-        VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-        
-        VkSubmitInfo submitInfo = {};
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.waitSemaphoreCount = 1;
-        submitInfo.pWaitSemaphores = waitSemaphores;
-        submitInfo.pWaitDstStageMask = waitStages;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &frameData.CommandBuffer;
-        submitInfo.signalSemaphoreCount = 1;
-        submitInfo.pSignalSemaphores = signalSemaphores;
-
-        result = vkQueueSubmit(m_GraphicsDevice->Queues.Graphics, 1, &submitInfo, frameData.InFlightFence);
-        ASSERT(result == VK_SUCCESS, "Failed to submit command buffers to Graphics queue!");
-
-        result = m_Swapchain->PresentImage(m_GraphicsDevice->Queues.Present, frameData.RenderFinishSemaphore);
-        ASSERT(result == VK_SUCCESS, "Failed to present new swapchain image!");
-
-        m_CurrentFrameIndex = (m_CurrentFrameIndex + 1) % MAX_FRAMES_IN_FLIGHT;
-        return true;
+    void GraphicsContext::RebuildFrameResources() {
+        // Slot indices are about to be reassigned, so wait for our own outstanding frames (not the whole
+        // device) to let completion tracking restart cleanly on the new slots.
+        u64 lastFrameValue = *std::max_element(m_SlotTimelineValues.begin(), m_SlotTimelineValues.end());
+        m_GraphicsDevice->Sync->Wait({QueueType::Graphics, lastFrameValue});
+        m_CompletedFrameCount = m_FrameNumber;
+
+        // Pending presents may still wait on the old render-finished semaphores.
+        VkDevice device = m_GraphicsDevice->Device;
+        std::vector<VulkanFrameResources> oldResources = m_FrameResources;
+        m_GraphicsDevice->PendingDeletions.Push([=]() {
+            vulkan_destroy_frame_resources(device, oldResources);
+        });
+
+        LOG_INFO("Frames in flight: %u -> %u.", m_FramesInFlight, m_RequestedFramesInFlight);
+        m_FramesInFlight = m_RequestedFramesInFlight;
+        m_FrameResources = vulkan_create_frame_resources(device, m_FramesInFlight);
+        // Every slot's work has completed, so the old allocator can go straight away.
+        m_CommandAllocator = CommandAllocator::Create(device, m_GraphicsDevice->QueueIndices.Graphics, m_FramesInFlight);
+        m_SlotFrameNumbers.assign(m_FramesInFlight, 0);
+        m_SlotTimelineValues.assign(m_FramesInFlight, 0);
+        m_CurrentFrameIndex = 0;
     }
-    
+
     bool GraphicsContext::OnFramebufferResize(i32 width, i32 height) {
         m_SwapchainSuboptimal = true;
         m_SwapchainSpec.Extent.width = width;
@@ -149,56 +247,136 @@ namespace Cortex {
     }
 
     bool GraphicsContext::RecreateSwapchain() {
-        m_Swapchain = Swapchain::Create(m_GraphicsDevice, m_SwapchainSpec, m_RenderPass);
+        if (m_Headless) {
+            return RecreateOffscreenTargets();
+        }
+
+        VulkanSwapchainSpecification spec = vulkan_create_swapchain_spec(
+                                                m_GraphicsDevice->PhysicalDevice,
+                                                m_GraphicsDevice->Device,
+                                                m_GraphicsDevice->Details.DepthFormat,
+                                                m_GraphicsDevice->Surface,
+                                                m_SwapchainSpec.Extent.width, m_SwapchainSpec.Extent.height,
+                                                m_PresentConfig
+                                            );
+
+        // A minimised window has no framebuffer; keep the current swapchain until it comes back.
+        if (spec.Extent.width == 0 || spec.Extent.height == 0) {
+            return false;
+        }
+        if (spec.PresentMode != m_SwapchainSpec.PresentMode || spec.ImageCount != m_SwapchainSpec.ImageCount) {
+            LOG_INFO("Swapchain: %s with %u images.", string_VkPresentModeKHR(spec.PresentMode), spec.ImageCount);
+        }
+        m_SwapchainSpec = spec;
+
+        // Passing the old handle lets the driver hand resources across and keep presenting while the new
+        // swapchain is built. Frames already submitted keep using the old images; ~Swapchain defers their
+        // destruction until those frames have completed rather than draining the whole device.
+        m_Swapchain = Swapchain::Create(m_GraphicsDevice, m_SwapchainSpec, m_Swapchain->GetHandle());
+
+        m_SwapchainSuboptimal = false;
+        m_SwapchainGeneration++;
+        m_PresentId = 0; // present ids are per swapchain
+
+        if (m_RequestedFramesInFlight != m_FramesInFlight) {
+            RebuildFrameResources();
+        }
+        return true;
+    }
+
+    bool GraphicsContext::RecreateOffscreenTargets() {
+        if (m_SwapchainSpec.Extent.width == 0 || m_SwapchainSpec.Extent.height == 0) {
+            return false;
+        }
+        // Targets are per slot, so the slot count has to settle first.
+        if (m_RequestedFramesInFlight != m_FramesInFlight) {
+            RebuildFrameResources();
+        }
+
+        VkDevice device = m_GraphicsDevice->Device;
+        std::vector<VulkanOffscreenTarget> oldTargets = m_OffscreenTargets;
+        m_GraphicsDevice->PendingDeletions.Push([=]() {
+            vulkan_destroy_offscreen_targets(device, oldTargets);
+        });
+
+        m_SwapchainSpec = vulkan_create_offscreen_spec(m_GraphicsDevice->Details.DepthFormat, m_SwapchainSpec.Extent.width, m_SwapchainSpec.Extent.height, m_FramesInFlight);
+        m_OffscreenTargets = vulkan_create_offscreen_targets(device, m_GraphicsDevice->PhysicalDevice, m_SwapchainSpec);
         m_SwapchainSuboptimal = false;
+        m_SwapchainGeneration++;
         return true;
     }
 
-    std::shared_ptr<Model> GraphicsContext::LoadModelFromOBJ(const std::string& path) {
+    // Levels of detail, reordering for the GPU, then encoding; the result points into storage.
+    static ModelData graphics_import_mesh(const std::vector<VulkanVertex>& vertices, const std::vector<VulkanIndex>& indices, const MeshImportSettings& settings, ModelStorage& storage) {
+        CORTEX_PROFILE_FUNCTION();
+        std::vector<VulkanVertex> lodVertices = vertices;
+        std::vector<VulkanIndex> lodIndices = indices;
+        std::vector<MeshLod> lods;
+        mesh_build_lods(lodVertices, lodIndices, lods, settings.Lods);
+        for (u32 i = 1; i < lods.size(); i++) {
+            LOG_INFO("LOD %u: %u triangles, error %.4f.", i, lods[i].IndexCount / 3, lods[i].Error);
+        }
+
+        // Levels are reordered separately, since each is drawn on its own.
+        if (settings.Optimize) {
+            u32 vertexCount = static_cast<u32>(lodVertices.size());
+            MeshCacheStats before = mesh_analyze_vertex_cache(lodIndices.data(), lods[0].IndexCount, vertexCount);
+            for (const MeshLod& lod : lods) {
+                mesh_optimize_vertex_cache(lodIndices.data() + lod.FirstIndex, lod.IndexCount, vertexCount);
+                mesh_optimize_overdraw(lodIndices.data() + lod.FirstIndex, lod.IndexCount, lodVertices, settings.OverdrawThreshold);
+            }
+            mesh_optimize_vertex_fetch(lodVertices, lodIndices);
+            MeshCacheStats after = mesh_analyze_vertex_cache(lodIndices.data(), lods[0].IndexCount, static_cast<u32>(lodVertices.size()));
+            LOG_INFO("Vertex cache: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f.", before.ACMR, after.ACMR, before.ATVR, after.ATVR);
+        }
+
+        VertexLayout layout = vertex_choose_layout(lodVertices, settings.Quantize);
+        LOG_INFO("Vertex layout %s: %u bytes per vertex, %u before.", vertex_layout_name(layout), vertex_layout_stride(layout), static_cast<u32>(sizeof(VulkanVertex)));
+        return model_encode(lodVertices, lodIndices, lods, layout, storage);
+    }
+
+    std::shared_ptr<Model> GraphicsContext::LoadModel(const std::vector<VulkanVertex>& vertices, const std::vector<VulkanIndex>& indices, const MeshImportSettings& settings) {
+        ModelStorage storage;
+        return std::make_shared<Model>(m_GraphicsDevice, graphics_import_mesh(vertices, indices, settings, storage));
+    }
+
+    std::shared_ptr<Model> GraphicsContext::LoadModelFromOBJ(const std::string& path, const MeshImportSettings& settings) {
+        std::string cachePath = path + MESH_CACHE_EXTENSION;
+        if (settings.Cache) {
+            auto start = std::chrono::steady_clock::now();
+            ModelData data;
+            std::unique_ptr<MappedFile> cache = mesh_cache_read(cachePath, path, settings, data);
+            if (cache) {
+                f64 elapsed = std::chrono::duration<f64, std::micro>(std::chrono::steady_clock::now() - start).count();
+                LOG_INFO("Mapped %s from its mesh cache in %.1f us.", path.c_str(), elapsed);
+                return std::make_shared<Model>(m_GraphicsDevice, data);
+            }
+        }
+
         tinyobj::attrib_t attrib;
         std::vector<tinyobj::shape_t> shapes;
-        std::vector<tinyobj::material_t> materials;
-        std::string warn, err;
-
-        bool ok = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path.c_str());
-        ASSERT(ok, "Failed to load OBJ file.");
+        if (!m_ObjParser) {
+            m_ObjParser = std::make_unique<ObjParser>();
+        }
+        auto start = std::chrono::steady_clock::now();
+        if (m_ObjParser->Parse(path, attrib, shapes)) {
+            f64 elapsed = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+            LOG_INFO("Parsed %s in %.2f ms.", path.c_str(), elapsed);
+        } else {
+            LOG_INFO("Reading %s with tinyobj, the parallel parser does not handle it.", path.c_str());
+            vulkan_read_obj(path, attrib, shapes);
+        }
 
         std::vector<VulkanVertex> vertices;
         std::vector<VulkanIndex> indices;
-        for (const auto& shape : shapes) {
-            for (const auto& index : shape.mesh.indices) {
-                VulkanVertex vert {};
-
-                if (index.vertex_index >= 0) {
-                    vert.Position = {
-                        attrib.vertices[3 * index.vertex_index + 0],
-                        attrib.vertices[3 * index.vertex_index + 1],
-                        attrib.vertices[3 * index.vertex_index + 2],
-                    };
-                }
-
-                if (index.normal_index >= 0) {
-                    vert.Normal = {
-                        attrib.normals[3 * index.normal_index + 0],
-                        attrib.normals[3 * index.normal_index + 1],
-                        attrib.normals[3 * index.normal_index + 2],
-                    };
-                }
-
-                if (index.texcoord_index >= 0) {
-                    vert.TexCoord = {
-                        attrib.texcoords[2 * index.texcoord_index + 0],
-                        1.0f - attrib.texcoords[2 * index.texcoord_index + 1]
-                    };
-                }
-
-                vert.Color = {1.0f, 1.0f, 1.0f};
-
-                vertices.push_back(vert);
-                indices.push_back(indices.size());
-            }
-        }
+        vulkan_build_obj_vertices(attrib, shapes, vertices, indices);
+        LOG_INFO("Welded %zu corners of %s into %zu vertices.", indices.size(), path.c_str(), vertices.size());
 
-        return std::make_shared<Model>(m_GraphicsDevice, vertices, indices);
+        ModelStorage storage;
+        ModelData data = graphics_import_mesh(vertices, indices, settings, storage);
+        if (settings.Cache && !mesh_cache_write(cachePath, path, settings, data)) {
+            LOG_WARN("Failed to write mesh cache %s.", cachePath.c_str());
+        }
+        return std::make_shared<Model>(m_GraphicsDevice, data);
     }
 }
\ No newline at end of file
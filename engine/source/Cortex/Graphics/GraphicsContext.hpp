@@ -6,47 +6,86 @@
 #include "Cortex/Core/Window.hpp"
 
 #include "Cortex/Graphics/GraphicsDevice.hpp"
-#include "Cortex/Graphics/RenderPass.hpp"
 #include "Cortex/Graphics/Swapchain.hpp"
 #include "Cortex/Graphics/Pipeline.hpp"
 #include "Cortex/Graphics/Model.hpp"
+#include "Cortex/Graphics/MeshOptimizer.hpp"
+#include "Cortex/Graphics/MeshCache.hpp"
+#include "Cortex/Graphics/ObjParser.hpp"
 #include "Cortex/Graphics/Shader.hpp"
 
 namespace Cortex {
     class GraphicsContext {
         public:
             static std::unique_ptr<GraphicsContext> Create(const std::unique_ptr<Window>& window);
+            // Headless: no window, surface or swapchain. Frames render into offscreen images of the given
+            // extent, one per frame slot, and are never presented.
+            static std::unique_ptr<GraphicsContext> Create(VkExtent2D extent);
             GraphicsContext(const std::unique_ptr<Window>& window);
+            GraphicsContext(VkExtent2D extent);
             ~GraphicsContext();
             GraphicsContext(const GraphicsContext&) = delete;
             GraphicsContext &operator=(const GraphicsContext&) = delete;
 
             inline std::shared_ptr<GraphicsDevice> GetDevice() { return m_GraphicsDevice; }
-            inline RenderPass GetRenderPass() { return m_RenderPass; }
+            inline const VulkanSwapchainSpecification& GetSwapchainSpec() { return m_SwapchainSpec; }
+            inline VkImage GetCurrentSwapchainImage() { return m_Headless ? m_OffscreenTargets[m_CurrentFrameIndex].Image : m_Swapchain->GetCurrentImage(); }
+            inline VkImageView GetCurrentSwapchainImageView() { return m_Headless ? m_OffscreenTargets[m_CurrentFrameIndex].View : m_Swapchain->GetCurrentImageView(); }
+            // The layout the backbuffer must be left in when the frame ends; offscreen images are left ready to be read back.
+            inline VkImageLayout GetBackbufferFinalLayout() { return m_Headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR; }
+            inline bool IsHeadless() { return m_Headless; }
+            inline u32 GetSwapchainGeneration() { return m_SwapchainGeneration; }
+            inline u64 GetFrameNumber() { return m_FrameNumber; }
+            inline u64 GetCompletedFrameCount() { return m_CompletedFrameCount; }
+            inline u32 GetFramesInFlight() { return m_FramesInFlight; }
+            inline u32 GetCurrentFrameIndex() { return m_CurrentFrameIndex; }
+            // Extra command buffers (e.g. secondaries recorded on worker threads) for the current frame,
+            // recycled with the frame's slot. Each thread gets buffers from its own pool.
+            inline VkCommandBuffer AllocateCommandBuffer(VkCommandBufferLevel level) { return m_CommandAllocator->Allocate(m_CurrentFrameIndex, level); }
+            void SetFramesInFlight(u32 count);
 
             bool BeginFrame(VkCommandBuffer& commandBuffer);
-            bool BeginRenderPass(VkCommandBuffer commandBuffer);
-            bool EndRenderPass(VkCommandBuffer commandBuffer);
             bool EndFrame();
+            // Makes the current frame's submission wait for work on another queue, e.g. an async upload.
+            void AddFrameDependency(const QueuePoint& point, VkPipelineStageFlags stages);
+
+            inline const VulkanPresentConfig& GetPresentConfig() { return m_PresentConfig; }
+            void SetPresentConfig(const VulkanPresentConfig& config);
+            bool IsPresentWaitActive();
 
             bool OnFramebufferResize(i32 width, i32 height);
             bool RecreateSwapchain();
 
-            inline std::shared_ptr<Model> LoadModel(const std::vector<VulkanVertex>& vertices, const std::vector<VulkanIndex>& indices) {
-                return std::make_shared<Model>(m_GraphicsDevice, vertices, indices);
-            }
-
-            std::shared_ptr<Model> LoadModelFromOBJ(const std::string& path);
+            // Both build a chain of simplified levels of detail unless settings.Lods.MaxLevels is 1, and
+            // reorder every level for the vertex cache unless settings.Optimize is off.
+            std::shared_ptr<Model> LoadModel(const std::vector<VulkanVertex>& vertices, const std::vector<VulkanIndex>& indices, const MeshImportSettings& settings = {});
+            std::shared_ptr<Model> LoadModelFromOBJ(const std::string& path, const MeshImportSettings& settings = {});
             
         private:
+            void RebuildFrameResources();
+            bool RecreateOffscreenTargets();
+
             u32 m_CurrentFrameIndex;
+            u32 m_FramesInFlight;
+            u32 m_RequestedFramesInFlight;
+            std::vector<u64> m_SlotFrameNumbers; // per slot: number of frames submitted when it was last used
+            std::vector<u64> m_SlotTimelineValues; // per slot: graphics timeline value its last frame signals
+            std::vector<QueueWait> m_FrameWaits;
+            u64 m_FrameNumber;
+            u64 m_CompletedFrameCount;
+            VulkanPresentConfig m_PresentConfig;
+            u64 m_PresentId;
             VulkanSessionConfig m_Config;
             std::shared_ptr<GraphicsDevice> m_GraphicsDevice;
             VulkanSwapchainSpecification m_SwapchainSpec;
-            RenderPass m_RenderPass;
             bool m_SwapchainSuboptimal;
-            std::unique_ptr<Swapchain> m_Swapchain;
-            VulkanDepthResources m_VulkanDepthResources;
+            u32 m_SwapchainGeneration;
+            std::unique_ptr<Swapchain> m_Swapchain; // null when headless
+            bool m_Headless;
+            std::vector<VulkanOffscreenTarget> m_OffscreenTargets;
             std::vector<VulkanFrameResources> m_FrameResources;
+            std::shared_ptr<CommandAllocator> m_CommandAllocator;
+            VkCommandBuffer m_CommandBuffer;
+            std::unique_ptr<ObjParser> m_ObjParser; // created by the first OBJ import that misses its cache
     };
 }
\ No newline at end of file
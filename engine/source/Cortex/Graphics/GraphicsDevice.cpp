@@ -2,12 +2,19 @@
 
 namespace Cortex {
     std::unique_ptr<GraphicsDevice> GraphicsDevice::Create(VulkanSessionConfig config, const std::unique_ptr<Window>& window) {
-        return std::make_unique<GraphicsDevice>(config, window);
+        return std::make_unique<GraphicsDevice>(config, window.get());
     }
 
-    GraphicsDevice::GraphicsDevice(VulkanSessionConfig config, const std::unique_ptr<Window>& window) {
-        vulkan_create_instance(config.ValidationLayers, Instance);
-        window->GetVulkanSurface(Instance, Surface);
+    std::unique_ptr<GraphicsDevice> GraphicsDevice::Create(VulkanSessionConfig config) {
+        return std::make_unique<GraphicsDevice>(config, nullptr);
+    }
+
+    GraphicsDevice::GraphicsDevice(VulkanSessionConfig config, Window* window) {
+        vulkan_create_instance(config.ValidationLayers, window == nullptr, Instance);
+        Surface = VK_NULL_HANDLE;
+        if (window) {
+            window->GetVulkanSurface(Instance, Surface);
+        }
         VulkanPhysicalDeviceRequirements deviceRequirements = {
             config.DeviceExtensions,
             false,
@@ -16,31 +23,106 @@ namespace Cortex {
             true
         };
         vulkan_obtain_physical_device(Instance, Surface, deviceRequirements, PhysicalDevice);
+
+        // Portability implementations (MoltenVK) must have the subset enabled; nothing else exposes it.
+        std::vector<const char*> deviceExtensions = config.DeviceExtensions;
+        if (vulkan_check_device_extension_support(PhysicalDevice, {"VK_KHR_portability_subset"})) {
+            deviceExtensions.push_back("VK_KHR_portability_subset");
+        }
+
+        // Memory budget is only read by tools measuring memory use, so enable it when it's there.
+        Details.MemoryBudgetSupported = vulkan_check_device_extension_support(PhysicalDevice, {VK_EXT_MEMORY_BUDGET_EXTENSION_NAME});
+        if (Details.MemoryBudgetSupported) {
+            deviceExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        }
+
+        // Present wait is optional: enable it when both extensions and their features are there.
+        VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures = {};
+        presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+        VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures = {};
+        presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+        presentIdFeatures.pNext = &presentWaitFeatures;
+        void* presentChain = nullptr;
+
+        Details.PresentWaitSupported = false;
+        if (Surface != VK_NULL_HANDLE && vulkan_check_device_extension_support(PhysicalDevice, {VK_KHR_PRESENT_ID_EXTENSION_NAME, VK_KHR_PRESENT_WAIT_EXTENSION_NAME})) {
+            VkPhysicalDeviceFeatures2 features = {};
+            features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+            features.pNext = &presentIdFeatures;
+            vkGetPhysicalDeviceFeatures2(PhysicalDevice, &features);
+            if (presentIdFeatures.presentId && presentWaitFeatures.presentWait) {
+                deviceExtensions.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+                deviceExtensions.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+                presentChain = &presentIdFeatures;
+                Details.PresentWaitSupported = true;
+            }
+        }
+
+        // Timeline semaphores (core in 1.2) carry all queue and frame synchronisation, so they are required.
+        VkPhysicalDeviceTimelineSemaphoreFeatures timelineFeatures = {};
+        timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+        VkPhysicalDeviceFeatures2 timelineQuery = {};
+        timelineQuery.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        timelineQuery.pNext = &timelineFeatures;
+        vkGetPhysicalDeviceFeatures2(PhysicalDevice, &timelineQuery);
+        ASSERT(timelineFeatures.timelineSemaphore, "Vulkan device does not support timeline semaphores!");
+        timelineFeatures.pNext = presentChain;
+        const void* featureChain = &timelineFeatures;
+
+        // Pipeline statistics are only for profiling, so their absence just turns them off.
+        VkPhysicalDeviceFeatures supportedFeatures;
+        vkGetPhysicalDeviceFeatures(PhysicalDevice, &supportedFeatures);
+        VkPhysicalDeviceFeatures enabledFeatures = {};
+        enabledFeatures.samplerAnisotropy = VK_TRUE;
+        enabledFeatures.pipelineStatisticsQuery = supportedFeatures.pipelineStatisticsQuery;
+        Details.PipelineStatisticsSupported = supportedFeatures.pipelineStatisticsQuery == VK_TRUE;
+
         vulkan_create_device(
             Instance, 
             PhysicalDevice, 
             Surface,
-            config.DeviceExtensions, 
+            deviceExtensions, 
+            enabledFeatures,
+            featureChain,
             Device, 
             QueueIndices, 
             Queues
         );
-        TransferCommandPool = vulkan_create_command_pool(Device, QueueIndices.Transfer, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+        TransferCommands = CommandAllocator::Create(Device, QueueIndices.Transfer, 1);
+        Sync = QueueSync::Create(Device, Queues);
+        PendingDeletions.SetQueueSync(Sync.get());
+
+        WaitForPresentKHR = nullptr;
+        if (Details.PresentWaitSupported) {
+            WaitForPresentKHR = (PFN_vkWaitForPresentKHR)vkGetDeviceProcAddr(Device, "vkWaitForPresentKHR");
+            Details.PresentWaitSupported = WaitForPresentKHR != nullptr;
+        }
 
         Details.MaxMultisamplingCount = vulkan_get_max_msaa_count(PhysicalDevice);
+        Details.SupportedMultisamplingCounts = vulkan_get_supported_msaa_counts(PhysicalDevice);
         Details.DepthFormat = vulkan_find_supported_format(
             PhysicalDevice, 
             {VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT},
             VK_IMAGE_TILING_OPTIMAL,
             VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT
         );
+        vulkan_get_timestamp_support(PhysicalDevice, QueueIndices.Graphics, Details.TimestampPeriod, Details.TimestampValidBits, Details.TimestampsSupported);
+        Details.AsyncComputeSupported = Queues.Compute != VK_NULL_HANDLE && Queues.Compute != Queues.Graphics;
+        if (!Details.AsyncComputeSupported) {
+            LOG_INFO("No separate compute queue, async compute passes will run on the graphics queue.");
+        }
     }
 
     GraphicsDevice::~GraphicsDevice() {
+        // The only place the device is drained: everything still queued for deletion goes at once.
         vkDeviceWaitIdle(Device);
-        vkDestroyCommandPool(Device, TransferCommandPool, nullptr);
+        PendingDeletions.Flush();
+        Sync.reset();
+        TransferCommands.reset();
         vkDestroyDevice(Device, nullptr);
-        vkDestroySurfaceKHR(Instance, Surface, nullptr);
+        if (Surface != VK_NULL_HANDLE) {
+            vkDestroySurfaceKHR(Instance, Surface, nullptr);
+        }
         vkDestroyInstance(Instance, nullptr);  
     }
 }
\ No newline at end of file
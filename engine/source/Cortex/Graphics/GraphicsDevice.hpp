@@ -5,22 +5,35 @@
 
 #include "Cortex/Core/Window.hpp"
 
+#include "Cortex/Graphics/QueueSync.hpp"
+#include "Cortex/Graphics/CommandAllocator.hpp"
+#include "Cortex/Graphics/DeletionQueue.hpp"
+#include "Cortex/Graphics/FrameStats.hpp"
+
 namespace Cortex {
     class GraphicsDevice {
         public:
             static std::unique_ptr<GraphicsDevice> Create(VulkanSessionConfig config, const std::unique_ptr<Window>& window);
-            GraphicsDevice(VulkanSessionConfig config, const std::unique_ptr<Window>& window);
+            // Headless: no surface, no present queue, and the config should not ask for VK_KHR_swapchain.
+            static std::unique_ptr<GraphicsDevice> Create(VulkanSessionConfig config);
+            GraphicsDevice(VulkanSessionConfig config, Window* window);
             ~GraphicsDevice();
             GraphicsDevice(const GraphicsDevice&) = delete;
             GraphicsDevice &operator=(const GraphicsDevice&) = delete;
 
             VkInstance Instance;
-            VkSurfaceKHR Surface;
+            VkSurfaceKHR Surface; // VK_NULL_HANDLE when headless
             VkPhysicalDevice PhysicalDevice;
             VkDevice Device;
             VulkanQueueIndices QueueIndices;
             VulkanQueues Queues;
-            VkCommandPool TransferCommandPool;
+            std::shared_ptr<CommandAllocator> TransferCommands; // one-shot upload buffers, a single slot
             VulkanDeviceDetails Details;
+            PFN_vkWaitForPresentKHR WaitForPresentKHR;
+            std::unique_ptr<QueueSync> Sync;
+            DeletionQueue PendingDeletions;
+            inline bool IsHeadless() { return Surface == VK_NULL_HANDLE; }
+
+            RenderCounters Counters; // bumped by recording and upload code, collected once per frame by the renderer
     };
 }
\ No newline at end of file
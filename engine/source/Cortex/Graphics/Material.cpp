@@ -1,5 +1,11 @@
 #include "Cortex/Graphics/Material.hpp"
 
 namespace Cortex {
-    
+    std::shared_ptr<Material> Material::Create(const glm::vec4& baseColor) {
+        return std::make_shared<Material>(baseColor);
+    }
+
+    Material::Material(const glm::vec4& baseColor) {
+        m_BaseColor = baseColor;
+    }
 }
\ No newline at end of file
@@ -7,8 +7,14 @@
 #include "Cortex/Graphics/GraphicsDevice.hpp"
 
 namespace Cortex {
+    // Only a tint for now, applied through the per-draw push constants.
     class Material {
         public:
-
+            static std::shared_ptr<Material> Create(const glm::vec4& baseColor);
+            Material(const glm::vec4& baseColor);
+            inline const glm::vec4& GetBaseColor() { return m_BaseColor; }
+            inline void SetBaseColor(const glm::vec4& baseColor) { m_BaseColor = baseColor; }
+        private:
+            glm::vec4 m_BaseColor;
     };
 }
\ No newline at end of file
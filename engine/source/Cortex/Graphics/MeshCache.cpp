@@ -0,0 +1,168 @@
+#include "Cortex/Graphics/MeshCache.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <type_traits>
+
+namespace Cortex {
+    static_assert(std::is_trivially_copyable_v<MeshCacheHeader>, "MeshCacheHeader is written as raw bytes.");
+
+    static inline u64 mesh_cache_mix(u64 h) {
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 33;
+        h *= 0xC4CEB9FE1A85EC53ull;
+        h ^= h >> 33;
+        return h;
+    }
+
+    // Eight bytes a step, so hashing a source file costs little beside reading it.
+    u64 mesh_cache_hash(const void* data, u64 size, u64 seed) {
+        const u8* bytes = static_cast<const u8*>(data);
+        u64 h = seed ^ (size * 0x9E3779B97F4A7C15ull);
+        u64 i = 0;
+        for (; i + 8 <= size; i += 8) {
+            u64 word;
+            memcpy(&word, bytes + i, sizeof(word));
+            h = (h ^ mesh_cache_mix(word)) * 0x9E3779B97F4A7C15ull;
+        }
+        u64 tail = 0;
+        if (i < size) {
+            memcpy(&tail, bytes + i, size - i);
+        }
+        h = (h ^ mesh_cache_mix(tail)) * 0x9E3779B97F4A7C15ull;
+        return mesh_cache_mix(h);
+    }
+
+    u64 mesh_cache_settings_hash(const MeshImportSettings& settings) {
+        // Field by field, since the struct's padding is not guaranteed to be zero.
+        u64 h = mesh_cache_hash(&settings.Lods.MaxLevels, sizeof(settings.Lods.MaxLevels));
+        h = mesh_cache_hash(&settings.Lods.Reduction, sizeof(settings.Lods.Reduction), h);
+        h = mesh_cache_hash(&settings.Lods.MinTriangles, sizeof(settings.Lods.MinTriangles), h);
+        h = mesh_cache_hash(&settings.Lods.AttributeWeight, sizeof(settings.Lods.AttributeWeight), h);
+        h = mesh_cache_hash(&settings.Optimize, sizeof(settings.Optimize), h);
+        h = mesh_cache_hash(&settings.OverdrawThreshold, sizeof(settings.OverdrawThreshold), h);
+        h = mesh_cache_hash(&settings.Quantize, sizeof(settings.Quantize), h);
+        u32 cacheSize = MESH_VERTEX_CACHE_SIZE;
+        return mesh_cache_hash(&cacheSize, sizeof(cacheSize), h);
+    }
+
+    static inline u64 mesh_cache_align(u64 offset) {
+        return (offset + MESH_CACHE_ALIGNMENT - 1) & ~static_cast<u64>(MESH_CACHE_ALIGNMENT - 1);
+    }
+
+    static inline u64 mesh_cache_index_size(u32 indexType) {
+        return indexType == VK_INDEX_TYPE_UINT16 ? sizeof(u16) : sizeof(u32);
+    }
+
+    static bool mesh_cache_hash_file(const std::string& path, u64& outHash) {
+        std::unique_ptr<MappedFile> file = MappedFile::Open(path);
+        if (!file) {
+            return false;
+        }
+        outHash = mesh_cache_hash(file->GetData(), file->GetSize());
+        return true;
+    }
+
+    std::unique_ptr<MappedFile> mesh_cache_read(const std::string& cachePath, const std::string& sourcePath, const MeshImportSettings& settings, ModelData& outData) {
+        CORTEX_PROFILE_FUNCTION();
+        std::unique_ptr<MappedFile> cache = MappedFile::Open(cachePath);
+        if (!cache || cache->GetSize() < sizeof(MeshCacheHeader)) {
+            return nullptr;
+        }
+        MeshCacheHeader header;
+        memcpy(&header, cache->GetData(), sizeof(header));
+        if (header.Magic != MESH_CACHE_MAGIC || header.Version != MESH_CACHE_VERSION || header.SettingsHash != mesh_cache_settings_hash(settings)) {
+            return nullptr;
+        }
+
+        // The source is only hashed once its size or time has moved, so an unchanged asset costs a
+        // stat; a touched but identical one still hits.
+        FileInfo source;
+        if (!file_get_info(sourcePath, source) || source.Size != header.SourceSize) {
+            return nullptr;
+        }
+        if (source.Modified != header.SourceModified) {
+            u64 sourceHash;
+            if (!mesh_cache_hash_file(sourcePath, sourceHash) || sourceHash != header.SourceHash) {
+                return nullptr;
+            }
+        }
+
+        // Everything the header points at must lie inside the file before anything is read from it.
+        if (header.FileSize != cache->GetSize()
+            || header.Layout >= VERTEX_LAYOUT_COUNT
+            || header.VertexStride != vertex_layout_stride(static_cast<VertexLayout>(header.Layout))
+            || (header.IndexType != VK_INDEX_TYPE_UINT16 && header.IndexType != VK_INDEX_TYPE_UINT32)
+            || header.LodCount > MESH_MAX_LODS
+            || header.LodOffset + static_cast<u64>(header.LodCount) * sizeof(MeshLod) > header.FileSize
+            || header.VertexOffset + static_cast<u64>(header.VertexCount) * header.VertexStride > header.FileSize
+            || header.IndexOffset + header.IndexCount * mesh_cache_index_size(header.IndexType) > header.FileSize) {
+            LOG_WARN("Ignoring malformed mesh cache %s.", cachePath.c_str());
+            return nullptr;
+        }
+        const u8* base = cache->GetData();
+        const MeshLod* lods = reinterpret_cast<const MeshLod*>(base + header.LodOffset);
+        for (u32 i = 0; i < header.LodCount; i++) {
+            if (static_cast<u64>(lods[i].FirstIndex) + lods[i].IndexCount > header.IndexCount) {
+                LOG_WARN("Ignoring malformed mesh cache %s.", cachePath.c_str());
+                return nullptr;
+            }
+        }
+
+        outData.Layout = static_cast<VertexLayout>(header.Layout);
+        outData.IndexType = static_cast<VkIndexType>(header.IndexType);
+        outData.VertexCount = header.VertexCount;
+        outData.IndexCount = header.IndexCount;
+        outData.Vertices = base + header.VertexOffset;
+        outData.Indices = base + header.IndexOffset;
+        outData.VertexToModel = header.VertexToModel;
+        outData.BoundingSphere = header.BoundingSphere;
+        outData.Lods = lods;
+        outData.LodCount = header.LodCount;
+        return cache;
+    }
+
+    bool mesh_cache_write(const std::string& cachePath, const std::string& sourcePath, const MeshImportSettings& settings, const ModelData& data) {
+        CORTEX_PROFILE_FUNCTION();
+        MeshCacheHeader header = {};
+        header.Magic = MESH_CACHE_MAGIC;
+        header.Version = MESH_CACHE_VERSION;
+        FileInfo source;
+        if (!file_get_info(sourcePath, source) || !mesh_cache_hash_file(sourcePath, header.SourceHash)) {
+            return false;
+        }
+        header.SourceSize = source.Size;
+        header.SourceModified = source.Modified;
+        header.SettingsHash = mesh_cache_settings_hash(settings);
+        header.Layout = static_cast<u32>(data.Layout);
+        header.IndexType = static_cast<u32>(data.IndexType);
+        header.VertexCount = data.VertexCount;
+        header.IndexCount = data.IndexCount;
+        header.VertexStride = vertex_layout_stride(data.Layout);
+        header.LodCount = data.LodCount;
+        header.VertexToModel = data.VertexToModel;
+        header.BoundingSphere = data.BoundingSphere;
+        header.LodOffset = mesh_cache_align(sizeof(MeshCacheHeader));
+        header.VertexOffset = mesh_cache_align(header.LodOffset + static_cast<u64>(data.LodCount) * sizeof(MeshLod));
+        header.IndexOffset = mesh_cache_align(header.VertexOffset + static_cast<u64>(data.VertexCount) * header.VertexStride);
+        header.FileSize = header.IndexOffset + data.IndexCount * mesh_cache_index_size(header.IndexType);
+
+        std::vector<u8> file(header.FileSize, 0);
+        memcpy(file.data(), &header, sizeof(header));
+        memcpy(file.data() + header.LodOffset, data.Lods, static_cast<size_t>(data.LodCount) * sizeof(MeshLod));
+        memcpy(file.data() + header.VertexOffset, data.Vertices, static_cast<size_t>(data.VertexCount) * header.VertexStride);
+        memcpy(file.data() + header.IndexOffset, data.Indices, static_cast<size_t>(header.FileSize - header.IndexOffset));
+
+        std::string temporaryPath = cachePath + ".tmp";
+        {
+            std::ofstream stream(temporaryPath, std::ios::binary | std::ios::trunc);
+            stream.write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size()));
+            if (!stream.good()) {
+                std::remove(temporaryPath.c_str());
+                return false;
+            }
+        }
+        return std::rename(temporaryPath.c_str(), cachePath.c_str()) == 0;
+    }
+}
\ No newline at end of file
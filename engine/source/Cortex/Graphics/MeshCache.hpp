@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Cortex/Base/MappedFile.hpp"
+#include "Cortex/Graphics/Model.hpp"
+#include "Cortex/Graphics/MeshOptimizer.hpp"
+
+namespace Cortex {
+    #define MESH_CACHE_MAGIC 0x534D5843u   // "CXMS"
+    #define MESH_CACHE_VERSION 1            // bump whenever the import pipeline's output changes
+    #define MESH_CACHE_ALIGNMENT 64         // every blob starts on a cache line
+    #define MESH_CACHE_EXTENSION ".cxmesh"
+
+    // A mesh cache file is this header, then the LOD table, the vertices and the indices, each
+    // aligned to MESH_CACHE_ALIGNMENT and stored exactly as ModelData describes them, so loading is
+    // mapping the file and pointing into it. Native byte order: the cache is rebuilt, not shipped.
+    struct MeshCacheHeader {
+        u32 Magic;
+        u32 Version;
+        u64 SourceHash;         // of the source file's bytes
+        u64 SourceSize;
+        i64 SourceModified;     // while size and time still match, the source is not hashed again
+        u64 SettingsHash;       // of the import settings the mesh was built with
+        u32 Layout;
+        u32 IndexType;
+        u32 VertexCount;
+        u32 IndexCount;
+        u32 VertexStride;
+        u32 LodCount;
+        glm::mat4 VertexToModel;
+        glm::vec4 BoundingSphere;
+        u64 LodOffset;
+        u64 VertexOffset;
+        u64 IndexOffset;
+        u64 FileSize;
+    };
+
+    u64 mesh_cache_hash(const void* data, u64 size, u64 seed = 0);
+    // Covers every setting that changes what an import produces.
+    u64 mesh_cache_settings_hash(const MeshImportSettings& settings);
+
+    // Maps the cache at cachePath and points outData into it, if it holds sourcePath as imported with
+    // these settings. Null when the cache is missing, stale or malformed; otherwise outData stays
+    // valid for as long as the returned mapping lives.
+    std::unique_ptr<MappedFile> mesh_cache_read(const std::string& cachePath, const std::string& sourcePath, const MeshImportSettings& settings, ModelData& outData);
+    // Writes data to cachePath, keyed on sourcePath's current contents. Written beside and renamed
+    // over the old file, so a reader never sees it half done.
+    bool mesh_cache_write(const std::string& cachePath, const std::string& sourcePath, const MeshImportSettings& settings, const ModelData& data);
+}
\ No newline at end of file
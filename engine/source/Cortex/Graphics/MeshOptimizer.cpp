@@ -0,0 +1,262 @@
+#include "Cortex/Graphics/MeshOptimizer.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace Cortex {
+    #define MESH_UNUSED_VERTEX 0xFFFFFFFFu
+
+    // A FIFO cache kept as the miss count at which each vertex last entered: a vertex is still cached
+    // while fewer than cacheSize misses have happened since.
+    struct MeshCacheSimulator {
+        std::vector<u32> EnteredAt;
+        u32 Misses;
+        u32 Size;
+
+        MeshCacheSimulator(u32 vertexCount, u32 cacheSize) : EnteredAt(vertexCount, 0), Misses(cacheSize + 1), Size(cacheSize) {}
+
+        inline void Reset() {
+            Misses += Size + 1;
+        }
+
+        inline u32 Triangle(const VulkanIndex* triangle) {
+            u32 misses = 0;
+            for (u32 corner = 0; corner < 3; corner++) {
+                VulkanIndex v = triangle[corner];
+                if (Misses - EnteredAt[v] > Size) {
+                    EnteredAt[v] = Misses++;
+                    misses++;
+                }
+            }
+            return misses;
+        }
+    };
+
+    // Triangles using each vertex, as offsets into one list.
+    struct MeshVertexTriangles {
+        std::vector<u32> Offsets;
+        std::vector<u32> Triangles;
+
+        MeshVertexTriangles(const VulkanIndex* indices, u32 indexCount, u32 vertexCount) : Offsets(vertexCount + 1, 0), Triangles(indexCount) {
+            for (u32 i = 0; i < indexCount; i++) {
+                Offsets[indices[i] + 1]++;
+            }
+            std::partial_sum(Offsets.begin(), Offsets.end(), Offsets.begin());
+            std::vector<u32> cursor(Offsets.begin(), Offsets.end() - 1);
+            for (u32 i = 0; i < indexCount; i++) {
+                Triangles[cursor[indices[i]]++] = i / 3;
+            }
+        }
+    };
+
+    MeshCacheStats mesh_analyze_vertex_cache(const VulkanIndex* indices, u32 indexCount, u32 vertexCount, u32 cacheSize) {
+        MeshCacheStats stats;
+        if (indexCount < 3) {
+            return stats;
+        }
+        MeshCacheSimulator cache(vertexCount, cacheSize);
+        std::vector<u8> referenced(vertexCount, 0);
+        u32 misses = 0;
+        u32 unique = 0;
+        for (u32 i = 0; i < indexCount; i += 3) {
+            misses += cache.Triangle(indices + i);
+            for (u32 corner = 0; corner < 3; corner++) {
+                unique += referenced[indices[i + corner]] == 0;
+                referenced[indices[i + corner]] = 1;
+            }
+        }
+        stats.ACMR = static_cast<f32>(misses) / (indexCount / 3);
+        stats.ATVR = static_cast<f32>(misses) / unique;
+        return stats;
+    }
+
+    void mesh_optimize_vertex_cache(VulkanIndex* indices, u32 indexCount, u32 vertexCount, u32 cacheSize) {
+        CORTEX_PROFILE_FUNCTION();
+        u32 triangleCount = indexCount / 3;
+        if (triangleCount == 0) {
+            return;
+        }
+        MeshVertexTriangles adjacency(indices, indexCount, vertexCount);
+        std::vector<u32> live(vertexCount);
+        for (u32 v = 0; v < vertexCount; v++) {
+            live[v] = adjacency.Offsets[v + 1] - adjacency.Offsets[v];
+        }
+        std::vector<u32> cachedAt(vertexCount, 0);
+        std::vector<u8> emitted(triangleCount, 0);
+        std::vector<VulkanIndex> deadEnds;     // vertices recently touched, to resume from when a fan runs dry
+        std::vector<VulkanIndex> candidates;
+        std::vector<VulkanIndex> output;
+        output.reserve(indexCount);
+        u32 time = cacheSize + 1;
+        u32 cursor = 0;
+
+        // With nothing cached worth continuing from: the most recent dead end that still has triangles,
+        // or failing that the next such vertex in index order.
+        auto skipDeadEnd = [&]() -> u32 {
+            while (!deadEnds.empty()) {
+                VulkanIndex v = deadEnds.back();
+                deadEnds.pop_back();
+                if (live[v] > 0) {
+                    return v;
+                }
+            }
+            for (; cursor < vertexCount; cursor++) {
+                if (live[cursor] > 0) {
+                    return cursor;
+                }
+            }
+            return MESH_UNUSED_VERTEX;
+        };
+
+        u32 fan = skipDeadEnd();
+        while (fan != MESH_UNUSED_VERTEX) {
+            // Emit every triangle left around the fanning vertex.
+            candidates.clear();
+            for (u32 i = adjacency.Offsets[fan]; i < adjacency.Offsets[fan + 1]; i++) {
+                u32 triangle = adjacency.Triangles[i];
+                if (emitted[triangle]) {
+                    continue;
+                }
+                emitted[triangle] = 1;
+                for (u32 corner = 0; corner < 3; corner++) {
+                    VulkanIndex v = indices[triangle * 3 + corner];
+                    output.push_back(v);
+                    deadEnds.push_back(v);
+                    candidates.push_back(v);
+                    live[v]--;
+                    if (time - cachedAt[v] > cacheSize) {
+                        cachedAt[v] = time++;
+                    }
+                }
+            }
+
+            // Continue from the candidate that entered the cache longest ago but will still be in it
+            // after its remaining triangles are emitted.
+            u32 next = MESH_UNUSED_VERTEX;
+            i64 best = -1;
+            for (VulkanIndex v : candidates) {
+                if (live[v] == 0) {
+                    continue;
+                }
+                i64 priority = 0;
+                if (time - cachedAt[v] + 2 * live[v] <= cacheSize) {
+                    priority = time - cachedAt[v];
+                }
+                if (priority > best) {
+                    best = priority;
+                    next = v;
+                }
+            }
+            fan = next != MESH_UNUSED_VERTEX ? next : skipDeadEnd();
+        }
+        std::copy(output.begin(), output.end(), indices);
+    }
+
+    void mesh_optimize_overdraw(VulkanIndex* indices, u32 indexCount, const std::vector<VulkanVertex>& vertices, f32 threshold, u32 cacheSize) {
+        CORTEX_PROFILE_FUNCTION();
+        u32 triangleCount = indexCount / 3;
+        u32 vertexCount = static_cast<u32>(vertices.size());
+        if (triangleCount < 2) {
+            return;
+        }
+
+        // Hard boundaries: triangles the cache order reached with nothing cached, where reordering
+        // costs nothing.
+        MeshCacheSimulator cache(vertexCount, cacheSize);
+        std::vector<u32> hard;
+        for (u32 t = 0; t < triangleCount; t++) {
+            if (cache.Triangle(indices + t * 3) == 3 || t == 0) {
+                hard.push_back(t);
+            }
+        }
+        hard.push_back(triangleCount);
+
+        // Soft boundaries: within each, a new cluster starts whenever the one so far, with a cold cache,
+        // has come within threshold of the hard cluster's ACMR.
+        std::vector<u32> clusters;
+        for (u32 h = 0; h + 1 < hard.size(); h++) {
+            u32 start = hard[h];
+            u32 end = hard[h + 1];
+            cache.Reset();
+            u32 misses = 0;
+            for (u32 t = start; t < end; t++) {
+                misses += cache.Triangle(indices + t * 3);
+            }
+            f32 target = threshold * misses / (end - start);
+
+            clusters.push_back(start);
+            cache.Reset();
+            u32 runningMisses = 0;
+            u32 runningTriangles = 0;
+            for (u32 t = start; t + 1 < end; t++) {
+                runningMisses += cache.Triangle(indices + t * 3);
+                runningTriangles++;
+                if (static_cast<f32>(runningMisses) / runningTriangles <= target) {
+                    clusters.push_back(t + 1);
+                    cache.Reset();
+                    runningMisses = 0;
+                    runningTriangles = 0;
+                }
+            }
+        }
+        clusters.push_back(triangleCount);
+
+        // Area weighted centroids and normals, for the mesh and for each cluster.
+        glm::vec3 meshCentroid(0.0f);
+        f32 meshArea = 0.0f;
+        std::vector<glm::vec3> centroids(clusters.size() - 1, glm::vec3(0.0f));
+        std::vector<glm::vec3> normals(clusters.size() - 1, glm::vec3(0.0f));
+        std::vector<f32> areas(clusters.size() - 1, 0.0f);
+        for (u32 c = 0; c + 1 < clusters.size(); c++) {
+            for (u32 t = clusters[c]; t < clusters[c + 1]; t++) {
+                const glm::vec3& a = vertices[indices[t * 3 + 0]].Position;
+                const glm::vec3& b = vertices[indices[t * 3 + 1]].Position;
+                const glm::vec3& d = vertices[indices[t * 3 + 2]].Position;
+                glm::vec3 normal = glm::cross(b - a, d - a);
+                f32 area = glm::length(normal);
+                centroids[c] += area * (a + b + d) / 3.0f;
+                normals[c] += normal;
+                areas[c] += area;
+            }
+            meshCentroid += centroids[c];
+            meshArea += areas[c];
+            if (areas[c] > 0.0f) {
+                centroids[c] /= areas[c];
+            }
+        }
+        if (meshArea > 0.0f) {
+            meshCentroid /= meshArea;
+        }
+
+        std::vector<f32> keys(clusters.size() - 1);
+        for (u32 c = 0; c < keys.size(); c++) {
+            f32 length = glm::length(normals[c]);
+            keys[c] = length > 0.0f ? glm::dot(centroids[c] - meshCentroid, normals[c] / length) : 0.0f;
+        }
+        std::vector<u32> order(keys.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](u32 a, u32 b) { return keys[a] > keys[b]; });
+
+        std::vector<VulkanIndex> output;
+        output.reserve(triangleCount * 3);
+        for (u32 c : order) {
+            output.insert(output.end(), indices + clusters[c] * 3, indices + clusters[c + 1] * 3);
+        }
+        std::copy(output.begin(), output.end(), indices);
+    }
+
+    void mesh_optimize_vertex_fetch(std::vector<VulkanVertex>& vertices, std::vector<VulkanIndex>& indices) {
+        CORTEX_PROFILE_FUNCTION();
+        std::vector<u32> remap(vertices.size(), MESH_UNUSED_VERTEX);
+        std::vector<VulkanVertex> ordered;
+        ordered.reserve(vertices.size());
+        for (VulkanIndex& index : indices) {
+            if (remap[index] == MESH_UNUSED_VERTEX) {
+                remap[index] = static_cast<u32>(ordered.size());
+                ordered.push_back(vertices[index]);
+            }
+            index = remap[index];
+        }
+        vertices = std::move(ordered);
+    }
+}
\ No newline at end of file
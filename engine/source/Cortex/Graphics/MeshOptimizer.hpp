@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Cortex/Graphics/VulkanTypes.hpp"
+#include "Cortex/Graphics/MeshSimplifier.hpp"
+
+namespace Cortex {
+    #define MESH_VERTEX_CACHE_SIZE 16   // FIFO entries the optimizers and statistics assume; real caches are no smaller
+
+    struct MeshImportSettings {
+        MeshLodSettings Lods;
+        bool Optimize = true;           // reorders every level for the vertex cache and overdraw, then vertices for fetch
+        f32 OverdrawThreshold = 1.05f;  // how much worse than the cache order's ACMR the overdraw order may get
+        bool Quantize = true;           // stores vertices in the smallest quantized layout rather than as VulkanVertex
+        bool Cache = true;              // files imported from disk keep the result in a mesh cache beside them
+    };
+
+    // Post-transform cache efficiency of an index list under a FIFO cache of the given size.
+    struct MeshCacheStats {
+        f32 ACMR = 0.0f;    // vertex shader invocations per triangle: 3 without reuse, 0.5 at best on a regular grid
+        f32 ATVR = 0.0f;    // vertex shader invocations per vertex referenced: 1 is ideal
+    };
+
+    MeshCacheStats mesh_analyze_vertex_cache(const VulkanIndex* indices, u32 indexCount, u32 vertexCount, u32 cacheSize = MESH_VERTEX_CACHE_SIZE);
+    // Reorders triangles so each vertex is reused while it is still in the cache: Tipsify (Sander et
+    // al., "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw"), linear in the triangles.
+    void mesh_optimize_vertex_cache(VulkanIndex* indices, u32 indexCount, u32 vertexCount, u32 cacheSize = MESH_VERTEX_CACHE_SIZE);
+    // Expects cache optimized input. Splits it into clusters wherever the cache order starts afresh, or
+    // could without its ACMR growing beyond threshold times its own, then draws the clusters facing
+    // furthest out from the mesh's center first, so they tend to hide the rest.
+    void mesh_optimize_overdraw(VulkanIndex* indices, u32 indexCount, const std::vector<VulkanVertex>& vertices, f32 threshold, u32 cacheSize = MESH_VERTEX_CACHE_SIZE);
+    // Renumbers vertices in the order the indices first use them, so the vertex fetch walks memory
+    // forwards. Vertices no index uses are dropped.
+    void mesh_optimize_vertex_fetch(std::vector<VulkanVertex>& vertices, std::vector<VulkanIndex>& indices);
+}
\ No newline at end of file
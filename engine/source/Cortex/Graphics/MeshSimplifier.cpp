@@ -0,0 +1,422 @@
+#include "Cortex/Graphics/MeshSimplifier.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <unordered_map>
+
+namespace Cortex {
+    #define MESH_BORDER_WEIGHT 10.0         // border planes against face planes, so open edges hold their shape
+    #define MESH_NORMAL_WEIGHT 0.5f
+    #define MESH_TEXCOORD_WEIGHT 1.0f
+    #define MESH_COLOR_WEIGHT 0.5f
+    #define MESH_COLLAPSE_ERROR_SLACK 1.5   // a pass takes collapses up to this much dearer than its goal's
+
+    // Squared distance to a set of planes, each weighted by the area it came from: p'Ap + 2b'p + c.
+    struct MeshQuadric {
+        f64 A00 = 0.0, A01 = 0.0, A02 = 0.0, A11 = 0.0, A12 = 0.0, A22 = 0.0;
+        f64 B0 = 0.0, B1 = 0.0, B2 = 0.0;
+        f64 C = 0.0;
+        f64 Weight = 0.0;
+    };
+
+    static MeshQuadric mesh_quadric_from_plane(const glm::vec3& normal, f32 distance, f64 weight) {
+        MeshQuadric q;
+        f64 a = normal.x, b = normal.y, c = normal.z, d = distance;
+        q.A00 = weight * a * a; q.A01 = weight * a * b; q.A02 = weight * a * c;
+        q.A11 = weight * b * b; q.A12 = weight * b * c; q.A22 = weight * c * c;
+        q.B0 = weight * a * d; q.B1 = weight * b * d; q.B2 = weight * c * d;
+        q.C = weight * d * d;
+        q.Weight = weight;
+        return q;
+    }
+
+    static void mesh_quadric_add(MeshQuadric& q, const MeshQuadric& other) {
+        q.A00 += other.A00; q.A01 += other.A01; q.A02 += other.A02;
+        q.A11 += other.A11; q.A12 += other.A12; q.A22 += other.A22;
+        q.B0 += other.B0; q.B1 += other.B1; q.B2 += other.B2;
+        q.C += other.C;
+        q.Weight += other.Weight;
+    }
+
+    static f64 mesh_quadric_error(const MeshQuadric& q, const glm::vec3& p) {
+        f64 x = p.x, y = p.y, z = p.z;
+        f64 error = q.A00 * x * x + q.A11 * y * y + q.A22 * z * z
+                  + 2.0 * (q.A01 * x * y + q.A02 * x * z + q.A12 * y * z)
+                  + 2.0 * (q.B0 * x + q.B1 * y + q.B2 * z) + q.C;
+        return std::max(error, 0.0);
+    }
+
+    static f32 mesh_attribute_distance(const VulkanVertex& a, const VulkanVertex& b) {
+        glm::vec3 normal = a.Normal - b.Normal;
+        glm::vec2 texCoord = a.TexCoord - b.TexCoord;
+        glm::vec3 color = a.Color - b.Color;
+        return MESH_NORMAL_WEIGHT * glm::dot(normal, normal) + MESH_TEXCOORD_WEIGHT * glm::dot(texCoord, texCoord) + MESH_COLOR_WEIGHT * glm::dot(color, color);
+    }
+
+    static inline u64 mesh_edge_key(u32 a, u32 b) {
+        return a < b ? (static_cast<u64>(a) << 32) | b : (static_cast<u64>(b) << 32) | a;
+    }
+
+    struct MeshPositionHash {
+        size_t operator()(const glm::vec3& p) const {
+            u32 bits[3];
+            memcpy(bits, &p, sizeof(bits));
+            return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+        }
+    };
+
+    struct MeshCollapse {
+        u32 From;
+        u32 To;
+        f64 Cost;       // quadric and attribute error together; what collapses are ordered by
+        f64 Error;      // the geometric part, as a distance in normalised space
+    };
+
+    // Works on positions rather than vertices: vertices at one position (the sides of a UV or normal
+    // seam) collapse together, each onto whichever vertex at the target has the closest attributes.
+    class MeshSimplifier {
+        public:
+            MeshSimplifier(const std::vector<VulkanVertex>& vertices, const std::vector<VulkanIndex>& indices, f32 attributeWeight);
+            void Simplify(u32 targetIndexCount);
+            inline const std::vector<VulkanIndex>& GetIndices() const { return m_Indices; }
+            inline f32 GetError() const { return static_cast<f32>(m_Error * m_Scale); }
+        private:
+            void BuildAdjacency();
+            bool Evaluate(u32 from, u32 to, MeshCollapse& outCollapse) const;
+            bool Flips(u32 from, u32 to) const;
+            bool BreaksManifold(u32 from, u32 to) const;
+            void Apply(const MeshCollapse& collapse);
+            u32 NearestVertex(u32 vertex, u32 position) const;
+
+            const std::vector<VulkanVertex>& m_Vertices;
+            f32 m_AttributeWeight;
+            f32 m_Scale;                                    // normalised positions times this are model space
+            std::vector<glm::vec3> m_Positions;             // normalised to a unit box
+            std::vector<u32> m_VertexPosition;
+            std::vector<std::vector<u32>> m_PositionVertices;
+            std::vector<MeshQuadric> m_Quadrics;
+            std::vector<u8> m_Locked;                       // on a non-manifold edge; never moves
+            std::vector<VulkanIndex> m_VertexRemap;
+            std::vector<VulkanIndex> m_Indices;
+            f64 m_Error;
+
+            // Rebuilt every pass: the triangles around each position, as offsets into one list, and the
+            // edges only one triangle uses.
+            std::vector<u32> m_AdjacencyOffsets;
+            std::vector<u32> m_Adjacency;
+            std::vector<u8> m_Border;
+            std::vector<u64> m_BorderEdges;                 // sorted
+    };
+
+    MeshSimplifier::MeshSimplifier(const std::vector<VulkanVertex>& vertices, const std::vector<VulkanIndex>& indices, f32 attributeWeight)
+        : m_Vertices(vertices), m_AttributeWeight(attributeWeight), m_Indices(indices), m_Error(0.0) {
+        // Collapse costs compare squared distances, so the mesh is scaled to a unit box to keep them in
+        // a range where f64 quadrics stay exact enough whatever units the model was authored in.
+        glm::vec3 min(0.0f), max(0.0f);
+        if (!vertices.empty()) {
+            min = max = vertices[0].Position;
+        }
+        for (const auto& vertex : vertices) {
+            min = glm::min(min, vertex.Position);
+            max = glm::max(max, vertex.Position);
+        }
+        glm::vec3 extent = max - min;
+        m_Scale = std::max(extent.x, std::max(extent.y, extent.z));
+        if (m_Scale <= 0.0f) {
+            m_Scale = 1.0f;
+        }
+
+        std::unordered_map<glm::vec3, u32, MeshPositionHash> positionIndices;
+        m_VertexPosition.resize(vertices.size());
+        for (u32 i = 0; i < vertices.size(); i++) {
+            glm::vec3 position = vertices[i].Position + glm::vec3(0.0f);   // folds -0 into +0 for hashing
+            auto [it, inserted] = positionIndices.try_emplace(position, static_cast<u32>(m_Positions.size()));
+            if (inserted) {
+                m_Positions.push_back((position - min) / m_Scale);
+                m_PositionVertices.emplace_back();
+            }
+            m_VertexPosition[i] = it->second;
+            m_PositionVertices[it->second].push_back(i);
+        }
+        m_VertexRemap.resize(vertices.size());
+        for (u32 i = 0; i < vertices.size(); i++) {
+            m_VertexRemap[i] = i;
+        }
+
+        // Every triangle's plane goes to its corners. Edges used once are borders, and get a plane
+        // through them at right angles to the face, so collapses cannot drag them inwards.
+        std::unordered_map<u64, u32> edgeUses;
+        for (size_t i = 0; i + 2 < m_Indices.size(); i += 3) {
+            for (u32 corner = 0; corner < 3; corner++) {
+                edgeUses[mesh_edge_key(m_VertexPosition[m_Indices[i + corner]], m_VertexPosition[m_Indices[i + (corner + 1) % 3]])]++;
+            }
+        }
+        m_Quadrics.resize(m_Positions.size());
+        m_Locked.assign(m_Positions.size(), 0);
+        for (size_t i = 0; i + 2 < m_Indices.size(); i += 3) {
+            u32 p[3] = {m_VertexPosition[m_Indices[i]], m_VertexPosition[m_Indices[i + 1]], m_VertexPosition[m_Indices[i + 2]]};
+            glm::vec3 normal = glm::cross(m_Positions[p[1]] - m_Positions[p[0]], m_Positions[p[2]] - m_Positions[p[0]]);
+            f32 length = glm::length(normal);
+            if (length <= 0.0f) {
+                continue;
+            }
+            normal /= length;
+            MeshQuadric face = mesh_quadric_from_plane(normal, -glm::dot(normal, m_Positions[p[0]]), 0.5 * length);
+            for (u32 corner = 0; corner < 3; corner++) {
+                mesh_quadric_add(m_Quadrics[p[corner]], face);
+
+                u32 a = p[corner], b = p[(corner + 1) % 3];
+                if (edgeUses[mesh_edge_key(a, b)] == 1) {
+                    glm::vec3 edge = m_Positions[b] - m_Positions[a];
+                    glm::vec3 side = glm::cross(edge, normal);
+                    f32 sideLength = glm::length(side);
+                    if (sideLength > 0.0f) {
+                        side /= sideLength;
+                        MeshQuadric border = mesh_quadric_from_plane(side, -glm::dot(side, m_Positions[a]), MESH_BORDER_WEIGHT * glm::dot(edge, edge));
+                        mesh_quadric_add(m_Quadrics[a], border);
+                        mesh_quadric_add(m_Quadrics[b], border);
+                    }
+                }
+            }
+        }
+    }
+
+    void MeshSimplifier::BuildAdjacency() {
+        m_AdjacencyOffsets.assign(m_Positions.size() + 1, 0);
+        for (VulkanIndex index : m_Indices) {
+            m_AdjacencyOffsets[m_VertexPosition[index] + 1]++;
+        }
+        for (size_t i = 1; i < m_AdjacencyOffsets.size(); i++) {
+            m_AdjacencyOffsets[i] += m_AdjacencyOffsets[i - 1];
+        }
+        m_Adjacency.resize(m_Indices.size());
+        std::vector<u32> cursor(m_AdjacencyOffsets.begin(), m_AdjacencyOffsets.end() - 1);
+        for (u32 i = 0; i < m_Indices.size(); i++) {
+            m_Adjacency[cursor[m_VertexPosition[m_Indices[i]]]++] = i / 3;
+        }
+    }
+
+    u32 MeshSimplifier::NearestVertex(u32 vertex, u32 position) const {
+        u32 nearest = m_PositionVertices[position][0];
+        f32 nearestDistance = mesh_attribute_distance(m_Vertices[vertex], m_Vertices[nearest]);
+        for (u32 candidate : m_PositionVertices[position]) {
+            f32 distance = mesh_attribute_distance(m_Vertices[vertex], m_Vertices[candidate]);
+            if (distance < nearestDistance) {
+                nearest = candidate;
+                nearestDistance = distance;
+            }
+        }
+        return nearest;
+    }
+
+    bool MeshSimplifier::Evaluate(u32 from, u32 to, MeshCollapse& outCollapse) const {
+        // A border position may only slide along its border; anything else would open a hole.
+        if (m_Locked[from] || (m_Border[from] && !std::binary_search(m_BorderEdges.begin(), m_BorderEdges.end(), mesh_edge_key(from, to)))) {
+            return false;
+        }
+        MeshQuadric quadric = m_Quadrics[from];
+        mesh_quadric_add(quadric, m_Quadrics[to]);
+        f64 error = mesh_quadric_error(quadric, m_Positions[to]);
+
+        // The attribute change each vertex at from suffers, weighted like the planes by surface area.
+        f32 attributes = 0.0f;
+        for (u32 vertex : m_PositionVertices[from]) {
+            attributes = std::max(attributes, mesh_attribute_distance(m_Vertices[vertex], m_Vertices[NearestVertex(vertex, to)]));
+        }
+        outCollapse.From = from;
+        outCollapse.To = to;
+        outCollapse.Cost = error + static_cast<f64>(m_AttributeWeight) * attributes * m_Quadrics[from].Weight;
+        outCollapse.Error = quadric.Weight > 0.0 ? glm::sqrt(error / quadric.Weight) : 0.0;
+        return true;
+    }
+
+    bool MeshSimplifier::Flips(u32 from, u32 to) const {
+        for (u32 i = m_AdjacencyOffsets[from]; i < m_AdjacencyOffsets[from + 1]; i++) {
+            u32 triangle = m_Adjacency[i];
+            u32 p[3] = {m_VertexPosition[m_Indices[triangle * 3]], m_VertexPosition[m_Indices[triangle * 3 + 1]], m_VertexPosition[m_Indices[triangle * 3 + 2]]};
+            if (p[0] == to || p[1] == to || p[2] == to) {
+                continue;   // collapses away
+            }
+            glm::vec3 before = glm::cross(m_Positions[p[1]] - m_Positions[p[0]], m_Positions[p[2]] - m_Positions[p[0]]);
+            for (u32& corner : p) {
+                corner = corner == from ? to : corner;
+            }
+            glm::vec3 after = glm::cross(m_Positions[p[1]] - m_Positions[p[0]], m_Positions[p[2]] - m_Positions[p[0]]);
+            if (glm::dot(before, after) <= 1e-2f * glm::length(before) * glm::length(after)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool MeshSimplifier::BreaksManifold(u32 from, u32 to) const {
+        // The link condition: the ends of an edge may share no neighbours other than the corners
+        // opposite it, or the collapse pinches the surface into a fin.
+        std::vector<u32> fromNeighbours, toNeighbours;
+        u32 shared = 0;
+        for (u32 i = m_AdjacencyOffsets[from]; i < m_AdjacencyOffsets[from + 1]; i++) {
+            u32 triangle = m_Adjacency[i];
+            bool touchesTo = false;
+            for (u32 corner = 0; corner < 3; corner++) {
+                u32 p = m_VertexPosition[m_Indices[triangle * 3 + corner]];
+                touchesTo |= p == to;
+                if (p != from && p != to) {
+                    fromNeighbours.push_back(p);
+                }
+            }
+            shared += touchesTo;
+        }
+        for (u32 i = m_AdjacencyOffsets[to]; i < m_AdjacencyOffsets[to + 1]; i++) {
+            u32 triangle = m_Adjacency[i];
+            for (u32 corner = 0; corner < 3; corner++) {
+                u32 p = m_VertexPosition[m_Indices[triangle * 3 + corner]];
+                if (p != from && p != to) {
+                    toNeighbours.push_back(p);
+                }
+            }
+        }
+        std::sort(fromNeighbours.begin(), fromNeighbours.end());
+        fromNeighbours.erase(std::unique(fromNeighbours.begin(), fromNeighbours.end()), fromNeighbours.end());
+        std::sort(toNeighbours.begin(), toNeighbours.end());
+        toNeighbours.erase(std::unique(toNeighbours.begin(), toNeighbours.end()), toNeighbours.end());
+        std::vector<u32> common;
+        std::set_intersection(fromNeighbours.begin(), fromNeighbours.end(), toNeighbours.begin(), toNeighbours.end(), std::back_inserter(common));
+        return common.size() > shared;
+    }
+
+    void MeshSimplifier::Apply(const MeshCollapse& collapse) {
+        for (u32 vertex : m_PositionVertices[collapse.From]) {
+            m_VertexRemap[vertex] = NearestVertex(vertex, collapse.To);
+        }
+        mesh_quadric_add(m_Quadrics[collapse.To], m_Quadrics[collapse.From]);
+        m_Error = std::max(m_Error, collapse.Error);
+    }
+
+    void MeshSimplifier::Simplify(u32 targetIndexCount) {
+        CORTEX_PROFILE_FUNCTION();
+        // In passes: cost every edge, then take the cheapest collapses that do not touch one another,
+        // so each is judged against the neighbourhood it was costed in.
+        while (m_Indices.size() > targetIndexCount) {
+            BuildAdjacency();
+            std::vector<u64> edges;
+            edges.reserve(m_Indices.size());
+            for (size_t i = 0; i + 2 < m_Indices.size(); i += 3) {
+                for (u32 corner = 0; corner < 3; corner++) {
+                    edges.push_back(mesh_edge_key(m_VertexPosition[m_Indices[i + corner]], m_VertexPosition[m_Indices[i + (corner + 1) % 3]]));
+                }
+            }
+            std::sort(edges.begin(), edges.end());
+
+            // Collapses change which edges are borders, so they are found afresh from the use counts.
+            // Edges used more than twice lock their ends; nothing sensible can be said about moving them.
+            m_Border.assign(m_Positions.size(), 0);
+            m_BorderEdges.clear();
+            for (size_t first = 0, last = 0; first < edges.size(); first = last) {
+                while (last < edges.size() && edges[last] == edges[first]) {
+                    last++;
+                }
+                u32 a = static_cast<u32>(edges[first] >> 32), b = static_cast<u32>(edges[first]);
+                if (last - first == 1) {
+                    m_Border[a] = m_Border[b] = 1;
+                    m_BorderEdges.push_back(edges[first]);
+                } else if (last - first > 2) {
+                    m_Locked[a] = m_Locked[b] = 1;
+                }
+            }
+            edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+            std::vector<MeshCollapse> collapses;
+            collapses.reserve(edges.size());
+            for (u64 edge : edges) {
+                u32 a = static_cast<u32>(edge >> 32), b = static_cast<u32>(edge);
+                MeshCollapse forward, backward;
+                bool canForward = Evaluate(a, b, forward);
+                bool canBackward = Evaluate(b, a, backward);
+                if (canForward || canBackward) {
+                    collapses.push_back(!canBackward || (canForward && forward.Cost <= backward.Cost) ? forward : backward);
+                }
+            }
+            if (collapses.empty()) {
+                break;
+            }
+            std::sort(collapses.begin(), collapses.end(), [](const MeshCollapse& a, const MeshCollapse& b) { return a.Cost < b.Cost; });
+
+            // Most collapses remove two triangles. Aiming for half the remaining work per pass, and
+            // nothing much dearer than the collapse at that point, keeps the order close to greedy.
+            u32 trianglesToRemove = static_cast<u32>((m_Indices.size() - targetIndexCount) / 3);
+            size_t goal = std::max<size_t>(1, trianglesToRemove / 2);
+            f64 costLimit = goal < collapses.size() ? collapses[goal].Cost * MESH_COLLAPSE_ERROR_SLACK : collapses.back().Cost;
+            std::vector<u8> touched(m_Positions.size(), 0);
+            u32 removed = 0;
+            u32 applied = 0;
+            for (const MeshCollapse& collapse : collapses) {
+                if (removed >= trianglesToRemove || collapse.Cost > costLimit) {
+                    break;
+                }
+                if (touched[collapse.From] || touched[collapse.To] || Flips(collapse.From, collapse.To) || BreaksManifold(collapse.From, collapse.To)) {
+                    continue;
+                }
+                Apply(collapse);
+                applied++;
+                // Everything around from changes shape, so none of it may move again this pass.
+                for (u32 i = m_AdjacencyOffsets[collapse.From]; i < m_AdjacencyOffsets[collapse.From + 1]; i++) {
+                    u32 triangle = m_Adjacency[i];
+                    u32 corners = 0;
+                    for (u32 corner = 0; corner < 3; corner++) {
+                        u32 p = m_VertexPosition[m_Indices[triangle * 3 + corner]];
+                        touched[p] = 1;
+                        corners += p == collapse.To;
+                    }
+                    removed += corners;
+                }
+            }
+            if (applied == 0) {
+                break;
+            }
+
+            // Vertices were only remapped onto positions nothing else moved this pass, so one lookup
+            // resolves every corner. Triangles left with two corners at one position are gone.
+            size_t write = 0;
+            for (size_t i = 0; i + 2 < m_Indices.size(); i += 3) {
+                VulkanIndex a = m_VertexRemap[m_Indices[i]], b = m_VertexRemap[m_Indices[i + 1]], c = m_VertexRemap[m_Indices[i + 2]];
+                u32 pa = m_VertexPosition[a], pb = m_VertexPosition[b], pc = m_VertexPosition[c];
+                if (pa == pb || pb == pc || pc == pa) {
+                    continue;
+                }
+                m_Indices[write++] = a;
+                m_Indices[write++] = b;
+                m_Indices[write++] = c;
+            }
+            m_Indices.resize(write);
+        }
+    }
+
+    void mesh_build_lods(const std::vector<VulkanVertex>& vertices, std::vector<VulkanIndex>& indices, std::vector<MeshLod>& outLods, const MeshLodSettings& settings) {
+        CORTEX_PROFILE_FUNCTION();
+        outLods.assign(1, {0, static_cast<u32>(indices.size()), 0.0f});
+        u32 levels = std::min<u32>(settings.MaxLevels, MESH_MAX_LODS);
+        if (levels <= 1 || indices.size() / 3 < settings.MinTriangles) {
+            return;
+        }
+
+        // One simplifier runs down the whole chain, so each level builds on the last and its error
+        // covers every collapse since full detail.
+        MeshSimplifier simplifier(vertices, indices, settings.AttributeWeight);
+        for (u32 level = 1; level < levels; level++) {
+            u32 previous = outLods.back().IndexCount;
+            u32 target = static_cast<u32>(previous / 3 * settings.Reduction) * 3;
+            if (target / 3 < settings.MinTriangles) {
+                break;
+            }
+            simplifier.Simplify(target);
+            const std::vector<VulkanIndex>& simplified = simplifier.GetIndices();
+            // Stuck on borders, seams or flips well short of the target: not worth another level.
+            if (simplified.empty() || simplified.size() > previous - (previous - target) / 2) {
+                break;
+            }
+            outLods.push_back({static_cast<u32>(indices.size()), static_cast<u32>(simplified.size()), simplifier.GetError()});
+            indices.insert(indices.end(), simplified.begin(), simplified.end());
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Cortex/Graphics/VulkanTypes.hpp"
+
+namespace Cortex {
+    #define MESH_MAX_LODS 8
+
+    struct MeshLodSettings {
+        u32 MaxLevels = 4;              // including full detail; 1 generates nothing
+        f32 Reduction = 0.5f;           // each level aims for this fraction of the previous one's triangles
+        u32 MinTriangles = 64;          // no level is generated below this
+        f32 AttributeWeight = 1.0f;     // how strongly normal, texture coordinate and colour seams resist collapse
+    };
+
+    // A range of a model's index buffer. Every level indexes the same vertices.
+    struct MeshLod {
+        u32 FirstIndex = 0;
+        u32 IndexCount = 0;
+        f32 Error = 0.0f;   // model space distance the level may stray from full detail
+    };
+
+    // Quadric error edge collapse. Vertices are only ever collapsed onto one another, never moved, so
+    // the levels are index lists over the original vertices: each one is appended to indices, and
+    // outLods gets the full detail range followed by one range per level that was worth keeping.
+    void mesh_build_lods(const std::vector<VulkanVertex>& vertices, std::vector<VulkanIndex>& indices, std::vector<MeshLod>& outLods, const MeshLodSettings& settings = {});
+}
\ No newline at end of file
@@ -1,27 +1,117 @@
 #include "Cortex/Graphics/Model.hpp"
 
 namespace Cortex {
-    Model::Model(std::shared_ptr<GraphicsDevice> device, const std::vector<VulkanVertex>& vertices, const std::vector<VulkanIndex>& indices) {
+    ModelData model_encode(const std::vector<VulkanVertex>& vertices, const std::vector<VulkanIndex>& indices, const std::vector<MeshLod>& lods, VertexLayout layout, ModelStorage& storage) {
+        CORTEX_PROFILE_FUNCTION();
+        ModelData data;
+        data.Layout = layout;
+        data.VertexCount = static_cast<u32>(vertices.size());
+        data.IndexCount = static_cast<u32>(indices.size());
+        storage.Vertices = vertex_encode(layout, vertices, data.VertexToModel);
+        data.Vertices = storage.Vertices.data();
+
+        data.IndexType = vertices.size() <= 0xFFFF ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+        if (data.IndexType == VK_INDEX_TYPE_UINT16) {
+            storage.Indices.resize(indices.size() * sizeof(u16));
+            u16* narrowed = reinterpret_cast<u16*>(storage.Indices.data());
+            for (size_t i = 0; i < indices.size(); i++) {
+                narrowed[i] = static_cast<u16>(indices[i]);
+            }
+        } else {
+            storage.Indices.resize(indices.size() * sizeof(u32));
+            memcpy(storage.Indices.data(), indices.data(), storage.Indices.size());
+        }
+        data.Indices = storage.Indices.data();
+
+        storage.Lods = lods;
+        data.Lods = storage.Lods.data();
+        data.LodCount = static_cast<u32>(storage.Lods.size());
+
+        // Centered on the bounding box rather than the tightest fit; close enough for culling.
+        glm::vec3 min(0.0f);
+        glm::vec3 max(0.0f);
+        if (!vertices.empty()) {
+            min = max = vertices[0].Position;
+        }
+        for (const auto& vertex : vertices) {
+            min = glm::min(min, vertex.Position);
+            max = glm::max(max, vertex.Position);
+        }
+        glm::vec3 center = 0.5f * (min + max);
+        f32 radius = 0.0f;
+        for (const auto& vertex : vertices) {
+            radius = std::max(radius, glm::length(vertex.Position - center));
+        }
+        data.BoundingSphere = glm::vec4(center, radius);
+        return data;
+    }
+
+    Model::Model(std::shared_ptr<GraphicsDevice> device, const std::vector<VulkanVertex>& vertices, const std::vector<VulkanIndex>& indices, const std::vector<MeshLod>& lods, VertexLayout layout) {
+        m_GraphicsDevice = device;
+        ModelStorage storage;
+        Upload(model_encode(vertices, indices, lods, layout, storage));
+    }
+
+    Model::Model(std::shared_ptr<GraphicsDevice> device, const ModelData& data) {
         m_GraphicsDevice = device;
-        m_VertexBuffer = vulkan_create_vertex_buffer(m_GraphicsDevice, vertices);
-        m_IndexBuffer = vulkan_create_index_buffer(m_GraphicsDevice, indices);
+        Upload(data);
+    }
 
-        LOG_INFO("Vertices: %i. Indices: %i.", m_VertexBuffer.VertexCount, m_IndexBuffer.IndexCount);
+    void Model::Upload(const ModelData& data) {
+        ASSERT(data.LodCount <= MESH_MAX_LODS, "Model has more levels of detail than MESH_MAX_LODS.");
+        m_VertexLayout = data.Layout;
+        m_VertexToModel = data.VertexToModel;
+        m_BoundingSphere = data.BoundingSphere;
+        m_VertexBuffer = vulkan_create_vertex_buffer(m_GraphicsDevice, data.Vertices, data.VertexCount, vertex_layout_stride(data.Layout));
+        m_IndexBuffer = vulkan_create_index_buffer(m_GraphicsDevice, data.Indices, data.IndexCount, data.IndexType);
+        m_Lods.assign(data.Lods, data.Lods + data.LodCount);
+        if (m_Lods.empty()) {
+            m_Lods.push_back({0, data.IndexCount, 0.0f});
+        }
+
+        LOG_INFO("Vertices: %i (%s, %u bytes each). Indices: %i (%s). Levels of detail: %zu.", m_VertexBuffer.VertexCount, vertex_layout_name(m_VertexLayout), vertex_layout_stride(m_VertexLayout),
+            m_IndexBuffer.IndexCount, m_IndexBuffer.IndexType == VK_INDEX_TYPE_UINT16 ? "16-bit" : "32-bit", m_Lods.size());
     }
 
     Model::~Model() {
-        vulkan_destroy_vertex_buffer(m_GraphicsDevice, m_VertexBuffer);
-        vulkan_destroy_index_buffer(m_GraphicsDevice, m_IndexBuffer);
+        VkDevice device = m_GraphicsDevice->Device;
+        VulkanVertexBuffer vertexBuffer = m_VertexBuffer;
+        VulkanIndexBuffer indexBuffer = m_IndexBuffer;
+        m_GraphicsDevice->PendingDeletions.Push([=]() {
+            vkDestroyBuffer(device, vertexBuffer.VertexBuffer, nullptr);
+            vkFreeMemory(device, vertexBuffer.VertexBufferMemory, nullptr);
+            vkDestroyBuffer(device, indexBuffer.IndexBuffer, nullptr);
+            vkFreeMemory(device, indexBuffer.IndexBufferMemory, nullptr);
+        });
+    }
+
+    glm::vec4 Model::GetBoundingSphere(const glm::mat4& modelToWorld) const {
+        glm::vec3 center = glm::vec3(modelToWorld * glm::vec4(glm::vec3(m_BoundingSphere), 1.0f));
+        f32 scale = std::max(glm::length(glm::vec3(modelToWorld[0])), std::max(glm::length(glm::vec3(modelToWorld[1])), glm::length(glm::vec3(modelToWorld[2]))));
+        return glm::vec4(center, m_BoundingSphere.w * scale);
     }
 
     void Model::Bind(VkCommandBuffer commandBuffer) {
         VkBuffer buffers[] = { m_VertexBuffer.VertexBuffer };
         VkDeviceSize offsets[] = { 0 };
         vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
-        vkCmdBindIndexBuffer(commandBuffer, m_IndexBuffer.IndexBuffer, 0, VK_INDEX_TYPE_UINT32);
+        vkCmdBindIndexBuffer(commandBuffer, m_IndexBuffer.IndexBuffer, 0, m_IndexBuffer.IndexType);
+    }
+
+    void Model::Draw(VkCommandBuffer commandBuffer, u32 lod) {
+        lod = std::min(lod, GetLodCount() - 1);
+        const MeshLod& range = m_Lods[lod];
+        vkCmdDrawIndexed(commandBuffer, range.IndexCount, 1, range.FirstIndex, 0, 0);
+        m_GraphicsDevice->Counters.DrawCalls++;
+        m_GraphicsDevice->Counters.Instances++;
+        m_GraphicsDevice->Counters.Triangles += range.IndexCount / 3;
+        m_GraphicsDevice->Counters.LodInstances[lod]++;
+        m_GraphicsDevice->Counters.LodTriangles[lod] += range.IndexCount / 3;
     }
 
-    void Model::Draw(VkCommandBuffer commandBuffer) {
-        vkCmdDrawIndexed(commandBuffer, m_IndexBuffer.IndexCount, 1, 0, 0, 0);
+    void Model::DrawIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset) {
+        vkCmdDrawIndexedIndirect(commandBuffer, buffer, offset, 1, sizeof(VkDrawIndexedIndirectCommand));
+        // Whether the GPU drew it is only known on the GPU; pipeline statistics count the triangles.
+        m_GraphicsDevice->Counters.DrawCalls++;
     }
 }
\ No newline at end of file
@@ -3,21 +3,70 @@
 #include "Cortex/Graphics/VulkanHelpers.hpp"
 #include "Cortex/Graphics/VulkanTypes.hpp"
 #include "Cortex/Graphics/VulkanBuffers.hpp"
+#include "Cortex/Graphics/MeshSimplifier.hpp"
+#include "Cortex/Graphics/VertexLayout.hpp"
 
 #include "Cortex/Graphics/GraphicsDevice.hpp"
 
 namespace Cortex {
+    // A mesh exactly as the GPU takes it, vertices already in their layout and indices at their width.
+    // Points at memory it does not own: what model_encode filled, or a mapped mesh cache.
+    struct ModelData {
+        VertexLayout Layout = VertexLayout::Full;
+        VkIndexType IndexType = VK_INDEX_TYPE_UINT32;
+        u32 VertexCount = 0;
+        u32 IndexCount = 0;
+        const void* Vertices = nullptr;
+        const void* Indices = nullptr;
+        glm::mat4 VertexToModel = glm::mat4(1.0f);
+        glm::vec4 BoundingSphere = glm::vec4(0.0f);
+        const MeshLod* Lods = nullptr;
+        u32 LodCount = 0;
+    };
+
+    struct ModelStorage {
+        std::vector<u8> Vertices;
+        std::vector<u8> Indices;
+        std::vector<MeshLod> Lods;
+    };
+
+    // Encodes vertices in the given layout and indices in 16 bits whenever there are few enough
+    // vertices. The result points into storage.
+    ModelData model_encode(const std::vector<VulkanVertex>& vertices, const std::vector<VulkanIndex>& indices, const std::vector<MeshLod>& lods, VertexLayout layout, ModelStorage& storage);
+
     class Model {
         public:
-            Model(std::shared_ptr<GraphicsDevice> device, const std::vector<VulkanVertex>& vertices, const std::vector<VulkanIndex>& indices);
+            // lods are ranges of indices, finest first; empty draws all of them as the only level.
+            Model(std::shared_ptr<GraphicsDevice> device, const std::vector<VulkanVertex>& vertices, const std::vector<VulkanIndex>& indices, const std::vector<MeshLod>& lods = {}, VertexLayout layout = VertexLayout::Full);
+            // Uploads data as it is, with no conversion.
+            Model(std::shared_ptr<GraphicsDevice> device, const ModelData& data);
             ~Model();
             Model(const Model&) = delete;
             Model &operator=(const Model&) = delete;
             void Bind(VkCommandBuffer commandBuffer);
-            void Draw(VkCommandBuffer commandBuffer);
+            void Draw(VkCommandBuffer commandBuffer, u32 lod = 0);
+            // Draws with the parameters a VkDrawIndexedIndirectCommand in buffer holds at offset.
+            void DrawIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset);
+            inline VertexLayout GetVertexLayout() const { return m_VertexLayout; }
+            // Takes the vertex buffer's positions to model space; draws push ModelToWorld times this.
+            inline const glm::mat4& GetVertexToModel() const { return m_VertexToModel; }
+            inline VkDeviceSize GetVertexBufferSize() const { return static_cast<VkDeviceSize>(m_VertexBuffer.VertexCount) * vertex_layout_stride(m_VertexLayout); }
+            inline VkDeviceSize GetIndexBufferSize() const { return static_cast<VkDeviceSize>(m_IndexBuffer.IndexCount) * (m_IndexBuffer.IndexType == VK_INDEX_TYPE_UINT16 ? 2 : 4); }
+            inline u32 GetLodCount() const { return static_cast<u32>(m_Lods.size()); }
+            inline const MeshLod& GetLod(u32 lod) const { return m_Lods[lod]; }
+            // Sphere around every vertex in model space: center in xyz, radius in w.
+            inline const glm::vec4& GetBoundingSphere() const { return m_BoundingSphere; }
+            // The same sphere in world space; the radius grows with the largest axis scale.
+            glm::vec4 GetBoundingSphere(const glm::mat4& modelToWorld) const;
         private:
+            void Upload(const ModelData& data);
+
             std::shared_ptr<GraphicsDevice> m_GraphicsDevice;
             VulkanVertexBuffer m_VertexBuffer;
             VulkanIndexBuffer m_IndexBuffer;
+            std::vector<MeshLod> m_Lods;
+            VertexLayout m_VertexLayout;
+            glm::mat4 m_VertexToModel;
+            glm::vec4 m_BoundingSphere;
     };
 }
\ No newline at end of file
@@ -0,0 +1,620 @@
+#include "Cortex/Graphics/ObjParser.hpp"
+
+#include "Cortex/Base/MappedFile.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+namespace Cortex {
+    #define OBJ_RELATIVE_POSITION 1
+    #define OBJ_RELATIVE_TEXCOORD 2
+    #define OBJ_RELATIVE_NORMAL 4
+
+    static inline bool obj_is_space(char c) {
+        return c == ' ' || c == '\t';
+    }
+
+    static inline bool obj_is_digit(char c) {
+        return static_cast<u32>(c - '0') < 10;
+    }
+
+    static inline const char* obj_skip_space(const char* p, const char* end) {
+        while (p < end && obj_is_space(*p)) {
+            p++;
+        }
+        return p;
+    }
+
+    // Lines never hold '\r' or '\n', so this is tinyobj's strcspn(" \t\r").
+    static inline const char* obj_token_end(const char* p, const char* end) {
+        while (p < end && !obj_is_space(*p)) {
+            p++;
+        }
+        return p;
+    }
+
+    // strcspn("/ \t\r"), the end of one index within a face corner.
+    static inline const char* obj_index_end(const char* p, const char* end) {
+        while (p < end && *p != '/' && !obj_is_space(*p)) {
+            p++;
+        }
+        return p;
+    }
+
+    // Digits at the start of eight loaded bytes: a byte is a digit when xor '0' leaves it below 10,
+    // which adding 0x76 turns into a clear top bit. Carries only leave bytes that are already flagged.
+    static inline u32 obj_digit_run(u64 word) {
+        u64 x = word ^ 0x3030303030303030ull;
+        u64 flagged = ((x + 0x7676767676767676ull) | x) & 0x8080808080808080ull;
+        return flagged ? static_cast<u32>(__builtin_ctzll(flagged)) / 8 : 8;
+    }
+
+    // The value of the first count (1 to 8) digits in word, two digits, then four, then eight at a time.
+    static inline u64 obj_digits_value(u64 word, u32 count) {
+        word -= 0x3030303030303030ull;
+        word <<= (8 - count) * 8;
+        word = word * 10 + (word >> 8);
+        word = (((word & 0x000000FF000000FFull) * (100 + (1000000ull << 32))) + (((word >> 16) & 0x000000FF000000FFull) * (1 + (10000ull << 32)))) >> 32;
+        return word;
+    }
+
+    static const u64 s_ObjPowersOfTen[] = {1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull};
+
+    // Consumes the digits at p, up to eight per load while eight bytes remain readable, adding them
+    // onto value. Values past 19 digits wrap; callers only trust shorter runs.
+    static inline u32 obj_scan_digits(const char*& p, const char* end, const char* readEnd, u64& value) {
+        u32 count = 0;
+        while (readEnd - p >= 8) {
+            u64 word;
+            memcpy(&word, p, sizeof(word));
+            u32 run = std::min(obj_digit_run(word), static_cast<u32>(end - p));
+            if (run > 0) {
+                value = value * s_ObjPowersOfTen[run] + obj_digits_value(word, run);
+                p += run;
+                count += run;
+            }
+            if (run < 8) {
+                return count;
+            }
+        }
+        while (p < end && obj_is_digit(*p)) {
+            value = value * 10 + static_cast<u64>(*p - '0');
+            p++;
+            count++;
+        }
+        return count;
+    }
+
+    // atoi, which is what tinyobj reads indices with.
+    static inline int obj_parse_int(const char* p, const char* end, const char* readEnd) {
+        while (p < end && (obj_is_space(*p) || *p == '\v' || *p == '\f')) {
+            p++;
+        }
+        bool negative = false;
+        if (p < end && (*p == '+' || *p == '-')) {
+            negative = *p == '-';
+            p++;
+        }
+        u64 value = 0;
+        obj_scan_digits(p, end, readEnd, value);
+        return negative ? -static_cast<int>(value) : static_cast<int>(value);
+    }
+
+    static const f64 s_ObjFractionLut[] = {1.0, 0.1, 0.01, 0.001, 0.0001, 0.00001, 0.000001, 0.0000001};
+
+    // tinyobj's tryParseDouble, operation for operation, for what the fast path leaves to it.
+    static bool obj_parse_double_reference(const char* s, const char* sEnd, f64& out) {
+        if (s >= sEnd) {
+            return false;
+        }
+        f64 mantissa = 0.0;
+        int exponent = 0;
+        char sign = '+';
+        char exponentSign = '+';
+        const char* c = s;
+        int read = 0;
+        bool leadingDot = false;
+
+        if (*c == '+' || *c == '-') {
+            sign = *c;
+            c++;
+            if (c != sEnd && *c == '.') {
+                leadingDot = true;
+            }
+        } else if (obj_is_digit(*c)) {
+        } else if (*c == '.') {
+            leadingDot = true;
+        } else {
+            return false;
+        }
+
+        if (!leadingDot) {
+            while (c != sEnd && obj_is_digit(*c)) {
+                mantissa *= 10;
+                mantissa += static_cast<int>(*c - 0x30);
+                c++;
+                read++;
+            }
+            if (read == 0) {
+                return false;
+            }
+        }
+
+        if (c != sEnd) {
+            bool exponentNext = false;
+            if (*c == '.') {
+                c++;
+                read = 1;
+                while (c != sEnd && obj_is_digit(*c)) {
+                    mantissa += static_cast<int>(*c - 0x30) * (read < 8 ? s_ObjFractionLut[read] : std::pow(10.0, -read));
+                    read++;
+                    c++;
+                }
+                exponentNext = c != sEnd && (*c == 'e' || *c == 'E');
+            } else {
+                exponentNext = *c == 'e' || *c == 'E';
+            }
+
+            if (exponentNext) {
+                c++;
+                if (c != sEnd && (*c == '+' || *c == '-')) {
+                    exponentSign = *c;
+                    c++;
+                } else if (c == sEnd || !obj_is_digit(*c)) {
+                    return false;
+                }
+                read = 0;
+                while (c != sEnd && obj_is_digit(*c)) {
+                    if (exponent > 2147483647 / 10) {
+                        return false;
+                    }
+                    exponent *= 10;
+                    exponent += static_cast<int>(*c - 0x30);
+                    c++;
+                    read++;
+                }
+                exponent *= exponentSign == '+' ? 1 : -1;
+                if (read == 0) {
+                    return false;
+                }
+            }
+        }
+
+        out = (sign == '+' ? 1 : -1) * (exponent ? std::ldexp(mantissa * std::pow(5.0, exponent), exponent) : mantissa);
+        return true;
+    }
+
+    // The integer part is read a word at a time; the exact double tinyobj builds digit by digit is
+    // that integer as long as it is under 2^53. The fraction is summed just as tinyobj sums it, since
+    // a correctly rounded conversion would now and then land on a different float.
+    static inline bool obj_parse_double(const char* s, const char* sEnd, const char* readEnd, f64& out) {
+        const char* c = s;
+        bool negative = false;
+        if (c < sEnd && (*c == '+' || *c == '-')) {
+            negative = *c == '-';
+            c++;
+        }
+        u64 integer = 0;
+        u32 digits = obj_scan_digits(c, sEnd, readEnd, integer);
+        if (digits == 0 || digits > 15 || (c < sEnd && (*c == 'e' || *c == 'E'))) {
+            return obj_parse_double_reference(s, sEnd, out);
+        }
+        f64 mantissa = static_cast<f64>(integer);
+        if (c < sEnd && *c == '.') {
+            c++;
+            int read = 1;
+            while (c < sEnd && obj_is_digit(*c)) {
+                mantissa += static_cast<int>(*c - 0x30) * (read < 8 ? s_ObjFractionLut[read] : std::pow(10.0, -read));
+                read++;
+                c++;
+            }
+            if (c < sEnd && (*c == 'e' || *c == 'E')) {
+                return obj_parse_double_reference(s, sEnd, out);
+            }
+        }
+        out = (negative ? -1 : 1) * mantissa;
+        return true;
+    }
+
+    // tinyobj's parseReal: the next token, converted like tinyobj, or fallback if it is no number.
+    static inline bool obj_parse_real(const char*& p, const char* end, const char* readEnd, f64 fallback, f32& out) {
+        p = obj_skip_space(p, end);
+        const char* tokenEnd = obj_token_end(p, end);
+        f64 value = fallback;
+        bool parsed = obj_parse_double(p, tokenEnd, readEnd, value);
+        out = static_cast<f32>(value);
+        p = tokenEnd;
+        return parsed;
+    }
+
+    // tinyobj's fixIndex, with relative indices resolved against the chunk's own count for now.
+    static inline bool obj_fix_index(int index, u32 count, bool allowZero, int& out, u8& relative, u8 bit) {
+        if (index > 0) {
+            out = index - 1;
+            return true;
+        }
+        if (index == 0) {
+            out = -1;
+            return allowZero;
+        }
+        out = static_cast<int>(count) + index;
+        relative |= bit;
+        return true;
+    }
+
+    static bool obj_parse_face(ObjChunk& chunk, const char* p, const char* end, const char* readEnd) {
+        u32 vertexCount = static_cast<u32>(chunk.Vertices.size() / 3);
+        u32 normalCount = static_cast<u32>(chunk.Normals.size() / 3);
+        u32 texCoordCount = static_cast<u32>(chunk.TexCoords.size() / 2);
+        u32 corners = 0;
+        p = obj_skip_space(p, end);
+        while (p < end) {
+            tinyobj::index_t corner = {-1, -1, -1};
+            u8 relative = 0;
+            if (!obj_fix_index(obj_parse_int(p, end, readEnd), vertexCount, false, corner.vertex_index, relative, OBJ_RELATIVE_POSITION)) {
+                return false;
+            }
+            p = obj_index_end(p, end);
+            if (p < end && *p == '/') {
+                p++;
+                if (p < end && *p == '/') {
+                    p++;
+                    if (!obj_fix_index(obj_parse_int(p, end, readEnd), normalCount, true, corner.normal_index, relative, OBJ_RELATIVE_NORMAL)) {
+                        return false;
+                    }
+                    p = obj_index_end(p, end);
+                } else {
+                    if (!obj_fix_index(obj_parse_int(p, end, readEnd), texCoordCount, true, corner.texcoord_index, relative, OBJ_RELATIVE_TEXCOORD)) {
+                        return false;
+                    }
+                    p = obj_index_end(p, end);
+                    if (p < end && *p == '/') {
+                        p++;
+                        if (!obj_fix_index(obj_parse_int(p, end, readEnd), normalCount, true, corner.normal_index, relative, OBJ_RELATIVE_NORMAL)) {
+                            return false;
+                        }
+                        p = obj_index_end(p, end);
+                    }
+                }
+            }
+
+            if (relative != 0 || !chunk.Relative.empty()) {
+                chunk.Relative.resize(chunk.Corners.size(), 0);
+                chunk.Relative.push_back(relative);
+            }
+            chunk.Corners.push_back(corner);
+            corners++;
+            p = obj_skip_space(p, end);
+        }
+        chunk.FaceSizes.push_back(corners);
+        return corners <= 4;
+    }
+
+    // Dispatches on the same line prefixes, in the same order, as tinyobj::LoadObj.
+    static void obj_parse_chunk(ObjChunk& chunk, const char* readEnd) {
+        const char* p = chunk.Begin;
+        while (p < chunk.End) {
+            // Lines end at '\n', '\r' or both, as safeGetline has them.
+            const char* lineEnd = p;
+            while (lineEnd < chunk.End && *lineEnd != '\n' && *lineEnd != '\r') {
+                lineEnd++;
+            }
+            const char* next = lineEnd;
+            if (next < chunk.End) {
+                next += (*next == '\r' && next + 1 < chunk.End && next[1] == '\n') ? 2 : 1;
+            }
+            const char* end = lineEnd;
+            const char* token = obj_skip_space(p, end);
+            p = next;
+
+            if (token == end || token[0] == '#') {
+                continue;
+            }
+            char c0 = token[0];
+            char c1 = token + 1 < end ? token[1] : '\0';
+            char c2 = token + 2 < end ? token[2] : '\0';
+
+            if (c0 == 'v' && obj_is_space(c1)) {
+                const char* t = token + 2;
+                f32 x, y, z;
+                obj_parse_real(t, end, readEnd, 0.0, x);
+                obj_parse_real(t, end, readEnd, 0.0, y);
+                obj_parse_real(t, end, readEnd, 0.0, z);
+                f32 r, g, b;
+                bool color = obj_parse_real(t, end, readEnd, 0.0, r) && obj_parse_real(t, end, readEnd, 0.0, g) && obj_parse_real(t, end, readEnd, 0.0, b);
+                if (!color) {
+                    r = g = b = 1.0f;
+                }
+                chunk.Vertices.insert(chunk.Vertices.end(), {x, y, z});
+                chunk.Colors.insert(chunk.Colors.end(), {r, g, b});
+            } else if (c0 == 'v' && c1 == 'n' && obj_is_space(c2)) {
+                const char* t = token + 3;
+                f32 x, y, z;
+                obj_parse_real(t, end, readEnd, 0.0, x);
+                obj_parse_real(t, end, readEnd, 0.0, y);
+                obj_parse_real(t, end, readEnd, 0.0, z);
+                chunk.Normals.insert(chunk.Normals.end(), {x, y, z});
+            } else if (c0 == 'v' && c1 == 't' && obj_is_space(c2)) {
+                const char* t = token + 3;
+                f32 u, v;
+                obj_parse_real(t, end, readEnd, 0.0, u);
+                obj_parse_real(t, end, readEnd, 0.0, v);
+                chunk.TexCoords.insert(chunk.TexCoords.end(), {u, v});
+            } else if ((c0 == 'v' && c1 == 'w' && obj_is_space(c2)) || ((c0 == 'l' || c0 == 'p' || c0 == 't') && obj_is_space(c1))) {
+                chunk.Supported = false;
+                return;
+            } else if (c0 == 'f' && obj_is_space(c1)) {
+                if (!obj_parse_face(chunk, token + 2, end, readEnd)) {
+                    chunk.Supported = false;
+                    return;
+                }
+            } else if (c0 == 'g' && obj_is_space(c1)) {
+                // Every token after the 'g' itself, joined by single spaces.
+                std::string name;
+                const char* t = obj_token_end(token, end);
+                u32 names = 0;
+                while ((t = obj_skip_space(t, end)) < end) {
+                    const char* nameEnd = obj_token_end(t, end);
+                    name.append(names++ > 0 ? " " : "").append(t, nameEnd);
+                    t = nameEnd;
+                }
+                chunk.Groups.push_back({static_cast<u32>(chunk.FaceSizes.size()), static_cast<u32>(chunk.Vertices.size() / 3), std::move(name)});
+            } else if (c0 == 'o' && obj_is_space(c1)) {
+                chunk.Groups.push_back({static_cast<u32>(chunk.FaceSizes.size()), static_cast<u32>(chunk.Vertices.size() / 3), std::string(token + 2, end)});
+            } else if (c0 == 's' && obj_is_space(c1)) {
+                const char* t = obj_skip_space(token + 2, end);
+                if (t == end) {
+                    continue;
+                }
+                u32 id = 0;
+                if (!(end - t >= 3 && t[0] == 'o' && t[1] == 'f' && t[2] == 'f')) {
+                    int value = obj_parse_int(t, end, readEnd);
+                    id = value < 0 ? 0 : static_cast<u32>(value);
+                }
+                chunk.Smoothing.push_back({static_cast<u32>(chunk.FaceSizes.size()), id});
+            }
+            // usemtl, mtllib and anything unknown are skipped; tinyobj's usemtl only changes the
+            // material, which is -1 without the library.
+        }
+    }
+
+    // tinyobj's quad split: across the shorter diagonal, with the same float arithmetic. tinyobj
+    // splits when the shape is flushed, so quads may use positions up to that point, vertexLimit.
+    static inline bool obj_split_quad(const tinyobj::index_t* quad, const std::vector<f32>& v, u32 vertexLimit, tinyobj::index_t* out) {
+        size_t vi0 = static_cast<size_t>(quad[0].vertex_index);
+        size_t vi1 = static_cast<size_t>(quad[1].vertex_index);
+        size_t vi2 = static_cast<size_t>(quad[2].vertex_index);
+        size_t vi3 = static_cast<size_t>(quad[3].vertex_index);
+        if (vi0 >= vertexLimit || vi1 >= vertexLimit || vi2 >= vertexLimit || vi3 >= vertexLimit) {
+            return false;
+        }
+        f32 e02x = v[vi2 * 3 + 0] - v[vi0 * 3 + 0];
+        f32 e02y = v[vi2 * 3 + 1] - v[vi0 * 3 + 1];
+        f32 e02z = v[vi2 * 3 + 2] - v[vi0 * 3 + 2];
+        f32 e13x = v[vi3 * 3 + 0] - v[vi1 * 3 + 0];
+        f32 e13y = v[vi3 * 3 + 1] - v[vi1 * 3 + 1];
+        f32 e13z = v[vi3 * 3 + 2] - v[vi1 * 3 + 2];
+        f32 sqr02 = e02x * e02x + e02y * e02y + e02z * e02z;
+        f32 sqr13 = e13x * e13x + e13y * e13y + e13z * e13z;
+        if (sqr02 < sqr13) {
+            out[0] = quad[0]; out[1] = quad[1]; out[2] = quad[2];
+            out[3] = quad[0]; out[4] = quad[2]; out[5] = quad[3];
+        } else {
+            out[0] = quad[0]; out[1] = quad[1]; out[2] = quad[3];
+            out[3] = quad[1]; out[4] = quad[2]; out[5] = quad[3];
+        }
+        return true;
+    }
+
+    static void obj_triangulate_chunk(ObjChunk& chunk, const std::vector<f32>& vertices) {
+        chunk.Triangles.clear();
+        chunk.TriangleSmoothing.clear();
+        chunk.GroupTriangles.clear();
+        chunk.Triangles.reserve(chunk.Corners.size());
+        chunk.TriangleSmoothing.reserve(chunk.Corners.size() / 3);
+        u32 smoothing = chunk.SmoothingId;
+        size_t nextSmoothing = 0;
+        size_t nextGroup = 0;
+        u32 vertexLimit = chunk.Groups.empty() ? chunk.VertexLimit : chunk.VertexBase + chunk.Groups[0].VertexCount;
+        const tinyobj::index_t* corner = chunk.Corners.data();
+        for (u32 face = 0; face <= chunk.FaceSizes.size(); face++) {
+            while (nextGroup < chunk.Groups.size() && chunk.Groups[nextGroup].Face == face) {
+                chunk.GroupTriangles.push_back(static_cast<u32>(chunk.TriangleSmoothing.size()));
+                nextGroup++;
+                vertexLimit = nextGroup < chunk.Groups.size() ? chunk.VertexBase + chunk.Groups[nextGroup].VertexCount : chunk.VertexLimit;
+            }
+            while (nextSmoothing < chunk.Smoothing.size() && chunk.Smoothing[nextSmoothing].Face == face) {
+                smoothing = chunk.Smoothing[nextSmoothing++].Id;
+            }
+            if (face == chunk.FaceSizes.size()) {
+                break;
+            }
+
+            // Fewer than three corners is a degenerate face tinyobj skips, as is a quad indexing past
+            // the positions.
+            u32 size = chunk.FaceSizes[face];
+            if (size == 3) {
+                chunk.Triangles.insert(chunk.Triangles.end(), corner, corner + 3);
+                chunk.TriangleSmoothing.push_back(smoothing);
+            } else if (size == 4) {
+                tinyobj::index_t split[6];
+                if (obj_split_quad(corner, vertices, vertexLimit, split)) {
+                    chunk.Triangles.insert(chunk.Triangles.end(), split, split + 6);
+                    chunk.TriangleSmoothing.insert(chunk.TriangleSmoothing.end(), {smoothing, smoothing});
+                }
+            }
+            corner += size;
+        }
+    }
+
+    ObjParser::ObjParser(u32 threadCount)
+        : m_Workers(std::make_unique<WorkerPool>(threadCount, "OBJ")) {
+    }
+
+    bool ObjParser::Parse(const std::string& path, tinyobj::attrib_t& outAttrib, std::vector<tinyobj::shape_t>& outShapes) {
+        CORTEX_PROFILE_FUNCTION();
+        std::unique_ptr<MappedFile> file = MappedFile::Open(path);
+        if (!file) {
+            return false;
+        }
+        const char* data = reinterpret_cast<const char*>(file->GetData());
+        const char* fileEnd = data + file->GetSize();
+
+        // Chunks start just after a '\n', so no line is split; a file of lone '\r' line ends stays whole.
+        u32 chunkCount = static_cast<u32>(std::max<u64>(1, file->GetSize() / OBJ_CHUNK_SIZE));
+        std::vector<ObjChunk> chunks(chunkCount);
+        const char* begin = data;
+        for (u32 i = 0; i < chunkCount; i++) {
+            const char* end = fileEnd;
+            if (i + 1 < chunkCount) {
+                end = std::max(begin, data + file->GetSize() * (i + 1) / chunkCount);
+                const char* lineBreak = static_cast<const char*>(memchr(end, '\n', fileEnd - end));
+                end = lineBreak ? lineBreak + 1 : fileEnd;
+            }
+            chunks[i].Begin = begin;
+            chunks[i].End = end;
+            begin = end;
+        }
+
+        m_Workers->Run(chunkCount, [&](u32 i) {
+            obj_parse_chunk(chunks[i], fileEnd);
+        });
+
+        // Offsets of every chunk's attributes, and the smoothing group each starts in.
+        u64 vertexCount = 0;
+        u64 normalCount = 0;
+        u64 texCoordCount = 0;
+        u32 smoothing = 0;
+        for (ObjChunk& chunk : chunks) {
+            if (!chunk.Supported) {
+                return false;
+            }
+            chunk.VertexBase = static_cast<u32>(vertexCount);
+            chunk.NormalBase = static_cast<u32>(normalCount);
+            chunk.TexCoordBase = static_cast<u32>(texCoordCount);
+            chunk.SmoothingId = smoothing;
+            vertexCount += chunk.Vertices.size() / 3;
+            normalCount += chunk.Normals.size() / 3;
+            texCoordCount += chunk.TexCoords.size() / 2;
+            if (!chunk.Smoothing.empty()) {
+                smoothing = chunk.Smoothing.back().Id;
+            }
+        }
+        if (vertexCount > 0x7FFFFFFF || normalCount > 0x7FFFFFFF || texCoordCount > 0x7FFFFFFF) {
+            return false;
+        }
+        u32 vertexLimit = static_cast<u32>(vertexCount);
+        for (u32 i = chunkCount; i-- > 0;) {
+            chunks[i].VertexLimit = vertexLimit;
+            if (!chunks[i].Groups.empty()) {
+                vertexLimit = chunks[i].VertexBase + chunks[i].Groups[0].VertexCount;
+            }
+        }
+
+        outAttrib = tinyobj::attrib_t();
+        outAttrib.vertices.resize(vertexCount * 3);
+        outAttrib.colors.resize(vertexCount * 3);
+        outAttrib.normals.resize(normalCount * 3);
+        outAttrib.texcoords.resize(texCoordCount * 2);
+        std::atomic<bool> malformed(false);
+        m_Workers->Run(chunkCount, [&](u32 i) {
+            ObjChunk& chunk = chunks[i];
+            std::copy(chunk.Vertices.begin(), chunk.Vertices.end(), outAttrib.vertices.begin() + chunk.VertexBase * 3ull);
+            std::copy(chunk.Colors.begin(), chunk.Colors.end(), outAttrib.colors.begin() + chunk.VertexBase * 3ull);
+            std::copy(chunk.Normals.begin(), chunk.Normals.end(), outAttrib.normals.begin() + chunk.NormalBase * 3ull);
+            std::copy(chunk.TexCoords.begin(), chunk.TexCoords.end(), outAttrib.texcoords.begin() + chunk.TexCoordBase * 2ull);
+            bool invalid = false;
+            for (size_t c = 0; c < chunk.Relative.size(); c++) {
+                tinyobj::index_t& corner = chunk.Corners[c];
+                u8 relative = chunk.Relative[c];
+                if (relative & OBJ_RELATIVE_POSITION) {
+                    corner.vertex_index += static_cast<int>(chunk.VertexBase);
+                    invalid |= corner.vertex_index < 0;
+                }
+                if (relative & OBJ_RELATIVE_NORMAL) {
+                    corner.normal_index += static_cast<int>(chunk.NormalBase);
+                    invalid |= corner.normal_index < 0;
+                }
+                if (relative & OBJ_RELATIVE_TEXCOORD) {
+                    corner.texcoord_index += static_cast<int>(chunk.TexCoordBase);
+                    invalid |= corner.texcoord_index < 0;
+                }
+            }
+            if (invalid) {
+                malformed = true;
+            }
+        });
+        if (malformed) {
+            return false;
+        }
+
+        // Quads split on the merged positions, so this waits for all of them.
+        m_Workers->Run(chunkCount, [&](u32 i) {
+            obj_triangulate_chunk(chunks[i], outAttrib.vertices);
+        });
+
+        // Shapes break where tinyobj's do: a 'g' or 'o' closes the shape so far, kept if it has any
+        // triangles, and its name is the one in effect when faces were last added to it.
+        outShapes.clear();
+        std::vector<u32> shapeTriangles;
+        std::string name;
+        std::string shapeName;
+        u32 triangles = 0;
+        bool pending = false;
+        auto closeShape = [&](bool last) {
+            if (pending) {
+                shapeName = name;
+            }
+            if (triangles > 0 || (last && pending)) {
+                outShapes.emplace_back();
+                outShapes.back().name = shapeName;
+                shapeTriangles.push_back(triangles);
+            }
+            shapeName.clear();
+            triangles = 0;
+            pending = false;
+        };
+        for (ObjChunk& chunk : chunks) {
+            chunk.Segments.clear();
+            u32 face = 0;
+            u32 triangle = 0;
+            for (size_t g = 0; g <= chunk.Groups.size(); g++) {
+                bool end = g == chunk.Groups.size();
+                u32 groupFace = end ? static_cast<u32>(chunk.FaceSizes.size()) : chunk.Groups[g].Face;
+                u32 groupTriangle = end ? static_cast<u32>(chunk.TriangleSmoothing.size()) : chunk.GroupTriangles[g];
+                pending |= groupFace > face;
+                if (groupTriangle > triangle) {
+                    chunk.Segments.push_back({static_cast<u32>(outShapes.size()), triangle, groupTriangle - triangle, triangles});
+                    triangles += groupTriangle - triangle;
+                }
+                face = groupFace;
+                triangle = groupTriangle;
+                if (!end) {
+                    closeShape(false);
+                    name = chunk.Groups[g].Name;
+                }
+            }
+        }
+        closeShape(true);
+
+        for (size_t s = 0; s < outShapes.size(); s++) {
+            tinyobj::mesh_t& mesh = outShapes[s].mesh;
+            mesh.indices.resize(shapeTriangles[s] * 3ull);
+            mesh.num_face_vertices.assign(shapeTriangles[s], 3);
+            mesh.material_ids.assign(shapeTriangles[s], -1);
+            mesh.smoothing_group_ids.resize(shapeTriangles[s]);
+        }
+        m_Workers->Run(chunkCount, [&](u32 i) {
+            for (const ObjSegment& segment : chunks[i].Segments) {
+                tinyobj::mesh_t& mesh = outShapes[segment.Shape].mesh;
+                const tinyobj::index_t* corners = chunks[i].Triangles.data() + segment.FirstTriangle * 3ull;
+                std::copy(corners, corners + segment.TriangleCount * 3ull, mesh.indices.begin() + segment.ShapeTriangle * 3ull);
+                const u32* smoothing = chunks[i].TriangleSmoothing.data() + segment.FirstTriangle;
+                std::copy(smoothing, smoothing + segment.TriangleCount, mesh.smoothing_group_ids.begin() + segment.ShapeTriangle);
+            }
+        });
+        return true;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Cortex/Base/Base.hpp"
+#include "Cortex/Base/WorkerPool.hpp"
+
+#include "tiny_obj_loader.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Cortex {
+    // Tests may define a smaller size to put chunk boundaries on every kind of line.
+#if !defined(OBJ_CHUNK_SIZE)
+    #define OBJ_CHUNK_SIZE (128u << 10) // bytes per parse job, rounded up to the next line break
+#endif
+
+    // A 'g' or 'o' line, as the number of faces and positions its chunk had parsed before it.
+    struct ObjGroupMarker {
+        u32 Face;
+        u32 VertexCount;
+        std::string Name;
+    };
+
+    struct ObjSmoothingMarker {
+        u32 Face;
+        u32 Id;
+    };
+
+    // Where a run of a chunk's triangles lands in the merged shapes.
+    struct ObjSegment {
+        u32 Shape;
+        u32 FirstTriangle;
+        u32 TriangleCount;
+        u32 ShapeTriangle;
+    };
+
+    // What one job parsed from its lines. Relative indices stay relative to the chunk's first
+    // attribute until the merge knows how many came before it.
+    struct ObjChunk {
+        const char* Begin = nullptr;
+        const char* End = nullptr;
+        std::vector<f32> Vertices;
+        std::vector<f32> Colors;
+        std::vector<f32> Normals;
+        std::vector<f32> TexCoords;
+        std::vector<tinyobj::index_t> Corners;
+        std::vector<u32> FaceSizes;
+        std::vector<u8> Relative;       // per corner, which of its indices are relative; empty if none are
+        std::vector<ObjGroupMarker> Groups;
+        std::vector<ObjSmoothingMarker> Smoothing;
+        bool Supported = true;
+
+        u32 VertexBase = 0;
+        u32 NormalBase = 0;
+        u32 TexCoordBase = 0;
+        u32 SmoothingId = 0;            // in effect at the chunk's first line
+        u32 VertexLimit = 0;            // positions parsed by the first 'g' or 'o' after the chunk, or in all
+        std::vector<tinyobj::index_t> Triangles;
+        std::vector<u32> TriangleSmoothing;
+        std::vector<u32> GroupTriangles; // triangles before each group marker
+        std::vector<ObjSegment> Segments;
+    };
+
+    // Reads OBJ files into exactly the attributes and shapes tinyobj::LoadObj gives vulkan_read_obj,
+    // down to the bits of every float, without iostreams or a string per line. The file is mapped and
+    // split into line-aligned chunks that are parsed in parallel, then merged with their indices
+    // offset by the attributes of the chunks before them. Material libraries are not read, since
+    // imports take nothing from them, so every face's material is -1.
+    class ObjParser {
+        public:
+            // threadCount workers besides the calling thread.
+            ObjParser(u32 threadCount = WorkerPool::DefaultThreadCount());
+            // False if the file cannot be mapped, is malformed, or uses what only tinyobj handles:
+            // polygons beyond quads, lines, points, tags or skin weights. Callers fall back to tinyobj,
+            // which also reports what was wrong.
+            bool Parse(const std::string& path, tinyobj::attrib_t& outAttrib, std::vector<tinyobj::shape_t>& outShapes);
+        private:
+            std::unique_ptr<WorkerPool> m_Workers;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,560 @@
+#include "Cortex/Graphics/OcclusionCuller.hpp"
+
+#include "Cortex/Core/Frustum.hpp"
+
+namespace Cortex {
+    static u32 occlusion_previous_power_of_two(u32 value) {
+        u32 power = 1;
+        while (power <= value / 2) {
+            power <<= 1;
+        }
+        return power;
+    }
+
+    static u32 occlusion_next_power_of_two(u32 value) {
+        u32 power = 1;
+        while (power < value) {
+            power <<= 1;
+        }
+        return power;
+    }
+
+    static void occlusion_memory_barrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStages, VkAccessFlags srcAccess, VkPipelineStageFlags dstStages, VkAccessFlags dstAccess) {
+        VkMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = srcAccess;
+        barrier.dstAccessMask = dstAccess;
+        vkCmdPipelineBarrier(commandBuffer, srcStages, dstStages, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+
+    static VkImageView occlusion_create_hiz_view(VkDevice device, VkImage image, u32 baseMip, u32 mipCount) {
+        VkImageViewCreateInfo viewInfo = {};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = image;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = VK_FORMAT_R32_SFLOAT;
+        viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        viewInfo.subresourceRange.baseMipLevel = baseMip;
+        viewInfo.subresourceRange.levelCount = mipCount;
+        viewInfo.subresourceRange.baseArrayLayer = 0;
+        viewInfo.subresourceRange.layerCount = 1;
+
+        VkImageView view;
+        VkResult result = vkCreateImageView(device, &viewInfo, nullptr, &view);
+        ASSERT(result == VK_SUCCESS, "Failed to create a Hi-Z image view.");
+        return view;
+    }
+
+    std::unique_ptr<OcclusionCuller> OcclusionCuller::Create(std::shared_ptr<GraphicsDevice> device, std::shared_ptr<ShaderLibrary> library) {
+        return std::make_unique<OcclusionCuller>(device, library);
+    }
+
+    OcclusionCuller::OcclusionCuller(std::shared_ptr<GraphicsDevice> device, std::shared_ptr<ShaderLibrary> library) {
+        m_GraphicsDevice = device;
+        m_CurrentSlot = 0;
+        m_InstanceCount = 0;
+        m_RenderExtent = {0, 0};
+        m_Generation = 1;
+        m_Capacity = 0;
+        m_VisibilityBuffer = VK_NULL_HANDLE;
+        m_VisibilityMemory = VK_NULL_HANDLE;
+        m_VisibilityCleared = false;
+        m_DrawBuffer = VK_NULL_HANDLE;
+        m_DrawMemory = VK_NULL_HANDLE;
+        m_DepthExtent = {0, 0};
+        m_DepthSamples = VK_SAMPLE_COUNT_1_BIT;
+        m_HiZExtent = {0, 0};
+        m_HiZMipCount = 0;
+        m_HiZImage = VK_NULL_HANDLE;
+        m_HiZMemory = VK_NULL_HANDLE;
+        m_HiZView = VK_NULL_HANDLE;
+        m_HiZInitialized = false;
+        m_DescriptorPool = VK_NULL_HANDLE;
+        m_Stats = {};
+
+        auto cullShader = library->LoadCompute("cull", "../../testbed/assets/shaders/cull.comp");
+        auto initShader = library->LoadCompute("hiz_init", "../../testbed/assets/shaders/hiz_init.comp");
+        auto initMultisampledShader = library->LoadCompute("hiz_init_ms", "../../testbed/assets/shaders/hiz_init_ms.comp");
+        auto reduceShader = library->LoadCompute("hiz_reduce", "../../testbed/assets/shaders/hiz_reduce.comp");
+        m_CullPipeline = ComputePipeline::Create(m_GraphicsDevice, cullShader);
+        m_InitPipeline = ComputePipeline::Create(m_GraphicsDevice, initShader);
+        m_InitMultisampledPipeline = ComputePipeline::Create(m_GraphicsDevice, initMultisampledShader);
+        m_ReducePipeline = ComputePipeline::Create(m_GraphicsDevice, reduceShader);
+        m_CullSetLayout = cullShader->m_DescriptorSetLayouts[0];
+        m_InitSetLayout = initShader->m_DescriptorSetLayouts[0];
+        m_InitMultisampledSetLayout = initMultisampledShader->m_DescriptorSetLayouts[0];
+        m_ReduceSetLayout = reduceShader->m_DescriptorSetLayouts[0];
+
+        // Nearest filtering: the cull shader wants the farthest depth of a texel, never a blend of several.
+        VkSamplerCreateInfo samplerInfo = {};
+        samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        samplerInfo.magFilter = VK_FILTER_NEAREST;
+        samplerInfo.minFilter = VK_FILTER_NEAREST;
+        samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+        samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.minLod = 0.0f;
+        samplerInfo.maxLod = static_cast<f32>(OCCLUSION_HIZ_MAX_MIPS);
+        VkResult result = vkCreateSampler(m_GraphicsDevice->Device, &samplerInfo, nullptr, &m_HiZSampler);
+        ASSERT(result == VK_SUCCESS, "Failed to create the Hi-Z sampler.");
+
+        for (auto& slot : m_Slots) {
+            vulkan_create_buffer(
+                m_GraphicsDevice->PhysicalDevice,
+                m_GraphicsDevice->Device,
+                sizeof(OcclusionStats),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                slot.StatsBuffer,
+                slot.StatsMemory
+            );
+            vkMapMemory(m_GraphicsDevice->Device, slot.StatsMemory, 0, sizeof(OcclusionStats), 0, &slot.StatsMapped);
+            memset(slot.StatsMapped, 0, sizeof(OcclusionStats));
+        }
+    }
+
+    OcclusionCuller::~OcclusionCuller() {
+        ReleasePyramid();
+        VkDevice device = m_GraphicsDevice->Device;
+        VkSampler sampler = m_HiZSampler;
+        VkBuffer visibilityBuffer = m_VisibilityBuffer;
+        VkDeviceMemory visibilityMemory = m_VisibilityMemory;
+        VkBuffer drawBuffer = m_DrawBuffer;
+        VkDeviceMemory drawMemory = m_DrawMemory;
+        auto slots = m_Slots;
+        m_GraphicsDevice->PendingDeletions.Push([=]() {
+            for (const auto& slot : slots) {
+                if (slot.InstanceBuffer != VK_NULL_HANDLE) {
+                    vkUnmapMemory(device, slot.InstanceMemory);
+                    vkDestroyBuffer(device, slot.InstanceBuffer, nullptr);
+                    vkFreeMemory(device, slot.InstanceMemory, nullptr);
+                }
+                vkUnmapMemory(device, slot.StatsMemory);
+                vkDestroyBuffer(device, slot.StatsBuffer, nullptr);
+                vkFreeMemory(device, slot.StatsMemory, nullptr);
+            }
+            if (visibilityBuffer != VK_NULL_HANDLE) {
+                vkDestroyBuffer(device, visibilityBuffer, nullptr);
+                vkFreeMemory(device, visibilityMemory, nullptr);
+                vkDestroyBuffer(device, drawBuffer, nullptr);
+                vkFreeMemory(device, drawMemory, nullptr);
+            }
+            vkDestroySampler(device, sampler, nullptr);
+        });
+        m_CullPipeline.reset();
+        m_InitPipeline.reset();
+        m_InitMultisampledPipeline.reset();
+        m_ReducePipeline.reset();
+    }
+
+    void OcclusionCuller::ReleasePyramid() {
+        if (m_HiZImage == VK_NULL_HANDLE) { return; }
+        VkDevice device = m_GraphicsDevice->Device;
+        VkImage image = m_HiZImage;
+        VkDeviceMemory memory = m_HiZMemory;
+        VkImageView view = m_HiZView;
+        std::vector<VkImageView> mipViews = m_HiZMipViews;
+        VkDescriptorPool pool = m_DescriptorPool;
+        // Destroying the pool frees every set allocated from it, the slots' included.
+        m_GraphicsDevice->PendingDeletions.Push([=]() {
+            vkDestroyDescriptorPool(device, pool, nullptr);
+            for (auto mipView : mipViews) {
+                vkDestroyImageView(device, mipView, nullptr);
+            }
+            vkDestroyImageView(device, view, nullptr);
+            vkDestroyImage(device, image, nullptr);
+            vkFreeMemory(device, memory, nullptr);
+        });
+        m_HiZImage = VK_NULL_HANDLE;
+        m_HiZMemory = VK_NULL_HANDLE;
+        m_HiZView = VK_NULL_HANDLE;
+        m_HiZMipViews.clear();
+        m_DescriptorPool = VK_NULL_HANDLE;
+        m_ReduceSets.clear();
+    }
+
+    void OcclusionCuller::Resize(VkExtent2D maxDepthExtent, VkSampleCountFlagBits samples) {
+        if (m_HiZImage != VK_NULL_HANDLE && maxDepthExtent.width == m_DepthExtent.width && maxDepthExtent.height == m_DepthExtent.height && samples == m_DepthSamples) {
+            return;
+        }
+        CORTEX_PROFILE_FUNCTION();
+        ReleasePyramid();
+        VkDevice device = m_GraphicsDevice->Device;
+        m_DepthExtent = maxDepthExtent;
+        m_DepthSamples = samples;
+
+        // Rounding down to a power of two makes every reduction an exact 2x2, and keeps each base texel's
+        // footprint under two depth texels a side so the init pass stays a small fixed loop.
+        m_HiZExtent.width = occlusion_previous_power_of_two(std::max(maxDepthExtent.width, 1u));
+        m_HiZExtent.height = occlusion_previous_power_of_two(std::max(maxDepthExtent.height, 1u));
+        m_HiZMipCount = 1;
+        while (m_HiZMipCount < OCCLUSION_HIZ_MAX_MIPS && (std::max(m_HiZExtent.width, m_HiZExtent.height) >> m_HiZMipCount) > 0) {
+            m_HiZMipCount++;
+        }
+
+        VkImageCreateInfo imageInfo = {};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.extent = {m_HiZExtent.width, m_HiZExtent.height, 1};
+        imageInfo.mipLevels = m_HiZMipCount;
+        imageInfo.arrayLayers = 1;
+        imageInfo.format = VK_FORMAT_R32_SFLOAT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        VkResult result = vkCreateImage(device, &imageInfo, nullptr, &m_HiZImage);
+        ASSERT(result == VK_SUCCESS, "Failed to create the Hi-Z image.");
+
+        VkMemoryRequirements requirements;
+        vkGetImageMemoryRequirements(device, m_HiZImage, &requirements);
+        VkMemoryAllocateInfo allocInfo = {};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize = requirements.size;
+        allocInfo.memoryTypeIndex = vulkan_find_memory_type(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_GraphicsDevice->PhysicalDevice);
+        result = vkAllocateMemory(device, &allocInfo, nullptr, &m_HiZMemory);
+        ASSERT(result == VK_SUCCESS, "Failed to allocate Hi-Z image memory.");
+        vkBindImageMemory(device, m_HiZImage, m_HiZMemory, 0);
+
+        m_HiZView = occlusion_create_hiz_view(device, m_HiZImage, 0, m_HiZMipCount);
+        for (u32 mip = 0; mip < m_HiZMipCount; mip++) {
+            m_HiZMipViews.push_back(occlusion_create_hiz_view(device, m_HiZImage, mip, 1));
+        }
+        m_HiZInitialized = false;
+
+        // Every slot's cull and init sets, plus a reduce set per mip.
+        u32 slotCount = MAX_FRAMES_IN_FLIGHT_LIMIT;
+        std::array<VkDescriptorPoolSize, 3> poolSizes = {{
+            {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 4 * slotCount},
+            {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2 * slotCount},
+            {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, slotCount + 2 * OCCLUSION_HIZ_MAX_MIPS}
+        }};
+        VkDescriptorPoolCreateInfo poolInfo = {};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.poolSizeCount = static_cast<u32>(poolSizes.size());
+        poolInfo.pPoolSizes = poolSizes.data();
+        poolInfo.maxSets = 2 * slotCount + OCCLUSION_HIZ_MAX_MIPS;
+        result = vkCreateDescriptorPool(device, &poolInfo, nullptr, &m_DescriptorPool);
+        ASSERT(result == VK_SUCCESS, "Failed to create the occlusion culling descriptor pool.");
+
+        if (m_HiZMipCount > 1) {
+            std::vector<VkDescriptorSetLayout> layouts(m_HiZMipCount - 1, m_ReduceSetLayout);
+            VkDescriptorSetAllocateInfo setInfo = {};
+            setInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            setInfo.descriptorPool = m_DescriptorPool;
+            setInfo.descriptorSetCount = static_cast<u32>(layouts.size());
+            setInfo.pSetLayouts = layouts.data();
+            m_ReduceSets.resize(layouts.size());
+            result = vkAllocateDescriptorSets(device, &setInfo, m_ReduceSets.data());
+            ASSERT(result == VK_SUCCESS, "Failed to allocate Hi-Z reduction descriptor sets.");
+        }
+
+        for (u32 mip = 1; mip < m_HiZMipCount; mip++) {
+            VkDescriptorImageInfo imageInfos[2] = {};
+            imageInfos[0].imageView = m_HiZMipViews[mip - 1];
+            imageInfos[0].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+            imageInfos[1].imageView = m_HiZMipViews[mip];
+            imageInfos[1].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+            VkWriteDescriptorSet writes[2] = {};
+            for (u32 i = 0; i < 2; i++) {
+                writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                writes[i].dstSet = m_ReduceSets[mip - 1];
+                writes[i].dstBinding = i;
+                writes[i].dstArrayElement = 0;
+                writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+                writes[i].descriptorCount = 1;
+                writes[i].pImageInfo = &imageInfos[i];
+            }
+            vkUpdateDescriptorSets(device, 2, writes, 0, nullptr);
+        }
+
+        m_Generation++;
+        LOG_INFO("Hi-Z pyramid resized to %ux%u with %u mips.", m_HiZExtent.width, m_HiZExtent.height, m_HiZMipCount);
+    }
+
+    void OcclusionCuller::EnsureCapacity(u32 count) {
+        if (m_VisibilityBuffer != VK_NULL_HANDLE && count <= m_Capacity) { return; }
+
+        // Frames in flight may still be reading the old buffers. Their visibility history is dropped, so
+        // for one frame everything is drawn late instead of early.
+        if (m_VisibilityBuffer != VK_NULL_HANDLE) {
+            VkDevice device = m_GraphicsDevice->Device;
+            VkBuffer visibilityBuffer = m_VisibilityBuffer;
+            VkDeviceMemory visibilityMemory = m_VisibilityMemory;
+            VkBuffer drawBuffer = m_DrawBuffer;
+            VkDeviceMemory drawMemory = m_DrawMemory;
+            m_GraphicsDevice->PendingDeletions.Push([=]() {
+                vkDestroyBuffer(device, visibilityBuffer, nullptr);
+                vkFreeMemory(device, visibilityMemory, nullptr);
+                vkDestroyBuffer(device, drawBuffer, nullptr);
+                vkFreeMemory(device, drawMemory, nullptr);
+            });
+        }
+
+        m_Capacity = std::max<u32>(OCCLUSION_INITIAL_CAPACITY, occlusion_next_power_of_two(count));
+        vulkan_create_buffer(
+            m_GraphicsDevice->PhysicalDevice,
+            m_GraphicsDevice->Device,
+            sizeof(u32) * m_Capacity,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            m_VisibilityBuffer,
+            m_VisibilityMemory
+        );
+        vulkan_create_buffer(
+            m_GraphicsDevice->PhysicalDevice,
+            m_GraphicsDevice->Device,
+            2 * sizeof(VkDrawIndexedIndirectCommand) * m_Capacity,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            m_DrawBuffer,
+            m_DrawMemory
+        );
+        m_VisibilityCleared = false;
+        m_Generation++;
+    }
+
+    void OcclusionCuller::EnsureSlotCapacity(OcclusionCullerSlot& slot, u32 count) {
+        if (slot.InstanceBuffer != VK_NULL_HANDLE && count <= slot.InstanceCapacity) { return; }
+
+        VkDevice device = m_GraphicsDevice->Device;
+        if (slot.InstanceBuffer != VK_NULL_HANDLE) {
+            VkBuffer buffer = slot.InstanceBuffer;
+            VkDeviceMemory memory = slot.InstanceMemory;
+            m_GraphicsDevice->PendingDeletions.Push([=]() {
+                vkUnmapMemory(device, memory);
+                vkDestroyBuffer(device, buffer, nullptr);
+                vkFreeMemory(device, memory, nullptr);
+            });
+        }
+
+        slot.InstanceCapacity = std::max<u32>(OCCLUSION_INITIAL_CAPACITY, occlusion_next_power_of_two(count));
+        VkDeviceSize size = sizeof(OcclusionCullHeader) + sizeof(OcclusionCullInstance) * slot.InstanceCapacity;
+        vulkan_create_buffer(
+            m_GraphicsDevice->PhysicalDevice,
+            device,
+            size,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            slot.InstanceBuffer,
+            slot.InstanceMemory
+        );
+        vkMapMemory(device, slot.InstanceMemory, 0, size, 0, &slot.InstanceMapped);
+        slot.Generation = 0;
+    }
+
+    void OcclusionCuller::UpdateSlotDescriptors(OcclusionCullerSlot& slot) {
+        VkDevice device = m_GraphicsDevice->Device;
+        if (slot.Pool != m_DescriptorPool) {
+            VkDescriptorSetLayout layouts[2] = {m_CullSetLayout, m_DepthSamples == VK_SAMPLE_COUNT_1_BIT ? m_InitSetLayout : m_InitMultisampledSetLayout};
+            VkDescriptorSet sets[2];
+            VkDescriptorSetAllocateInfo allocInfo = {};
+            allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            allocInfo.descriptorPool = m_DescriptorPool;
+            allocInfo.descriptorSetCount = 2;
+            allocInfo.pSetLayouts = layouts;
+            VkResult result = vkAllocateDescriptorSets(device, &allocInfo, sets);
+            ASSERT(result == VK_SUCCESS, "Failed to allocate occlusion culling descriptor sets.");
+            slot.CullSet = sets[0];
+            slot.InitSet = sets[1];
+            slot.Pool = m_DescriptorPool;
+            slot.Generation = 0;
+            slot.DepthView = VK_NULL_HANDLE;
+        }
+        if (slot.Generation == m_Generation) { return; }
+
+        VkDescriptorBufferInfo bufferInfos[4] = {};
+        bufferInfos[0] = {slot.InstanceBuffer, 0, VK_WHOLE_SIZE};
+        bufferInfos[1] = {m_VisibilityBuffer, 0, VK_WHOLE_SIZE};
+        bufferInfos[2] = {m_DrawBuffer, 0, VK_WHOLE_SIZE};
+        bufferInfos[3] = {slot.StatsBuffer, 0, VK_WHOLE_SIZE};
+
+        VkDescriptorImageInfo hizInfo = {};
+        hizInfo.sampler = m_HiZSampler;
+        hizInfo.imageView = m_HiZView;
+        hizInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+        VkDescriptorImageInfo baseInfo = {};
+        baseInfo.imageView = m_HiZMipViews[0];
+        baseInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+        VkWriteDescriptorSet writes[6] = {};
+        for (u32 i = 0; i < 6; i++) {
+            writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[i].dstArrayElement = 0;
+            writes[i].descriptorCount = 1;
+        }
+        for (u32 i = 0; i < 4; i++) {
+            writes[i].dstSet = slot.CullSet;
+            writes[i].dstBinding = i;
+            writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[i].pBufferInfo = &bufferInfos[i];
+        }
+        writes[4].dstSet = slot.CullSet;
+        writes[4].dstBinding = 4;
+        writes[4].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writes[4].pImageInfo = &hizInfo;
+        writes[5].dstSet = slot.InitSet;
+        writes[5].dstBinding = 1;
+        writes[5].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        writes[5].pImageInfo = &baseInfo;
+        vkUpdateDescriptorSets(device, 6, writes, 0, nullptr);
+        slot.Generation = m_Generation;
+    }
+
+    void OcclusionCuller::BeginFrame(u32 slotIndex, const Scene& scene, const std::vector<u8>& lods, const glm::mat4& worldToClip, VkExtent2D renderExtent) {
+        CORTEX_PROFILE_FUNCTION();
+        ASSERT(m_HiZImage != VK_NULL_HANDLE, "Occlusion culler used before it was sized.");
+        ASSERT(slotIndex < m_Slots.size(), "Occlusion culler slot out of range.");
+        m_CurrentSlot = slotIndex;
+        OcclusionCullerSlot& slot = m_Slots[slotIndex];
+        if (slot.Pending) {
+            memcpy(&m_Stats, slot.StatsMapped, sizeof(OcclusionStats));
+            slot.Pending = false;
+        }
+        memset(slot.StatsMapped, 0, sizeof(OcclusionStats));
+
+        u32 count = static_cast<u32>(scene.Entities.size());
+        EnsureCapacity(count);
+        EnsureSlotCapacity(slot, count);
+        UpdateSlotDescriptors(slot);
+        m_InstanceCount = count;
+        m_RenderExtent = renderExtent;
+
+        auto* header = static_cast<OcclusionCullHeader*>(slot.InstanceMapped);
+        header->WorldToClip = worldToClip;
+        Frustum frustum = Frustum::FromMatrix(worldToClip);
+        for (u32 i = 0; i < 6; i++) {
+            header->Planes[i] = frustum.Planes[i];
+        }
+        header->HiZ = glm::vec4(m_HiZExtent.width, m_HiZExtent.height, m_HiZMipCount, 0.0f);
+        header->Counts = glm::uvec4(count, m_Capacity, 0, 0);
+
+        // Spheres go to world space here rather than in the shader, so the GPU needs no model matrices.
+        auto* instances = reinterpret_cast<OcclusionCullInstance*>(header + 1);
+        for (u32 i = 0; i < count; i++) {
+            const Entity& e = scene.Entities[i];
+            instances[i].Sphere = e.Mesh.Model->GetBoundingSphere(e.Transform.ModelMatrix);
+            const MeshLod& lod = e.Mesh.Model->GetLod(lods.empty() ? 0 : lods[i]);
+            instances[i].Draw = glm::uvec4(lod.IndexCount, lod.FirstIndex, 0, 0);
+        }
+        m_GraphicsDevice->Counters.BytesUploaded += sizeof(OcclusionCullHeader) + sizeof(OcclusionCullInstance) * count;
+    }
+
+    void OcclusionCuller::RecordEarlyCull(VkCommandBuffer commandBuffer) {
+        CORTEX_PROFILE_FUNCTION();
+        OcclusionCullerSlot& slot = m_Slots[m_CurrentSlot];
+        slot.Pending = true;
+
+        if (!m_HiZInitialized) {
+            VkImageMemoryBarrier barrier = {};
+            barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.image = m_HiZImage;
+            barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, m_HiZMipCount, 0, 1};
+            barrier.srcAccessMask = 0;
+            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+            m_HiZInitialized = true;
+        }
+        if (!m_VisibilityCleared) {
+            vkCmdFillBuffer(commandBuffer, m_VisibilityBuffer, 0, VK_WHOLE_SIZE, 0);
+            occlusion_memory_barrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                                     VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+            m_VisibilityCleared = true;
+        }
+        if (m_InstanceCount == 0) { return; }
+
+        // The previous frame's draws may still be reading the draw buffer, and its late cull writing
+        // visibility and the pyramid.
+        occlusion_memory_barrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+
+        u32 phase = 0;
+        m_CullPipeline->Bind(commandBuffer);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_CullPipeline->GetLayout(), 0, 1, &slot.CullSet, 0, nullptr);
+        m_GraphicsDevice->Counters.DescriptorBinds++;
+        vkCmdPushConstants(commandBuffer, m_CullPipeline->GetLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(phase), &phase);
+        vkCmdDispatch(commandBuffer, (m_InstanceCount + OCCLUSION_CULL_GROUP_SIZE - 1) / OCCLUSION_CULL_GROUP_SIZE, 1, 1);
+
+        occlusion_memory_barrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                                 VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
+    }
+
+    void OcclusionCuller::RecordLateCull(VkCommandBuffer commandBuffer, VkImageView depthView) {
+        CORTEX_PROFILE_FUNCTION();
+        if (m_InstanceCount == 0) { return; }
+        VkDevice device = m_GraphicsDevice->Device;
+        OcclusionCullerSlot& slot = m_Slots[m_CurrentSlot];
+
+        // The slot's previous frame has completed, so its init set can be repointed at a new depth view.
+        if (slot.DepthView != depthView) {
+            VkDescriptorImageInfo depthInfo = {};
+            depthInfo.sampler = m_HiZSampler;
+            depthInfo.imageView = depthView;
+            depthInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+            VkWriteDescriptorSet write = {};
+            write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write.dstSet = slot.InitSet;
+            write.dstBinding = 0;
+            write.dstArrayElement = 0;
+            write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            write.descriptorCount = 1;
+            write.pImageInfo = &depthInfo;
+            vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+            slot.DepthView = depthView;
+        }
+
+        struct {
+            glm::ivec2 DepthSize;
+            glm::ivec2 HiZSize;
+            i32 Samples;
+        } init;
+        init.DepthSize = glm::ivec2(m_RenderExtent.width, m_RenderExtent.height);
+        init.HiZSize = glm::ivec2(m_HiZExtent.width, m_HiZExtent.height);
+        init.Samples = static_cast<i32>(m_DepthSamples);
+
+        auto& initPipeline = m_DepthSamples == VK_SAMPLE_COUNT_1_BIT ? m_InitPipeline : m_InitMultisampledPipeline;
+        initPipeline->Bind(commandBuffer);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, initPipeline->GetLayout(), 0, 1, &slot.InitSet, 0, nullptr);
+        m_GraphicsDevice->Counters.DescriptorBinds++;
+        vkCmdPushConstants(commandBuffer, initPipeline->GetLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(init), &init);
+        vkCmdDispatch(commandBuffer, (m_HiZExtent.width + OCCLUSION_HIZ_GROUP_SIZE - 1) / OCCLUSION_HIZ_GROUP_SIZE,
+                      (m_HiZExtent.height + OCCLUSION_HIZ_GROUP_SIZE - 1) / OCCLUSION_HIZ_GROUP_SIZE, 1);
+
+        if (m_HiZMipCount > 1) {
+            m_ReducePipeline->Bind(commandBuffer);
+        }
+        for (u32 mip = 1; mip < m_HiZMipCount; mip++) {
+            occlusion_memory_barrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                                     VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+            glm::ivec2 sourceSize = glm::max(glm::ivec2(m_HiZExtent.width >> (mip - 1), m_HiZExtent.height >> (mip - 1)), glm::ivec2(1));
+            glm::ivec2 size = glm::max(sourceSize / 2, glm::ivec2(1));
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_ReducePipeline->GetLayout(), 0, 1, &m_ReduceSets[mip - 1], 0, nullptr);
+            m_GraphicsDevice->Counters.DescriptorBinds++;
+            vkCmdPushConstants(commandBuffer, m_ReducePipeline->GetLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(sourceSize), &sourceSize);
+            vkCmdDispatch(commandBuffer, (size.x + OCCLUSION_HIZ_GROUP_SIZE - 1) / OCCLUSION_HIZ_GROUP_SIZE,
+                          (size.y + OCCLUSION_HIZ_GROUP_SIZE - 1) / OCCLUSION_HIZ_GROUP_SIZE, 1);
+        }
+        occlusion_memory_barrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+
+        u32 phase = 1;
+        m_CullPipeline->Bind(commandBuffer);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_CullPipeline->GetLayout(), 0, 1, &slot.CullSet, 0, nullptr);
+        m_GraphicsDevice->Counters.DescriptorBinds++;
+        vkCmdPushConstants(commandBuffer, m_CullPipeline->GetLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(phase), &phase);
+        vkCmdDispatch(commandBuffer, (m_InstanceCount + OCCLUSION_CULL_GROUP_SIZE - 1) / OCCLUSION_CULL_GROUP_SIZE, 1, 1);
+
+        // The stats are read on the CPU once the frame's fence has signalled.
+        occlusion_memory_barrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                                 VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_HOST_READ_BIT);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "Cortex/Graphics/VulkanHelpers.hpp"
+#include "Cortex/Graphics/VulkanTypes.hpp"
+#include "Cortex/Graphics/GraphicsDevice.hpp"
+
+#include "Cortex/Graphics/Pipeline.hpp"
+#include "Cortex/Graphics/Shader.hpp"
+#include "Cortex/Graphics/FrameStats.hpp"
+
+#include "Cortex/Core/Scene.hpp"
+
+namespace Cortex {
+    #define OCCLUSION_HIZ_MAX_MIPS 16
+    #define OCCLUSION_INITIAL_CAPACITY 1024
+    #define OCCLUSION_CULL_GROUP_SIZE 64    // local_size_x of cull.comp
+    #define OCCLUSION_HIZ_GROUP_SIZE 8      // local_size_x/y of hiz_init.comp and hiz_reduce.comp
+
+    // Header of the instance buffer cull.comp reads, std430.
+    struct OcclusionCullHeader {
+        glm::mat4 WorldToClip;
+        glm::vec4 Planes[6];
+        glm::vec4 HiZ;      // pyramid width, height, mip count, unused
+        glm::uvec4 Counts;  // instances, draw buffer capacity per phase, unused, unused
+    };
+
+    struct OcclusionCullInstance {
+        glm::vec4 Sphere;   // world space center and radius
+        glm::uvec4 Draw;    // index count, first index, unused, unused
+    };
+
+    struct OcclusionCullerSlot {
+        VkBuffer InstanceBuffer = VK_NULL_HANDLE;
+        VkDeviceMemory InstanceMemory = VK_NULL_HANDLE;
+        void* InstanceMapped = nullptr;
+        u32 InstanceCapacity = 0;
+        VkBuffer StatsBuffer = VK_NULL_HANDLE;
+        VkDeviceMemory StatsMemory = VK_NULL_HANDLE;
+        void* StatsMapped = nullptr;
+        VkDescriptorPool Pool = VK_NULL_HANDLE;    // the pool its sets came from
+        VkDescriptorSet CullSet = VK_NULL_HANDLE;
+        VkDescriptorSet InitSet = VK_NULL_HANDLE;
+        u64 Generation = 0;                         // of the buffers and pyramid its sets point at
+        VkImageView DepthView = VK_NULL_HANDLE;     // the depth view its init set points at
+        bool Pending = false;                       // stats written by a frame not yet read back
+    };
+
+    // Two-phase GPU occlusion culling against a hierarchical depth pyramid. Phase 0 draws what was
+    // visible last frame; its depth is reduced into the pyramid, everything is tested against it, and
+    // phase 1 draws whatever turned out visible without having been drawn already. Each entity gets an
+    // indirect draw per phase, written by the cull shader, which draws it or draws nothing.
+    class OcclusionCuller {
+        public:
+            static std::unique_ptr<OcclusionCuller> Create(std::shared_ptr<GraphicsDevice> device, std::shared_ptr<ShaderLibrary> library);
+            OcclusionCuller(std::shared_ptr<GraphicsDevice> device, std::shared_ptr<ShaderLibrary> library);
+            ~OcclusionCuller();
+            OcclusionCuller(const OcclusionCuller&) = delete;
+            OcclusionCuller &operator=(const OcclusionCuller&) = delete;
+            // Sizes the pyramid for the largest depth buffer the graph renders; cheap when nothing changed.
+            void Resize(VkExtent2D maxDepthExtent, VkSampleCountFlagBits samples);
+            // Reads back the stats the slot's previous frame wrote, then uploads this frame's bounds and the
+            // level of detail each entity draws (lods[i], or the finest if lods is empty). The slot's
+            // previous frame must have completed.
+            void BeginFrame(u32 slot, const Scene& scene, const std::vector<u8>& lods, const glm::mat4& worldToClip, VkExtent2D renderExtent);
+            void RecordEarlyCull(VkCommandBuffer commandBuffer);
+            // Builds the pyramid from the depth phase 0 left behind, then tests every entity against it.
+            void RecordLateCull(VkCommandBuffer commandBuffer, VkImageView depthView);
+            inline VkBuffer GetDrawBuffer() { return m_DrawBuffer; }
+            inline VkDeviceSize GetDrawOffset(u32 phase, u32 entity) { return (static_cast<VkDeviceSize>(phase) * m_Capacity + entity) * sizeof(VkDrawIndexedIndirectCommand); }
+            inline const OcclusionStats& GetStats() { return m_Stats; }
+        private:
+            void EnsureCapacity(u32 count);
+            void EnsureSlotCapacity(OcclusionCullerSlot& slot, u32 count);
+            void UpdateSlotDescriptors(OcclusionCullerSlot& slot);
+            void ReleasePyramid();
+
+            std::shared_ptr<GraphicsDevice> m_GraphicsDevice;
+            std::shared_ptr<ComputePipeline> m_CullPipeline;
+            std::shared_ptr<ComputePipeline> m_InitPipeline;
+            std::shared_ptr<ComputePipeline> m_InitMultisampledPipeline;
+            std::shared_ptr<ComputePipeline> m_ReducePipeline;
+            VkDescriptorSetLayout m_CullSetLayout;
+            VkDescriptorSetLayout m_InitSetLayout;
+            VkDescriptorSetLayout m_InitMultisampledSetLayout;
+            VkDescriptorSetLayout m_ReduceSetLayout;
+            std::array<OcclusionCullerSlot, MAX_FRAMES_IN_FLIGHT_LIMIT> m_Slots;
+            u32 m_CurrentSlot;
+            u32 m_InstanceCount;
+            VkExtent2D m_RenderExtent;
+            u64 m_Generation;
+
+            // Shared by every slot: visibility carries over from one frame to the next, and the draws are
+            // consumed within the frame that writes them.
+            u32 m_Capacity;
+            VkBuffer m_VisibilityBuffer;
+            VkDeviceMemory m_VisibilityMemory;
+            bool m_VisibilityCleared;
+            VkBuffer m_DrawBuffer;
+            VkDeviceMemory m_DrawMemory;
+
+            // The pyramid stays in VK_IMAGE_LAYOUT_GENERAL; it is only ever touched by compute.
+            VkExtent2D m_DepthExtent;
+            VkSampleCountFlagBits m_DepthSamples;
+            VkExtent2D m_HiZExtent;
+            u32 m_HiZMipCount;
+            VkImage m_HiZImage;
+            VkDeviceMemory m_HiZMemory;
+            VkImageView m_HiZView;
+            std::vector<VkImageView> m_HiZMipViews;
+            bool m_HiZInitialized;
+            VkSampler m_HiZSampler;
+            VkDescriptorPool m_DescriptorPool;
+            std::vector<VkDescriptorSet> m_ReduceSets;    // one per mip after the first
+
+            OcclusionStats m_Stats;
+    };
+}
\ No newline at end of file
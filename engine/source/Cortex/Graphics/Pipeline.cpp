@@ -9,6 +9,9 @@ namespace Cortex {
             VK_DYNAMIC_STATE_SCISSOR
         };
 
+        config.VertexBindings = vertex_bindings<VulkanVertex>();
+        config.VertexAttributes = vertex_attributes<VulkanVertex>();
+
         config.Viewport = {};
         config.Viewport.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
         config.Viewport.scissorCount = 1;
@@ -70,10 +73,8 @@ namespace Cortex {
 
         ASSERT(config.RenderPass != VK_NULL_HANDLE, "Cannot create graphics pipeline without a valid RenderPass"); 
 
-        auto bindings = VulkanVertex::BindingDescriptions();
-        auto attributes = VulkanVertex::AttributeDescriptions();
-
-        config.Multisampler.rasterizationSamples = device->Details.MaxMultisamplingCount;
+        const auto& bindings = config.VertexBindings;
+        const auto& attributes = config.VertexAttributes;
 
         VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
         vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -91,13 +92,13 @@ namespace Cortex {
         colorBlendInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
         colorBlendInfo.logicOpEnable = VK_FALSE;
         colorBlendInfo.logicOp = VK_LOGIC_OP_COPY;
-        colorBlendInfo.attachmentCount = 1;
-        colorBlendInfo.pAttachments = &config.ColorBlendAttachment;
+        colorBlendInfo.attachmentCount = config.ColorAttachmentCount;
+        colorBlendInfo.pAttachments = config.ColorAttachmentCount > 0 ? &config.ColorBlendAttachment : nullptr;
 
         VkGraphicsPipelineCreateInfo createInfo = {};
         createInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
         
-        createInfo.stageCount = 2;
+        createInfo.stageCount = static_cast<u32>(m_Shader->GetShaderStageCreateInfos().size());
         createInfo.pStages = m_Shader->GetShaderStageCreateInfos().data();
 
         createInfo.pVertexInputState = &vertexInputInfo;
@@ -113,7 +114,7 @@ namespace Cortex {
         createInfo.layout = m_PipelineLayout;
 
         createInfo.renderPass = config.RenderPass;
-        createInfo.subpass = 0;
+        createInfo.subpass = config.SubpassIndex;
 
         createInfo.basePipelineHandle = VK_NULL_HANDLE;
         createInfo.basePipelineIndex = -1;
@@ -123,10 +124,52 @@ namespace Cortex {
     }
     
     Pipeline::~Pipeline() {
-        vkDestroyPipeline(m_GraphicsDevice->Device, m_PipelineHandle, nullptr);
+        VkDevice device = m_GraphicsDevice->Device;
+        VkPipeline pipeline = m_PipelineHandle;
+        m_GraphicsDevice->PendingDeletions.Push([=]() {
+            vkDestroyPipeline(device, pipeline, nullptr);
+        });
     }
     
     void Pipeline::Bind(VkCommandBuffer commandBuffer) {
         vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineHandle);
+        m_GraphicsDevice->Counters.PipelineBinds++;
+    }
+
+    std::shared_ptr<ComputePipeline> ComputePipeline::Create(std::shared_ptr<GraphicsDevice> device, std::shared_ptr<Shader> shader) {
+        return std::make_shared<ComputePipeline>(device, shader);
+    }
+
+    ComputePipeline::ComputePipeline(std::shared_ptr<GraphicsDevice> device, std::shared_ptr<Shader> shader) {
+        m_GraphicsDevice = device;
+        m_Shader = shader;
+
+        const auto& stages = m_Shader->GetShaderStageCreateInfos();
+        ASSERT(stages.size() == 1 && stages[0].stage == VK_SHADER_STAGE_COMPUTE_BIT, "Cannot create a compute pipeline from a shader without a single compute stage.");
+
+        m_PipelineLayout = shader->GetPipelineLayout();
+
+        VkComputePipelineCreateInfo createInfo = {};
+        createInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        createInfo.stage = stages[0];
+        createInfo.layout = m_PipelineLayout;
+        createInfo.basePipelineHandle = VK_NULL_HANDLE;
+        createInfo.basePipelineIndex = -1;
+
+        VkResult result = vkCreateComputePipelines(m_GraphicsDevice->Device, VK_NULL_HANDLE, 1, &createInfo, nullptr, &m_PipelineHandle);
+        ASSERT(result == VK_SUCCESS, "Failed to create a Vulkan compute pipeline!");
+    }
+
+    ComputePipeline::~ComputePipeline() {
+        VkDevice device = m_GraphicsDevice->Device;
+        VkPipeline pipeline = m_PipelineHandle;
+        m_GraphicsDevice->PendingDeletions.Push([=]() {
+            vkDestroyPipeline(device, pipeline, nullptr);
+        });
+    }
+
+    void ComputePipeline::Bind(VkCommandBuffer commandBuffer) {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_PipelineHandle);
+        m_GraphicsDevice->Counters.PipelineBinds++;
     }
 }
\ No newline at end of file
@@ -3,17 +3,21 @@
 #include "Cortex/Graphics/VulkanHelpers.hpp"
 #include "Cortex/Graphics/VulkanTypes.hpp"
 #include "Cortex/Graphics/GraphicsDevice.hpp"
+#include "Cortex/Graphics/VertexLayout.hpp"
 
 #include "Cortex/Graphics/Shader.hpp"
 
 namespace Cortex {
     struct VulkanPipelineConfig {
         std::vector<VkDynamicState> DynamicStates;
+        std::vector<VkVertexInputBindingDescription> VertexBindings;
+        std::vector<VkVertexInputAttributeDescription> VertexAttributes;
         VkPipelineViewportStateCreateInfo Viewport;
         VkPipelineInputAssemblyStateCreateInfo InputAssembly;
         VkPipelineRasterizationStateCreateInfo Rasterizer;
         VkPipelineMultisampleStateCreateInfo Multisampler;
         VkPipelineColorBlendAttachmentState ColorBlendAttachment;
+        u32 ColorAttachmentCount = 1;   // 0 for depth-only passes
         VkPipelineDepthStencilStateCreateInfo DepthStencil;
         VkRenderPass RenderPass = nullptr;
         u32 SubpassIndex = 0;
@@ -35,4 +39,20 @@ namespace Cortex {
             VkPipeline m_PipelineHandle;
             VkPipelineLayout m_PipelineLayout;
     };
+
+    class ComputePipeline {
+        public:
+            static std::shared_ptr<ComputePipeline> Create(std::shared_ptr<GraphicsDevice> device, std::shared_ptr<Shader> shader);
+            ComputePipeline(std::shared_ptr<GraphicsDevice> device, std::shared_ptr<Shader> shader);
+            ~ComputePipeline();
+            ComputePipeline(const ComputePipeline&) = delete;
+            ComputePipeline &operator=(const ComputePipeline&) = delete;
+            void Bind(VkCommandBuffer commandBuffer);
+            inline VkPipelineLayout GetLayout() { return m_PipelineLayout; }
+        private:
+            std::shared_ptr<GraphicsDevice> m_GraphicsDevice;
+            std::shared_ptr<Shader> m_Shader;
+            VkPipeline m_PipelineHandle;
+            VkPipelineLayout m_PipelineLayout;
+    };
 }
\ No newline at end of file
@@ -0,0 +1,158 @@
+#include "Cortex/Graphics/QueueSync.hpp"
+
+namespace Cortex {
+    std::unique_ptr<QueueSync> QueueSync::Create(VkDevice device, const VulkanQueues& queues) {
+        return std::make_unique<QueueSync>(device, queues);
+    }
+
+    QueueSync::QueueSync(VkDevice device, const VulkanQueues& queues) {
+        m_Device = device;
+        m_Queues[(u32)QueueType::Graphics] = queues.Graphics;
+        m_Queues[(u32)QueueType::Transfer] = queues.Transfer;
+        m_Queues[(u32)QueueType::Compute] = queues.Compute;
+        m_SubmittedValues.fill(0);
+        m_CompletedValues.fill(0);
+
+        VkSemaphoreTypeCreateInfo typeInfo = {};
+        typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+        typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        typeInfo.initialValue = 0;
+
+        VkSemaphoreCreateInfo createInfo = {};
+        createInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        createInfo.pNext = &typeInfo;
+
+        for (u32 i = 0; i < QUEUE_TYPE_COUNT; i++) {
+            VkResult result = vkCreateSemaphore(m_Device, &createInfo, nullptr, &m_Semaphores[i]);
+            ASSERT(result == VK_SUCCESS, "Failed to create a timeline semaphore!");
+        }
+    }
+
+    QueueSync::~QueueSync() {
+        for (auto semaphore : m_Semaphores) {
+            vkDestroySemaphore(m_Device, semaphore, nullptr);
+        }
+    }
+
+    QueuePoint QueueSync::Submit(QueueType queue, const QueueSubmitInfo& info) {
+        u32 index = (u32)queue;
+        ASSERT(m_Queues[index] != VK_NULL_HANDLE, "Submitting to a queue the device does not have.");
+
+        // Timeline and binary semaphores share the arrays; binary entries take a value that is ignored.
+        // Values handed to Vulkan are uint64_t, which is not u64 on every platform.
+        std::vector<VkSemaphore> waitSemaphores;
+        std::vector<uint64_t> waitValues;
+        std::vector<VkPipelineStageFlags> waitStages;
+        for (const auto& wait : info.Waits) {
+            if (wait.Point.Value == 0) {
+                continue;
+            }
+            waitSemaphores.push_back(m_Semaphores[(u32)wait.Point.Queue]);
+            waitValues.push_back(wait.Point.Value);
+            waitStages.push_back(wait.Stages);
+        }
+        if (info.WaitBinary != VK_NULL_HANDLE) {
+            waitSemaphores.push_back(info.WaitBinary);
+            waitValues.push_back(0);
+            waitStages.push_back(info.WaitBinaryStages);
+        }
+
+        u64 signalValue = m_SubmittedValues[index] + 1;
+        std::vector<VkSemaphore> signalSemaphores = { m_Semaphores[index] };
+        std::vector<uint64_t> signalValues = { signalValue };
+        if (info.SignalBinary != VK_NULL_HANDLE) {
+            signalSemaphores.push_back(info.SignalBinary);
+            signalValues.push_back(0);
+        }
+
+        VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+        timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        timelineInfo.waitSemaphoreValueCount = static_cast<u32>(waitValues.size());
+        timelineInfo.pWaitSemaphoreValues = waitValues.data();
+        timelineInfo.signalSemaphoreValueCount = static_cast<u32>(signalValues.size());
+        timelineInfo.pSignalSemaphoreValues = signalValues.data();
+
+        VkSubmitInfo submitInfo = {};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.pNext = &timelineInfo;
+        submitInfo.waitSemaphoreCount = static_cast<u32>(waitSemaphores.size());
+        submitInfo.pWaitSemaphores = waitSemaphores.data();
+        submitInfo.pWaitDstStageMask = waitStages.data();
+        submitInfo.commandBufferCount = static_cast<u32>(info.CommandBuffers.size());
+        submitInfo.pCommandBuffers = info.CommandBuffers.data();
+        submitInfo.signalSemaphoreCount = static_cast<u32>(signalSemaphores.size());
+        submitInfo.pSignalSemaphores = signalSemaphores.data();
+
+        VkResult result = vkQueueSubmit(m_Queues[index], 1, &submitInfo, VK_NULL_HANDLE);
+        ASSERT(result == VK_SUCCESS, "Failed to submit command buffers!");
+
+        m_SubmittedValues[index] = signalValue;
+        return {queue, signalValue};
+    }
+
+    u64 QueueSync::GetCompletedValue(QueueType queue) {
+        u32 index = (u32)queue;
+        if (m_CompletedValues[index] < m_SubmittedValues[index]) {
+            uint64_t value = 0;
+            vkGetSemaphoreCounterValue(m_Device, m_Semaphores[index], &value);
+            m_CompletedValues[index] = std::max<u64>(m_CompletedValues[index], value);
+        }
+        return m_CompletedValues[index];
+    }
+
+    bool QueueSync::IsComplete(const QueuePoint& point) {
+        if (point.Value <= m_CompletedValues[(u32)point.Queue]) {
+            return true;
+        }
+        return point.Value <= GetCompletedValue(point.Queue);
+    }
+
+    bool QueueSync::Wait(const QueuePoint& point, u64 timeout) {
+        return Wait(std::vector<QueuePoint>{ point }, timeout);
+    }
+
+    bool QueueSync::Wait(const std::vector<QueuePoint>& points, u64 timeout) {
+        // Only the furthest point on each queue matters; everything before it completes first.
+        QueueValues targets = {};
+        for (const auto& point : points) {
+            ASSERT(point.Value <= m_SubmittedValues[(u32)point.Queue], "Waiting on a queue value that was never submitted would never return.");
+            targets[(u32)point.Queue] = std::max(targets[(u32)point.Queue], point.Value);
+        }
+
+        std::vector<VkSemaphore> semaphores;
+        std::vector<uint64_t> values;
+        for (u32 i = 0; i < QUEUE_TYPE_COUNT; i++) {
+            if (targets[i] > m_CompletedValues[i]) {
+                semaphores.push_back(m_Semaphores[i]);
+                values.push_back(targets[i]);
+            }
+        }
+        if (semaphores.empty()) {
+            return true;
+        }
+
+        VkSemaphoreWaitInfo waitInfo = {};
+        waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        waitInfo.semaphoreCount = static_cast<u32>(semaphores.size());
+        waitInfo.pSemaphores = semaphores.data();
+        waitInfo.pValues = values.data();
+        VkResult result = vkWaitSemaphores(m_Device, &waitInfo, timeout);
+        if (result != VK_SUCCESS) {
+            ASSERT(result == VK_TIMEOUT, "Failed to wait on timeline semaphores!");
+            return false;
+        }
+
+        for (u32 i = 0; i < QUEUE_TYPE_COUNT; i++) {
+            m_CompletedValues[i] = std::max(m_CompletedValues[i], targets[i]);
+        }
+        return true;
+    }
+
+    void QueueSync::WaitIdle() {
+        std::vector<QueuePoint> points;
+        for (u32 i = 0; i < QUEUE_TYPE_COUNT; i++) {
+            points.push_back({(QueueType)i, m_SubmittedValues[i]});
+        }
+        Wait(points);
+    }
+}
\ No newline at end of file
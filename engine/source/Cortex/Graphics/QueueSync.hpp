@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Cortex/Graphics/VulkanTypes.hpp"
+
+namespace Cortex {
+    #define QUEUE_TYPE_COUNT 3
+
+    // Queues that take submissions. Present is not listed: it only ever waits on binary semaphores.
+    enum class QueueType {
+        Graphics = 0,
+        Transfer = 1,
+        Compute = 2
+    };
+
+    using QueueValues = std::array<u64, QUEUE_TYPE_COUNT>;
+
+    // A position on one queue's timeline. Work is complete once that queue's semaphore reaches Value;
+    // a Value of 0 is always complete.
+    struct QueuePoint {
+        QueueType Queue;
+        u64 Value;
+    };
+
+    struct QueueWait {
+        QueuePoint Point;
+        VkPipelineStageFlags Stages;
+    };
+
+    struct QueueSubmitInfo {
+        std::vector<VkCommandBuffer> CommandBuffers;
+        std::vector<QueueWait> Waits;
+        // Binary semaphores for the swapchain, which cannot wait on or signal timeline semaphores.
+        VkSemaphore WaitBinary = VK_NULL_HANDLE;
+        VkPipelineStageFlags WaitBinaryStages = 0;
+        VkSemaphore SignalBinary = VK_NULL_HANDLE;
+    };
+
+    // One timeline semaphore per queue, each with a monotonically increasing value. Every submission
+    // signals the next value on its queue, so "has this work finished" becomes a counter comparison and
+    // cross-queue dependencies are just (queue, value) pairs handed to the next submission.
+    class QueueSync {
+        public:
+            static std::unique_ptr<QueueSync> Create(VkDevice device, const VulkanQueues& queues);
+            QueueSync(VkDevice device, const VulkanQueues& queues);
+            ~QueueSync();
+            QueueSync(const QueueSync&) = delete;
+            QueueSync &operator=(const QueueSync&) = delete;
+
+            QueuePoint Submit(QueueType queue, const QueueSubmitInfo& info);
+
+            inline u64 GetSubmittedValue(QueueType queue) const { return m_SubmittedValues[(u32)queue]; }
+            inline const QueueValues& GetSubmittedValues() const { return m_SubmittedValues; }
+            inline QueuePoint GetLastSubmitted(QueueType queue) const { return {queue, m_SubmittedValues[(u32)queue]}; }
+            inline VkSemaphore GetSemaphore(QueueType queue) const { return m_Semaphores[(u32)queue]; }
+
+            u64 GetCompletedValue(QueueType queue);
+            bool IsComplete(const QueuePoint& point);
+            bool Wait(const QueuePoint& point, u64 timeout = std::numeric_limits<u64>::max());
+            bool Wait(const std::vector<QueuePoint>& points, u64 timeout = std::numeric_limits<u64>::max());
+            void WaitIdle();
+        private:
+            VkDevice m_Device;
+            std::array<VkQueue, QUEUE_TYPE_COUNT> m_Queues;
+            std::array<VkSemaphore, QUEUE_TYPE_COUNT> m_Semaphores;
+            QueueValues m_SubmittedValues;
+            QueueValues m_CompletedValues; // last values read back, so repeat polls skip the driver call
+    };
+}
\ No newline at end of file
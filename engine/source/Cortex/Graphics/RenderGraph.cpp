@@ -0,0 +1,1396 @@
+#include "Cortex/Graphics/RenderGraph.hpp"
+
+#include <set>
+
+namespace Cortex {
+
+    // BUILDER
+
+    RenderGraphBuilder::RenderGraphBuilder(RenderGraph& graph, RenderGraphPass pass) : m_Graph(graph), m_Pass(pass) {}
+
+    RenderGraphResource RenderGraphBuilder::CreateImage(const std::string& name, const RenderGraphImageDesc& desc) {
+        RenderGraphResourceNode node = {};
+        node.Name = name;
+        node.Desc = desc;
+        node.Imported = false;
+        node.Output = false;
+        node.FinalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        m_Graph.m_Resources.push_back(node);
+        return static_cast<RenderGraphResource>(m_Graph.m_Resources.size() - 1);
+    }
+
+    void RenderGraphBuilder::WriteColor(RenderGraphResource resource) {
+        AddAccess(resource, RenderGraphUsage::ColorAttachment, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, false, {});
+    }
+
+    void RenderGraphBuilder::WriteColor(RenderGraphResource resource, VkClearColorValue clear) {
+        VkClearValue value = {};
+        value.color = clear;
+        AddAccess(resource, RenderGraphUsage::ColorAttachment, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, true, value);
+    }
+
+    void RenderGraphBuilder::WriteDepth(RenderGraphResource resource) {
+        AddAccess(resource, RenderGraphUsage::DepthAttachment, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, false, {});
+    }
+
+    void RenderGraphBuilder::WriteDepth(RenderGraphResource resource, VkClearDepthStencilValue clear) {
+        VkClearValue value = {};
+        value.depthStencil = clear;
+        AddAccess(resource, RenderGraphUsage::DepthAttachment, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, true, value);
+    }
+
+    void RenderGraphBuilder::ReadDepth(RenderGraphResource resource) {
+        AddAccess(resource, RenderGraphUsage::DepthAttachmentReadOnly, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, false, {});
+    }
+
+    void RenderGraphBuilder::ReadInput(RenderGraphResource resource) {
+        AddAccess(resource, RenderGraphUsage::InputAttachment, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, false, {});
+    }
+
+    void RenderGraphBuilder::ResolveColor(RenderGraphResource source, RenderGraphResource destination) {
+        AddAccess(destination, RenderGraphUsage::ResolveAttachment, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, false, {});
+        m_Graph.m_Passes[m_Pass].Accesses.back().ResolveSource = source;
+    }
+
+    void RenderGraphBuilder::ReadTexture(RenderGraphResource resource, VkPipelineStageFlags stages) {
+        AddAccess(resource, RenderGraphUsage::SampledRead, stages, false, {});
+    }
+
+    void RenderGraphBuilder::ReadStorage(RenderGraphResource resource, VkPipelineStageFlags stages) {
+        AddAccess(resource, RenderGraphUsage::StorageRead, stages, false, {});
+    }
+
+    void RenderGraphBuilder::WriteStorage(RenderGraphResource resource, VkPipelineStageFlags stages) {
+        AddAccess(resource, RenderGraphUsage::StorageWrite, stages, false, {});
+    }
+
+    void RenderGraphBuilder::SetSideEffect() {
+        m_Graph.m_Passes[m_Pass].SideEffect = true;
+    }
+
+    void RenderGraphBuilder::SetAsyncCompute() {
+        m_Graph.m_Passes[m_Pass].AsyncCompute = true;
+    }
+
+    void RenderGraphBuilder::AddAccess(RenderGraphResource resource, RenderGraphUsage usage, VkPipelineStageFlags stages, bool clear, VkClearValue clearValue) {
+        ASSERT(resource < m_Graph.m_Resources.size(), "Render graph pass references an unknown resource.");
+        auto& pass = m_Graph.m_Passes[m_Pass];
+        for (const auto& access : pass.Accesses) {
+            ASSERT(access.Resource != resource, "A render graph pass may only access each resource once.");
+        }
+        RenderGraphAccess access = {};
+        access.Resource = resource;
+        access.Usage = usage;
+        access.Stages = stages;
+        access.Clear = clear;
+        access.ClearValue = clearValue;
+        access.ResolveSource = RENDER_GRAPH_INVALID_HANDLE;
+        pass.Accesses.push_back(access);
+    }
+
+    // GRAPH
+
+    std::unique_ptr<RenderGraph> RenderGraph::Create(std::shared_ptr<GraphicsDevice> device) {
+        return std::make_unique<RenderGraph>(device);
+    }
+
+    RenderGraph::RenderGraph(std::shared_ptr<GraphicsDevice> device) {
+        m_GraphicsDevice = device;
+        m_Stats = {};
+        m_Compiled = false;
+        m_Profiler = nullptr;
+        m_AsyncWaitStages = 0;
+        m_AsyncComputeWait = {{QueueType::Compute, 0}, 0};
+    }
+
+    RenderGraph::~RenderGraph() {
+        ReleasePhysicalResources();
+        RetireTransientCache();
+
+        VkDevice device = m_GraphicsDevice->Device;
+        std::vector<VkRenderPass> renderPasses;
+        for (auto& entry : m_RenderPassCache) {
+            renderPasses.push_back(entry.second);
+        }
+        std::vector<VkCommandPool> commandPools;
+        for (auto& commandBuffer : m_ComputeCommandBuffers) {
+            commandPools.push_back(commandBuffer.CommandPool);
+        }
+        m_GraphicsDevice->PendingDeletions.Push([=]() {
+            for (VkRenderPass renderPass : renderPasses) {
+                vkDestroyRenderPass(device, renderPass, nullptr);
+            }
+            for (VkCommandPool commandPool : commandPools) {
+                vkDestroyCommandPool(device, commandPool, nullptr);
+            }
+        });
+    }
+
+    RenderGraphResource RenderGraph::ImportImage(const std::string& name, const RenderGraphImageDesc& desc, VkImageLayout initialLayout, VkImageLayout finalLayout) {
+        RenderGraphResourceNode node = {};
+        node.Name = name;
+        node.Desc = desc;
+        node.Imported = true;
+        node.Output = finalLayout != VK_IMAGE_LAYOUT_UNDEFINED;
+        node.FinalLayout = finalLayout;
+        node.InitialState.Layout = initialLayout;
+        // Imported images are typically handed to us straight from a semaphore wait on the colour output stage.
+        node.InitialState.Stages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        node.InitialState.Access = 0;
+        m_Resources.push_back(node);
+        return static_cast<RenderGraphResource>(m_Resources.size() - 1);
+    }
+
+    void RenderGraph::SetImportedImage(RenderGraphResource resource, VkImage image, VkImageView view) {
+        ASSERT(m_Resources[resource].Imported, "Only imported render graph resources can be bound externally.");
+        m_Resources[resource].Image = image;
+        m_Resources[resource].View = view;
+    }
+
+    RenderGraphPass RenderGraph::AddPass(const std::string& name, std::function<void(RenderGraphBuilder&)> setup, std::function<void(VkCommandBuffer)> execute) {
+        RenderGraphPassNode node = {};
+        node.Name = name;
+        node.SideEffect = false;
+        node.AsyncCompute = false;
+        node.Execute = execute;
+        node.RenderArea = {0, 0};
+        m_Passes.push_back(node);
+
+        RenderGraphPass handle = static_cast<RenderGraphPass>(m_Passes.size() - 1);
+        RenderGraphBuilder builder(*this, handle);
+        setup(builder);
+        m_Compiled = false;
+        return handle;
+    }
+
+    void RenderGraph::Compile() {
+        CORTEX_PROFILE_SCOPE("RenderGraph::Compile");
+        ReleasePhysicalResources();
+        m_Stats = {};
+
+        CullPasses();
+        BuildGroups();
+        ComputeLifetimes();
+        ComputeAttachmentOps();
+        AllocateTransients();
+        ComputeBarriers();
+        CreateRenderPasses();
+
+        m_Compiled = true;
+    }
+
+    void RenderGraph::Execute(VkCommandBuffer commandBuffer) {
+        CORTEX_PROFILE_SCOPE("RenderGraph::Execute");
+        ASSERT(m_Compiled, "Render graph must be compiled before it is executed.");
+
+        // Submitted first so the compute queue starts while graphics work is still being recorded.
+        m_AsyncComputeWait = {{QueueType::Compute, 0}, 0};
+        if (m_Stats.AsyncPassCount > 0) {
+            SubmitAsyncCompute();
+        }
+
+        for (auto& group : m_Groups) {
+            if (group.Async) { continue; }
+            RecordBarriers(commandBuffer, group.Barriers);
+
+            if (!group.Raster) {
+                for (RenderGraphPass handle : group.Passes) {
+                    GpuProfileScope scope(m_Profiler, commandBuffer, m_Passes[handle].Name, true);
+                    m_Passes[handle].Execute(commandBuffer);
+                }
+                continue;
+            }
+
+            VkRenderPassBeginInfo passBeginInfo = {};
+            passBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+            passBeginInfo.renderPass = group.RenderPass;
+            passBeginInfo.framebuffer = GetFramebuffer(group);
+            passBeginInfo.renderArea.offset = {0, 0};
+            passBeginInfo.renderArea.extent = {0, 0};
+            for (RenderGraphPass handle : group.Passes) {
+                VkExtent2D area = GetRenderArea(handle);
+                passBeginInfo.renderArea.extent.width = std::max(passBeginInfo.renderArea.extent.width, area.width);
+                passBeginInfo.renderArea.extent.height = std::max(passBeginInfo.renderArea.extent.height, area.height);
+            }
+            passBeginInfo.clearValueCount = static_cast<u32>(group.ClearValues.size());
+            passBeginInfo.pClearValues = group.ClearValues.data();
+
+            vkCmdBeginRenderPass(commandBuffer, &passBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+            for (u32 i = 0; i < group.Passes.size(); i++) {
+                if (i > 0) {
+                    vkCmdNextSubpass(commandBuffer, VK_SUBPASS_CONTENTS_INLINE);
+                }
+
+                VkExtent2D area = GetRenderArea(group.Passes[i]);
+                VkViewport viewport = {};
+                viewport.x = 0.0f;
+                viewport.y = 0.0f;
+                viewport.width = static_cast<f32>(area.width);
+                viewport.height = static_cast<f32>(area.height);
+                viewport.minDepth = 0.0f;
+                viewport.maxDepth = 1.0f;
+                vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+                VkRect2D scissor = {};
+                scissor.offset = {0, 0};
+                scissor.extent = area;
+                vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+                // Timestamps are legal inside a render pass, so subpasses are timed individually; the
+                // load and store work of the render pass itself lands in the enclosing scope.
+                GpuProfileScope scope(m_Profiler, commandBuffer, m_Passes[group.Passes[i]].Name, true);
+                m_Passes[group.Passes[i]].Execute(commandBuffer);
+            }
+
+            vkCmdEndRenderPass(commandBuffer);
+        }
+
+        RecordBarriers(commandBuffer, m_FinalBarriers);
+    }
+
+    void RenderGraph::SubmitAsyncCompute() {
+        CORTEX_PROFILE_SCOPE("RenderGraph::SubmitAsyncCompute");
+        u32 index;
+        VkCommandBuffer commandBuffer = AcquireComputeCommandBuffer(index);
+
+        VkCommandBufferBeginInfo beginInfo = {};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        VkResult result = vkBeginCommandBuffer(commandBuffer, &beginInfo);
+        ASSERT(result == VK_SUCCESS, "Failed to begin recording an async compute command buffer!");
+
+        for (auto& group : m_Groups) {
+            if (!group.Async) { continue; }
+            RecordBarriers(commandBuffer, group.Barriers);
+            for (RenderGraphPass handle : group.Passes) {
+                m_Passes[handle].Execute(commandBuffer);
+            }
+        }
+        RecordBarriers(commandBuffer, m_AsyncReleaseBarriers);
+
+        result = vkEndCommandBuffer(commandBuffer);
+        ASSERT(result == VK_SUCCESS, "Failed to finish recording an async compute command buffer!");
+
+        // Async resources are rewritten every frame, so wait for the graphics work that last consumed
+        // them. That is the previous frame; this frame's graphics work overlaps freely.
+        QueueSubmitInfo submitInfo = {};
+        submitInfo.CommandBuffers = { commandBuffer };
+        submitInfo.Waits = {{ m_GraphicsDevice->Sync->GetLastSubmitted(QueueType::Graphics), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT }};
+        QueuePoint point = m_GraphicsDevice->Sync->Submit(QueueType::Compute, submitInfo);
+
+        m_ComputeCommandBuffers[index].Point = point;
+        // Side-effect-only async work has no graphics consumer for the frame to wait on.
+        if (m_AsyncWaitStages != 0) {
+            m_AsyncComputeWait = {point, m_AsyncWaitStages};
+        }
+    }
+
+    VkCommandBuffer RenderGraph::AcquireComputeCommandBuffer(u32& outIndex) {
+        for (u32 i = 0; i < m_ComputeCommandBuffers.size(); i++) {
+            auto& entry = m_ComputeCommandBuffers[i];
+            if (m_GraphicsDevice->Sync->IsComplete(entry.Point)) {
+                vkResetCommandPool(m_GraphicsDevice->Device, entry.CommandPool, 0);
+                outIndex = i;
+                return entry.CommandBuffer;
+            }
+        }
+
+        // Grows to however many submissions are in flight at once, typically the frames in flight.
+        RenderGraphCommandBuffer entry = {};
+        entry.CommandPool = vulkan_create_command_pool(m_GraphicsDevice->Device, m_GraphicsDevice->QueueIndices.Compute, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+        entry.CommandBuffer = vulkan_create_command_buffer(m_GraphicsDevice->Device, entry.CommandPool);
+        entry.Point = {QueueType::Compute, 0};
+        m_ComputeCommandBuffers.push_back(entry);
+        outIndex = static_cast<u32>(m_ComputeCommandBuffers.size() - 1);
+        return entry.CommandBuffer;
+    }
+
+    void RenderGraph::SetRenderArea(RenderGraphPass pass, VkExtent2D area) {
+        ASSERT(pass < m_Passes.size(), "Invalid render graph pass handle.");
+        m_Passes[pass].RenderArea = area;
+    }
+
+    VkExtent2D RenderGraph::GetRenderArea(RenderGraphPass pass) {
+        const auto& node = m_Passes[pass];
+        const auto& group = m_Groups[node.Group];
+        if (node.RenderArea.width == 0 || node.RenderArea.height == 0) {
+            return group.Extent;
+        }
+        VkExtent2D area;
+        area.width = std::min(node.RenderArea.width, group.Extent.width);
+        area.height = std::min(node.RenderArea.height, group.Extent.height);
+        return area;
+    }
+
+    void RenderGraph::Reset() {
+        ReleasePhysicalResources();
+        m_Passes.clear();
+        m_Resources.clear();
+        m_ExecutionOrder.clear();
+        m_Groups.clear();
+        m_Stats = {};
+        m_Compiled = false;
+    }
+
+    VkRenderPass RenderGraph::GetRenderPass(RenderGraphPass pass) {
+        ASSERT(m_Compiled, "Render graph must be compiled before querying render passes.");
+        ASSERT(!m_Passes[pass].Culled, "Culled render graph passes have no renderpass.");
+        return m_Groups[m_Passes[pass].Group].RenderPass;
+    }
+
+    u32 RenderGraph::GetSubpass(RenderGraphPass pass) {
+        ASSERT(m_Compiled, "Render graph must be compiled before querying subpasses.");
+        return m_Passes[pass].Subpass;
+    }
+
+    VkImageView RenderGraph::GetImageView(RenderGraphResource resource) {
+        ASSERT(m_Compiled || m_Resources[resource].Imported, "Transient render graph images only exist once the graph is compiled.");
+        return m_Resources[resource].View;
+    }
+
+    // COMPILATION
+
+    static bool render_graph_usage_writes(RenderGraphUsage usage) {
+        switch (usage) {
+            case RenderGraphUsage::ColorAttachment:
+            case RenderGraphUsage::ResolveAttachment:
+            case RenderGraphUsage::DepthAttachment:
+            case RenderGraphUsage::StorageWrite:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    static bool render_graph_usage_is_attachment(RenderGraphUsage usage) {
+        switch (usage) {
+            case RenderGraphUsage::ColorAttachment:
+            case RenderGraphUsage::ResolveAttachment:
+            case RenderGraphUsage::DepthAttachment:
+            case RenderGraphUsage::DepthAttachmentReadOnly:
+            case RenderGraphUsage::InputAttachment:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    static bool render_graph_access_overwrites(const RenderGraphAccess& access) {
+        return access.Clear || access.Usage == RenderGraphUsage::ResolveAttachment;
+    }
+
+    void RenderGraph::CullPasses() {
+        // Walk the passes backwards, keeping only those which (transitively) contribute to an output.
+        std::vector<bool> needed(m_Resources.size(), false);
+        for (u32 i = 0; i < m_Resources.size(); i++) {
+            needed[i] = m_Resources[i].Output;
+        }
+
+        for (i32 p = static_cast<i32>(m_Passes.size()) - 1; p >= 0; p--) {
+            auto& pass = m_Passes[p];
+            bool keep = pass.SideEffect;
+            for (const auto& access : pass.Accesses) {
+                if (render_graph_usage_writes(access.Usage) && needed[access.Resource]) {
+                    keep = true;
+                }
+            }
+
+            pass.Culled = !keep;
+            if (!keep) { continue; }
+
+            for (const auto& access : pass.Accesses) {
+                if (render_graph_access_overwrites(access)) {
+                    needed[access.Resource] = false;
+                }
+            }
+            for (const auto& access : pass.Accesses) {
+                if (!render_graph_access_overwrites(access)) {
+                    needed[access.Resource] = true;
+                }
+                if (access.ResolveSource != RENDER_GRAPH_INVALID_HANDLE) {
+                    needed[access.ResolveSource] = true;
+                }
+            }
+        }
+
+        // Every access is recorded at declaration time, so each dependency edge points forward
+        // and declaration order of the surviving passes is already a valid topological order.
+        m_ExecutionOrder.clear();
+        for (u32 p = 0; p < m_Passes.size(); p++) {
+            if (m_Passes[p].Culled) {
+                m_Stats.CulledPassCount++;
+            } else {
+                m_ExecutionOrder.push_back(p);
+            }
+        }
+        m_Stats.PassCount = static_cast<u32>(m_ExecutionOrder.size());
+    }
+
+    void RenderGraph::BuildGroups() {
+        m_Groups.clear();
+
+        // A single compute submission runs ahead of the frame's graphics submission, so an async pass can
+        // only depend on other async passes. Anything graphics has touched this frame keeps it on graphics.
+        bool asyncAvailable = m_GraphicsDevice->Details.AsyncComputeSupported;
+        std::vector<bool> graphicsTouched(m_Resources.size(), false);
+
+        for (RenderGraphPass handle : m_ExecutionOrder) {
+            auto& pass = m_Passes[handle];
+            pass.Raster = false;
+            VkExtent2D extent = {0, 0};
+            for (const auto& access : pass.Accesses) {
+                if (!render_graph_usage_is_attachment(access.Usage)) { continue; }
+                VkExtent2D attachmentExtent = m_Resources[access.Resource].Desc.Extent;
+                ASSERT(!pass.Raster || (attachmentExtent.width == extent.width && attachmentExtent.height == extent.height), "All attachments of a render graph pass must share an extent.");
+                extent = attachmentExtent;
+                pass.Raster = true;
+            }
+
+            pass.Async = pass.AsyncCompute && asyncAvailable && !pass.Raster;
+            for (const auto& access : pass.Accesses) {
+                if (m_Resources[access.Resource].Imported || graphicsTouched[access.Resource]) {
+                    pass.Async = false;
+                }
+            }
+            if (pass.AsyncCompute && asyncAvailable && !pass.Async) {
+                LOG_DEBUG("Render graph pass '%s' depends on graphics work from the same frame, running it on the graphics queue.", pass.Name.c_str());
+            }
+            if (pass.Async) {
+                m_Stats.AsyncPassCount++;
+            } else {
+                for (const auto& access : pass.Accesses) {
+                    graphicsTouched[access.Resource] = true;
+                }
+            }
+
+            // A raster pass joins the previous render pass as a new subpass when it picks up that pass's
+            // attachments directly; anything it would need to sample forces a real render pass boundary.
+            bool merge = false;
+            if (pass.Raster && !m_Groups.empty() && m_Groups.back().Raster) {
+                const auto& group = m_Groups.back();
+                bool shares = false;
+                bool compatible = group.Extent.width == extent.width && group.Extent.height == extent.height;
+                for (const auto& access : pass.Accesses) {
+                    bool touched = false;
+                    for (RenderGraphPass other : group.Passes) {
+                        for (const auto& otherAccess : m_Passes[other].Accesses) {
+                            touched |= otherAccess.Resource == access.Resource;
+                        }
+                    }
+                    if (!touched) { continue; }
+                    if (render_graph_usage_is_attachment(access.Usage)) {
+                        shares = true;
+                    } else {
+                        compatible = false;
+                    }
+                }
+                merge = compatible && shares;
+            }
+
+            if (!merge) {
+                RenderGraphPassGroup group = {};
+                group.Raster = pass.Raster;
+                group.Async = pass.Async;
+                group.Extent = extent;
+                group.RenderPass = VK_NULL_HANDLE;
+                m_Groups.push_back(group);
+            }
+
+            auto& group = m_Groups.back();
+            pass.Group = static_cast<u32>(m_Groups.size() - 1);
+            pass.Subpass = static_cast<u32>(group.Passes.size());
+            group.Passes.push_back(handle);
+
+            if (pass.Raster && merge) {
+                m_Stats.MergedPassCount++;
+            }
+        }
+
+        for (const auto& group : m_Groups) {
+            if (group.Raster) {
+                m_Stats.RenderPassCount++;
+            }
+        }
+    }
+
+    void RenderGraph::ComputeLifetimes() {
+        for (auto& resource : m_Resources) {
+            resource.FirstUse = -1;
+            resource.LastUse = -1;
+            resource.Usage = 0;
+            resource.Async = false;
+            resource.Aspect = vulkan_format_has_depth(resource.Desc.Format) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+            if (vulkan_format_has_stencil(resource.Desc.Format)) {
+                resource.Aspect |= VK_IMAGE_ASPECT_STENCIL_BIT;
+            }
+        }
+
+        // Lifetimes are measured in groups rather than passes: every attachment of a render pass is
+        // bound for its whole duration, so two images in the same render pass may never alias.
+        for (u32 g = 0; g < m_Groups.size(); g++) {
+            for (RenderGraphPass handle : m_Groups[g].Passes) {
+                for (const auto& access : m_Passes[handle].Accesses) {
+                    auto& resource = m_Resources[access.Resource];
+                    if (resource.FirstUse < 0) {
+                        resource.FirstUse = static_cast<i32>(g);
+                    }
+                    resource.LastUse = static_cast<i32>(g);
+                    resource.Async |= m_Groups[g].Async;
+
+                    switch (access.Usage) {
+                        case RenderGraphUsage::ColorAttachment:
+                        case RenderGraphUsage::ResolveAttachment:
+                            resource.Usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+                            break;
+                        case RenderGraphUsage::DepthAttachment:
+                        case RenderGraphUsage::DepthAttachmentReadOnly:
+                            resource.Usage |= VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+                            break;
+                        case RenderGraphUsage::InputAttachment:
+                            resource.Usage |= VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+                            break;
+                        case RenderGraphUsage::SampledRead:
+                            resource.Usage |= VK_IMAGE_USAGE_SAMPLED_BIT;
+                            break;
+                        case RenderGraphUsage::StorageRead:
+                        case RenderGraphUsage::StorageWrite:
+                            resource.Usage |= VK_IMAGE_USAGE_STORAGE_BIT;
+                            break;
+                    }
+                }
+            }
+        }
+
+        const VkImageUsageFlags attachmentUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+        for (auto& resource : m_Resources) {
+            if (resource.Output && resource.FirstUse >= 0) {
+                resource.LastUse = static_cast<i32>(m_Groups.size()) - 1;
+            }
+            // Async work runs alongside whichever graphics groups happen to execute at the same time, so
+            // group order says nothing about when its images are free. Keep them out of aliasing.
+            if (resource.Async) {
+                resource.FirstUse = 0;
+                resource.LastUse = static_cast<i32>(m_Groups.size()) - 1;
+            }
+            // Refined by ComputeAttachmentOps once we know whether contents ever leave tile memory.
+            resource.Memoryless = !resource.Imported && resource.Usage != 0 && (resource.Usage & ~attachmentUsage) == 0;
+        }
+    }
+
+    void RenderGraph::ComputeAttachmentOps() {
+        std::vector<bool> hasContents(m_Resources.size(), false);
+        for (u32 i = 0; i < m_Resources.size(); i++) {
+            hasContents[i] = m_Resources[i].Imported && m_Resources[i].InitialState.Layout != VK_IMAGE_LAYOUT_UNDEFINED;
+        }
+
+        // Contents must be stored if the next access after this group relies on them, or if they leave the graph.
+        auto neededAfter = [&](RenderGraphResource resource, u32 groupIndex) -> bool {
+            for (u32 g = groupIndex + 1; g < m_Groups.size(); g++) {
+                for (RenderGraphPass handle : m_Groups[g].Passes) {
+                    for (const auto& access : m_Passes[handle].Accesses) {
+                        if (access.Resource == resource) {
+                            return !render_graph_access_overwrites(access);
+                        }
+                    }
+                }
+            }
+            return m_Resources[resource].Output;
+        };
+
+        for (u32 g = 0; g < m_Groups.size(); g++) {
+            auto& group = m_Groups[g];
+            group.Attachments.clear();
+            group.AttachmentDescs.clear();
+            group.ClearValues.clear();
+
+            if (group.Raster) {
+                for (RenderGraphPass handle : group.Passes) {
+                    for (const auto& access : m_Passes[handle].Accesses) {
+                        if (!render_graph_usage_is_attachment(access.Usage)) { continue; }
+                        const auto& resource = m_Resources[access.Resource];
+                        RenderGraphResourceState state = vulkan_get_render_graph_usage_state(access.Usage, access.Stages, resource.Desc.Format);
+
+                        auto existing = std::find(group.Attachments.begin(), group.Attachments.end(), access.Resource);
+                        if (existing != group.Attachments.end()) {
+                            group.AttachmentDescs[existing - group.Attachments.begin()].finalLayout = state.Layout;
+                            continue;
+                        }
+
+                        VkAttachmentDescription desc = {};
+                        desc.format = resource.Desc.Format;
+                        desc.samples = resource.Desc.Samples;
+                        if (access.Clear) {
+                            desc.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+                        } else if (hasContents[access.Resource] && !render_graph_access_overwrites(access)) {
+                            desc.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+                        } else {
+                            desc.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+                        }
+                        desc.storeOp = neededAfter(access.Resource, g) ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+                        bool stencil = vulkan_format_has_stencil(resource.Desc.Format);
+                        desc.stencilLoadOp = stencil ? desc.loadOp : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+                        desc.stencilStoreOp = stencil ? desc.storeOp : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+                        // The graph's barriers bring each attachment into its first layout before the render pass,
+                        // so the only transitions left to the render pass are the ones between subpasses.
+                        desc.initialLayout = state.Layout;
+                        desc.finalLayout = state.Layout;
+
+                        if (desc.loadOp == VK_ATTACHMENT_LOAD_OP_LOAD || desc.storeOp == VK_ATTACHMENT_STORE_OP_STORE) {
+                            m_Resources[access.Resource].Memoryless = false;
+                        }
+
+                        group.Attachments.push_back(access.Resource);
+                        group.AttachmentDescs.push_back(desc);
+                        group.ClearValues.push_back(access.ClearValue);
+                    }
+                }
+            }
+
+            for (RenderGraphPass handle : group.Passes) {
+                for (const auto& access : m_Passes[handle].Accesses) {
+                    if (render_graph_usage_writes(access.Usage)) { hasContents[access.Resource] = true; }
+                }
+            }
+        }
+    }
+
+    void RenderGraph::AllocateTransients() {
+        struct Placement {
+            RenderGraphResource Resource;
+            VkMemoryRequirements Requirements;
+        };
+
+        std::vector<Placement> placements;
+        for (u32 i = 0; i < m_Resources.size(); i++) {
+            auto& resource = m_Resources[i];
+            if (resource.Imported || resource.FirstUse < 0) { continue; }
+
+            if (resource.Memoryless) {
+                resource.Usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+            }
+        }
+
+        if (AdoptCachedTransients()) {
+            return;
+        }
+        RetireTransientCache();
+
+        for (u32 i = 0; i < m_Resources.size(); i++) {
+            auto& resource = m_Resources[i];
+            if (resource.Imported || resource.FirstUse < 0) { continue; }
+
+            vulkan_create_image_handle(
+                m_GraphicsDevice->Device,
+                resource.Desc.Extent.width,
+                resource.Desc.Extent.height,
+                resource.Desc.Samples,
+                resource.Desc.Format,
+                VK_IMAGE_TILING_OPTIMAL,
+                resource.Usage,
+                resource.Image
+            );
+
+            Placement placement = {};
+            placement.Resource = i;
+            vkGetImageMemoryRequirements(m_GraphicsDevice->Device, resource.Image, &placement.Requirements);
+            placements.push_back(placement);
+
+            m_Stats.TransientImageCount++;
+            m_Stats.TransientBytesRequested += placement.Requirements.size;
+            if (resource.Memoryless) {
+                m_Stats.MemorylessImageCount++;
+            }
+        }
+
+        // Greedy first-fit by decreasing size: a resource may share memory with any other resource
+        // in the same block provided their lifetimes (in execution order) never overlap.
+        std::sort(placements.begin(), placements.end(), [](const Placement& a, const Placement& b) {
+            return a.Requirements.size > b.Requirements.size;
+        });
+
+        std::vector<std::vector<RenderGraphResource>> blockResidents;
+        for (const auto& placement : placements) {
+            auto& resource = m_Resources[placement.Resource];
+            // Attachments that never leave tile memory can live in lazily allocated memory, which tilers
+            // typically never back with physical pages. Fall back to ordinary device memory elsewhere.
+            u32 typeIndex;
+            bool lazy = resource.Memoryless && vulkan_try_find_memory_type(
+                placement.Requirements.memoryTypeBits,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT,
+                m_GraphicsDevice->PhysicalDevice,
+                typeIndex
+            );
+            if (!lazy) {
+                typeIndex = vulkan_find_memory_type(placement.Requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_GraphicsDevice->PhysicalDevice);
+            }
+
+            u32 blockIndex = RENDER_GRAPH_INVALID_HANDLE;
+            for (u32 b = 0; b < m_MemoryBlocks.size(); b++) {
+                if (m_MemoryBlocks[b].MemoryTypeIndex == typeIndex) {
+                    blockIndex = b;
+                    break;
+                }
+            }
+            if (blockIndex == RENDER_GRAPH_INVALID_HANDLE) {
+                m_MemoryBlocks.push_back({VK_NULL_HANDLE, typeIndex, 0, lazy});
+                blockResidents.emplace_back();
+                blockIndex = static_cast<u32>(m_MemoryBlocks.size() - 1);
+            }
+
+            std::vector<RenderGraphResource> conflicts;
+            for (RenderGraphResource other : blockResidents[blockIndex]) {
+                const auto& o = m_Resources[other];
+                if (o.FirstUse <= resource.LastUse && resource.FirstUse <= o.LastUse) {
+                    conflicts.push_back(other);
+                }
+            }
+
+            VkDeviceSize alignment = placement.Requirements.alignment;
+            VkDeviceSize size = placement.Requirements.size;
+            std::vector<VkDeviceSize> candidates = {0};
+            for (RenderGraphResource other : conflicts) {
+                const auto& o = m_Resources[other];
+                VkDeviceSize end = o.MemoryOffset + o.MemorySize;
+                candidates.push_back(((end + alignment - 1) / alignment) * alignment);
+            }
+            std::sort(candidates.begin(), candidates.end());
+
+            VkDeviceSize offset = 0;
+            for (VkDeviceSize candidate : candidates) {
+                bool fits = true;
+                for (RenderGraphResource other : conflicts) {
+                    const auto& o = m_Resources[other];
+                    if (candidate < o.MemoryOffset + o.MemorySize && o.MemoryOffset < candidate + size) {
+                        fits = false;
+                        break;
+                    }
+                }
+                if (fits) {
+                    offset = candidate;
+                    break;
+                }
+            }
+
+            resource.MemoryBlock = blockIndex;
+            resource.MemoryOffset = offset;
+            resource.MemorySize = size;
+            blockResidents[blockIndex].push_back(placement.Resource);
+            m_MemoryBlocks[blockIndex].Size = std::max(m_MemoryBlocks[blockIndex].Size, offset + size);
+        }
+
+        for (auto& block : m_MemoryBlocks) {
+            VkMemoryAllocateInfo allocInfo = {};
+            allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+            allocInfo.allocationSize = block.Size;
+            allocInfo.memoryTypeIndex = block.MemoryTypeIndex;
+            VkResult result = vkAllocateMemory(m_GraphicsDevice->Device, &allocInfo, nullptr, &block.Memory);
+            ASSERT(result == VK_SUCCESS, "Failed to allocate render graph transient memory.");
+            if (block.Lazy) {
+                m_Stats.LazyBytesAllocated += block.Size;
+            } else {
+                m_Stats.TransientBytesAllocated += block.Size;
+            }
+        }
+
+        for (const auto& placement : placements) {
+            auto& resource = m_Resources[placement.Resource];
+            vkBindImageMemory(m_GraphicsDevice->Device, resource.Image, m_MemoryBlocks[resource.MemoryBlock].Memory, resource.MemoryOffset);
+            VkImageAspectFlags viewAspect = (resource.Aspect & VK_IMAGE_ASPECT_DEPTH_BIT) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+            resource.View = vulkan_create_image_view(m_GraphicsDevice->Device, resource.Image, resource.Desc.Format, viewAspect);
+        }
+    }
+
+    void RenderGraph::ComputeBarriers() {
+        std::vector<RenderGraphResourceState> lastStates(m_Resources.size());
+        for (RenderGraphPass handle : m_ExecutionOrder) {
+            for (const auto& access : m_Passes[handle].Accesses) {
+                lastStates[access.Resource] = vulkan_get_render_graph_usage_state(access.Usage, access.Stages, m_Resources[access.Resource].Desc.Format);
+            }
+        }
+
+        // A transient starts every frame with undefined contents, but must still wait for the last
+        // use of anything sharing its memory - including itself from the previous frame.
+        std::vector<RenderGraphResourceState> states(m_Resources.size());
+        for (u32 i = 0; i < m_Resources.size(); i++) {
+            auto& resource = m_Resources[i];
+            if (resource.Imported) {
+                states[i] = resource.InitialState;
+                continue;
+            }
+            if (resource.FirstUse < 0) { continue; }
+
+            resource.FrameStartState = {VK_IMAGE_LAYOUT_UNDEFINED, 0, 0};
+            if (resource.Async) {
+                // The compute submission waits on the previous frame's graphics work, which covers its last use.
+                states[i] = resource.FrameStartState;
+                continue;
+            }
+            for (u32 j = 0; j < m_Resources.size(); j++) {
+                const auto& other = m_Resources[j];
+                if (other.Imported || other.FirstUse < 0 || other.MemoryBlock != resource.MemoryBlock) { continue; }
+                bool overlaps = other.MemoryOffset < resource.MemoryOffset + resource.MemorySize && resource.MemoryOffset < other.MemoryOffset + other.MemorySize;
+                if (!overlaps) { continue; }
+                resource.FrameStartState.Stages |= lastStates[j].Stages;
+                resource.FrameStartState.Access |= lastStates[j].Access;
+            }
+            states[i] = resource.FrameStartState;
+        }
+
+        u32 computeFamily = m_GraphicsDevice->QueueIndices.Compute;
+        u32 graphicsFamily = m_GraphicsDevice->QueueIndices.Graphics;
+        std::vector<bool> onComputeQueue(m_Resources.size(), false);
+        m_AsyncReleaseBarriers = {};
+        m_AsyncWaitStages = 0;
+
+        for (auto& group : m_Groups) {
+            group.Barriers = {};
+            std::set<RenderGraphResource> attached;
+            for (RenderGraphPass handle : group.Passes) {
+                for (const auto& access : m_Passes[handle].Accesses) {
+                    RenderGraphResourceState required = vulkan_get_render_graph_usage_state(access.Usage, access.Stages, m_Resources[access.Resource].Desc.Format);
+                    RenderGraphResourceState& current = states[access.Resource];
+
+                    bool attachment = group.Raster && render_graph_usage_is_attachment(access.Usage);
+                    if (attachment && attached.count(access.Resource)) {
+                        // Already bound to this render pass; the subpass dependency orders it instead of a barrier.
+                        current.Layout = required.Layout;
+                        current.Stages |= required.Stages;
+                        current.Access |= required.Access;
+                        continue;
+                    }
+                    if (attachment) {
+                        attached.insert(access.Resource);
+                    }
+
+                    if (group.Async) {
+                        onComputeQueue[access.Resource] = true;
+                    } else if (onComputeQueue[access.Resource]) {
+                        // Handoff from the compute queue. The frame's semaphore wait on the compute submission
+                        // orders it, so the barrier only starts at the consuming stages. Across families the
+                        // layout change doubles as an ownership transfer, with a matching release on compute.
+                        onComputeQueue[access.Resource] = false;
+                        RenderGraphBarrier acquire = {access.Resource, {current.Layout, required.Stages, 0}, required};
+                        if (computeFamily != graphicsFamily) {
+                            acquire.SrcQueueFamily = computeFamily;
+                            acquire.DstQueueFamily = graphicsFamily;
+                            RenderGraphBarrier release = {access.Resource, current, {required.Layout, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0}, computeFamily, graphicsFamily};
+                            m_AsyncReleaseBarriers.Barriers.push_back(release);
+                            m_AsyncReleaseBarriers.SrcStages |= current.Stages;
+                            m_AsyncReleaseBarriers.DstStages |= VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+                        }
+                        group.Barriers.Barriers.push_back(acquire);
+                        group.Barriers.SrcStages |= required.Stages;
+                        group.Barriers.DstStages |= required.Stages;
+                        m_AsyncWaitStages |= required.Stages;
+                        current = required;
+                        continue;
+                    }
+
+                    bool hazard = current.Layout != required.Layout || vulkan_access_is_write(current.Access) || vulkan_access_is_write(required.Access);
+                    if (hazard) {
+                        group.Barriers.Barriers.push_back({access.Resource, current, required});
+                        group.Barriers.SrcStages |= current.Stages;
+                        group.Barriers.DstStages |= required.Stages;
+                        current = required;
+                    } else {
+                        // Read after read in the same layout; just widen the set of stages a later writer must wait on.
+                        current.Stages |= required.Stages;
+                        current.Access |= required.Access;
+                    }
+                }
+            }
+            if (!group.Barriers.Barriers.empty()) {
+                m_Stats.BarrierCount += static_cast<u32>(group.Barriers.Barriers.size());
+                m_Stats.BarrierBatchCount++;
+            }
+        }
+
+        m_FinalBarriers = {};
+        for (u32 i = 0; i < m_Resources.size(); i++) {
+            const auto& resource = m_Resources[i];
+            if (!resource.Output || resource.FirstUse < 0 || states[i].Layout == resource.FinalLayout) { continue; }
+            RenderGraphResourceState finalState = {resource.FinalLayout, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0};
+            m_FinalBarriers.Barriers.push_back({i, states[i], finalState});
+            m_FinalBarriers.SrcStages |= states[i].Stages;
+            m_FinalBarriers.DstStages |= finalState.Stages;
+        }
+        if (!m_FinalBarriers.Barriers.empty()) {
+            m_Stats.BarrierCount += static_cast<u32>(m_FinalBarriers.Barriers.size());
+            m_Stats.BarrierBatchCount++;
+        }
+    }
+
+    void RenderGraph::CreateRenderPasses() {
+        for (auto& group : m_Groups) {
+            if (!group.Raster) { continue; }
+
+            u32 attachmentCount = static_cast<u32>(group.Attachments.size());
+            u32 subpassCount = static_cast<u32>(group.Passes.size());
+            auto attachmentIndex = [&](RenderGraphResource resource) -> u32 {
+                return static_cast<u32>(std::find(group.Attachments.begin(), group.Attachments.end(), resource) - group.Attachments.begin());
+            };
+
+            struct SubpassRefs {
+                std::vector<VkAttachmentReference> Colors;
+                std::vector<VkAttachmentReference> Resolves;
+                std::vector<VkAttachmentReference> Inputs;
+                VkAttachmentReference Depth = {VK_ATTACHMENT_UNUSED, VK_IMAGE_LAYOUT_UNDEFINED};
+                std::vector<u32> Preserves;
+                bool AnyResolve = false;
+            };
+            std::vector<SubpassRefs> refs(subpassCount);
+            std::vector<std::vector<bool>> uses(subpassCount, std::vector<bool>(attachmentCount, false));
+            std::map<std::pair<u32, u32>, VkSubpassDependency> dependencies;
+
+            std::vector<u32> lastSubpass(attachmentCount, VK_SUBPASS_EXTERNAL);
+            std::vector<RenderGraphResourceState> lastState(attachmentCount);
+
+            for (u32 k = 0; k < subpassCount; k++) {
+                const auto& pass = m_Passes[group.Passes[k]];
+                auto& ref = refs[k];
+
+                for (const auto& access : pass.Accesses) {
+                    if (!render_graph_usage_is_attachment(access.Usage)) { continue; }
+                    u32 index = attachmentIndex(access.Resource);
+                    RenderGraphResourceState state = vulkan_get_render_graph_usage_state(access.Usage, access.Stages, m_Resources[access.Resource].Desc.Format);
+                    uses[k][index] = true;
+
+                    if (access.Usage == RenderGraphUsage::ColorAttachment) {
+                        ref.Colors.push_back({index, state.Layout});
+                        VkAttachmentReference resolveRef = {VK_ATTACHMENT_UNUSED, VK_IMAGE_LAYOUT_UNDEFINED};
+                        for (const auto& resolve : pass.Accesses) {
+                            if (resolve.Usage == RenderGraphUsage::ResolveAttachment && resolve.ResolveSource == access.Resource) {
+                                resolveRef = {attachmentIndex(resolve.Resource), VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+                                ref.AnyResolve = true;
+                            }
+                        }
+                        ref.Resolves.push_back(resolveRef);
+                    } else if (access.Usage == RenderGraphUsage::DepthAttachment || access.Usage == RenderGraphUsage::DepthAttachmentReadOnly) {
+                        ref.Depth = {index, state.Layout};
+                    } else if (access.Usage == RenderGraphUsage::InputAttachment) {
+                        ref.Inputs.push_back({index, state.Layout});
+                    }
+
+                    u32 previous = lastSubpass[index];
+                    if (previous != VK_SUBPASS_EXTERNAL && previous != k) {
+                        bool hazard = lastState[index].Layout != state.Layout || vulkan_access_is_write(lastState[index].Access) || vulkan_access_is_write(state.Access);
+                        if (hazard) {
+                            auto& dependency = dependencies[{previous, k}];
+                            dependency.srcSubpass = previous;
+                            dependency.dstSubpass = k;
+                            dependency.srcStageMask |= lastState[index].Stages;
+                            dependency.dstStageMask |= state.Stages;
+                            dependency.srcAccessMask |= lastState[index].Access;
+                            dependency.dstAccessMask |= state.Access;
+                            // Input attachments only ever read the pixel being shaded, so the data can stay on-tile.
+                            dependency.dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+                            lastState[index] = state;
+                        } else {
+                            lastState[index].Stages |= state.Stages;
+                            lastState[index].Access |= state.Access;
+                        }
+                    } else {
+                        lastState[index] = state;
+                    }
+                    lastSubpass[index] = k;
+                }
+            }
+
+            // Attachments used both before and after a subpass that ignores them must be preserved across it.
+            for (u32 a = 0; a < attachmentCount; a++) {
+                i32 first = -1;
+                i32 last = -1;
+                for (u32 k = 0; k < subpassCount; k++) {
+                    if (!uses[k][a]) { continue; }
+                    if (first < 0) { first = static_cast<i32>(k); }
+                    last = static_cast<i32>(k);
+                }
+                for (i32 k = first + 1; k < last; k++) {
+                    if (!uses[k][a]) { refs[k].Preserves.push_back(a); }
+                }
+            }
+
+            std::vector<u64> key;
+            for (const auto& desc : group.AttachmentDescs) {
+                key.insert(key.end(), {
+                    (u64)desc.format, (u64)desc.samples,
+                    (u64)desc.loadOp, (u64)desc.storeOp, (u64)desc.stencilLoadOp, (u64)desc.stencilStoreOp,
+                    (u64)desc.initialLayout, (u64)desc.finalLayout
+                });
+            }
+            auto keyRefs = [&](const std::vector<VkAttachmentReference>& list) {
+                key.push_back(list.size());
+                for (const auto& r : list) { key.insert(key.end(), {(u64)r.attachment, (u64)r.layout}); }
+            };
+            for (const auto& ref : refs) {
+                keyRefs(ref.Colors);
+                keyRefs(ref.Resolves);
+                keyRefs(ref.Inputs);
+                key.insert(key.end(), {(u64)ref.Depth.attachment, (u64)ref.Depth.layout, (u64)ref.Preserves.size()});
+                key.insert(key.end(), ref.Preserves.begin(), ref.Preserves.end());
+            }
+            std::vector<VkSubpassDependency> dependencyList;
+            for (const auto& entry : dependencies) {
+                const auto& d = entry.second;
+                dependencyList.push_back(d);
+                key.insert(key.end(), {(u64)d.srcSubpass, (u64)d.dstSubpass, (u64)d.srcStageMask, (u64)d.dstStageMask, (u64)d.srcAccessMask, (u64)d.dstAccessMask});
+            }
+
+            auto cached = m_RenderPassCache.find(key);
+            if (cached != m_RenderPassCache.end()) {
+                group.RenderPass = cached->second;
+                continue;
+            }
+
+            std::vector<VkSubpassDescription> subpasses(subpassCount);
+            for (u32 k = 0; k < subpassCount; k++) {
+                auto& subpass = subpasses[k];
+                const auto& ref = refs[k];
+                subpass = {};
+                subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+                subpass.inputAttachmentCount = static_cast<u32>(ref.Inputs.size());
+                subpass.pInputAttachments = ref.Inputs.data();
+                subpass.colorAttachmentCount = static_cast<u32>(ref.Colors.size());
+                subpass.pColorAttachments = ref.Colors.data();
+                subpass.pResolveAttachments = ref.AnyResolve ? ref.Resolves.data() : nullptr;
+                subpass.pDepthStencilAttachment = ref.Depth.attachment != VK_ATTACHMENT_UNUSED ? &ref.Depth : nullptr;
+                subpass.preserveAttachmentCount = static_cast<u32>(ref.Preserves.size());
+                subpass.pPreserveAttachments = ref.Preserves.data();
+            }
+
+            VkRenderPassCreateInfo createInfo = {};
+            createInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+            createInfo.attachmentCount = attachmentCount;
+            createInfo.pAttachments = group.AttachmentDescs.data();
+            createInfo.subpassCount = subpassCount;
+            createInfo.pSubpasses = subpasses.data();
+            createInfo.dependencyCount = static_cast<u32>(dependencyList.size());
+            createInfo.pDependencies = dependencyList.data();
+
+            VkResult result = vkCreateRenderPass(m_GraphicsDevice->Device, &createInfo, nullptr, &group.RenderPass);
+            ASSERT(result == VK_SUCCESS, "Failed to create a render graph renderpass!");
+            m_RenderPassCache[key] = group.RenderPass;
+        }
+    }
+
+    // EXECUTION
+
+    VkFramebuffer RenderGraph::GetFramebuffer(RenderGraphPassGroup& group) {
+        std::vector<VkImageView> views;
+        views.reserve(group.Attachments.size());
+        for (RenderGraphResource resource : group.Attachments) {
+            views.push_back(m_Resources[resource].View);
+        }
+
+        auto cached = group.Framebuffers.find(views);
+        if (cached != group.Framebuffers.end()) {
+            return cached->second;
+        }
+
+        VkFramebufferCreateInfo createInfo = {};
+        createInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        createInfo.renderPass = group.RenderPass;
+        createInfo.attachmentCount = static_cast<u32>(views.size());
+        createInfo.pAttachments = views.data();
+        createInfo.width = group.Extent.width;
+        createInfo.height = group.Extent.height;
+        createInfo.layers = 1;
+
+        VkFramebuffer framebuffer;
+        VkResult result = vkCreateFramebuffer(m_GraphicsDevice->Device, &createInfo, nullptr, &framebuffer);
+        ASSERT(result == VK_SUCCESS, "Failed to create a render graph framebuffer!");
+        group.Framebuffers[views] = framebuffer;
+        return framebuffer;
+    }
+
+    void RenderGraph::RecordBarriers(VkCommandBuffer commandBuffer, const RenderGraphBarrierBatch& batch) {
+        if (batch.Barriers.empty()) { return; }
+
+        std::vector<VkImageMemoryBarrier> barriers(batch.Barriers.size());
+        for (u32 i = 0; i < batch.Barriers.size(); i++) {
+            const auto& barrier = batch.Barriers[i];
+            const auto& resource = m_Resources[barrier.Resource];
+            barriers[i] = {};
+            barriers[i].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barriers[i].srcAccessMask = barrier.Src.Access;
+            barriers[i].dstAccessMask = barrier.Dst.Access;
+            barriers[i].oldLayout = barrier.Src.Layout;
+            barriers[i].newLayout = barrier.Dst.Layout;
+            barriers[i].srcQueueFamilyIndex = barrier.SrcQueueFamily;
+            barriers[i].dstQueueFamilyIndex = barrier.DstQueueFamily;
+            barriers[i].image = resource.Image;
+            barriers[i].subresourceRange.aspectMask = resource.Aspect;
+            barriers[i].subresourceRange.baseMipLevel = 0;
+            barriers[i].subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+            barriers[i].subresourceRange.baseArrayLayer = 0;
+            barriers[i].subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+        }
+
+        VkPipelineStageFlags srcStages = batch.SrcStages ? static_cast<VkPipelineStageFlags>(batch.SrcStages) : static_cast<VkPipelineStageFlags>(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+        vkCmdPipelineBarrier(commandBuffer, srcStages, batch.DstStages, 0, 0, nullptr, 0, nullptr, static_cast<u32>(barriers.size()), barriers.data());
+    }
+
+    std::vector<u64> RenderGraph::GetTransientKey() {
+        std::vector<u64> key;
+        for (const auto& resource : m_Resources) {
+            if (resource.Imported || resource.FirstUse < 0) { continue; }
+            key.push_back(resource.Desc.Format);
+            key.push_back(resource.Desc.Extent.width);
+            key.push_back(resource.Desc.Extent.height);
+            key.push_back(resource.Desc.Samples);
+            key.push_back(resource.Usage);
+            key.push_back(resource.Memoryless);
+            key.push_back(static_cast<u64>(resource.FirstUse));
+            key.push_back(static_cast<u64>(resource.LastUse));
+        }
+        return key;
+    }
+
+    bool RenderGraph::AdoptCachedTransients() {
+        if (m_TransientCache.Resources.empty() || m_TransientCache.Key != GetTransientKey()) {
+            return false;
+        }
+
+        // Same images, usages and lifetimes in the same order, so the old placement is still valid.
+        u32 cached = 0;
+        for (auto& resource : m_Resources) {
+            if (resource.Imported || resource.FirstUse < 0) { continue; }
+            const auto& old = m_TransientCache.Resources[cached++];
+            resource.Image = old.Image;
+            resource.View = old.View;
+            resource.MemoryBlock = old.MemoryBlock;
+            resource.MemoryOffset = old.MemoryOffset;
+            resource.MemorySize = old.MemorySize;
+
+            m_Stats.TransientImageCount++;
+            m_Stats.TransientBytesRequested += resource.MemorySize;
+            if (resource.Memoryless) {
+                m_Stats.MemorylessImageCount++;
+            }
+        }
+        m_MemoryBlocks = m_TransientCache.MemoryBlocks;
+        for (const auto& block : m_MemoryBlocks) {
+            if (block.Lazy) {
+                m_Stats.LazyBytesAllocated += block.Size;
+            } else {
+                m_Stats.TransientBytesAllocated += block.Size;
+            }
+        }
+        m_Stats.TransientsReused = true;
+        m_TransientCache = {};
+        return true;
+    }
+
+    void RenderGraph::ReleasePhysicalResources() {
+        RenderGraphRetiredObjects retired = {};
+
+        // Framebuffers may reference imported views that are about to change, so they never carry over.
+        for (auto& group : m_Groups) {
+            for (auto& framebuffer : group.Framebuffers) {
+                retired.Framebuffers.push_back(framebuffer.second);
+            }
+            group.Framebuffers.clear();
+        }
+        if (!retired.Framebuffers.empty()) {
+            RetireObjects(retired);
+        }
+
+        if (!m_MemoryBlocks.empty()) {
+            RetireTransientCache();
+            m_TransientCache.Key = GetTransientKey();
+            for (auto& resource : m_Resources) {
+                if (resource.Imported || resource.FirstUse < 0) { continue; }
+                m_TransientCache.Resources.push_back(resource);
+                resource.View = VK_NULL_HANDLE;
+                resource.Image = VK_NULL_HANDLE;
+            }
+            m_TransientCache.MemoryBlocks = m_MemoryBlocks;
+            m_MemoryBlocks.clear();
+        }
+        m_Compiled = false;
+    }
+
+    void RenderGraph::RetireTransientCache() {
+        if (m_TransientCache.Resources.empty() && m_TransientCache.MemoryBlocks.empty()) { return; }
+
+        RenderGraphRetiredObjects retired = {};
+        for (const auto& resource : m_TransientCache.Resources) {
+            if (resource.View != VK_NULL_HANDLE) { retired.Views.push_back(resource.View); }
+            if (resource.Image != VK_NULL_HANDLE) { retired.Images.push_back(resource.Image); }
+        }
+        for (const auto& block : m_TransientCache.MemoryBlocks) {
+            retired.Memory.push_back(block.Memory);
+        }
+        RetireObjects(retired);
+        m_TransientCache = {};
+    }
+
+    void RenderGraph::RetireObjects(const RenderGraphRetiredObjects& objects) {
+        VkDevice device = m_GraphicsDevice->Device;
+        m_GraphicsDevice->PendingDeletions.Push([=]() {
+            for (VkFramebuffer framebuffer : objects.Framebuffers) {
+                vkDestroyFramebuffer(device, framebuffer, nullptr);
+            }
+            for (VkImageView view : objects.Views) {
+                vkDestroyImageView(device, view, nullptr);
+            }
+            for (VkImage image : objects.Images) {
+                vkDestroyImage(device, image, nullptr);
+            }
+            for (VkDeviceMemory memory : objects.Memory) {
+                vkFreeMemory(device, memory, nullptr);
+            }
+        });
+    }
+
+    // INSPECTION
+
+    static const char* render_graph_usage_name(RenderGraphUsage usage) {
+        switch (usage) {
+            case RenderGraphUsage::ColorAttachment: return "color";
+            case RenderGraphUsage::ResolveAttachment: return "resolve";
+            case RenderGraphUsage::DepthAttachment: return "depth";
+            case RenderGraphUsage::DepthAttachmentReadOnly: return "depth-read";
+            case RenderGraphUsage::InputAttachment: return "input";
+            case RenderGraphUsage::SampledRead: return "sampled";
+            case RenderGraphUsage::StorageRead: return "storage-read";
+            case RenderGraphUsage::StorageWrite: return "storage-write";
+        }
+        return "unknown";
+    }
+
+    std::string RenderGraph::Dump() {
+        std::stringstream ss;
+        ss << "RenderGraph: " << m_Stats.PassCount << " passes (" << m_Stats.CulledPassCount << " culled, " << m_Stats.AsyncPassCount << " async compute) in "
+           << m_Stats.RenderPassCount << " renderpasses (" << m_Stats.MergedPassCount << " merged as subpasses), "
+           << m_Stats.BarrierCount << " barriers in " << m_Stats.BarrierBatchCount << " batches\n";
+
+        VkDeviceSize requested = m_Stats.TransientBytesRequested;
+        VkDeviceSize allocated = m_Stats.TransientBytesAllocated + m_Stats.LazyBytesAllocated;
+        f64 saved = requested > 0 ? 100.0 * (1.0 - (f64)allocated / (f64)requested) : 0.0;
+        ss << "Transient memory: " << (requested >> 10) << " KiB requested, " << (allocated >> 10) << " KiB allocated (" << saved << "% aliased), "
+           << m_Stats.MemorylessImageCount << " memoryless images in " << (m_Stats.LazyBytesAllocated >> 10) << " KiB lazily allocated"
+           << (m_Stats.TransientsReused ? ", reused from previous compile\n" : "\n");
+
+        auto dumpBatch = [&](const RenderGraphBarrierBatch& batch) {
+            for (const auto& barrier : batch.Barriers) {
+                ss << "      barrier " << m_Resources[barrier.Resource].Name << ": "
+                   << string_VkImageLayout(barrier.Src.Layout) << " -> " << string_VkImageLayout(barrier.Dst.Layout) << "\n";
+            }
+        };
+
+        static const char* loadNames[] = {"load", "clear", "dont-care"};
+        static const char* storeNames[] = {"store", "dont-care"};
+
+        ss << "Passes:\n";
+        for (u32 g = 0; g < m_Groups.size(); g++) {
+            const auto& group = m_Groups[g];
+            ss << "  [" << g << "]";
+            if (group.Raster) {
+                ss << " renderpass " << group.Extent.width << "x" << group.Extent.height << ", " << group.Passes.size() << " subpass(es)";
+            } else if (group.Async) {
+                ss << " async compute";
+            }
+            ss << "\n";
+            dumpBatch(group.Barriers);
+            for (u32 a = 0; a < group.Attachments.size(); a++) {
+                const auto& desc = group.AttachmentDescs[a];
+                ss << "      attachment " << m_Resources[group.Attachments[a]].Name << ": "
+                   << (desc.loadOp <= VK_ATTACHMENT_LOAD_OP_DONT_CARE ? loadNames[desc.loadOp] : "none") << "/"
+                   << (desc.storeOp <= VK_ATTACHMENT_STORE_OP_DONT_CARE ? storeNames[desc.storeOp] : "none") << "\n";
+            }
+            for (RenderGraphPass handle : group.Passes) {
+                const auto& pass = m_Passes[handle];
+                ss << "    " << pass.Name << (group.Raster ? " (subpass " + std::to_string(pass.Subpass) + ")" : "") << "\n";
+                for (const auto& access : pass.Accesses) {
+                    ss << "      " << (render_graph_usage_writes(access.Usage) ? "write " : "read  ")
+                       << m_Resources[access.Resource].Name << " as " << render_graph_usage_name(access.Usage)
+                       << (access.Clear ? " (clear)" : "") << "\n";
+                }
+            }
+        }
+        for (const auto& pass : m_Passes) {
+            if (pass.Culled) {
+                ss << "  [culled] " << pass.Name << "\n";
+            }
+        }
+        if (!m_AsyncReleaseBarriers.Barriers.empty()) {
+            ss << "  [async release]\n";
+            dumpBatch(m_AsyncReleaseBarriers);
+        }
+        if (!m_FinalBarriers.Barriers.empty()) {
+            ss << "  [final]\n";
+            dumpBatch(m_FinalBarriers);
+        }
+
+        ss << "Resources:\n";
+        for (const auto& resource : m_Resources) {
+            ss << "  " << resource.Name << " " << resource.Desc.Extent.width << "x" << resource.Desc.Extent.height
+               << " " << string_VkFormat(resource.Desc.Format) << " x" << (u32)resource.Desc.Samples;
+            if (resource.FirstUse < 0) {
+                ss << " unused\n";
+                continue;
+            }
+            ss << " lifetime [" << resource.FirstUse << ", " << resource.LastUse << "]";
+            if (resource.Imported) {
+                ss << " imported\n";
+            } else {
+                ss << " block " << resource.MemoryBlock << " @ " << resource.MemoryOffset << " (" << (resource.MemorySize >> 10) << " KiB)"
+                   << (resource.Memoryless ? " memoryless" : "") << "\n";
+            }
+        }
+
+        return ss.str();
+    }
+
+    // HELPERS
+
+    RenderGraphResourceState vulkan_get_render_graph_usage_state(RenderGraphUsage usage, VkPipelineStageFlags stages, VkFormat format) {
+        RenderGraphResourceState state = {};
+        state.Stages = stages;
+        switch (usage) {
+            case RenderGraphUsage::ColorAttachment:
+            case RenderGraphUsage::ResolveAttachment:
+                state.Layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+                state.Access = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+                break;
+            case RenderGraphUsage::DepthAttachment:
+                state.Layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+                state.Access = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+                break;
+            case RenderGraphUsage::DepthAttachmentReadOnly:
+                state.Layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+                state.Access = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+                break;
+            case RenderGraphUsage::InputAttachment:
+                state.Layout = vulkan_format_has_depth(format) ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+                state.Access = VK_ACCESS_INPUT_ATTACHMENT_READ_BIT;
+                break;
+            case RenderGraphUsage::SampledRead:
+                state.Layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+                state.Access = VK_ACCESS_SHADER_READ_BIT;
+                break;
+            case RenderGraphUsage::StorageRead:
+                state.Layout = VK_IMAGE_LAYOUT_GENERAL;
+                state.Access = VK_ACCESS_SHADER_READ_BIT;
+                break;
+            case RenderGraphUsage::StorageWrite:
+                state.Layout = VK_IMAGE_LAYOUT_GENERAL;
+                state.Access = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+                break;
+        }
+        return state;
+    }
+
+    bool vulkan_access_is_write(VkAccessFlags access) {
+        const VkAccessFlags writes =
+            VK_ACCESS_SHADER_WRITE_BIT |
+            VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+            VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+            VK_ACCESS_TRANSFER_WRITE_BIT |
+            VK_ACCESS_HOST_WRITE_BIT |
+            VK_ACCESS_MEMORY_WRITE_BIT;
+        return (access & writes) != 0;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,271 @@
+#pragma once
+
+#include "Cortex/Graphics/VulkanHelpers.hpp"
+#include "Cortex/Graphics/VulkanTypes.hpp"
+#include "Cortex/Graphics/GraphicsDevice.hpp"
+#include "Cortex/Graphics/QueueSync.hpp"
+#include "Cortex/Graphics/GpuProfiler.hpp"
+
+#include <functional>
+#include <map>
+#include <limits>
+
+namespace Cortex {
+    using RenderGraphResource = u32;
+    using RenderGraphPass = u32;
+
+    #define RENDER_GRAPH_INVALID_HANDLE std::numeric_limits<u32>::max()
+
+    enum class RenderGraphUsage {
+        ColorAttachment,
+        ResolveAttachment,
+        DepthAttachment,
+        DepthAttachmentReadOnly,
+        InputAttachment,
+        SampledRead,
+        StorageRead,
+        StorageWrite
+    };
+
+    struct RenderGraphImageDesc {
+        VkFormat Format = VK_FORMAT_UNDEFINED;
+        VkExtent2D Extent = {0, 0};
+        VkSampleCountFlagBits Samples = VK_SAMPLE_COUNT_1_BIT;
+    };
+
+    struct RenderGraphResourceState {
+        VkImageLayout Layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags Stages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        VkAccessFlags Access = 0;
+    };
+
+    struct RenderGraphAccess {
+        RenderGraphResource Resource;
+        RenderGraphUsage Usage;
+        VkPipelineStageFlags Stages;
+        bool Clear;
+        VkClearValue ClearValue;
+        RenderGraphResource ResolveSource;
+    };
+
+    struct RenderGraphBarrier {
+        RenderGraphResource Resource;
+        RenderGraphResourceState Src;
+        RenderGraphResourceState Dst;
+        u32 SrcQueueFamily = VK_QUEUE_FAMILY_IGNORED;   // set on both halves of an ownership transfer
+        u32 DstQueueFamily = VK_QUEUE_FAMILY_IGNORED;
+    };
+
+    struct RenderGraphBarrierBatch {
+        VkPipelineStageFlags SrcStages = 0;
+        VkPipelineStageFlags DstStages = 0;
+        std::vector<RenderGraphBarrier> Barriers;
+    };
+
+    struct RenderGraphResourceNode {
+        std::string Name;
+        RenderGraphImageDesc Desc;
+        bool Imported;
+        bool Output;
+        RenderGraphResourceState InitialState;
+        VkImageLayout FinalLayout;
+
+        // Compiled
+        VkImageUsageFlags Usage;
+        VkImageAspectFlags Aspect;
+        i32 FirstUse;
+        i32 LastUse;
+        RenderGraphResourceState FrameStartState;
+        bool Memoryless;
+        bool Async;     // touched by an async compute pass
+
+        // Physical
+        VkImage Image;
+        VkImageView View;
+        u32 MemoryBlock;
+        VkDeviceSize MemoryOffset;
+        VkDeviceSize MemorySize;
+    };
+
+    struct RenderGraphPassNode {
+        std::string Name;
+        bool SideEffect;
+        bool AsyncCompute;
+        std::vector<RenderGraphAccess> Accesses;
+        std::function<void(VkCommandBuffer)> Execute;
+        VkExtent2D RenderArea;
+
+        // Compiled
+        bool Culled;
+        bool Raster;
+        bool Async;     // AsyncCompute was requested and the pass qualified for the compute queue
+        u32 Group;
+        u32 Subpass;
+    };
+
+    // A run of passes recorded back to back. Raster passes that hand data to each other through
+    // attachments are merged into one VkRenderPass, one subpass each, so it can stay in tile memory.
+    struct RenderGraphPassGroup {
+        std::vector<RenderGraphPass> Passes;
+        bool Raster;
+        bool Async;
+        VkExtent2D Extent;
+        VkRenderPass RenderPass;
+        std::vector<RenderGraphResource> Attachments;
+        std::vector<VkAttachmentDescription> AttachmentDescs;
+        std::vector<VkClearValue> ClearValues;
+        RenderGraphBarrierBatch Barriers;
+        std::map<std::vector<VkImageView>, VkFramebuffer> Framebuffers;
+    };
+
+    struct RenderGraphMemoryBlock {
+        VkDeviceMemory Memory;
+        u32 MemoryTypeIndex;
+        VkDeviceSize Size;
+        bool Lazy;
+    };
+
+    // Physical objects a recompile replaced. Frames still in flight may reference them, so they go
+    // through the device's deletion queue rather than being destroyed on the spot.
+    struct RenderGraphRetiredObjects {
+        std::vector<VkFramebuffer> Framebuffers;
+        std::vector<VkImageView> Views;
+        std::vector<VkImage> Images;
+        std::vector<VkDeviceMemory> Memory;
+    };
+
+    // Transient images from the previous compile. A recompile that ends up with the same transient
+    // layout (e.g. a swapchain recreated at the same size) adopts them instead of reallocating.
+    struct RenderGraphTransientCache {
+        std::vector<u64> Key;
+        std::vector<RenderGraphResourceNode> Resources;
+        std::vector<RenderGraphMemoryBlock> MemoryBlocks;
+    };
+
+    // Command buffers for async compute submissions, reused once the compute timeline passes Point.
+    struct RenderGraphCommandBuffer {
+        VkCommandPool CommandPool;
+        VkCommandBuffer CommandBuffer;
+        QueuePoint Point;
+    };
+
+    struct RenderGraphStats {
+        u32 PassCount;
+        u32 AsyncPassCount;
+        u32 CulledPassCount;
+        u32 RenderPassCount;
+        u32 MergedPassCount;
+        u32 BarrierCount;
+        u32 BarrierBatchCount;
+        u32 TransientImageCount;
+        u32 MemorylessImageCount;
+        VkDeviceSize TransientBytesRequested;
+        VkDeviceSize TransientBytesAllocated;
+        VkDeviceSize LazyBytesAllocated;
+        bool TransientsReused;
+    };
+
+    class RenderGraph;
+
+    class RenderGraphBuilder {
+        public:
+            RenderGraphBuilder(RenderGraph& graph, RenderGraphPass pass);
+            RenderGraphResource CreateImage(const std::string& name, const RenderGraphImageDesc& desc);
+            void WriteColor(RenderGraphResource resource);
+            void WriteColor(RenderGraphResource resource, VkClearColorValue clear);
+            void WriteDepth(RenderGraphResource resource);
+            void WriteDepth(RenderGraphResource resource, VkClearDepthStencilValue clear);
+            void ReadDepth(RenderGraphResource resource);
+            void ReadInput(RenderGraphResource resource);
+            void ResolveColor(RenderGraphResource source, RenderGraphResource destination);
+            void ReadTexture(RenderGraphResource resource, VkPipelineStageFlags stages = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+            void ReadStorage(RenderGraphResource resource, VkPipelineStageFlags stages);
+            void WriteStorage(RenderGraphResource resource, VkPipelineStageFlags stages);
+            void SetSideEffect();
+            // Runs a compute pass on the async compute queue, overlapping the frame's graphics work. Only
+            // honoured for passes that touch no attachments, no imported images, and nothing graphics
+            // work earlier in the frame has used; anything else stays on the graphics queue.
+            void SetAsyncCompute();
+        private:
+            void AddAccess(RenderGraphResource resource, RenderGraphUsage usage, VkPipelineStageFlags stages, bool clear, VkClearValue clearValue);
+            RenderGraph& m_Graph;
+            RenderGraphPass m_Pass;
+    };
+
+    class RenderGraph {
+        public:
+            static std::unique_ptr<RenderGraph> Create(std::shared_ptr<GraphicsDevice> device);
+            RenderGraph(std::shared_ptr<GraphicsDevice> device);
+            ~RenderGraph();
+            RenderGraph(const RenderGraph&) = delete;
+            RenderGraph &operator=(const RenderGraph&) = delete;
+
+            RenderGraphResource ImportImage(const std::string& name, const RenderGraphImageDesc& desc, VkImageLayout initialLayout, VkImageLayout finalLayout);
+            void SetImportedImage(RenderGraphResource resource, VkImage image, VkImageView view);
+            RenderGraphPass AddPass(const std::string& name, std::function<void(RenderGraphBuilder&)> setup, std::function<void(VkCommandBuffer)> execute);
+
+            void Compile();
+            void Execute(VkCommandBuffer commandBuffer);
+            void Reset();
+
+            // The compute submission from the last Execute, and the graphics stages that consume its
+            // results. The frame's graphics submission must wait on it; Value is 0 when nothing ran async.
+            inline const QueueWait& GetAsyncComputeWait() { return m_AsyncComputeWait; }
+
+            // Times every graphics-queue pass as a scope under whatever scope is open when Execute runs, with
+            // pipeline statistics when the profiler has them on.
+            // Async compute passes are recorded on their own queue and are not timed.
+            inline void SetProfiler(GpuProfiler* profiler) { m_Profiler = profiler; }
+
+            // Restricts a raster pass to the top-left corner of its attachments. Takes effect on the next
+            // Execute without recompiling, so the area can change every frame.
+            void SetRenderArea(RenderGraphPass pass, VkExtent2D area);
+
+            VkRenderPass GetRenderPass(RenderGraphPass pass);
+            u32 GetSubpass(RenderGraphPass pass);
+            VkImageView GetImageView(RenderGraphResource resource);
+            inline const RenderGraphStats& GetStats() { return m_Stats; }
+            std::string Dump();
+
+        private:
+            friend class RenderGraphBuilder;
+
+            void CullPasses();
+            void BuildGroups();
+            void ComputeLifetimes();
+            void ComputeAttachmentOps();
+            void AllocateTransients();
+            void ComputeBarriers();
+            void CreateRenderPasses();
+            VkFramebuffer GetFramebuffer(RenderGraphPassGroup& group);
+            VkExtent2D GetRenderArea(RenderGraphPass pass);
+            void RecordBarriers(VkCommandBuffer commandBuffer, const RenderGraphBarrierBatch& batch);
+            void SubmitAsyncCompute();
+            VkCommandBuffer AcquireComputeCommandBuffer(u32& outIndex);
+            std::vector<u64> GetTransientKey();
+            bool AdoptCachedTransients();
+            void ReleasePhysicalResources();
+            void RetireTransientCache();
+            void RetireObjects(const RenderGraphRetiredObjects& objects);
+
+            std::shared_ptr<GraphicsDevice> m_GraphicsDevice;
+            std::vector<RenderGraphResourceNode> m_Resources;
+            std::vector<RenderGraphPassNode> m_Passes;
+            std::vector<RenderGraphPass> m_ExecutionOrder;
+            std::vector<RenderGraphPassGroup> m_Groups;
+            std::vector<RenderGraphMemoryBlock> m_MemoryBlocks;
+            RenderGraphBarrierBatch m_FinalBarriers;
+            RenderGraphBarrierBatch m_AsyncReleaseBarriers;
+            VkPipelineStageFlags m_AsyncWaitStages;
+            QueueWait m_AsyncComputeWait;
+            std::vector<RenderGraphCommandBuffer> m_ComputeCommandBuffers;
+            std::map<std::vector<u64>, VkRenderPass> m_RenderPassCache;
+            RenderGraphTransientCache m_TransientCache;
+            RenderGraphStats m_Stats;
+            GpuProfiler* m_Profiler;
+            bool m_Compiled;
+    };
+
+    RenderGraphResourceState vulkan_get_render_graph_usage_state(RenderGraphUsage usage, VkPipelineStageFlags stages, VkFormat format);
+    bool vulkan_access_is_write(VkAccessFlags access);
+}
\ No newline at end of file
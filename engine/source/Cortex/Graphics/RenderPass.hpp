@@ -1,10 +0,0 @@
-#pragma once
-
-#include "Cortex/Graphics/VulkanHelpers.hpp"
-#include "Cortex/Graphics/VulkanTypes.hpp"
-
-namespace Cortex {
-    struct RenderPass {
-        VkRenderPass Pass;
-    };
-}
\ No newline at end of file
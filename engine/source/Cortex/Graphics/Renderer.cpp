@@ -1,52 +1,741 @@
 #include "Cortex/Graphics/Renderer.hpp"
 
 namespace Cortex {
+    // One variant of the forward shader per vertex layout; "basic" itself reads VulkanVertex.
+    static std::string renderer_forward_shader_name(VertexLayout layout) {
+        return layout == VertexLayout::Full ? "basic" : std::string("basic_") + vertex_layout_name(layout);
+    }
+
     std::unique_ptr<Renderer> Renderer::Create(const std::unique_ptr<GraphicsContext>& context) {
         return std::make_unique<Renderer>(context);
     }
 
     Renderer::Renderer(const std::unique_ptr<GraphicsContext>& context) {
+        m_Context = context.get();
         m_GraphicsDevice = context->GetDevice();
         m_CurrentFrameIndex = 0;
+        m_FramesInFlight = 0;
+        m_CurrentScene = nullptr;
+        m_RenderGraphDirty = false;
+        m_FrameStats = {};
+        m_LastFrameTime = std::chrono::steady_clock::now();
+        m_FrameTimeCursor = 0;
+        m_StatsHistory.resize(FRAME_STATS_HISTORY_LENGTH);
+        SetMSAASamples(m_Settings.MSAASamples);
+        m_DynamicResolution.SetSettings(m_Settings.DynamicResolution);
 
         m_ShaderLibrary = ShaderLibrary::Create(m_GraphicsDevice);
-        auto shader = m_ShaderLibrary->Load("basic", "../../testbed/assets/shaders/basic.vert", "../../testbed/assets/shaders/basic.frag");
+        for (u32 layout = 0; layout < VERTEX_LAYOUT_COUNT; layout++) {
+            VertexLayout vertexLayout = static_cast<VertexLayout>(layout);
+            m_ShaderLibrary->Load(renderer_forward_shader_name(vertexLayout), "../../testbed/assets/shaders/basic.vert", "../../testbed/assets/shaders/basic.frag", vertex_layout_shader_defines(vertexLayout));
+        }
+        m_ShaderLibrary->Load("upscale", "../../testbed/assets/shaders/upscale.vert", "../../testbed/assets/shaders/upscale.frag");
+        m_ShaderLibrary->Load("depth", "../../testbed/assets/shaders/depth.vert", "");
         m_Texture = Texture2D::Create(m_GraphicsDevice, "../../testbed/assets/models/viking/viking_room.png");
 
-        m_UniformBuffers = vulkan_create_uniform_buffers(m_GraphicsDevice, MAX_FRAMES_IN_FLIGHT);
-        m_MaterialDescriptorSets = vulkan_create_descriptor_sets(m_GraphicsDevice->Device, shader->m_DescriptorPool, MAX_FRAMES_IN_FLIGHT, shader->m_DescriptorSetLayouts[0], m_Texture, m_UniformBuffers);
+        m_OcclusionCuller = OcclusionCuller::Create(m_GraphicsDevice, m_ShaderLibrary);
 
-        auto pipelineConfig = VulkanPipelineConfig::Default();
-        pipelineConfig.RenderPass = context->GetRenderPass().Pass;
-        m_Pipeline = Pipeline::Create(m_GraphicsDevice, m_ShaderLibrary->Get("basic"), pipelineConfig);
+        m_UpscaleSampler = vulkan_create_sampler_2D(m_GraphicsDevice, VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, false);
+
+        if (!m_GraphicsDevice->Details.TimestampsSupported) {
+            LOG_WARN("Graphics queue does not support timestamps, dynamic resolution will stay at full scale.");
+        }
+        CreateFrameResources();
+
+        m_RenderGraph = RenderGraph::Create(m_GraphicsDevice);
+        m_UpscaleRenderPass = VK_NULL_HANDLE;
+        m_PhaseCount = 1;
+        m_SceneDepth = RENDER_GRAPH_INVALID_HANDLE;
+        m_DepthPrepass = false;
+        m_RenderGraph->SetProfiler(m_GpuProfiler.get());
+        BuildRenderGraph();
     }
 
     Renderer::~Renderer() {
-        vkDeviceWaitIdle(m_GraphicsDevice->Device);
-        vkDestroyDescriptorPool(m_GraphicsDevice->Device, m_MaterialDescriptorPool, nullptr);
+        ReleaseFrameResources();
+        VkDevice device = m_GraphicsDevice->Device;
+        VkSampler upscaleSampler = m_UpscaleSampler.Sampler;
+        m_GraphicsDevice->PendingDeletions.Push([=]() {
+            vkDestroySampler(device, upscaleSampler, nullptr);
+        });
+        m_UpscalePipeline.reset();
+        for (auto& phase : m_Phases) {
+            phase.DepthPrepassPipelines = {};
+            phase.ForwardPipelines = {};
+        }
+        m_OcclusionCuller.reset();
+        m_RenderGraph.reset();
+    }
+
+    void Renderer::CreateFrameResources() {
+        m_FramesInFlight = m_Context->GetFramesInFlight();
+
+        auto shader = m_ShaderLibrary->Get("basic");
+        m_UniformBuffers = vulkan_create_uniform_buffers(m_GraphicsDevice, m_FramesInFlight);
+        m_MaterialDescriptorSets = vulkan_create_descriptor_sets(m_GraphicsDevice->Device, shader->m_DescriptorPool, m_FramesInFlight, shader->m_DescriptorSetLayouts[0], m_Texture, m_UniformBuffers);
+
+        // One set per frame in flight, so a recompile can repoint the current frame's set while earlier
+        // frames are still sampling through theirs.
+        auto upscaleShader = m_ShaderLibrary->Get("upscale");
+        std::vector<VkDescriptorSetLayout> upscaleLayouts(m_FramesInFlight, upscaleShader->m_DescriptorSetLayouts[0]);
+        VkDescriptorSetAllocateInfo allocInfo = {};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = upscaleShader->m_DescriptorPool;
+        allocInfo.descriptorSetCount = m_FramesInFlight;
+        allocInfo.pSetLayouts = upscaleLayouts.data();
+        m_UpscaleDescriptorSets.resize(m_FramesInFlight);
+        m_UpscaleDescriptorViews.assign(m_FramesInFlight, VK_NULL_HANDLE);
+        VkResult allocResult = vkAllocateDescriptorSets(m_GraphicsDevice->Device, &allocInfo, m_UpscaleDescriptorSets.data());
+        ASSERT(allocResult == VK_SUCCESS, "Failed to allocate upscale descriptor sets.");
+
+        // The depth-only shader reflects a layout with just the camera, so it cannot share the material
+        // sets; its own sets point at the same per-frame uniform buffers.
+        auto depthShader = m_ShaderLibrary->Get("depth");
+        std::vector<VkDescriptorSetLayout> depthLayouts(m_FramesInFlight, depthShader->m_DescriptorSetLayouts[0]);
+        allocInfo.descriptorPool = depthShader->m_DescriptorPool;
+        allocInfo.pSetLayouts = depthLayouts.data();
+        m_DepthPrepassDescriptorSets.resize(m_FramesInFlight);
+        allocResult = vkAllocateDescriptorSets(m_GraphicsDevice->Device, &allocInfo, m_DepthPrepassDescriptorSets.data());
+        ASSERT(allocResult == VK_SUCCESS, "Failed to allocate depth prepass descriptor sets.");
+        for (u32 i = 0; i < m_FramesInFlight; i++) {
+            VkDescriptorBufferInfo bufferInfo = {};
+            bufferInfo.buffer = m_UniformBuffers[i].UniformBuffer;
+            bufferInfo.offset = 0;
+            bufferInfo.range = m_UniformBuffers[i].Size;
+
+            VkWriteDescriptorSet write = {};
+            write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write.dstSet = m_DepthPrepassDescriptorSets[i];
+            write.dstBinding = 0;
+            write.dstArrayElement = 0;
+            write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            write.descriptorCount = 1;
+            write.pBufferInfo = &bufferInfo;
+            vkUpdateDescriptorSets(m_GraphicsDevice->Device, 1, &write, 0, nullptr);
+        }
+
+        // Query pools are per frame slot, so the profiler is rebuilt with the slot count; timing history
+        // starts over, which a change in frames in flight invalidates anyway.
+        m_GpuProfiler = GpuProfiler::Create(m_GraphicsDevice, m_FramesInFlight);
+        m_GpuProfiler->SetPipelineStatisticsEnabled(m_Settings.PipelineStatistics);
+        if (m_RenderGraph) {
+            m_RenderGraph->SetProfiler(m_GpuProfiler.get());
+        }
+    }
+
+    void Renderer::ReleaseFrameResources() {
+        VkDevice device = m_GraphicsDevice->Device;
+        std::vector<VulkanUniformBuffer> uniformBuffers = m_UniformBuffers;
+        VkDescriptorPool materialPool = m_ShaderLibrary->Get("basic")->m_DescriptorPool;
+        VkDescriptorPool upscalePool = m_ShaderLibrary->Get("upscale")->m_DescriptorPool;
+        VkDescriptorPool depthPool = m_ShaderLibrary->Get("depth")->m_DescriptorPool;
+        std::vector<VkDescriptorSet> materialSets = m_MaterialDescriptorSets;
+        std::vector<VkDescriptorSet> upscaleSets = m_UpscaleDescriptorSets;
+        std::vector<VkDescriptorSet> depthSets = m_DepthPrepassDescriptorSets;
+        // Pushed before the shaders' own deletions, so the sets go back to their pools before the pools go.
+        m_GraphicsDevice->PendingDeletions.Push([=]() {
+            for (const auto& buffer : uniformBuffers) {
+                vkUnmapMemory(device, buffer.UniformBufferMemory);
+                vkDestroyBuffer(device, buffer.UniformBuffer, nullptr);
+                vkFreeMemory(device, buffer.UniformBufferMemory, nullptr);
+            }
+            vkFreeDescriptorSets(device, materialPool, static_cast<u32>(materialSets.size()), materialSets.data());
+            vkFreeDescriptorSets(device, upscalePool, static_cast<u32>(upscaleSets.size()), upscaleSets.data());
+            vkFreeDescriptorSets(device, depthPool, static_cast<u32>(depthSets.size()), depthSets.data());
+        });
+        m_GpuProfiler.reset();
+        m_UniformBuffers.clear();
+        m_MaterialDescriptorSets.clear();
+        m_UpscaleDescriptorSets.clear();
+        m_UpscaleDescriptorViews.clear();
+        m_DepthPrepassDescriptorSets.clear();
+    }
+
+    void Renderer::SetMSAASamples(VkSampleCountFlagBits samples) {
+        // Fall back to the highest supported count not above the request; 1x is always supported.
+        VkSampleCountFlags supported = m_GraphicsDevice->Details.SupportedMultisamplingCounts | VK_SAMPLE_COUNT_1_BIT;
+        VkSampleCountFlagBits chosen = VK_SAMPLE_COUNT_1_BIT;
+        for (u32 count = samples; count > 0; count >>= 1) {
+            if (supported & count) {
+                chosen = static_cast<VkSampleCountFlagBits>(count);
+                break;
+            }
+        }
+        if (chosen != samples) {
+            LOG_WARN("MSAA x%u is not supported by this device, using x%u instead.", (u32)samples, (u32)chosen);
+        }
+        if (chosen == m_Settings.MSAASamples) { return; }
+
+        LOG_INFO("Switching MSAA to x%u.", (u32)chosen);
+        m_Settings.MSAASamples = chosen;
+        m_RenderGraphDirty = true;
+    }
+
+    void Renderer::SetDynamicResolution(const DynamicResolutionSettings& settings) {
+        LOG_INFO("Dynamic resolution %s (scale %.2f-%.2f, target %.2fms).", settings.Enabled ? "enabled" : "disabled", settings.MinScale, settings.MaxScale, settings.TargetGpuTime);
+        m_Settings.DynamicResolution = settings;
+        m_DynamicResolution.SetSettings(settings);
+        m_RenderGraphDirty = true;
+    }
+
+    void Renderer::SetPipelineStatistics(bool enabled) {
+        if (enabled && !m_GraphicsDevice->Details.PipelineStatisticsSupported) {
+            LOG_WARN("Pipeline statistics queries are not supported by this device.");
+            return;
+        }
+        LOG_INFO("Pipeline statistics %s.", enabled ? "enabled" : "disabled");
+        m_Settings.PipelineStatistics = enabled;
+        m_GpuProfiler->SetPipelineStatisticsEnabled(enabled);
+    }
+
+    void Renderer::SetOcclusionCulling(bool enabled) {
+        if (enabled == m_Settings.OcclusionCulling) { return; }
+        // The pyramid is built by sampling the depth buffer from a compute shader.
+        VkFormatProperties properties;
+        vkGetPhysicalDeviceFormatProperties(m_GraphicsDevice->PhysicalDevice, m_Context->GetSwapchainSpec().DepthFormat, &properties);
+        if (enabled && !(properties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT)) {
+            LOG_WARN("The depth format cannot be sampled on this device, occlusion culling is unavailable.");
+            return;
+        }
+        LOG_INFO("Occlusion culling %s.", enabled ? "enabled" : "disabled");
+        m_Settings.OcclusionCulling = enabled;
+        m_RenderGraphDirty = true;
+    }
+
+    void Renderer::SetCpuOcclusionCulling(bool enabled) {
+        if (enabled && !m_CpuOcclusionCuller) {
+            m_CpuOcclusionCuller = std::make_unique<SoftwareOcclusionCuller>();
+        }
+        LOG_INFO("CPU occlusion culling %s.", enabled ? "enabled" : "disabled");
+        m_Settings.CpuOcclusionCulling = enabled;
+    }
+
+    void Renderer::SetLodSelection(const LodSelectionSettings& settings) {
+        if (settings.ForcedLevel >= 0) {
+            LOG_INFO("LOD selection forced to level %i.", settings.ForcedLevel);
+        } else {
+            LOG_INFO("LOD selection: %.2f pixels of error, %.0f%% hysteresis.", settings.ErrorPixels, settings.Hysteresis * 100.0f);
+        }
+        m_Settings.LodSelection = settings;
+    }
+
+    void Renderer::BuildRenderGraph() {
+        CORTEX_PROFILE_FUNCTION();
+        const VulkanSwapchainSpecification& spec = m_Context->GetSwapchainSpec();
+        m_SwapchainGeneration = m_Context->GetSwapchainGeneration();
+        m_RenderGraphDirty = false;
+
+        m_RenderGraph->Reset();
+
+        RenderGraphImageDesc backbufferDesc = {};
+        backbufferDesc.Format = spec.SurfaceFormat.format;
+        backbufferDesc.Extent = spec.Extent;
+        backbufferDesc.Samples = VK_SAMPLE_COUNT_1_BIT;
+        m_Backbuffer = m_RenderGraph->ImportImage("Backbuffer", backbufferDesc, VK_IMAGE_LAYOUT_UNDEFINED, m_Context->GetBackbufferFinalLayout());
+
+        // With dynamic resolution on, the scene renders into the corner of an intermediate target sized
+        // for the largest scale, and a final pass stretches whatever part of it was used onto the backbuffer.
+        bool scaled = m_Settings.DynamicResolution.Enabled;
+        m_MaxRenderExtent = DynamicResolution::GetMaxRenderExtent(spec.Extent, m_Settings.DynamicResolution);
+        m_SceneColor = m_Backbuffer;
+        m_UpscalePass = RENDER_GRAPH_INVALID_HANDLE;
+
+        VkSampleCountFlagBits samples = m_Settings.MSAASamples;
+        RenderGraphImageDesc depthDesc = {};
+        depthDesc.Format = spec.DepthFormat;
+        depthDesc.Extent = m_MaxRenderExtent;
+        depthDesc.Samples = samples;
+        m_SceneDepth = RENDER_GRAPH_INVALID_HANDLE;
+        RenderGraphResource color = RENDER_GRAPH_INVALID_HANDLE;
+
+        // With occlusion culling the scene is drawn in two phases around a compute pass that reduces the
+        // first phase's depth into a pyramid and tests everything against it. The second phase loads
+        // what the first left in the attachments, so only the first clears and only the last resolves.
+        bool occlusion = m_Settings.OcclusionCulling;
+        m_PhaseCount = occlusion ? 2 : 1;
+        if (occlusion) {
+            m_OcclusionCuller->Resize(m_MaxRenderExtent, samples);
+        }
+
+        for (u32 index = 0; index < m_PhaseCount; index++) {
+            RendererScenePhase& phase = m_Phases[index];
+            bool first = index == 0;
+            bool last = index == m_PhaseCount - 1;
+
+            if (occlusion) {
+                m_RenderGraph->AddPass(first ? "OcclusionCullEarly" : "OcclusionCullLate", [&](RenderGraphBuilder& builder) {
+                    if (!first) {
+                        builder.ReadTexture(m_SceneDepth, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+                    }
+                    builder.SetSideEffect();
+                }, [this, first](VkCommandBuffer commandBuffer) {
+                    if (first) {
+                        m_OcclusionCuller->RecordEarlyCull(commandBuffer);
+                    } else {
+                        m_OcclusionCuller->RecordLateCull(commandBuffer, m_RenderGraph->GetImageView(m_SceneDepth));
+                    }
+                });
+            }
+
+            // The prepass leaves the nearest surface's depth in every pixel, so the forward pass only shades
+            // fragments that pass an EQUAL test against it and never writes depth. Sharing the attachment
+            // merges the two into one render pass, keeping depth on tile between them.
+            phase.DepthPrepassPass = RENDER_GRAPH_INVALID_HANDLE;
+            if (m_DepthPrepass) {
+                phase.DepthPrepassPass = m_RenderGraph->AddPass(first ? "DepthPrepass" : "DepthPrepassLate", [&](RenderGraphBuilder& builder) {
+                    if (first) {
+                        m_SceneDepth = builder.CreateImage("SceneDepth", depthDesc);
+                        builder.WriteDepth(m_SceneDepth, {1.0f, 0});
+                    } else {
+                        builder.WriteDepth(m_SceneDepth);
+                    }
+                }, [this, index](VkCommandBuffer commandBuffer) {
+                    RecordDepthPrepass(commandBuffer, index);
+                });
+            }
+
+            phase.ForwardPass = m_RenderGraph->AddPass(first ? "Forward" : "ForwardLate", [&](RenderGraphBuilder& builder) {
+                if (m_SceneDepth == RENDER_GRAPH_INVALID_HANDLE) {
+                    m_SceneDepth = builder.CreateImage("SceneDepth", depthDesc);
+                    builder.WriteDepth(m_SceneDepth, {1.0f, 0});
+                } else if (m_DepthPrepass) {
+                    builder.ReadDepth(m_SceneDepth);
+                } else {
+                    builder.WriteDepth(m_SceneDepth);
+                }
+
+                RenderGraphImageDesc colorDesc = backbufferDesc;
+                colorDesc.Extent = m_MaxRenderExtent;
+                if (first && scaled) {
+                    m_SceneColor = builder.CreateImage("SceneColor", colorDesc);
+                }
+
+                if (samples == VK_SAMPLE_COUNT_1_BIT) {
+                    if (first) {
+                        builder.WriteColor(m_SceneColor, {{0.8f, 0.8f, 0.8f, 1.0f}});
+                    } else {
+                        builder.WriteColor(m_SceneColor);
+                    }
+                    return;
+                }
+
+                if (first) {
+                    colorDesc.Samples = samples;
+                    color = builder.CreateImage("SceneColorMSAA", colorDesc);
+                    builder.WriteColor(color, {{0.8f, 0.8f, 0.8f, 1.0f}});
+                } else {
+                    builder.WriteColor(color);
+                }
+                if (last) {
+                    builder.ResolveColor(color, m_SceneColor);
+                }
+            }, [this, index](VkCommandBuffer commandBuffer) {
+                RecordForwardPass(commandBuffer, index);
+            });
+        }
+
+        if (scaled) {
+            m_UpscalePass = m_RenderGraph->AddPass("Upscale", [&](RenderGraphBuilder& builder) {
+                builder.ReadTexture(m_SceneColor);
+                builder.WriteColor(m_Backbuffer);
+            }, [this](VkCommandBuffer commandBuffer) {
+                RecordUpscalePass(commandBuffer);
+            });
+        }
+
+        m_RenderGraph->Compile();
+
+        // Render passes are cached by attachment signature, so a resize normally hands back the same
+        // handle and the pipeline survives; only rebuild it when the signature actually changed.
+        for (u32 index = 0; index < m_PhaseCount; index++) {
+            RendererScenePhase& phase = m_Phases[index];
+            if (m_DepthPrepass) {
+                VkRenderPass prepassRenderPass = m_RenderGraph->GetRenderPass(phase.DepthPrepassPass);
+                if (prepassRenderPass != phase.DepthPrepassRenderPass) {
+                    for (u32 layout = 0; layout < VERTEX_LAYOUT_COUNT; layout++) {
+                        auto pipelineConfig = VulkanPipelineConfig::Default();
+                        pipelineConfig.VertexBindings = vertex_layout_bindings(static_cast<VertexLayout>(layout));
+                        pipelineConfig.VertexAttributes = vertex_layout_attributes(static_cast<VertexLayout>(layout));
+                        pipelineConfig.VertexAttributes.resize(1); // position only
+                        pipelineConfig.ColorAttachmentCount = 0;
+                        pipelineConfig.Multisampler.rasterizationSamples = samples;
+                        pipelineConfig.RenderPass = prepassRenderPass;
+                        pipelineConfig.SubpassIndex = m_RenderGraph->GetSubpass(phase.DepthPrepassPass);
+                        phase.DepthPrepassPipelines[layout] = Pipeline::Create(m_GraphicsDevice, m_ShaderLibrary->Get("depth"), pipelineConfig);
+                    }
+                    phase.DepthPrepassRenderPass = prepassRenderPass;
+                }
+            }
+
+            VkRenderPass forwardRenderPass = m_RenderGraph->GetRenderPass(phase.ForwardPass);
+            if (forwardRenderPass != phase.ForwardRenderPass) {
+                for (u32 layout = 0; layout < VERTEX_LAYOUT_COUNT; layout++) {
+                    auto pipelineConfig = VulkanPipelineConfig::Default();
+                    pipelineConfig.VertexBindings = vertex_layout_bindings(static_cast<VertexLayout>(layout));
+                    pipelineConfig.VertexAttributes = vertex_layout_attributes(static_cast<VertexLayout>(layout));
+                    pipelineConfig.Multisampler.rasterizationSamples = samples;
+                    if (m_DepthPrepass) {
+                        pipelineConfig.DepthStencil.depthWriteEnable = VK_FALSE;
+                        pipelineConfig.DepthStencil.depthCompareOp = VK_COMPARE_OP_EQUAL;
+                    }
+                    pipelineConfig.RenderPass = forwardRenderPass;
+                    pipelineConfig.SubpassIndex = m_RenderGraph->GetSubpass(phase.ForwardPass);
+                    auto shader = m_ShaderLibrary->Get(renderer_forward_shader_name(static_cast<VertexLayout>(layout)));
+                    phase.ForwardPipelines[layout] = Pipeline::Create(m_GraphicsDevice, shader, pipelineConfig);
+                }
+                phase.ForwardRenderPass = forwardRenderPass;
+            }
+        }
+
+        if (!scaled) { return; }
+
+        VkRenderPass upscaleRenderPass = m_RenderGraph->GetRenderPass(m_UpscalePass);
+        if (upscaleRenderPass != m_UpscaleRenderPass) {
+            auto pipelineConfig = VulkanPipelineConfig::Default();
+            pipelineConfig.VertexBindings.clear();
+            pipelineConfig.VertexAttributes.clear();
+            pipelineConfig.Rasterizer.cullMode = VK_CULL_MODE_NONE;
+            pipelineConfig.DepthStencil.depthTestEnable = VK_FALSE;
+            pipelineConfig.DepthStencil.depthWriteEnable = VK_FALSE;
+            pipelineConfig.ColorBlendAttachment.blendEnable = VK_FALSE;
+            pipelineConfig.RenderPass = upscaleRenderPass;
+            pipelineConfig.SubpassIndex = m_RenderGraph->GetSubpass(m_UpscalePass);
+            m_UpscalePipeline = Pipeline::Create(m_GraphicsDevice, m_ShaderLibrary->Get("upscale"), pipelineConfig);
+            m_UpscaleRenderPass = upscaleRenderPass;
+        }
+    }
+
+    void Renderer::UpdateUpscaleDescriptor() {
+        // Only this frame's set is rewritten; its previous use finished before the frame fence signalled.
+        VkImageView view = m_RenderGraph->GetImageView(m_SceneColor);
+        if (m_UpscaleDescriptorViews[m_CurrentFrameIndex] == view) { return; }
+
+        VkDescriptorImageInfo imageInfo = {};
+        imageInfo.sampler = m_UpscaleSampler.Sampler;
+        imageInfo.imageView = view;
+        imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        VkWriteDescriptorSet write = {};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = m_UpscaleDescriptorSets[m_CurrentFrameIndex];
+        write.dstBinding = 0;
+        write.dstArrayElement = 0;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        write.descriptorCount = 1;
+        write.pImageInfo = &imageInfo;
+        vkUpdateDescriptorSets(m_GraphicsDevice->Device, 1, &write, 0, nullptr);
+        m_UpscaleDescriptorViews[m_CurrentFrameIndex] = view;
     }
 
     void Renderer::DrawScene(VkCommandBuffer commandBuffer, const Scene& scene) {
+        CORTEX_PROFILE_FUNCTION();
+        m_CurrentFrameIndex = m_Context->GetCurrentFrameIndex();
+        if (m_Context->GetFramesInFlight() != m_FramesInFlight) {
+            ReleaseFrameResources();
+            CreateFrameResources();
+        }
 
-        m_Pipeline->Bind(commandBuffer);
-        
-        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_Pipeline->GetLayout(), 0, 1, &m_MaterialDescriptorSets[m_CurrentFrameIndex], 0, nullptr);
+        // The forward pipeline's depth state depends on the prepass, so it is rebuilt along with the graph.
+        if (scene.DepthPrepass != m_DepthPrepass) {
+            LOG_INFO("Depth prepass %s.", scene.DepthPrepass ? "enabled" : "disabled");
+            m_DepthPrepass = scene.DepthPrepass;
+            for (auto& phase : m_Phases) {
+                phase.ForwardRenderPass = VK_NULL_HANDLE;
+            }
+            m_RenderGraphDirty = true;
+        }
 
-        for (auto& e : scene.Entities) {
-            // VulkanPushData push;
-            // push.ModelMatrix = scene.MainCamera.ProjectionMatrix * scene.MainCamera.ViewMatrix * e.Transform.ModelMatrix;
-            // vkCmdPushConstants(commandBuffer, m_PipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(VulkanPushData), &push);
-            
-            VulkanCameraUniformData cameraData;
-            cameraData.ModelToWorldSpace = e.Transform.ModelMatrix;
-            cameraData.WorldToClipSpace = scene.MainCamera.ProjectionMatrix * scene.MainCamera.ViewMatrix;
-            memcpy(m_UniformBuffers[m_CurrentFrameIndex].UniformBufferMapped, &cameraData, sizeof(cameraData));
-            
-            e.Mesh.Model->Bind(commandBuffer);
-            e.Mesh.Model->Draw(commandBuffer);
+        // Anything a rebuild replaces goes through the device's deletion queue, so neither a resize nor
+        // a settings change has to drain the GPU.
+        if (m_RenderGraphDirty || m_SwapchainGeneration != m_Context->GetSwapchainGeneration()) {
+            BuildRenderGraph();
+        }
+        if (m_UpscalePass != RENDER_GRAPH_INVALID_HANDLE) {
+            UpdateUpscaleDescriptor();
+        }
+
+        // This frame slot's timeline value has been waited on, so the timestamps it wrote last time are
+        // ready; a frame that resolved nothing leaves dynamic resolution where it was.
+        f64 gpuTime = 0.0;
+        if (m_GpuProfiler->BeginFrame(commandBuffer, m_CurrentFrameIndex, m_FrameStats.FrameNumber + 1)) {
+            gpuTime = m_GpuProfiler->GetFrameTime();
+        }
+        m_DynamicResolution.Update(gpuTime);
+        m_RenderExtent = m_DynamicResolution.GetRenderExtent(m_Context->GetSwapchainSpec().Extent);
+        m_RenderExtent.width = std::min(m_RenderExtent.width, m_MaxRenderExtent.width);
+        m_RenderExtent.height = std::min(m_RenderExtent.height, m_MaxRenderExtent.height);
+        for (u32 index = 0; index < m_PhaseCount; index++) {
+            m_RenderGraph->SetRenderArea(m_Phases[index].ForwardPass, m_RenderExtent);
+            if (m_Phases[index].DepthPrepassPass != RENDER_GRAPH_INVALID_HANDLE) {
+                m_RenderGraph->SetRenderArea(m_Phases[index].DepthPrepassPass, m_RenderExtent);
+            }
         }
 
-        m_CurrentFrameIndex = (m_CurrentFrameIndex + 1) % MAX_FRAMES_IN_FLIGHT;
+        // The camera is the same for every draw of both passes; the uniform buffer is read when the GPU
+        // executes the frame, so anything per entity has to travel in the command buffer instead.
+        VulkanCameraUniformData cameraData;
+        cameraData.WorldToClipSpace = scene.MainCamera.ProjectionMatrix * scene.MainCamera.ViewMatrix;
+        memcpy(m_UniformBuffers[m_CurrentFrameIndex].UniformBufferMapped, &cameraData, sizeof(cameraData));
+        m_GraphicsDevice->Counters.BytesUploaded += sizeof(cameraData);
+        // Levels are settled before either culler runs, since the GPU one bakes them into its draws.
+        SelectLods(scene);
+        if (m_PhaseCount > 1) {
+            m_OcclusionCuller->BeginFrame(m_CurrentFrameIndex, scene, m_EntityLods, cameraData.WorldToClipSpace, m_RenderExtent);
+        }
+        // Entities the CPU finds hidden are never recorded, so this has to finish before the graph executes.
+        m_EntityVisible.clear();
+        if (m_Settings.CpuOcclusionCulling) {
+            CullEntitiesOnCpu(scene, cameraData.WorldToClipSpace);
+        }
+
+        m_CurrentScene = &scene;
+        m_RenderGraph->SetImportedImage(m_Backbuffer, m_Context->GetCurrentSwapchainImage(), m_Context->GetCurrentSwapchainImageView());
+        m_RenderGraph->Execute(commandBuffer);
+        m_CurrentScene = nullptr;
+
+        const QueueWait& asyncCompute = m_RenderGraph->GetAsyncComputeWait();
+        if (asyncCompute.Point.Value > 0) {
+            m_Context->AddFrameDependency(asyncCompute.Point, asyncCompute.Stages);
+        }
+
+        m_GpuProfiler->EndFrame(commandBuffer);
+
+        auto now = std::chrono::steady_clock::now();
+        m_FrameStats.FrameNumber++;
+        m_FrameStats.FrameTime = std::chrono::duration<f64, std::chrono::milliseconds::period>(now - m_LastFrameTime).count();
+        m_FrameStats.MSAASamples = m_Settings.MSAASamples;
+        m_FrameStats.RenderExtent = m_RenderExtent;
+        m_FrameStats.RenderScale = m_DynamicResolution.GetScale();
+        m_FrameStats.DepthPrepass = m_DepthPrepass;
+        m_FrameStats.OcclusionCulling = m_PhaseCount > 1;
+        m_FrameStats.Occlusion = m_PhaseCount > 1 ? m_OcclusionCuller->GetStats() : OcclusionStats{};
+        m_FrameStats.CpuOcclusionCulling = m_Settings.CpuOcclusionCulling;
+        m_FrameStats.CpuOcclusion = m_Settings.CpuOcclusionCulling ? m_CpuOcclusionCuller->GetStats() : SoftwareOcclusionStats{};
+        if (gpuTime > 0.0) {
+            m_FrameStats.GpuTime = gpuTime;
+        }
+        m_LastFrameTime = now;
+        m_FrameStats.PresentMode = m_Context->GetSwapchainSpec().PresentMode;
+        m_FrameStats.FramesInFlight = m_FramesInFlight;
+
+        if (m_FrameTimeHistory.size() < FRAME_TIME_HISTORY_LENGTH) {
+            m_FrameTimeHistory.push_back(m_FrameStats.FrameTime);
+        } else {
+            m_FrameTimeHistory[m_FrameTimeCursor] = m_FrameStats.FrameTime;
+            m_FrameTimeCursor = (m_FrameTimeCursor + 1) % FRAME_TIME_HISTORY_LENGTH;
+        }
+        f64 sum = 0.0;
+        f64 maxTime = 0.0;
+        for (f64 time : m_FrameTimeHistory) {
+            sum += time;
+            maxTime = std::max(maxTime, time);
+        }
+        f64 mean = sum / m_FrameTimeHistory.size();
+        f64 variance = 0.0;
+        for (f64 time : m_FrameTimeHistory) {
+            variance += (time - mean) * (time - mean);
+        }
+        m_FrameStats.FrameTimeMean = mean;
+        m_FrameStats.FrameTimeStdDev = glm::sqrt(variance / m_FrameTimeHistory.size());
+        m_FrameStats.FrameTimeMax = maxTime;
+
+        m_FrameStats.Counters = m_GraphicsDevice->Counters;
+        m_GraphicsDevice->Counters = {};
+
+        // Pipeline statistics belong to the frame the profiler resolved, so overdraw uses that frame's
+        // render extent while it is still in the history.
+        const GpuFrameTimings& gpuTimings = m_GpuProfiler->GetLatest();
+        m_FrameStats.PipelineStatistics = gpuTimings.Statistics;
+        m_FrameStats.Overdraw = 0.0;
+        VkExtent2D statisticsExtent = m_RenderExtent;
+        const FrameStats& resolved = m_StatsHistory[gpuTimings.FrameNumber % FRAME_STATS_HISTORY_LENGTH];
+        if (resolved.FrameNumber == gpuTimings.FrameNumber) {
+            statisticsExtent = resolved.RenderExtent;
+        }
+        u64 pixels = static_cast<u64>(statisticsExtent.width) * statisticsExtent.height;
+        if (pixels > 0) {
+            m_FrameStats.Overdraw = static_cast<f64>(gpuTimings.Statistics.FragmentShaderInvocations) / pixels;
+        }
+
+        m_StatsHistory[m_FrameStats.FrameNumber % FRAME_STATS_HISTORY_LENGTH] = m_FrameStats;
+    }
+
+    void Renderer::SelectLods(const Scene& scene) {
+        CORTEX_PROFILE_FUNCTION();
+        const LodSelectionSettings& settings = m_Settings.LodSelection;
+        m_EntityLods.resize(scene.Entities.size(), 0);
+
+        // World space units to pixels: a perspective projection divides by distance, an orthographic
+        // one does not. Errors are measured at the nearest point of each bounding sphere.
+        const glm::mat4& projection = scene.MainCamera.ProjectionMatrix;
+        bool perspective = projection[2][3] != 0.0f;
+        f32 pixelsPerUnit = glm::abs(projection[1][1]) * 0.5f * m_RenderExtent.height;
+        glm::vec3 cameraPosition = glm::vec3(glm::inverse(scene.MainCamera.ViewMatrix)[3]);
+        f32 coarsenThreshold = settings.ErrorPixels * (1.0f - settings.Hysteresis);
+
+        for (u32 i = 0; i < scene.Entities.size(); i++) {
+            const Model& model = *scene.Entities[i].Mesh.Model;
+            u32 coarsest = model.GetLodCount() - 1;
+            if (settings.ForcedLevel >= 0) {
+                m_EntityLods[i] = static_cast<u8>(std::min<u32>(settings.ForcedLevel, coarsest));
+                continue;
+            }
+            if (coarsest == 0) {
+                m_EntityLods[i] = 0;
+                continue;
+            }
+
+            glm::vec4 sphere = model.GetBoundingSphere(scene.Entities[i].Transform.ModelMatrix);
+            f32 modelRadius = model.GetBoundingSphere().w;
+            f32 scale = modelRadius > 0.0f ? sphere.w / modelRadius : 1.0f;
+            f32 pixelsPerError = scale * pixelsPerUnit;
+            if (perspective) {
+                pixelsPerError /= std::max(glm::length(glm::vec3(sphere) - cameraPosition) - sphere.w, 1e-3f);
+            }
+
+            u32 lod = std::min<u32>(m_EntityLods[i], coarsest);
+            while (lod > 0 && model.GetLod(lod).Error * pixelsPerError > settings.ErrorPixels) {
+                lod--;
+            }
+            while (lod < coarsest && model.GetLod(lod + 1).Error * pixelsPerError <= coarsenThreshold) {
+                lod++;
+            }
+            m_EntityLods[i] = static_cast<u8>(lod);
+        }
+    }
+
+    void Renderer::CullEntitiesOnCpu(const Scene& scene, const glm::mat4& worldToClip) {
+        CORTEX_PROFILE_FUNCTION();
+        m_CpuOccluders.clear();
+        m_EntitySpheres.resize(scene.Entities.size());
+        for (u32 i = 0; i < scene.Entities.size(); i++) {
+            const Entity& e = scene.Entities[i];
+            if (e.Mesh.Occluder) {
+                m_CpuOccluders.push_back({e.Mesh.Occluder.get(), e.Transform.ModelMatrix});
+            }
+            m_EntitySpheres[i] = e.Mesh.Model->GetBoundingSphere(e.Transform.ModelMatrix);
+        }
+        m_CpuOcclusionCuller->Cull(worldToClip, m_CpuOccluders, m_EntitySpheres, m_EntityVisible);
+    }
+
+    std::vector<FrameStats> Renderer::GetFrameStatsHistory() {
+        std::vector<FrameStats> history;
+        u64 last = m_FrameStats.FrameNumber;
+        u64 first = last >= FRAME_STATS_HISTORY_LENGTH ? last - FRAME_STATS_HISTORY_LENGTH + 1 : 1;
+        for (u64 frame = first; frame <= last; frame++) {
+            history.push_back(m_StatsHistory[frame % FRAME_STATS_HISTORY_LENGTH]);
+        }
+        return history;
+    }
+
+    bool Renderer::WriteFrameStatsCSV(const std::string& path) {
+        std::ofstream file(path);
+        if (!file.is_open()) {
+            LOG_ERROR("Could not open %s to write frame stats.", path.c_str());
+            return false;
+        }
+
+        file << "frame,frame_ms,gpu_ms,render_width,render_height,msaa,depth_prepass,draw_calls,instances,triangles,pipeline_binds,descriptor_binds,bytes_uploaded,"
+             << "ia_vertices,ia_primitives,vs_invocations,clip_invocations,clip_primitives,fs_invocations,cs_invocations,overdraw,"
+             << "occlusion_culling,occlusion_tested,frustum_culled,occlusion_culled,drawn_early,drawn_late,"
+             << "cpu_occlusion_culling,cpu_occluders,cpu_occluder_triangles,cpu_tested,cpu_frustum_culled,cpu_occlusion_culled,cpu_raster_ms,cpu_test_ms";
+        for (u32 lod = 0; lod < MESH_MAX_LODS; lod++) {
+            file << ",lod" << lod << "_instances,lod" << lod << "_triangles";
+        }
+        file << "\n";
+        std::vector<FrameStats> history = GetFrameStatsHistory();
+        for (const FrameStats& stats : history) {
+            const RenderCounters& c = stats.Counters;
+            const GpuPipelineStatistics& p = stats.PipelineStatistics;
+            const OcclusionStats& o = stats.Occlusion;
+            const SoftwareOcclusionStats& s = stats.CpuOcclusion;
+            file << stats.FrameNumber << "," << stats.FrameTime << "," << stats.GpuTime << "," << stats.RenderExtent.width << ","
+                 << stats.RenderExtent.height << "," << (u32)stats.MSAASamples << "," << (u32)stats.DepthPrepass << "," << c.DrawCalls << "," << c.Instances << ","
+                 << c.Triangles << "," << c.PipelineBinds << "," << c.DescriptorBinds << "," << c.BytesUploaded << ","
+                 << p.InputVertices << "," << p.InputPrimitives << "," << p.VertexShaderInvocations << "," << p.ClippingInvocations << ","
+                 << p.ClippingPrimitives << "," << p.FragmentShaderInvocations << "," << p.ComputeShaderInvocations << "," << stats.Overdraw << ","
+                 << (u32)stats.OcclusionCulling << "," << o.Tested << "," << o.FrustumCulled << "," << o.OcclusionCulled << "," << o.DrawnEarly << "," << o.DrawnLate << ","
+                 << (u32)stats.CpuOcclusionCulling << "," << s.Occluders << "," << s.TrianglesRasterized << "," << s.Tested << "," << s.FrustumCulled << ","
+                 << s.OcclusionCulled << "," << s.RasterMilliseconds << "," << s.TestMilliseconds;
+            for (u32 lod = 0; lod < MESH_MAX_LODS; lod++) {
+                file << "," << c.LodInstances[lod] << "," << c.LodTriangles[lod];
+            }
+            file << "\n";
+        }
+        LOG_INFO("Wrote %zu frames of stats to %s.", history.size(), path.c_str());
+        return true;
+    }
+
+    void Renderer::RecordUpscalePass(VkCommandBuffer commandBuffer) {
+        struct {
+            glm::vec2 UVScale;
+            glm::vec2 TexelSize;
+            f32 Sharpness;
+        } push;
+        push.UVScale = glm::vec2(m_RenderExtent.width, m_RenderExtent.height) / glm::vec2(m_MaxRenderExtent.width, m_MaxRenderExtent.height);
+        push.TexelSize = 1.0f / glm::vec2(m_MaxRenderExtent.width, m_MaxRenderExtent.height);
+        push.Sharpness = m_Settings.DynamicResolution.Filter == UpscaleFilter::Sharpened ? m_Settings.DynamicResolution.Sharpness : 0.0f;
+
+        m_UpscalePipeline->Bind(commandBuffer);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_UpscalePipeline->GetLayout(), 0, 1, &m_UpscaleDescriptorSets[m_CurrentFrameIndex], 0, nullptr);
+        m_GraphicsDevice->Counters.DescriptorBinds++;
+        vkCmdPushConstants(commandBuffer, m_UpscalePipeline->GetLayout(), VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(push), &push);
+        vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+    }
+
+    void Renderer::RecordDepthPrepass(VkCommandBuffer commandBuffer, u32 phase) {
+        CORTEX_PROFILE_FUNCTION();
+        auto& pipelines = m_Phases[phase].DepthPrepassPipelines;
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelines[0]->GetLayout(), 0, 1, &m_DepthPrepassDescriptorSets[m_CurrentFrameIndex], 0, nullptr);
+        m_GraphicsDevice->Counters.DescriptorBinds++;
+        RecordEntityDraws(commandBuffer, pipelines, phase);
+    }
+
+    void Renderer::RecordForwardPass(VkCommandBuffer commandBuffer, u32 phase) {
+        CORTEX_PROFILE_FUNCTION();
+        auto& pipelines = m_Phases[phase].ForwardPipelines;
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelines[0]->GetLayout(), 0, 1, &m_MaterialDescriptorSets[m_CurrentFrameIndex], 0, nullptr);
+        m_GraphicsDevice->Counters.DescriptorBinds++;
+        RecordEntityDraws(commandBuffer, pipelines, phase);
+    }
+
+    void Renderer::RecordEntityDraws(VkCommandBuffer commandBuffer, const std::array<std::shared_ptr<Pipeline>, VERTEX_LAYOUT_COUNT>& pipelines, u32 phase) {
+        const Scene& scene = *m_CurrentScene;
+        const Model* boundModel = nullptr;
+        const Pipeline* boundPipeline = nullptr;
+        VkPipelineLayout layout = pipelines[0]->GetLayout();
+        // With occlusion culling every entity is still recorded, but through the indirect command the
+        // cull shader wrote for it this phase. Per-entity data travels in push constants, so the draws
+        // cannot be folded into one multi-draw. What the CPU culled is skipped outright.
+        bool indirect = m_PhaseCount > 1;
+        for (u32 i = 0; i < scene.Entities.size(); i++) {
+            if (!m_EntityVisible.empty() && !m_EntityVisible[i]) {
+                continue;
+            }
+            const Entity& e = scene.Entities[i];
+            // The pipelines differ only in vertex input, so switching layouts keeps the sets and pushes.
+            Pipeline* pipeline = pipelines[static_cast<u32>(e.Mesh.Model->GetVertexLayout())].get();
+            if (pipeline != boundPipeline) {
+                pipeline->Bind(commandBuffer);
+                boundPipeline = pipeline;
+            }
+
+            VulkanPushData push;
+            push.ModelMatrix = e.Transform.ModelMatrix * e.Mesh.Model->GetVertexToModel();
+            push.Color = e.Mesh.Material ? e.Mesh.Material->GetBaseColor() : glm::vec4(1.0f);
+            vkCmdPushConstants(commandBuffer, layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(VulkanPushData), &push);
+
+            // Consecutive entities sharing a model keep its buffers bound.
+            if (e.Mesh.Model.get() != boundModel) {
+                e.Mesh.Model->Bind(commandBuffer);
+                boundModel = e.Mesh.Model.get();
+            }
+            if (indirect) {
+                e.Mesh.Model->DrawIndirect(commandBuffer, m_OcclusionCuller->GetDrawBuffer(), m_OcclusionCuller->GetDrawOffset(phase, i));
+            } else {
+                e.Mesh.Model->Draw(commandBuffer, m_EntityLods[i]);
+            }
+        }
     }
 
     VkDescriptorSetLayout vulkan_create_descriptor_set_layout(VkDevice device) {
@@ -77,14 +766,14 @@ namespace Cortex {
         return layout;
     }
 
-    VkDescriptorPool vulkan_create_descriptor_pool(VkDevice device) {
+    VkDescriptorPool vulkan_create_descriptor_pool(VkDevice device, u32 count) {
         VkDescriptorPoolSize samplerSize = {};
         samplerSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        samplerSize.descriptorCount = MAX_FRAMES_IN_FLIGHT;
+        samplerSize.descriptorCount = count;
 
         VkDescriptorPoolSize uniformSize = {};
         uniformSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        uniformSize.descriptorCount = MAX_FRAMES_IN_FLIGHT;
+        uniformSize.descriptorCount = count;
 
         std::array<VkDescriptorPoolSize, 2> sizes = {uniformSize, samplerSize};
     
@@ -92,7 +781,7 @@ namespace Cortex {
         createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
         createInfo.poolSizeCount = 2;
         createInfo.pPoolSizes = sizes.data();
-        createInfo.maxSets = MAX_FRAMES_IN_FLIGHT;
+        createInfo.maxSets = count;
 
         VkDescriptorPool pool;
         VkResult result = vkCreateDescriptorPool(device, &createInfo, nullptr, &pool);
@@ -6,10 +6,46 @@
 #include "Cortex/Graphics/VulkanImages.hpp"
 #include "Cortex/Graphics/GraphicsContext.hpp"
 #include "Cortex/Graphics/Pipeline.hpp"
+#include "Cortex/Graphics/RenderGraph.hpp"
+#include "Cortex/Graphics/FrameStats.hpp"
+#include "Cortex/Graphics/DynamicResolution.hpp"
+#include "Cortex/Graphics/GpuProfiler.hpp"
+#include "Cortex/Graphics/OcclusionCuller.hpp"
 
 #include "Cortex/Core/Scene.hpp"
 
 namespace Cortex {
+    // Each entity draws the coarsest level of detail whose error, projected to the screen, stays within
+    // ErrorPixels. Once at a level it only moves to a coarser one when that level's error is Hysteresis
+    // below the threshold, so entities hovering at a boundary do not flicker between two levels.
+    struct LodSelectionSettings {
+        f32 ErrorPixels = 1.0f;
+        f32 Hysteresis = 0.25f;
+        i32 ForcedLevel = -1;   // draws every model at this level, or its coarsest; negative selects by error
+    };
+
+    struct RendererSettings {
+        VkSampleCountFlagBits MSAASamples = VK_SAMPLE_COUNT_4_BIT;
+        DynamicResolutionSettings DynamicResolution;
+        bool PipelineStatistics = false; // per-pass pipeline statistics queries; costs a little GPU time
+        bool OcclusionCulling = false;   // two-phase culling against a depth pyramid built on the GPU
+        bool CpuOcclusionCulling = false;   // skips recording entities hidden behind designated occluders
+        LodSelectionSettings LodSelection;
+    };
+
+    // The passes that draw the scene. Without occlusion culling there is a single phase; with it,
+    // phase 0 draws what was visible last frame and phase 1 what the depth pyramid shows is new. The
+    // phases' render passes can differ (only the last resolves), so each has its own pipelines, one
+    // per vertex layout. A layout's pipelines share their pipeline layout with every other layout's.
+    struct RendererScenePhase {
+        RenderGraphPass DepthPrepassPass = RENDER_GRAPH_INVALID_HANDLE;
+        VkRenderPass DepthPrepassRenderPass = VK_NULL_HANDLE;
+        std::array<std::shared_ptr<Pipeline>, VERTEX_LAYOUT_COUNT> DepthPrepassPipelines;
+        RenderGraphPass ForwardPass = RENDER_GRAPH_INVALID_HANDLE;
+        VkRenderPass ForwardRenderPass = VK_NULL_HANDLE;
+        std::array<std::shared_ptr<Pipeline>, VERTEX_LAYOUT_COUNT> ForwardPipelines;
+    };
+
     class Renderer {
         public:
             static std::unique_ptr<Renderer> Create(const std::unique_ptr<GraphicsContext>& context);
@@ -18,21 +54,80 @@ namespace Cortex {
             Renderer(const Renderer&) = delete;
             Renderer &operator=(const Renderer&) = delete;
             void DrawScene(VkCommandBuffer commandBuffer, const Scene& scene);
+            inline RenderGraph& GetRenderGraph() { return *m_RenderGraph; }
+            inline const RendererSettings& GetSettings() { return m_Settings; }
+            inline const FrameStats& GetFrameStats() { return m_FrameStats; }
+            // The last FRAME_STATS_HISTORY_LENGTH frames, oldest first.
+            std::vector<FrameStats> GetFrameStatsHistory();
+            bool WriteFrameStatsCSV(const std::string& path);
+            // Per-pass GPU timings from a few frames ago; empty if the device cannot write timestamps.
+            inline const GpuFrameTimings& GetGpuTimings() { return m_GpuProfiler->GetLatest(); }
+            inline GpuProfiler& GetGpuProfiler() { return *m_GpuProfiler; }
+            void SetMSAASamples(VkSampleCountFlagBits samples);
+            void SetDynamicResolution(const DynamicResolutionSettings& settings);
+            void SetPipelineStatistics(bool enabled);
+            void SetOcclusionCulling(bool enabled);
+            void SetCpuOcclusionCulling(bool enabled);
+            void SetLodSelection(const LodSelectionSettings& settings);
         private:
+            void CreateFrameResources();
+            void ReleaseFrameResources();
+            void BuildRenderGraph();
+            void SelectLods(const Scene& scene);
+            void CullEntitiesOnCpu(const Scene& scene, const glm::mat4& worldToClip);
+            void RecordDepthPrepass(VkCommandBuffer commandBuffer, u32 phase);
+            void RecordForwardPass(VkCommandBuffer commandBuffer, u32 phase);
+            void RecordEntityDraws(VkCommandBuffer commandBuffer, const std::array<std::shared_ptr<Pipeline>, VERTEX_LAYOUT_COUNT>& pipelines, u32 phase);
+            void RecordUpscalePass(VkCommandBuffer commandBuffer);
+            void UpdateUpscaleDescriptor();
+
+            GraphicsContext* m_Context;
             std::shared_ptr<GraphicsDevice> m_GraphicsDevice;
+            std::unique_ptr<RenderGraph> m_RenderGraph;
+            bool m_RenderGraphDirty;
+            u32 m_SwapchainGeneration;
+            RendererSettings m_Settings;
+            FrameStats m_FrameStats;
+            std::chrono::steady_clock::time_point m_LastFrameTime;
+            std::vector<f64> m_FrameTimeHistory;
+            u32 m_FrameTimeCursor;
+            std::vector<FrameStats> m_StatsHistory; // ring indexed by frame number modulo FRAME_STATS_HISTORY_LENGTH
+            RenderGraphResource m_Backbuffer;
+            std::array<RendererScenePhase, 2> m_Phases;
+            u32 m_PhaseCount;       // 2 when the graph was built with occlusion culling
+            RenderGraphResource m_SceneDepth;
+            bool m_DepthPrepass;    // whether the graph was built with the prepass; follows the scene drawn
+            std::vector<VkDescriptorSet> m_DepthPrepassDescriptorSets;
+            std::unique_ptr<OcclusionCuller> m_OcclusionCuller;
+            std::unique_ptr<SoftwareOcclusionCuller> m_CpuOcclusionCuller;  // created when first enabled
+            std::vector<SoftwareOccluder> m_CpuOccluders;
+            std::vector<glm::vec4> m_EntitySpheres;
+            std::vector<u8> m_EntityVisible;    // this frame's CPU culling result; empty records everything
+            std::vector<u8> m_EntityLods;       // level of detail per entity, kept from frame to frame for hysteresis
+            DynamicResolution m_DynamicResolution;
+            VkExtent2D m_MaxRenderExtent;
+            VkExtent2D m_RenderExtent;
+            RenderGraphResource m_SceneColor;
+            RenderGraphPass m_UpscalePass;
+            VkRenderPass m_UpscaleRenderPass;
+            std::shared_ptr<Pipeline> m_UpscalePipeline;
+            VulkanSampler2D m_UpscaleSampler;
+            std::vector<VkDescriptorSet> m_UpscaleDescriptorSets;
+            std::vector<VkImageView> m_UpscaleDescriptorViews;
+            std::unique_ptr<GpuProfiler> m_GpuProfiler;
+            const Scene* m_CurrentScene;
             u32 m_CurrentFrameIndex;
+            u32 m_FramesInFlight;
             std::shared_ptr<ShaderLibrary> m_ShaderLibrary;
             VkDescriptorSetLayout m_MaterialDescriptorSetLayout;
             std::vector<VkDescriptorSet> m_MaterialDescriptorSets;
-            VkDescriptorPool m_MaterialDescriptorPool;
             VkPipelineLayout m_PipelineLayout;
-            std::shared_ptr<Pipeline> m_Pipeline;
             std::shared_ptr<Texture2D> m_Texture;
             std::vector<VulkanUniformBuffer> m_UniformBuffers;
     };
 
     VkDescriptorSetLayout vulkan_create_descriptor_set_layout(VkDevice device);
-    VkDescriptorPool vulkan_create_descriptor_pool(VkDevice device);
+    VkDescriptorPool vulkan_create_descriptor_pool(VkDevice device, u32 count);
     std::vector<VkDescriptorSet> vulkan_create_descriptor_sets(VkDevice device, VkDescriptorPool pool, u32 count, VkDescriptorSetLayout layout, std::shared_ptr<Texture2D> tex, const std::vector<VulkanUniformBuffer>& buffers);
 
 }
\ No newline at end of file
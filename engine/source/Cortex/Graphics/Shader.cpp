@@ -1,45 +1,69 @@
 #include "Cortex/Graphics/Shader.hpp"
 
 namespace Cortex {
-    std::shared_ptr<Shader> Shader::Create(std::shared_ptr<GraphicsDevice> device, const std::string& vertPath, const std::string& fragPath) {
-        return std::make_shared<Shader>(device, vertPath, fragPath);
+    std::shared_ptr<Shader> Shader::Create(std::shared_ptr<GraphicsDevice> device, const std::string& vertPath, const std::string& fragPath, const std::vector<std::string>& defines) {
+        return std::make_shared<Shader>(device, vertPath, fragPath, defines);
     }
 
-    Shader::Shader(std::shared_ptr<GraphicsDevice> device, const std::string& vertPath, const std::string& fragPath) {
+    std::shared_ptr<Shader> Shader::CreateCompute(std::shared_ptr<GraphicsDevice> device, const std::string& compPath) {
+        return std::make_shared<Shader>(device, compPath);
+    }
+
+    Shader::Shader(std::shared_ptr<GraphicsDevice> device, const std::string& vertPath, const std::string& fragPath, const std::vector<std::string>& defines) {
         m_GraphicsDevice = device;
         
         m_VertPath = vertPath;
         m_FragPath = fragPath;
 
-        m_ShaderBinaries[VK_SHADER_STAGE_VERTEX_BIT] = vulkan_compile_from_source(vertPath, ShaderType::VERTEX);
-        m_ShaderBinaries[VK_SHADER_STAGE_FRAGMENT_BIT] = vulkan_compile_from_source(fragPath, ShaderType::FRAGMENT);
+        // Without a fragment stage the shader is for depth-only passes.
+        m_ShaderBinaries[VK_SHADER_STAGE_VERTEX_BIT] = vulkan_compile_from_source(vertPath, ShaderType::VERTEX, defines);
+        if (!fragPath.empty()) {
+            m_ShaderBinaries[VK_SHADER_STAGE_FRAGMENT_BIT] = vulkan_compile_from_source(fragPath, ShaderType::FRAGMENT, defines);
+        }
+        Build();
+    }
+
+    Shader::Shader(std::shared_ptr<GraphicsDevice> device, const std::string& compPath) {
+        m_GraphicsDevice = device;
+
+        m_CompPath = compPath;
+        m_ShaderBinaries[VK_SHADER_STAGE_COMPUTE_BIT] = vulkan_compile_from_source(compPath, ShaderType::COMPUTE);
+        Build();
+    }
 
+    void Shader::Build() {
         m_ShaderSpec = Reflect();
         CreateDescriptorPool();
         CreateDescriptorSetLayouts();
         CreatePipelineLayout();
-        
-        m_ShaderModules[VK_SHADER_STAGE_VERTEX_BIT] = vulkan_create_shader_module(m_GraphicsDevice->Device, m_ShaderBinaries[VK_SHADER_STAGE_VERTEX_BIT]);
-        m_ShaderModules[VK_SHADER_STAGE_FRAGMENT_BIT] = vulkan_create_shader_module(m_GraphicsDevice->Device, m_ShaderBinaries[VK_SHADER_STAGE_FRAGMENT_BIT]);
 
-        m_ShaderStageCreateInfos.resize(2);
+        for (VkShaderStageFlagBits stage : {VK_SHADER_STAGE_VERTEX_BIT, VK_SHADER_STAGE_FRAGMENT_BIT, VK_SHADER_STAGE_COMPUTE_BIT}) {
+            if (m_ShaderBinaries.find(stage) == m_ShaderBinaries.end()) { continue; }
+            m_ShaderModules[stage] = vulkan_create_shader_module(m_GraphicsDevice->Device, m_ShaderBinaries[stage]);
 
-        m_ShaderStageCreateInfos[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-        m_ShaderStageCreateInfos[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
-        m_ShaderStageCreateInfos[0].module = m_ShaderModules[VK_SHADER_STAGE_VERTEX_BIT];
-        m_ShaderStageCreateInfos[0].pName = "main";
-
-        m_ShaderStageCreateInfos[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-        m_ShaderStageCreateInfos[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-        m_ShaderStageCreateInfos[1].module = m_ShaderModules[VK_SHADER_STAGE_FRAGMENT_BIT];
-        m_ShaderStageCreateInfos[1].pName = "main";
+            VkPipelineShaderStageCreateInfo stageInfo = {};
+            stageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+            stageInfo.stage = stage;
+            stageInfo.module = m_ShaderModules[stage];
+            stageInfo.pName = "main";
+            m_ShaderStageCreateInfos.push_back(stageInfo);
+        }
     }
 
     Shader::~Shader() {
-        for (auto& module : m_ShaderModules)
-            vkDestroyShaderModule(m_GraphicsDevice->Device, module.second, nullptr);
-        for (auto& layout : m_DescriptorSetLayouts)
-            vkDestroyDescriptorSetLayout(m_GraphicsDevice->Device, layout.second, nullptr);
+        VkDevice device = m_GraphicsDevice->Device;
+        auto modules = m_ShaderModules;
+        auto layouts = m_DescriptorSetLayouts;
+        VkPipelineLayout pipelineLayout = m_PipelineLayout;
+        VkDescriptorPool descriptorPool = m_DescriptorPool;
+        m_GraphicsDevice->PendingDeletions.Push([=]() {
+            for (auto& module : modules)
+                vkDestroyShaderModule(device, module.second, nullptr);
+            for (auto& layout : layouts)
+                vkDestroyDescriptorSetLayout(device, layout.second, nullptr);
+            vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+            vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+        });
     }
 
     void Shader::Compile() {
@@ -63,8 +87,8 @@ namespace Cortex {
                 VulkanDescriptorSpec descriptorSpec = {
                         .Name = res.name,
                         .Type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-                        .Stages = stageFlags,
-                        .Count = count
+                        .Count = count,
+                        .Stages = stageFlags
                     };
                 spec.DescriptorSets[set].Descriptors[binding] = descriptorSpec;
                 spec.TypeCounts[VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER] += 1;
@@ -80,40 +104,91 @@ namespace Cortex {
                 VulkanDescriptorSpec descriptorSpec = {
                         .Name = res.name,
                         .Type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                        .Stages = stageFlags,
-                        .Count = count
+                        .Count = count,
+                        .Stages = stageFlags
                     };
                 spec.DescriptorSets[set].Descriptors[binding] = descriptorSpec;
                 spec.TypeCounts[VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER] += 1;
             }
 
+            for (const auto& res : resources.storage_buffers) {
+                u32 set = comp.get_decoration(res.id, spv::DecorationDescriptorSet);
+                u32 binding = comp.get_decoration(res.id, spv::DecorationBinding);
+
+                VkShaderStageFlags stageFlags = spec.DescriptorSets[set].Descriptors[binding].Stages | stage.first;
+                VulkanDescriptorSpec descriptorSpec = {
+                        .Name = res.name,
+                        .Type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .Count = 1,
+                        .Stages = stageFlags
+                    };
+                spec.DescriptorSets[set].Descriptors[binding] = descriptorSpec;
+                spec.TypeCounts[VK_DESCRIPTOR_TYPE_STORAGE_BUFFER] += 1;
+            }
+
+            for (const auto& res : resources.storage_images) {
+                u32 set = comp.get_decoration(res.id, spv::DecorationDescriptorSet);
+                u32 binding = comp.get_decoration(res.id, spv::DecorationBinding);
+
+                VkShaderStageFlags stageFlags = spec.DescriptorSets[set].Descriptors[binding].Stages | stage.first;
+                VulkanDescriptorSpec descriptorSpec = {
+                        .Name = res.name,
+                        .Type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                        .Count = 1,
+                        .Stages = stageFlags
+                    };
+                spec.DescriptorSets[set].Descriptors[binding] = descriptorSpec;
+                spec.TypeCounts[VK_DESCRIPTOR_TYPE_STORAGE_IMAGE] += 1;
+            }
+
+            for (const auto& res : resources.subpass_inputs) {
+                u32 set = comp.get_decoration(res.id, spv::DecorationDescriptorSet);
+                u32 binding = comp.get_decoration(res.id, spv::DecorationBinding);
+
+                VkShaderStageFlags stageFlags = spec.DescriptorSets[set].Descriptors[binding].Stages | stage.first;
+                VulkanDescriptorSpec descriptorSpec = {
+                        .Name = res.name,
+                        .Type = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT,
+                        .Count = 1,
+                        .Stages = stageFlags
+                    };
+                spec.DescriptorSets[set].Descriptors[binding] = descriptorSpec;
+                spec.TypeCounts[VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT] += 1;
+            }
+
             for (const auto& res : resources.push_constant_buffers) {
                 auto& type = comp.get_type(res.base_type_id);
                 i32 memberCount = type.member_types.size();
                 u32 size = comp.get_declared_struct_size(type);
                 spec.PushConstants[stage.first].Name = res.name;
+                spec.PushConstants[stage.first].Size = size;
             }
         }
         return spec;
     }
 
     void Shader::CreateDescriptorPool() {
+        // Room for one set per frame at the frames-in-flight limit, twice over: when the frame count
+        // changes, the old per-frame sets are only freed once the frames using them have completed.
+        u32 setCapacity = 2 * MAX_FRAMES_IN_FLIGHT_LIMIT;
         std::vector<VkDescriptorPoolSize> poolSizes;
 
         for (auto& type : m_ShaderSpec.TypeCounts) {
             VkDescriptorPoolSize poolSize = {
                 .type = type.first,
-                .descriptorCount = type.second * MAX_FRAMES_IN_FLIGHT
+                .descriptorCount = type.second * setCapacity
             };
             poolSizes.push_back(poolSize);
         }
 
         VkDescriptorPoolCreateInfo poolInfo = {};
         poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
         poolInfo.poolSizeCount = static_cast<u32>(poolSizes.size());
         poolInfo.pPoolSizes = poolSizes.data();
-        poolInfo.maxSets = static_cast<u32>(m_ShaderSpec.DescriptorSets.size()) * MAX_FRAMES_IN_FLIGHT;        
+        poolInfo.maxSets = static_cast<u32>(m_ShaderSpec.DescriptorSets.size()) * setCapacity;
         VkResult result = vkCreateDescriptorPool(m_GraphicsDevice->Device, &poolInfo, nullptr, &m_DescriptorPool);
+        ASSERT(result == VK_SUCCESS, "Failed to create shader descriptor pool.");
     }
 
     void Shader::CreateDescriptorSetLayouts() {
@@ -140,9 +215,13 @@ namespace Cortex {
 
     void Shader::CreatePipelineLayout() {
 
-        // VkPushConstantRange pushRange = {};
-        // pushRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-        // pushRange.size = sizeof(VulkanPushData);
+        // A single range shared by every stage that declares push constants keeps the layout compatible
+        // with vkCmdPushConstants calls that update the whole block at once.
+        VkPushConstantRange pushRange = {};
+        for (auto& push : m_ShaderSpec.PushConstants) {
+            pushRange.stageFlags |= push.first;
+            pushRange.size = std::max(pushRange.size, push.second.Size);
+        }
         
         std::vector<VkDescriptorSetLayout> setLayouts;
         for (auto& layout : m_DescriptorSetLayouts) {
@@ -151,8 +230,8 @@ namespace Cortex {
 
         VkPipelineLayoutCreateInfo layoutInfo = {};
         layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-        layoutInfo.pushConstantRangeCount = 0;
-        layoutInfo.pPushConstantRanges = nullptr;
+        layoutInfo.pushConstantRangeCount = pushRange.size > 0 ? 1 : 0;
+        layoutInfo.pPushConstantRanges = pushRange.size > 0 ? &pushRange : nullptr;
         layoutInfo.setLayoutCount = static_cast<u32>(setLayouts.size());
         layoutInfo.pSetLayouts = setLayouts.data();
 
@@ -169,12 +248,19 @@ namespace Cortex {
     }
 
     void ShaderLibrary::Add(const std::string& name, const std::shared_ptr<Shader> shader) {
-        ASSERT(m_ShaderLookup.find(name) != m_ShaderLookup.end(), "A Shader with the same name already exists.");
+        ASSERT(m_ShaderLookup.find(name) == m_ShaderLookup.end(), "A Shader with the same name already exists.");
+        m_ShaderLookup[name] = shader;
+    }
+
+    std::shared_ptr<Shader> ShaderLibrary::Load(const std::string& name, const std::string& vertPath, const std::string& fragPath, const std::vector<std::string>& defines) {
+        auto shader = Shader::Create(m_GraphicsDevice, vertPath, fragPath, defines);
+        ASSERT(m_ShaderLookup.find(name) == m_ShaderLookup.end(), "A Shader with the same name already exists.");
         m_ShaderLookup[name] = shader;
+        return shader;
     }
 
-    std::shared_ptr<Shader> ShaderLibrary::Load(const std::string& name, const std::string& vertPath, const std::string& fragPath) {
-        auto shader = Shader::Create(m_GraphicsDevice, vertPath, fragPath);
+    std::shared_ptr<Shader> ShaderLibrary::LoadCompute(const std::string& name, const std::string& compPath) {
+        auto shader = Shader::CreateCompute(m_GraphicsDevice, compPath);
         ASSERT(m_ShaderLookup.find(name) == m_ShaderLookup.end(), "A Shader with the same name already exists.");
         m_ShaderLookup[name] = shader;
         return shader;
@@ -13,8 +13,10 @@ namespace Cortex {
 
     class Shader {
         public:
-            static std::shared_ptr<Shader> Create(std::shared_ptr<GraphicsDevice> device, const std::string& vertPath, const std::string& fragPath);
-            Shader(std::shared_ptr<GraphicsDevice> device, const std::string& vertPath, const std::string& fragPath);
+            static std::shared_ptr<Shader> Create(std::shared_ptr<GraphicsDevice> device, const std::string& vertPath, const std::string& fragPath, const std::vector<std::string>& defines = {});
+            static std::shared_ptr<Shader> CreateCompute(std::shared_ptr<GraphicsDevice> device, const std::string& compPath);
+            Shader(std::shared_ptr<GraphicsDevice> device, const std::string& vertPath, const std::string& fragPath, const std::vector<std::string>& defines = {});
+            Shader(std::shared_ptr<GraphicsDevice> device, const std::string& compPath);
             ~Shader();
             Shader(const Shader&) = delete;
             Shader &operator=(const Shader&) = delete;
@@ -24,6 +26,7 @@ namespace Cortex {
             std::unordered_map<u32, VkDescriptorSetLayout> m_DescriptorSetLayouts;
             VkDescriptorPool m_DescriptorPool;
         private:
+            void Build();
             VulkanShaderSpec Reflect();
             void CreateDescriptorPool();
             void CreateDescriptorSetLayouts();
@@ -32,6 +35,7 @@ namespace Cortex {
             std::shared_ptr<GraphicsDevice> m_GraphicsDevice;
             std::string m_VertPath;
             std::string m_FragPath;
+            std::string m_CompPath;
             std::vector<VkPipelineShaderStageCreateInfo> m_ShaderStageCreateInfos;
             std::unordered_map<VkShaderStageFlagBits, VkShaderModule> m_ShaderModules;
             std::unordered_map<VkShaderStageFlagBits, std::vector<u32>> m_ShaderBinaries;
@@ -46,7 +50,8 @@ namespace Cortex {
             static std::shared_ptr<ShaderLibrary> Create(std::shared_ptr<GraphicsDevice> device);
             ShaderLibrary(std::shared_ptr<GraphicsDevice> device);
             void Add(const std::string& name, const std::shared_ptr<Shader> shader);
-            std::shared_ptr<Shader> Load(const std::string& name, const std::string& vertPath, const std::string& fragPath);
+            std::shared_ptr<Shader> Load(const std::string& name, const std::string& vertPath, const std::string& fragPath, const std::vector<std::string>& defines = {});
+            std::shared_ptr<Shader> LoadCompute(const std::string& name, const std::string& compPath);
             std::shared_ptr<Shader> Get(const std::string& name);
 
         private:
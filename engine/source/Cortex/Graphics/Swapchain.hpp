@@ -2,34 +2,28 @@
 
 #include "Cortex/Graphics/VulkanHelpers.hpp"
 #include "Cortex/Graphics/VulkanTypes.hpp"
-#include "Cortex/Graphics/RenderPass.hpp"
 #include "Cortex/Graphics/GraphicsDevice.hpp"
 
 namespace Cortex {
     class Swapchain {
         public:
-            static std::unique_ptr<Swapchain> Create(std::shared_ptr<GraphicsDevice> device, VulkanSwapchainSpecification spec, RenderPass renderPass);
-            Swapchain(std::shared_ptr<GraphicsDevice> device, VulkanSwapchainSpecification spec, RenderPass renderPass);
+            static std::unique_ptr<Swapchain> Create(std::shared_ptr<GraphicsDevice> device, VulkanSwapchainSpecification spec, VkSwapchainKHR oldSwapchain = VK_NULL_HANDLE);
+            Swapchain(std::shared_ptr<GraphicsDevice> device, VulkanSwapchainSpecification spec, VkSwapchainKHR oldSwapchain);
             ~Swapchain();
             Swapchain(const Swapchain&) = delete;
             Swapchain &operator=(const Swapchain&) = delete;
-            VkResult SwapBuffers(const VkFence& inFlightFence, const VkSemaphore& imageAvailableSemaphore);
-            VkResult PresentImage(const VkQueue& presentQueue, const VkSemaphore& renderFinishSemaphore);
-            inline VkFramebuffer GetCurrentFramebuffer() { return m_SwapchainFramebuffers[m_CurrentImageIndex]; }
+            VkResult SwapBuffers(const VkSemaphore& imageAvailableSemaphore);
+            VkResult PresentImage(const VkQueue& presentQueue, const VkSemaphore& renderFinishSemaphore, uint64_t presentId = 0);
+            inline VkImage GetCurrentImage() { return m_SwapchainImages[m_CurrentImageIndex]; }
+            inline VkImageView GetCurrentImageView() { return m_SwapchainImageViews[m_CurrentImageIndex]; }
+            inline VkSwapchainKHR GetHandle() { return m_SwapchainHandle; }
         private:
             u32 m_CurrentImageIndex;
             std::shared_ptr<GraphicsDevice> m_GraphicsDevice;
             VkSwapchainKHR m_SwapchainHandle;
             VulkanSwapchainSpecification m_Spec;
-            VulkanDepthResources m_DepthResources;
-            VulkanColorResources m_ColorResources;
             std::vector<VkImage> m_SwapchainImages;
             std::vector<VkImageView> m_SwapchainImageViews;
-            std::vector<VkFramebuffer> m_SwapchainFramebuffers;
     };
 
-    void vulkan_create_depth_resources(const std::shared_ptr<GraphicsDevice> device, VulkanSwapchainSpecification spec, VulkanDepthResources& depthResources);
-    void vulkan_create_color_resources(const std::shared_ptr<GraphicsDevice> device, VulkanSwapchainSpecification spec, VulkanColorResources& colorResources);
-    void vulkan_destroy_depth_resources(const std::shared_ptr<GraphicsDevice> device, VulkanDepthResources& depthResources);
-    void vulkan_destroy_color_resources(const std::shared_ptr<GraphicsDevice> device, VulkanColorResources& colorResources);
 }
\ No newline at end of file
@@ -0,0 +1,135 @@
+#include "Cortex/Graphics/VertexLayout.hpp"
+
+#include "glm/gtc/packing.hpp"
+
+#include <type_traits>
+
+namespace Cortex {
+    static_assert(sizeof(VertexQuantized) == 16, "VertexQuantized has padding.");
+    static_assert(sizeof(VertexQuantizedColor) == 20, "VertexQuantizedColor has padding.");
+
+    std::vector<VkVertexInputBindingDescription> vertex_layout_bindings(VertexLayout layout) {
+        switch (layout) {
+            case VertexLayout::Quantized: return vertex_bindings<VertexQuantized>();
+            case VertexLayout::QuantizedColor: return vertex_bindings<VertexQuantizedColor>();
+            default: return vertex_bindings<VulkanVertex>();
+        }
+    }
+
+    std::vector<VkVertexInputAttributeDescription> vertex_layout_attributes(VertexLayout layout) {
+        switch (layout) {
+            case VertexLayout::Quantized: return vertex_attributes<VertexQuantized>();
+            case VertexLayout::QuantizedColor: return vertex_attributes<VertexQuantizedColor>();
+            default: return vertex_attributes<VulkanVertex>();
+        }
+    }
+
+    u32 vertex_layout_stride(VertexLayout layout) {
+        switch (layout) {
+            case VertexLayout::Quantized: return sizeof(VertexQuantized);
+            case VertexLayout::QuantizedColor: return sizeof(VertexQuantizedColor);
+            default: return sizeof(VulkanVertex);
+        }
+    }
+
+    const char* vertex_layout_name(VertexLayout layout) {
+        switch (layout) {
+            case VertexLayout::Quantized: return "quantized";
+            case VertexLayout::QuantizedColor: return "quantized_color";
+            default: return "full";
+        }
+    }
+
+    std::vector<std::string> vertex_layout_shader_defines(VertexLayout layout) {
+        switch (layout) {
+            case VertexLayout::Quantized: return {"VERTEX_OCTAHEDRAL_NORMAL"};
+            case VertexLayout::QuantizedColor: return {"VERTEX_OCTAHEDRAL_NORMAL", "VERTEX_COLOR"};
+            default: return {"VERTEX_COLOR"};
+        }
+    }
+
+    VertexLayout vertex_choose_layout(const std::vector<VulkanVertex>& vertices, bool quantize) {
+        if (!quantize) {
+            return VertexLayout::Full;
+        }
+        for (const VulkanVertex& vertex : vertices) {
+            if (vertex.Color != glm::vec3(1.0f)) {
+                return VertexLayout::QuantizedColor;
+            }
+        }
+        return VertexLayout::Quantized;
+    }
+
+    static inline i16 vertex_snorm16(f32 value) {
+        return static_cast<i16>(glm::round(glm::clamp(value, -1.0f, 1.0f) * 32767.0f));
+    }
+
+    glm::vec2 vertex_octahedral_encode(const glm::vec3& normal) {
+        f32 sum = glm::abs(normal.x) + glm::abs(normal.y) + glm::abs(normal.z);
+        if (sum == 0.0f) {
+            return glm::vec2(0.0f);
+        }
+        glm::vec2 p = glm::vec2(normal) / sum;
+        if (normal.z < 0.0f) {
+            glm::vec2 sign = {p.x >= 0.0f ? 1.0f : -1.0f, p.y >= 0.0f ? 1.0f : -1.0f};
+            p = (1.0f - glm::abs(glm::vec2(p.y, p.x))) * sign;
+        }
+        return p;
+    }
+
+    // The same as octahedral_decode in basic.vert.
+    glm::vec3 vertex_octahedral_decode(const glm::vec2& encoded) {
+        glm::vec3 n = {encoded.x, encoded.y, 1.0f - glm::abs(encoded.x) - glm::abs(encoded.y)};
+        f32 t = glm::max(-n.z, 0.0f);
+        n.x += n.x >= 0.0f ? -t : t;
+        n.y += n.y >= 0.0f ? -t : t;
+        return glm::normalize(n);
+    }
+
+    template<typename V> static void vertex_encode_quantized(const std::vector<VulkanVertex>& vertices, const glm::vec3& center, const glm::vec3& invExtent, V* out) {
+        for (size_t i = 0; i < vertices.size(); i++) {
+            const VulkanVertex& vertex = vertices[i];
+            glm::vec3 position = (vertex.Position - center) * invExtent;
+            glm::vec2 normal = vertex_octahedral_encode(vertex.Normal);
+            out[i].Position = {vertex_snorm16(position.x), vertex_snorm16(position.y), vertex_snorm16(position.z), 0};
+            out[i].Normal = {vertex_snorm16(normal.x), vertex_snorm16(normal.y)};
+            out[i].TexCoord = {glm::packHalf1x16(vertex.TexCoord.x), glm::packHalf1x16(vertex.TexCoord.y)};
+            if constexpr (std::is_same_v<V, VertexQuantizedColor>) {
+                glm::u8vec3 color(glm::round(glm::clamp(vertex.Color, 0.0f, 1.0f) * 255.0f));
+                out[i].Color = {color.r, color.g, color.b, 255};
+            }
+        }
+    }
+
+    std::vector<u8> vertex_encode(VertexLayout layout, const std::vector<VulkanVertex>& vertices, glm::mat4& outVertexToModel) {
+        CORTEX_PROFILE_FUNCTION();
+        std::vector<u8> data(vertex_layout_stride(layout) * vertices.size());
+        outVertexToModel = glm::mat4(1.0f);
+        if (layout == VertexLayout::Full) {
+            memcpy(data.data(), vertices.data(), data.size());
+            return data;
+        }
+
+        // Each axis spans the bounding box, so precision follows the mesh's size rather than its distance
+        // from the origin. Flat axes keep a tiny extent to stay invertible.
+        glm::vec3 min(0.0f);
+        glm::vec3 max(0.0f);
+        if (!vertices.empty()) {
+            min = max = vertices[0].Position;
+        }
+        for (const VulkanVertex& vertex : vertices) {
+            min = glm::min(min, vertex.Position);
+            max = glm::max(max, vertex.Position);
+        }
+        glm::vec3 center = 0.5f * (min + max);
+        glm::vec3 extent = glm::max(0.5f * (max - min), glm::vec3(1e-6f));
+        outVertexToModel = glm::scale(glm::translate(glm::mat4(1.0f), center), extent);
+
+        if (layout == VertexLayout::Quantized) {
+            vertex_encode_quantized(vertices, center, 1.0f / extent, reinterpret_cast<VertexQuantized*>(data.data()));
+        } else {
+            vertex_encode_quantized(vertices, center, 1.0f / extent, reinterpret_cast<VertexQuantizedColor*>(data.data()));
+        }
+        return data;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "Cortex/Graphics/VulkanTypes.hpp"
+
+#include <cstddef>
+
+namespace Cortex {
+    // Shader input locations, the same in every layout so one shader source serves them all.
+    #define VERTEX_LOCATION_POSITION 0
+    #define VERTEX_LOCATION_NORMAL 1
+    #define VERTEX_LOCATION_COLOR 2
+    #define VERTEX_LOCATION_TEXCOORD 3
+    #define VERTEX_LAYOUT_COUNT 3
+
+    // Component types whose Vulkan format follows from the type alone, so attribute descriptions can
+    // be generated from a vertex struct's members.
+    struct VertexSnorm16x4 { i16 X, Y, Z, W; };
+    struct VertexSnorm16x2 { i16 X, Y; };
+    struct VertexHalf2 { u16 X, Y; };
+    struct VertexUnorm8x4 { u8 R, G, B, A; };
+
+    template<typename T> struct VertexFormatOf;
+    template<> struct VertexFormatOf<glm::vec2> { static constexpr VkFormat Value = VK_FORMAT_R32G32_SFLOAT; };
+    template<> struct VertexFormatOf<glm::vec3> { static constexpr VkFormat Value = VK_FORMAT_R32G32B32_SFLOAT; };
+    template<> struct VertexFormatOf<VertexSnorm16x4> { static constexpr VkFormat Value = VK_FORMAT_R16G16B16A16_SNORM; };
+    template<> struct VertexFormatOf<VertexSnorm16x2> { static constexpr VkFormat Value = VK_FORMAT_R16G16_SNORM; };
+    template<> struct VertexFormatOf<VertexHalf2> { static constexpr VkFormat Value = VK_FORMAT_R16G16_SFLOAT; };
+    template<> struct VertexFormatOf<VertexUnorm8x4> { static constexpr VkFormat Value = VK_FORMAT_R8G8B8A8_UNORM; };
+
+    // Full is VulkanVertex as imported. The quantized layouts store positions as SNORM over the mesh's
+    // bounding box, which the model matrix pushed for each draw scales back out, normals as
+    // octahedral SNORM pairs and texture coordinates as halves; colour only where a mesh has any.
+    enum class VertexLayout : u8 {
+        Full,
+        Quantized,
+        QuantizedColor
+    };
+
+    struct VertexQuantized {
+        VertexSnorm16x4 Position;   // w unused, keeps the normal 4-byte aligned
+        VertexSnorm16x2 Normal;
+        VertexHalf2 TexCoord;
+    };
+
+    struct VertexQuantizedColor {
+        VertexSnorm16x4 Position;
+        VertexSnorm16x2 Normal;
+        VertexUnorm8x4 Color;
+        VertexHalf2 TexCoord;
+    };
+
+    #define VERTEX_ATTRIBUTE(vertex, member, location) VkVertexInputAttributeDescription{location, 0, VertexFormatOf<decltype(vertex::member)>::Value, static_cast<u32>(offsetof(vertex, member))}
+
+    // Position comes first in every layout, so a depth-only pipeline can keep just the first attribute.
+    template<typename V> struct VertexLayoutTraits;
+
+    template<> struct VertexLayoutTraits<VulkanVertex> {
+        static constexpr VertexLayout Layout = VertexLayout::Full;
+        static constexpr std::array<VkVertexInputAttributeDescription, 4> Attributes = {
+            VERTEX_ATTRIBUTE(VulkanVertex, Position, VERTEX_LOCATION_POSITION),
+            VERTEX_ATTRIBUTE(VulkanVertex, Normal, VERTEX_LOCATION_NORMAL),
+            VERTEX_ATTRIBUTE(VulkanVertex, Color, VERTEX_LOCATION_COLOR),
+            VERTEX_ATTRIBUTE(VulkanVertex, TexCoord, VERTEX_LOCATION_TEXCOORD),
+        };
+    };
+
+    template<> struct VertexLayoutTraits<VertexQuantized> {
+        static constexpr VertexLayout Layout = VertexLayout::Quantized;
+        static constexpr std::array<VkVertexInputAttributeDescription, 3> Attributes = {
+            VERTEX_ATTRIBUTE(VertexQuantized, Position, VERTEX_LOCATION_POSITION),
+            VERTEX_ATTRIBUTE(VertexQuantized, Normal, VERTEX_LOCATION_NORMAL),
+            VERTEX_ATTRIBUTE(VertexQuantized, TexCoord, VERTEX_LOCATION_TEXCOORD),
+        };
+    };
+
+    template<> struct VertexLayoutTraits<VertexQuantizedColor> {
+        static constexpr VertexLayout Layout = VertexLayout::QuantizedColor;
+        static constexpr std::array<VkVertexInputAttributeDescription, 4> Attributes = {
+            VERTEX_ATTRIBUTE(VertexQuantizedColor, Position, VERTEX_LOCATION_POSITION),
+            VERTEX_ATTRIBUTE(VertexQuantizedColor, Normal, VERTEX_LOCATION_NORMAL),
+            VERTEX_ATTRIBUTE(VertexQuantizedColor, Color, VERTEX_LOCATION_COLOR),
+            VERTEX_ATTRIBUTE(VertexQuantizedColor, TexCoord, VERTEX_LOCATION_TEXCOORD),
+        };
+    };
+
+    template<typename V> inline std::vector<VkVertexInputBindingDescription> vertex_bindings() {
+        return {{0, static_cast<u32>(sizeof(V)), VK_VERTEX_INPUT_RATE_VERTEX}};
+    }
+
+    template<typename V> inline std::vector<VkVertexInputAttributeDescription> vertex_attributes() {
+        return {VertexLayoutTraits<V>::Attributes.begin(), VertexLayoutTraits<V>::Attributes.end()};
+    }
+
+    std::vector<VkVertexInputBindingDescription> vertex_layout_bindings(VertexLayout layout);
+    std::vector<VkVertexInputAttributeDescription> vertex_layout_attributes(VertexLayout layout);
+    u32 vertex_layout_stride(VertexLayout layout);
+    const char* vertex_layout_name(VertexLayout layout);
+    // Preprocessor definitions that make basic.vert read the layout.
+    std::vector<std::string> vertex_layout_shader_defines(VertexLayout layout);
+
+    // The smallest layout that keeps everything the vertices use: Full unless quantize is set, and
+    // colour only if some vertex is not white.
+    VertexLayout vertex_choose_layout(const std::vector<VulkanVertex>& vertices, bool quantize);
+    // Vertices in the layout's format, ready to upload. outVertexToModel takes the layout's positions
+    // back to model space; identity for Full.
+    std::vector<u8> vertex_encode(VertexLayout layout, const std::vector<VulkanVertex>& vertices, glm::mat4& outVertexToModel);
+
+    glm::vec2 vertex_octahedral_encode(const glm::vec3& normal);
+    glm::vec3 vertex_octahedral_decode(const glm::vec2& encoded);
+}
\ No newline at end of file
@@ -3,20 +3,21 @@
 namespace Cortex {
 
     void vulkan_copy_buffer(const std::shared_ptr<GraphicsDevice> device, VkBuffer src, VkBuffer dst, VkDeviceSize size) {
-        VkCommandBuffer commandBuffer = vulkan_begin_transient_commands(device->Device, device->TransferCommandPool);
+        VkCommandBuffer commandBuffer = vulkan_begin_transient_commands(*device->TransferCommands);
         VkBufferCopy copyRegion = {};
         copyRegion.srcOffset = 0;
         copyRegion.dstOffset = 0;
         copyRegion.size = size;
         vkCmdCopyBuffer(commandBuffer, src, dst, 1, &copyRegion);
-        vulkan_end_transient_commands(device->Device, device->TransferCommandPool, device->Queues.Transfer, commandBuffer);
+        vulkan_end_transient_commands(*device->TransferCommands, *device->Sync, QueueType::Transfer, commandBuffer);
+        device->Counters.BytesUploaded += size;
     }
 
-    VulkanVertexBuffer vulkan_create_vertex_buffer(const std::shared_ptr<GraphicsDevice> device, const std::vector<VulkanVertex>& vertices) {
+    VulkanVertexBuffer vulkan_create_vertex_buffer(const std::shared_ptr<GraphicsDevice> device, const void* data, u32 vertexCount, u32 stride) {
         VulkanVertexBuffer vertexBuffer = {};
-        vertexBuffer.VertexCount = static_cast<u32>(vertices.size());
+        vertexBuffer.VertexCount = vertexCount;
         ASSERT(vertexBuffer.VertexCount > 2, "Vertex Count must be at least 3!");
-        VkDeviceSize bufferSize = sizeof(vertices[0]) * vertexBuffer.VertexCount;
+        VkDeviceSize bufferSize = static_cast<VkDeviceSize>(stride) * vertexBuffer.VertexCount;
 
         VkBuffer stagingBuffer;
         VkDeviceMemory stagingMemory;
@@ -31,9 +32,9 @@ namespace Cortex {
             stagingMemory
         );
 
-        void* data;
-        vkMapMemory(device->Device, stagingMemory, 0, bufferSize, 0, &data);
-        memcpy(data, vertices.data(), static_cast<u32>(bufferSize));
+        void* mapped;
+        vkMapMemory(device->Device, stagingMemory, 0, bufferSize, 0, &mapped);
+        memcpy(mapped, data, static_cast<size_t>(bufferSize));
         vkUnmapMemory(device->Device, stagingMemory);
 
         vulkan_create_buffer(
@@ -64,11 +65,13 @@ namespace Cortex {
         vkFreeMemory(device->Device, vertexBuffer.VertexBufferMemory, nullptr);
     }
 
-    VulkanIndexBuffer vulkan_create_index_buffer(const std::shared_ptr<GraphicsDevice> device, const std::vector<VulkanIndex>& indices) {
+    VulkanIndexBuffer vulkan_create_index_buffer(const std::shared_ptr<GraphicsDevice> device, const void* data, u32 indexCount, VkIndexType type) {
         VulkanIndexBuffer indexBuffer = {};
-        indexBuffer.IndexCount = static_cast<u32>(indices.size());
+        indexBuffer.IndexCount = indexCount;
+        indexBuffer.IndexType = type;
         ASSERT(indexBuffer.IndexCount > 2, "Index Count must be at least 3!");
-        VkDeviceSize bufferSize = sizeof(indices[0]) * indexBuffer.IndexCount;
+        ASSERT(type == VK_INDEX_TYPE_UINT32 || type == VK_INDEX_TYPE_UINT16, "Unsupported index type.");
+        VkDeviceSize bufferSize = (type == VK_INDEX_TYPE_UINT16 ? sizeof(u16) : sizeof(u32)) * indexBuffer.IndexCount;
 
         VkBuffer stagingBuffer;
         VkDeviceMemory stagingMemory;
@@ -83,9 +86,9 @@ namespace Cortex {
             stagingMemory
         );
 
-        void* data;
-        vkMapMemory(device->Device, stagingMemory, 0, bufferSize, 0, &data);
-        memcpy(data, indices.data(), static_cast<u32>(bufferSize));
+        void* mapped;
+        vkMapMemory(device->Device, stagingMemory, 0, bufferSize, 0, &mapped);
+        memcpy(mapped, data, static_cast<size_t>(bufferSize));
         vkUnmapMemory(device->Device, stagingMemory);
 
         vulkan_create_buffer(
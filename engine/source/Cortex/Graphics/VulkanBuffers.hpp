@@ -16,6 +16,7 @@ namespace Cortex {
         VkBuffer IndexBuffer;
         VkDeviceMemory IndexBufferMemory;
         u32 IndexCount;
+        VkIndexType IndexType;
     };
 
     struct VulkanUniformBuffer {
@@ -27,9 +28,11 @@ namespace Cortex {
     };
 
     void vulkan_copy_buffer(const std::shared_ptr<GraphicsDevice> device, VkBuffer src, VkBuffer dst, VkDeviceSize size);
-    VulkanVertexBuffer vulkan_create_vertex_buffer(const std::shared_ptr<GraphicsDevice> device, const std::vector<VulkanVertex>& vertices);
+    // data holds vertexCount vertices of any layout, stride bytes apart, copied straight into staging.
+    VulkanVertexBuffer vulkan_create_vertex_buffer(const std::shared_ptr<GraphicsDevice> device, const void* data, u32 vertexCount, u32 stride);
     void vulkan_destroy_vertex_buffer(const std::shared_ptr<GraphicsDevice> device, const VulkanVertexBuffer& vertexBuffer);
-    VulkanIndexBuffer vulkan_create_index_buffer(const std::shared_ptr<GraphicsDevice> device, const std::vector<VulkanIndex>& indices);
+    // data holds indexCount indices already of the given type.
+    VulkanIndexBuffer vulkan_create_index_buffer(const std::shared_ptr<GraphicsDevice> device, const void* data, u32 indexCount, VkIndexType type);
     void vulkan_destroy_index_buffer(const std::shared_ptr<GraphicsDevice> device, const VulkanIndexBuffer& indexBuffer);
     std::vector<VulkanUniformBuffer> vulkan_create_uniform_buffers(const std::shared_ptr<GraphicsDevice> device, u32 count);
 }
\ No newline at end of file
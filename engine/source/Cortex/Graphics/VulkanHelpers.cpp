@@ -4,9 +4,10 @@ namespace Cortex {
 
     // MISC RESOURCE CREATION
 
-    VulkanSwapchainSpecification vulkan_create_swapchain_spec(VkPhysicalDevice physicalDevice, VkDevice device, VkSampleCountFlagBits samples, VkFormat depthFormat, VkSurfaceKHR surface, u32 width, u32 height) {
+    VulkanSwapchainSpecification vulkan_create_swapchain_spec(VkPhysicalDevice physicalDevice, VkDevice device, VkFormat depthFormat, VkSurfaceKHR surface, u32 width, u32 height, const VulkanPresentConfig& presentConfig) {
         VulkanSwapchainProperties properties = vulkan_query_swapchain_properties(physicalDevice, surface);
-        u32 imageCount = properties.Capabilities.minImageCount + 1;
+        u32 imageCount = presentConfig.ImageCount > 0 ? presentConfig.ImageCount : properties.Capabilities.minImageCount + 1;
+        imageCount = std::max(imageCount, properties.Capabilities.minImageCount);
         if (properties.Capabilities.maxImageCount > 0 && imageCount > properties.Capabilities.maxImageCount)
         {
             imageCount = properties.Capabilities.maxImageCount;
@@ -14,92 +15,15 @@ namespace Cortex {
 
         VulkanSwapchainSpecification config;
         config.SurfaceFormat = vulkan_choose_surface_format(properties.Formats);
-        config.PresentMode = vulkan_choose_present_mode(properties.PresentModes);
+        config.PresentMode = vulkan_choose_present_mode(properties.PresentModes, presentConfig.PresentMode);
         config.Extent = vulkan_choose_extent(properties.Capabilities, width, height);
         config.ImageCount = imageCount;
         config.CurrentTransform = properties.Capabilities.currentTransform;
-        config.MultisamplingCount = samples;
         config.DepthFormat = depthFormat;
 
         return config;
     }
 
-    VkRenderPass vulkan_create_renderpass(VkPhysicalDevice physicalDevice, VkDevice device, const VulkanSwapchainSpecification& config) {
-        VkRenderPass renderpass;
-
-        VkAttachmentDescription colorAttachment = {};
-        colorAttachment.format = config.SurfaceFormat.format;
-        colorAttachment.samples = config.MultisamplingCount;
-        colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-        colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-        colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-        colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-        colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        colorAttachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-        VkAttachmentDescription depthAttachment = {};
-        depthAttachment.format = config.DepthFormat;
-        depthAttachment.samples = config.MultisamplingCount;
-        depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-        depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-        depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-        depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-        depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-        VkAttachmentDescription colorResolveAttachment = {};
-        colorResolveAttachment.format = config.SurfaceFormat.format;
-        colorResolveAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-        colorResolveAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-        colorResolveAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-        colorResolveAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-        colorResolveAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-        colorResolveAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        colorResolveAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-        VkAttachmentReference colorAttachmentRef = {};
-        colorAttachmentRef.attachment = 0;
-        colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-        VkAttachmentReference depthAttachmentRef{};
-        depthAttachmentRef.attachment = 1;
-        depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-        VkAttachmentReference colorResolveAttachmentRef = {};
-        colorResolveAttachmentRef.attachment = 2;
-        colorResolveAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-        VkSubpassDescription subpass = {};
-        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-        subpass.colorAttachmentCount = 1;
-        subpass.pColorAttachments = &colorAttachmentRef;
-        subpass.pDepthStencilAttachment = &depthAttachmentRef;
-        subpass.pResolveAttachments = &colorResolveAttachmentRef;
-
-        VkSubpassDependency dependancy = {};
-        dependancy.srcSubpass = VK_SUBPASS_EXTERNAL;
-        dependancy.dstSubpass = 0;
-        dependancy.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-        dependancy.srcAccessMask = 0;
-        dependancy.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-        dependancy.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-
-        std::array<VkAttachmentDescription, 3> attachments = {colorAttachment, depthAttachment, colorResolveAttachment};
-        VkRenderPassCreateInfo renderpassCreateInfo = {};
-        renderpassCreateInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-        renderpassCreateInfo.attachmentCount = static_cast<u32>(attachments.size());
-        renderpassCreateInfo.pAttachments = attachments.data();
-        renderpassCreateInfo.subpassCount = 1;
-        renderpassCreateInfo.pSubpasses = &subpass;
-        renderpassCreateInfo.dependencyCount = 1;
-        renderpassCreateInfo.pDependencies = &dependancy;
-
-        VkResult result = vkCreateRenderPass(device, &renderpassCreateInfo, nullptr, &renderpass);
-        ASSERT(result == VK_SUCCESS, "Failed to create a Vulkan renderpass!");
-
-        return renderpass;
-    }
-    
     VkPipelineLayout vulkan_create_pipeline_layout(VkDevice device, const VkDescriptorSetLayout& descriptorSetLayout) {
         VkPushConstantRange pushRange = {};
         pushRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -143,6 +67,24 @@ namespace Cortex {
 
     // DEVICE CREATION
 
+    bool vulkan_check_instance_extension_support(const std::vector<const char*> extensions) {
+        u32 extensionCount;
+        vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
+        std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+        vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, availableExtensions.data());
+        for (const char* name : extensions) {
+            bool found = false;
+            for (const auto& extension : availableExtensions) {
+                if (strcmp(name, extension.extensionName) == 0) {
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) { return false; }
+        }
+        return true;
+    }
+
     bool vulkan_check_layer_support(const std::vector<const char *> layers) {
         u32 availableLayerCount;
         vkEnumerateInstanceLayerProperties(&availableLayerCount, nullptr);
@@ -174,7 +116,7 @@ namespace Cortex {
                     break;
                 }
             }
-            if (!found) { std::cout << "Device does not support a requested extension!"; return false; }
+            if (!found) { LOG_DEBUG("Device does not support %s.", extension); return false; }
         }
         return true;
     }
@@ -193,9 +135,12 @@ namespace Cortex {
             return false;
         }
 
-        VulkanSwapchainProperties swapchainProperties = vulkan_query_swapchain_properties(physicalDevice, surface);
-        if (swapchainProperties.Formats.empty() || swapchainProperties.PresentModes.empty()) {
-            return false;
+        // Without a surface (headless) there is nothing to present to, so only check swapchain support with one.
+        if (surface != VK_NULL_HANDLE) {
+            VulkanSwapchainProperties swapchainProperties = vulkan_query_swapchain_properties(physicalDevice, surface);
+            if (swapchainProperties.Formats.empty() || swapchainProperties.PresentModes.empty()) {
+                return false;
+            }
         }
 
         if (requirements.DiscreteGPU && (deviceProperties.deviceType != VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)) {
@@ -256,14 +201,18 @@ namespace Cortex {
             if ((family.queueFlags & VK_QUEUE_GRAPHICS_BIT) && indices.Graphics == VULKAN_QUEUE_NOT_FOUND_INDEX) {
                 indices.Graphics = i;
             }
-            if ((family.queueFlags & VK_QUEUE_COMPUTE_BIT) && indices.Compute == VULKAN_QUEUE_NOT_FOUND_INDEX) {
+            // Prefer a compute family without graphics: that is the one that runs alongside graphics work.
+            bool dedicatedCompute = (family.queueFlags & VK_QUEUE_COMPUTE_BIT) && !(family.queueFlags & VK_QUEUE_GRAPHICS_BIT);
+            if ((family.queueFlags & VK_QUEUE_COMPUTE_BIT) && (indices.Compute == VULKAN_QUEUE_NOT_FOUND_INDEX || (dedicatedCompute && indices.Compute == indices.Graphics))) {
                 indices.Compute = i;
             }
             if ((family.queueFlags & VK_QUEUE_TRANSFER_BIT) && indices.Transfer == VULKAN_QUEUE_NOT_FOUND_INDEX) {
                 indices.Transfer = i;
             }
             VkBool32 presentSupport = false;
-            vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface, &presentSupport);
+            if (surface != VK_NULL_HANDLE) {
+                vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface, &presentSupport);
+            }
             if (presentSupport && (indices.Present == VULKAN_QUEUE_NOT_FOUND_INDEX)) {
                 indices.Present = i;
             }
@@ -306,9 +255,18 @@ namespace Cortex {
         return availableFormats[0];
     }
     
-    VkPresentModeKHR vulkan_choose_present_mode(const std::vector<VkPresentModeKHR>& availableModes) {
-        for (const auto& mode : availableModes) {
-            if (mode == VK_PRESENT_MODE_MAILBOX_KHR) {
+    VkPresentModeKHR vulkan_choose_present_mode(const std::vector<VkPresentModeKHR>& availableModes, VkPresentModeKHR requestedMode) {
+        // FIFO is the only mode every implementation must support, so it ends every fallback chain.
+        std::vector<VkPresentModeKHR> preferences = {requestedMode, VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_FIFO_KHR};
+        if (requestedMode == VK_PRESENT_MODE_FIFO_RELAXED_KHR) {
+            preferences = {requestedMode, VK_PRESENT_MODE_FIFO_KHR};
+        }
+        for (auto preference : preferences) {
+            for (const auto& mode : availableModes) {
+                if (mode != preference) { continue; }
+                if (mode != requestedMode) {
+                    LOG_WARN("Present mode %s is not supported, falling back to %s.", string_VkPresentModeKHR(requestedMode), string_VkPresentModeKHR(mode));
+                }
                 return mode;
             }
         }
@@ -320,15 +278,19 @@ namespace Cortex {
         VkExtent2D trueExtent = {
             width, height
         };
-        trueExtent.width = std::clamp(trueExtent.width, capabilities.maxImageExtent.width, capabilities.maxImageExtent.width);
-        trueExtent.height = std::clamp(trueExtent.height, capabilities.maxImageExtent.height, capabilities.maxImageExtent.height);
+        trueExtent.width = std::clamp(trueExtent.width, capabilities.minImageExtent.width, capabilities.maxImageExtent.width);
+        trueExtent.height = std::clamp(trueExtent.height, capabilities.minImageExtent.height, capabilities.maxImageExtent.height);
         return trueExtent;
     }
 
-    VkSampleCountFlagBits vulkan_get_max_msaa_count(VkPhysicalDevice physicalDevice) {
+    VkSampleCountFlags vulkan_get_supported_msaa_counts(VkPhysicalDevice physicalDevice) {
         VkPhysicalDeviceProperties properties;
         vkGetPhysicalDeviceProperties(physicalDevice, &properties);
-        VkSampleCountFlags counts = properties.limits.framebufferColorSampleCounts & properties.limits.framebufferDepthSampleCounts;
+        return properties.limits.framebufferColorSampleCounts & properties.limits.framebufferDepthSampleCounts;
+    }
+
+    VkSampleCountFlagBits vulkan_get_max_msaa_count(VkPhysicalDevice physicalDevice) {
+        VkSampleCountFlags counts = vulkan_get_supported_msaa_counts(physicalDevice);
         if (counts & VK_SAMPLE_COUNT_64_BIT) { return VK_SAMPLE_COUNT_64_BIT; }
         if (counts & VK_SAMPLE_COUNT_32_BIT) { return VK_SAMPLE_COUNT_32_BIT; }
         if (counts & VK_SAMPLE_COUNT_16_BIT) { return VK_SAMPLE_COUNT_16_BIT; }
@@ -338,7 +300,36 @@ namespace Cortex {
         return VK_SAMPLE_COUNT_1_BIT;
     }
 
-    void vulkan_create_instance(std::vector<const char*> validationLayers, VkInstance& outInstance) {
+    void vulkan_get_timestamp_support(VkPhysicalDevice physicalDevice, u32 queueFamily, f32& outPeriod, u32& outValidBits, bool& outSupported) {
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+        u32 familyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> families(familyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, families.data());
+
+        outPeriod = properties.limits.timestampPeriod;
+        outValidBits = queueFamily < familyCount ? families[queueFamily].timestampValidBits : 0;
+        outSupported = outValidBits > 0 && outPeriod > 0.0f;
+    }
+
+    VkDeviceSize vulkan_get_memory_usage(VkPhysicalDevice physicalDevice) {
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT budget = {};
+        budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+        VkPhysicalDeviceMemoryProperties2 properties = {};
+        properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+        properties.pNext = &budget;
+        vkGetPhysicalDeviceMemoryProperties2(physicalDevice, &properties);
+
+        VkDeviceSize usage = 0;
+        for (u32 i = 0; i < properties.memoryProperties.memoryHeapCount; i++) {
+            usage += budget.heapUsage[i];
+        }
+        return usage;
+    }
+
+    void vulkan_create_instance(std::vector<const char*> validationLayers, bool headless, VkInstance& outInstance) {
         ASSERT(vulkan_check_layer_support(validationLayers), "Detected Vulkan implentation does not support requested validation layers.");
 
         VkApplicationInfo appInfo = {};
@@ -349,15 +340,23 @@ namespace Cortex {
         appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
         appInfo.apiVersion = VK_API_VERSION_1_3;
 
-        u32 glfwExtensionCount = 0;
-        const char **glfwExtensions;
-        glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+        // A headless instance never creates a surface, so it needs none of GLFW's surface extensions and
+        // GLFW does not have to be initialised.
         std::vector<const char *> requiredExtensions;
-        for (u32 i = 0; i < glfwExtensionCount; i++)
-        {
-            requiredExtensions.emplace_back(glfwExtensions[i]);
+        if (!headless) {
+            u32 glfwExtensionCount = 0;
+            const char **glfwExtensions;
+            glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+            for (u32 i = 0; i < glfwExtensionCount; i++)
+            {
+                requiredExtensions.emplace_back(glfwExtensions[i]);
+            }
+        }
+        // Only portability drivers (MoltenVK) need enumerating explicitly; other loaders may not know it.
+        bool portability = vulkan_check_instance_extension_support({VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME});
+        if (portability) {
+            requiredExtensions.emplace_back(VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME);
         }
-        requiredExtensions.emplace_back(VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME);
 
         VkInstanceCreateInfo instanceCreateInfo = {};
         instanceCreateInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -366,7 +365,9 @@ namespace Cortex {
         instanceCreateInfo.ppEnabledExtensionNames = requiredExtensions.data();
         instanceCreateInfo.enabledLayerCount = static_cast<u32>(validationLayers.size());
         instanceCreateInfo.ppEnabledLayerNames = validationLayers.data();
-        instanceCreateInfo.flags |= VK_INSTANCE_CREATE_ENUMERATE_PORTABILITY_BIT_KHR;
+        if (portability) {
+            instanceCreateInfo.flags |= VK_INSTANCE_CREATE_ENUMERATE_PORTABILITY_BIT_KHR;
+        }
 
         VkResult result = vkCreateInstance(&instanceCreateInfo, nullptr, &outInstance);
         ASSERT(result == VK_SUCCESS, "Failed to create a Vulkan instance!");
@@ -390,9 +391,20 @@ namespace Cortex {
         ASSERT(outPhysicalDevice != VK_NULL_HANDLE, "Failed to find a suitable Vulkan physical device!");
     }
     
-    void vulkan_create_device(VkInstance instance, VkPhysicalDevice physicalDevice, VkSurfaceKHR surface, std::vector<const char*> deviceExtensions, VkDevice& outDevice, VulkanQueueIndices& outQueueIndices, VulkanQueues& outQueues) {
+    void vulkan_create_device(VkInstance instance, VkPhysicalDevice physicalDevice, VkSurfaceKHR surface, std::vector<const char*> deviceExtensions, const VkPhysicalDeviceFeatures& enabledFeatures, const void* featureChain, VkDevice& outDevice, VulkanQueueIndices& outQueueIndices, VulkanQueues& outQueues) {
         outQueueIndices = vulkan_find_queue_indices(physicalDevice, surface);
-        f32 queuePriority = 1.0f;
+        u32 queueFamilyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+        // Without a separate compute family, a second queue in the graphics family still lets compute
+        // submissions run alongside graphics ones.
+        bool sharedComputeQueue = outQueueIndices.Compute != VULKAN_QUEUE_NOT_FOUND_INDEX
+            && outQueueIndices.Compute == outQueueIndices.Graphics
+            && queueFamilies[outQueueIndices.Compute].queueCount > 1;
+
+        f32 queuePriorities[] = {1.0f, 1.0f};
         std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
         std::set<u32> uniqueIndices = {outQueueIndices.Graphics, outQueueIndices.Present, outQueueIndices.Transfer, outQueueIndices.Compute};
 
@@ -405,21 +417,19 @@ namespace Cortex {
             VkDeviceQueueCreateInfo queueCreateInfo = {};
             queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
             queueCreateInfo.queueFamilyIndex = index;
-            queueCreateInfo.queueCount = 1;
-            queueCreateInfo.pQueuePriorities = &queuePriority;
+            queueCreateInfo.queueCount = (sharedComputeQueue && index == outQueueIndices.Compute) ? 2 : 1;
+            queueCreateInfo.pQueuePriorities = queuePriorities;
             queueCreateInfos.push_back(queueCreateInfo);
         }
 
-        VkPhysicalDeviceFeatures deviceFeatures = {};
-        deviceFeatures.samplerAnisotropy = VK_TRUE;
-
         VkDeviceCreateInfo deviceCreateInfo = {};
         deviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+        deviceCreateInfo.pNext = featureChain;
         deviceCreateInfo.pQueueCreateInfos = queueCreateInfos.data();
         deviceCreateInfo.queueCreateInfoCount = static_cast<u32>(queueCreateInfos.size());
         deviceCreateInfo.ppEnabledExtensionNames = deviceExtensions.data();
         deviceCreateInfo.enabledExtensionCount = static_cast<u32>(deviceExtensions.size());
-        deviceCreateInfo.pEnabledFeatures = &deviceFeatures;
+        deviceCreateInfo.pEnabledFeatures = &enabledFeatures;
 
         VkResult result = vkCreateDevice(physicalDevice, &deviceCreateInfo, nullptr, &outDevice);
         ASSERT(result == VK_SUCCESS, "Failed to create a Vulkan device!");
@@ -430,52 +440,74 @@ namespace Cortex {
             vkGetDeviceQueue(outDevice, outQueueIndices.Present, 0, &outQueues.Present);
         if (outQueueIndices.Transfer != VULKAN_QUEUE_NOT_FOUND_INDEX)
             vkGetDeviceQueue(outDevice, outQueueIndices.Transfer, 0, &outQueues.Transfer);
-        if (outQueueIndices.Present != VULKAN_QUEUE_NOT_FOUND_INDEX)
-            vkGetDeviceQueue(outDevice, outQueueIndices.Compute, 0, &outQueues.Compute);
+        if (outQueueIndices.Compute != VULKAN_QUEUE_NOT_FOUND_INDEX)
+            vkGetDeviceQueue(outDevice, outQueueIndices.Compute, sharedComputeQueue ? 1 : 0, &outQueues.Compute);
     }
 
     // CONTEXT CREATION
 
-    std::vector<VulkanFrameResources> vulkan_create_frame_resources(VkDevice device, u32 count, u32 queueIndex) {
+    std::vector<VulkanFrameResources> vulkan_create_frame_resources(VkDevice device, u32 count) {
         std::vector<VulkanFrameResources> resources(count);
         for (u32 i = 0; i < count; i++) {
-            resources[i].CommandPool = vulkan_create_command_pool(device, queueIndex, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
-            resources[i].CommandBuffer = vulkan_create_command_buffer(device, resources[i].CommandPool);
             VkSemaphoreCreateInfo semaphoreInfo = {};
             semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-            VkFenceCreateInfo fenceInfo = {};
-            fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-            fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
             VkResult result = vkCreateSemaphore(device, &semaphoreInfo, nullptr, &resources[i].ImageAvailableSemaphore);
             ASSERT(result == VK_SUCCESS, "Failed to create Vulkan semaphore!");
             result = vkCreateSemaphore(device, &semaphoreInfo, nullptr, &resources[i].RenderFinishSemaphore);
             ASSERT(result == VK_SUCCESS, "Failed to create Vulkan semaphore!");
-            result = vkCreateFence(device, &fenceInfo, nullptr, &resources[i].InFlightFence);
-            ASSERT(result == VK_SUCCESS, "Failed to create Vulkan fence!");
         }
         return resources;
     }
     
     void vulkan_destroy_frame_resources(VkDevice device, std::vector<VulkanFrameResources> frameResources) {
         for (auto& data : frameResources) {
-            vkDestroyFence(device, data.InFlightFence, nullptr);
             vkDestroySemaphore(device, data.RenderFinishSemaphore, nullptr);
             vkDestroySemaphore(device, data.ImageAvailableSemaphore, nullptr);
-            vkDestroyCommandPool(device, data.CommandPool, nullptr);
         }
     }
 
-    // MISC
+    VulkanSwapchainSpecification vulkan_create_offscreen_spec(VkFormat depthFormat, u32 width, u32 height, u32 imageCount) {
+        // Mirrors what vulkan_create_swapchain_spec prefers, so headless frames do the same work as windowed ones.
+        VulkanSwapchainSpecification spec;
+        spec.SurfaceFormat = {VK_FORMAT_B8G8R8A8_UNORM, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR};
+        spec.PresentMode = VK_PRESENT_MODE_IMMEDIATE_KHR; // nothing paces offscreen frames
+        spec.Extent = {width, height};
+        spec.CurrentTransform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
+        spec.ImageCount = imageCount;
+        spec.DepthFormat = depthFormat;
+        return spec;
+    }
+
+    std::vector<VulkanOffscreenTarget> vulkan_create_offscreen_targets(VkDevice device, VkPhysicalDevice physicalDevice, const VulkanSwapchainSpecification& spec) {
+        std::vector<VulkanOffscreenTarget> targets(spec.ImageCount);
+        for (auto& target : targets) {
+            vulkan_create_image(
+                device, physicalDevice,
+                spec.Extent.width, spec.Extent.height,
+                VK_SAMPLE_COUNT_1_BIT,
+                spec.SurfaceFormat.format,
+                VK_IMAGE_TILING_OPTIMAL,
+                VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                target.Image, target.Memory
+            );
+            target.View = vulkan_create_image_view(device, target.Image, spec.SurfaceFormat.format, VK_IMAGE_ASPECT_COLOR_BIT);
+        }
+        return targets;
+    }
 
-    VkCommandBuffer vulkan_begin_transient_commands(VkDevice device, VkCommandPool commandPool) {
-        VkCommandBufferAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-        allocInfo.commandPool = commandPool;
-        allocInfo.commandBufferCount = 1;
+    void vulkan_destroy_offscreen_targets(VkDevice device, std::vector<VulkanOffscreenTarget> targets) {
+        for (auto& target : targets) {
+            vkDestroyImageView(device, target.View, nullptr);
+            vkDestroyImage(device, target.Image, nullptr);
+            vkFreeMemory(device, target.Memory, nullptr);
+        }
+    }
+
+    // MISC
 
-        VkCommandBuffer commandBuffer;
-        vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer);
+    VkCommandBuffer vulkan_begin_transient_commands(CommandAllocator& commandAllocator) {
+        VkCommandBuffer commandBuffer = commandAllocator.Allocate(0);
 
         VkCommandBufferBeginInfo beginInfo{};
         beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -485,23 +517,24 @@ namespace Cortex {
         return commandBuffer;
     }
 
-    void vulkan_end_transient_commands(VkDevice device, VkCommandPool commandPool, VkQueue queue, VkCommandBuffer commandBuffer) {
+    QueuePoint vulkan_end_transient_commands(CommandAllocator& commandAllocator, QueueSync& sync, QueueType queue, VkCommandBuffer commandBuffer) {
         vkEndCommandBuffer(commandBuffer);
 
-        VkSubmitInfo submitInfo{};
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &commandBuffer;
+        QueueSubmitInfo submitInfo = {};
+        submitInfo.CommandBuffers = { commandBuffer };
+        QueuePoint point = sync.Submit(queue, submitInfo);
 
-        vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
-        vkQueueWaitIdle(queue);
+        // Wait for this submission only, rather than the whole queue, so uploads don't stall behind frames.
+        sync.Wait(point);
 
-        vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+        // Finished, so this thread's transient pool can be rewound rather than freeing the buffer.
+        commandAllocator.ResetThread(0);
+        return point;
     }
 
     // SWAPCHAIN CREATION
 
-    void vulkan_create_swapchain(VkPhysicalDevice physicalDevice, VkDevice device, VkSurfaceKHR surface, const VulkanSwapchainSpecification &config, VkSwapchainKHR& outSwapchain) {
+    void vulkan_create_swapchain(VkPhysicalDevice physicalDevice, VkDevice device, VkSurfaceKHR surface, const VulkanSwapchainSpecification &config, VkSwapchainKHR oldSwapchain, VkSwapchainKHR& outSwapchain) {
         VkSwapchainCreateInfoKHR swapchainCreateInfo = {};
         VulkanQueueIndices indices = vulkan_find_queue_indices(physicalDevice, surface);
 
@@ -527,7 +560,7 @@ namespace Cortex {
         swapchainCreateInfo.clipped = VK_TRUE;
         swapchainCreateInfo.imageArrayLayers = 1;
         swapchainCreateInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
-        swapchainCreateInfo.oldSwapchain = VK_NULL_HANDLE;
+        swapchainCreateInfo.oldSwapchain = oldSwapchain;
 
         VkResult result = vkCreateSwapchainKHR(device, &swapchainCreateInfo, nullptr, &outSwapchain);
         ASSERT(result == VK_SUCCESS, "Failed to create Vulkan swapchain!");
@@ -541,33 +574,14 @@ namespace Cortex {
     }
     
     void vulkan_create_swapchain_image_views(VkDevice device, const VulkanSwapchainSpecification &config, const std::vector<VkImage> &images, std::vector<VkImageView>& outImageViews) {
-        outImageViews.resize(config.ImageCount);
-        for (u32 i = 0; i < config.ImageCount; i++)
+        // ImageCount is only a minimum; the implementation may have created more images than that.
+        outImageViews.resize(images.size());
+        for (u32 i = 0; i < images.size(); i++)
         {
             outImageViews[i] = vulkan_create_image_view(device, images[i], config.SurfaceFormat.format, VK_IMAGE_ASPECT_COLOR_BIT);
         }
     }
     
-    void vulkan_create_swapchain_framebuffers(VkDevice device, VulkanSwapchainSpecification config, std::vector<VkImageView> swapchainImageViews, VkImageView depthImageView, VkImageView colorResolveImageView, VkRenderPass renderpass, std::vector<VkFramebuffer>& outFramebuffers) {
-        outFramebuffers.resize(config.ImageCount);
-        for (u32 i = 0; i < config.ImageCount; i++) {
-            VkImageView attachments[] = {
-                colorResolveImageView, depthImageView, swapchainImageViews[i]
-            };
-            VkFramebufferCreateInfo framebufferCreateInfo = {};
-            framebufferCreateInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-            framebufferCreateInfo.renderPass = renderpass;
-            framebufferCreateInfo.attachmentCount = 3;
-            framebufferCreateInfo.pAttachments = attachments;
-            framebufferCreateInfo.width = config.Extent.width;
-            framebufferCreateInfo.height = config.Extent.height;
-            framebufferCreateInfo.layers = 1;
-
-            VkResult result = vkCreateFramebuffer(device, &framebufferCreateInfo, nullptr, &outFramebuffers[i]);
-            assert(result == VK_SUCCESS);
-        }
-    }
-
     VkFormat vulkan_find_supported_format(VkPhysicalDevice physicalDevice, const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features) {
         for (VkFormat format : candidates) {
             VkFormatProperties props;
@@ -610,7 +624,7 @@ namespace Cortex {
         return buffer;
     }
 
-    std::vector<u32> vulkan_compile_from_source(const std::string& path, ShaderType type) {
+    std::vector<u32> vulkan_compile_from_source(const std::string& path, ShaderType type, const std::vector<std::string>& defines) {
 
         shaderc_shader_kind kind;
         switch (type) {
@@ -620,10 +634,16 @@ namespace Cortex {
             case ShaderType::FRAGMENT:
                 kind = shaderc_glsl_fragment_shader;
                 break;
+            case ShaderType::COMPUTE:
+                kind = shaderc_glsl_compute_shader;
+                break;
         }
 
         shaderc::Compiler compiler;
         shaderc::CompileOptions options;
+        for (const std::string& define : defines) {
+            options.AddMacroDefinition(define);
+        }
         std::string source = vulkan_read_shader_source(path);
         shaderc::SpvCompilationResult result = compiler.CompileGlslToSpv(source, kind, path.c_str(), options);
 
@@ -705,9 +725,21 @@ namespace Cortex {
         ASSERT(false, "Failed to find Vulkan Memory Type");
     }
 
+    bool vulkan_try_find_memory_type(u32 typeFilter, VkMemoryPropertyFlags properties, VkPhysicalDevice physicalDevice, u32& outTypeIndex) {
+        VkPhysicalDeviceMemoryProperties memoryProperties;
+        vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+        for (u32 i = 0; i < memoryProperties.memoryTypeCount; i++) {
+            if ((typeFilter & (1 << i)) && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+                outTypeIndex = i;
+                return true;
+            }
+        }
+        return false;
+    }
+
     // IMAGE STUFF
 
-    void vulkan_create_image(VkDevice device, VkPhysicalDevice physicalDevice, u32 width, u32 height, VkSampleCountFlagBits samples, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory) {
+    void vulkan_create_image_handle(VkDevice device, u32 width, u32 height, VkSampleCountFlagBits samples, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkImage& image) {
         VkImageCreateInfo imageInfo = {};
         imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
         imageInfo.imageType = VK_IMAGE_TYPE_2D;
@@ -726,6 +758,10 @@ namespace Cortex {
 
         VkResult result = vkCreateImage(device, &imageInfo, nullptr, &image);
         ASSERT(result == VK_SUCCESS, "Failed to create a Vulkan image!");
+    }
+
+    void vulkan_create_image(VkDevice device, VkPhysicalDevice physicalDevice, u32 width, u32 height, VkSampleCountFlagBits samples, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory) {
+        vulkan_create_image_handle(device, width, height, samples, format, tiling, usage, image);
 
         VkMemoryRequirements memoryRequirements;
         vkGetImageMemoryRequirements(device, image, &memoryRequirements);
@@ -742,8 +778,34 @@ namespace Cortex {
         vkBindImageMemory(device, image, imageMemory, 0);
     }
 
-    void vulkan_transition_image_layout(VkDevice device, VkCommandPool commandPool, VkQueue queue, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout) {
-        VkCommandBuffer commandBuffer = vulkan_begin_transient_commands(device, commandPool);
+    bool vulkan_format_has_depth(VkFormat format) {
+        switch (format) {
+            case VK_FORMAT_D16_UNORM:
+            case VK_FORMAT_X8_D24_UNORM_PACK32:
+            case VK_FORMAT_D32_SFLOAT:
+            case VK_FORMAT_D16_UNORM_S8_UINT:
+            case VK_FORMAT_D24_UNORM_S8_UINT:
+            case VK_FORMAT_D32_SFLOAT_S8_UINT:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    bool vulkan_format_has_stencil(VkFormat format) {
+        switch (format) {
+            case VK_FORMAT_S8_UINT:
+            case VK_FORMAT_D16_UNORM_S8_UINT:
+            case VK_FORMAT_D24_UNORM_S8_UINT:
+            case VK_FORMAT_D32_SFLOAT_S8_UINT:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    void vulkan_transition_image_layout(VkDevice device, CommandAllocator& commandAllocator, QueueSync& sync, QueueType queue, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout) {
+        VkCommandBuffer commandBuffer = vulkan_begin_transient_commands(commandAllocator);
 
         VkImageMemoryBarrier barrier = {};
         barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -780,11 +842,11 @@ namespace Cortex {
 
         vkCmdPipelineBarrier(commandBuffer, sourceStage, destinationStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
 
-        vulkan_end_transient_commands(device, commandPool, queue, commandBuffer);
+        vulkan_end_transient_commands(commandAllocator, sync, queue, commandBuffer);
     }
 
-    void vulkan_copy_buffer_to_image(VkDevice device, VkCommandPool commandPool, VkQueue queue, VkBuffer buffer, VkImage image, u32 width, u32 height) {
-        VkCommandBuffer commandBuffer = vulkan_begin_transient_commands(device, commandPool);
+    void vulkan_copy_buffer_to_image(VkDevice device, CommandAllocator& commandAllocator, QueueSync& sync, QueueType queue, VkBuffer buffer, VkImage image, u32 width, u32 height) {
+        VkCommandBuffer commandBuffer = vulkan_begin_transient_commands(commandAllocator);
 
         VkBufferImageCopy region{};
         region.bufferOffset = 0;
@@ -808,7 +870,7 @@ namespace Cortex {
             &region
         );
 
-        vulkan_end_transient_commands(device, commandPool, queue, commandBuffer);
+        vulkan_end_transient_commands(commandAllocator, sync, queue, commandBuffer);
     }
 
     VkImageView vulkan_create_image_view(VkDevice device, VkImage image, VkFormat format, VkImageAspectFlags aspectFlags) {
@@ -834,4 +896,75 @@ namespace Cortex {
         return imageView;
     }
 
+    void vulkan_read_obj(const std::string& path, tinyobj::attrib_t& outAttrib, std::vector<tinyobj::shape_t>& outShapes) {
+        std::vector<tinyobj::material_t> materials;
+        std::string warn, err;
+
+        bool ok = tinyobj::LoadObj(&outAttrib, &outShapes, &materials, &warn, &err, path.c_str());
+        ASSERT(ok, "Failed to load OBJ file.");
+    }
+
+    struct ObjCornerHash {
+        inline size_t operator()(const tinyobj::index_t& index) const {
+            u64 h = static_cast<u32>(index.vertex_index);
+            h = h * 0x9E3779B97F4A7C15ull ^ static_cast<u32>(index.normal_index);
+            h = h * 0x9E3779B97F4A7C15ull ^ static_cast<u32>(index.texcoord_index);
+            return static_cast<size_t>(h ^ (h >> 32));
+        }
+    };
+
+    struct ObjCornerEqual {
+        inline bool operator()(const tinyobj::index_t& a, const tinyobj::index_t& b) const {
+            return a.vertex_index == b.vertex_index && a.normal_index == b.normal_index && a.texcoord_index == b.texcoord_index;
+        }
+    };
+
+    void vulkan_build_obj_vertices(const tinyobj::attrib_t& attrib, const std::vector<tinyobj::shape_t>& shapes, std::vector<VulkanVertex>& outVertices, std::vector<VulkanIndex>& outIndices) {
+        size_t cornerCount = 0;
+        for (const auto& shape : shapes) {
+            cornerCount += shape.mesh.indices.size();
+        }
+        outIndices.reserve(outIndices.size() + cornerCount);
+        std::unordered_map<tinyobj::index_t, VulkanIndex, ObjCornerHash, ObjCornerEqual> welded;
+        welded.reserve(cornerCount);
+
+        for (const auto& shape : shapes) {
+            for (const auto& index : shape.mesh.indices) {
+                auto [slot, inserted] = welded.try_emplace(index, static_cast<VulkanIndex>(outVertices.size()));
+                outIndices.push_back(slot->second);
+                if (!inserted) {
+                    continue;
+                }
+
+                VulkanVertex vert {};
+
+                if (index.vertex_index >= 0) {
+                    vert.Position = {
+                        attrib.vertices[3 * index.vertex_index + 0],
+                        attrib.vertices[3 * index.vertex_index + 1],
+                        attrib.vertices[3 * index.vertex_index + 2],
+                    };
+                }
+
+                if (index.normal_index >= 0) {
+                    vert.Normal = {
+                        attrib.normals[3 * index.normal_index + 0],
+                        attrib.normals[3 * index.normal_index + 1],
+                        attrib.normals[3 * index.normal_index + 2],
+                    };
+                }
+
+                if (index.texcoord_index >= 0) {
+                    vert.TexCoord = {
+                        attrib.texcoords[2 * index.texcoord_index + 0],
+                        1.0f - attrib.texcoords[2 * index.texcoord_index + 1]
+                    };
+                }
+
+                vert.Color = {1.0f, 1.0f, 1.0f};
+
+                outVertices.push_back(vert);
+            }
+        }
+    }
 }
\ No newline at end of file
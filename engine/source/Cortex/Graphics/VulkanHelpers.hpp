@@ -1,19 +1,21 @@
 #pragma once
 
 #include "Cortex/Graphics/VulkanTypes.hpp"
+#include "Cortex/Graphics/QueueSync.hpp"
+#include "Cortex/Graphics/CommandAllocator.hpp"
 
 namespace Cortex {
 
     // MISC RESOURCE CREATION
 
-    VulkanSwapchainSpecification vulkan_create_swapchain_spec(VkPhysicalDevice physicalDevice, VkDevice device, VkSampleCountFlagBits samples, VkFormat depthFormat, VkSurfaceKHR surface, u32 width, u32 height);
-    VkRenderPass vulkan_create_renderpass(VkPhysicalDevice physicalDevice, VkDevice device, const VulkanSwapchainSpecification& config);
+    VulkanSwapchainSpecification vulkan_create_swapchain_spec(VkPhysicalDevice physicalDevice, VkDevice device, VkFormat depthFormat, VkSurfaceKHR surface, u32 width, u32 height, const VulkanPresentConfig& presentConfig);
     VkPipelineLayout vulkan_create_pipeline_layout(VkDevice device, const VkDescriptorSetLayout& descriptorSetLayout);
     VkCommandBuffer vulkan_create_command_buffer(VkDevice device, VkCommandPool commandPool);
     VkCommandPool vulkan_create_command_pool(VkDevice device, u32 queueIndex, VkCommandPoolCreateFlags flags);
 
     // DEVICE CREATION
 
+    bool vulkan_check_instance_extension_support(const std::vector<const char*> extensions);
     bool vulkan_check_layer_support(const std::vector<const char *> layers);
     bool vulkan_check_device_extension_support(VkPhysicalDevice physicalDevice, const std::vector<const char*> extensions);
     bool vulkan_evaluate_physical_device(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface, VulkanPhysicalDeviceRequirements requirements, i32 &score);
@@ -21,32 +23,38 @@ namespace Cortex {
     VulkanQueueIndices vulkan_find_queue_indices(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface);
     VulkanSwapchainProperties vulkan_query_swapchain_properties(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface);
     VkSurfaceFormatKHR vulkan_choose_surface_format(const std::vector<VkSurfaceFormatKHR>& availableFormats);
-    VkPresentModeKHR vulkan_choose_present_mode(const std::vector<VkPresentModeKHR>& availableModes);
+    VkPresentModeKHR vulkan_choose_present_mode(const std::vector<VkPresentModeKHR>& availableModes, VkPresentModeKHR requestedMode);
     VkExtent2D vulkan_choose_extent(const VkSurfaceCapabilitiesKHR& capabilities, u32 width, u32 height);
 
+    VkSampleCountFlags vulkan_get_supported_msaa_counts(VkPhysicalDevice physicalDevice);
     VkSampleCountFlagBits vulkan_get_max_msaa_count(VkPhysicalDevice physicalDevice);
+    void vulkan_get_timestamp_support(VkPhysicalDevice physicalDevice, u32 queueFamily, f32& outPeriod, u32& outValidBits, bool& outSupported);
+    // Bytes of every memory heap in use by this process. Needs VK_EXT_memory_budget enabled on the device.
+    VkDeviceSize vulkan_get_memory_usage(VkPhysicalDevice physicalDevice);
 
-    void vulkan_create_instance(std::vector<const char*> validationLayers, VkInstance& outInstance);
+    void vulkan_create_instance(std::vector<const char*> validationLayers, bool headless, VkInstance& outInstance);
     void vulkan_create_surface(VkInstance instance, GLFWwindow* window, VkSurfaceKHR& outSurface);
     void vulkan_obtain_physical_device(VkInstance instance, VkSurfaceKHR surface, VulkanPhysicalDeviceRequirements deviceRequirements, VkPhysicalDevice& outPhysicalDevice);
-    void vulkan_create_device(VkInstance instance, VkPhysicalDevice physicalDevice, VkSurfaceKHR surface, std::vector<const char*> deviceExtensions, VkDevice& outDevice, VulkanQueueIndices& outQueueIndices, VulkanQueues& outQueues);
+    void vulkan_create_device(VkInstance instance, VkPhysicalDevice physicalDevice, VkSurfaceKHR surface, std::vector<const char*> deviceExtensions, const VkPhysicalDeviceFeatures& enabledFeatures, const void* featureChain, VkDevice& outDevice, VulkanQueueIndices& outQueueIndices, VulkanQueues& outQueues);
 
     // CONTEXT CREATION
 
-    std::vector<VulkanFrameResources> vulkan_create_frame_resources(VkDevice device, u32 count, u32 queueIndex);
+    std::vector<VulkanFrameResources> vulkan_create_frame_resources(VkDevice device, u32 count);
     void vulkan_destroy_frame_resources(VkDevice device, std::vector<VulkanFrameResources> frameResources);
+    VulkanSwapchainSpecification vulkan_create_offscreen_spec(VkFormat depthFormat, u32 width, u32 height, u32 imageCount);
+    std::vector<VulkanOffscreenTarget> vulkan_create_offscreen_targets(VkDevice device, VkPhysicalDevice physicalDevice, const VulkanSwapchainSpecification& spec);
+    void vulkan_destroy_offscreen_targets(VkDevice device, std::vector<VulkanOffscreenTarget> targets);
 
     // MISC
 
-    VkCommandBuffer vulkan_begin_transient_commands(VkDevice device, VkCommandPool commandPool);
-    void vulkan_end_transient_commands(VkDevice device, VkCommandPool commandPool, VkQueue queue, VkCommandBuffer commandBuffer);
+    VkCommandBuffer vulkan_begin_transient_commands(CommandAllocator& commandAllocator);
+    QueuePoint vulkan_end_transient_commands(CommandAllocator& commandAllocator, QueueSync& sync, QueueType queue, VkCommandBuffer commandBuffer);
 
     // SWAPCHAIN CREATION
 
-    void vulkan_create_swapchain(VkPhysicalDevice physicalDevice, VkDevice device, VkSurfaceKHR surface, const VulkanSwapchainSpecification &config, VkSwapchainKHR& outSwapchain);
+    void vulkan_create_swapchain(VkPhysicalDevice physicalDevice, VkDevice device, VkSurfaceKHR surface, const VulkanSwapchainSpecification &config, VkSwapchainKHR oldSwapchain, VkSwapchainKHR& outSwapchain);
     void vulkan_get_swapchain_images(VkDevice device, VkSwapchainKHR swapchain, std::vector<VkImage>& outImages);
     void vulkan_create_swapchain_image_views(VkDevice device, const VulkanSwapchainSpecification &config, const std::vector<VkImage> &images, std::vector<VkImageView>& outImageViews);
-    void vulkan_create_swapchain_framebuffers(VkDevice device, VulkanSwapchainSpecification config, std::vector<VkImageView> swapchainImageViews, VkImageView depthImageView, VkImageView colorResolveImageView, VkRenderPass renderpass, std::vector<VkFramebuffer>& outFramebuffers);
 
     VkFormat vulkan_find_supported_format(VkPhysicalDevice physicalDevice, const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
 
@@ -54,10 +62,18 @@ namespace Cortex {
 
     std::string vulkan_read_shader_source(const std::string& path);
     std::vector<char> vulkan_read_shader_binary(const std::string& path);
-    std::vector<u32> vulkan_compile_from_source(const std::string& path, ShaderType type);
+    // defines are passed to the preprocessor as if by #define NAME.
+    std::vector<u32> vulkan_compile_from_source(const std::string& path, ShaderType type, const std::vector<std::string>& defines = {});
     VkShaderModule vulkan_create_shader_module(VkDevice device, const std::vector<char>& code);
     VkShaderModule vulkan_create_shader_module(VkDevice device, const std::vector<u32>& code);
 
+    // MODEL LOADING
+
+    // Parsing and vertex building are separate so each can be measured without a device.
+    void vulkan_read_obj(const std::string& path, tinyobj::attrib_t& outAttrib, std::vector<tinyobj::shape_t>& outShapes);
+    // Corners that share a position, normal and texture coordinate index share a vertex.
+    void vulkan_build_obj_vertices(const tinyobj::attrib_t& attrib, const std::vector<tinyobj::shape_t>& shapes, std::vector<VulkanVertex>& outVertices, std::vector<VulkanIndex>& outIndices);
+
     // BUFFER STUFF
 
     void vulkan_create_buffer(
@@ -71,11 +87,15 @@ namespace Cortex {
     );
 
     u32 vulkan_find_memory_type(u32 typeFilter, VkMemoryPropertyFlags properties, VkPhysicalDevice physicalDevice);
+    bool vulkan_try_find_memory_type(u32 typeFilter, VkMemoryPropertyFlags properties, VkPhysicalDevice physicalDevice, u32& outTypeIndex);
 
     // IMAGE STUFF
 
+    void vulkan_create_image_handle(VkDevice device, u32 width, u32 height, VkSampleCountFlagBits samples, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkImage& image);
     void vulkan_create_image(VkDevice device, VkPhysicalDevice physicalDevice, u32 width, u32 height, VkSampleCountFlagBits samples, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory);
-    void vulkan_transition_image_layout(VkDevice device, VkCommandPool commandPool, VkQueue queue, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout);
-    void vulkan_copy_buffer_to_image(VkDevice device, VkCommandPool commandPool, VkQueue queue, VkBuffer buffer, VkImage image, u32 width, u32 height);
+    bool vulkan_format_has_depth(VkFormat format);
+    bool vulkan_format_has_stencil(VkFormat format);
+    void vulkan_transition_image_layout(VkDevice device, CommandAllocator& commandAllocator, QueueSync& sync, QueueType queue, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout);
+    void vulkan_copy_buffer_to_image(VkDevice device, CommandAllocator& commandAllocator, QueueSync& sync, QueueType queue, VkBuffer buffer, VkImage image, u32 width, u32 height);
     VkImageView vulkan_create_image_view(VkDevice device, VkImage image, VkFormat format, VkImageAspectFlags aspectFlags);
 }
\ No newline at end of file
@@ -39,6 +39,7 @@ namespace Cortex {
         void* data;
         vkMapMemory(device->Device, stagingMemory, 0, imageSize, 0, &data);
         memcpy(data, px, static_cast<size_t>(imageSize));
+        device->Counters.BytesUploaded += imageSize;
         vkUnmapMemory(device->Device, stagingMemory);
 
         stbi_image_free(px);
@@ -63,8 +64,9 @@ namespace Cortex {
 
         vulkan_transition_image_layout(
             device->Device, 
-            device->TransferCommandPool, 
-            device->Queues.Transfer,
+            *device->TransferCommands, 
+            *device->Sync,
+            QueueType::Transfer,
             m_Image,
             m_Format,
             VK_IMAGE_LAYOUT_UNDEFINED,
@@ -73,8 +75,9 @@ namespace Cortex {
 
         vulkan_copy_buffer_to_image(
             device->Device,
-            device->TransferCommandPool,
-            device->Queues.Transfer,
+            *device->TransferCommands,
+            *device->Sync,
+            QueueType::Transfer,
             stagingBuffer,
             m_Image,
             m_Width,
@@ -83,8 +86,9 @@ namespace Cortex {
 
         vulkan_transition_image_layout(
             device->Device, 
-            device->TransferCommandPool, 
-            device->Queues.Transfer,
+            *device->TransferCommands, 
+            *device->Sync,
+            QueueType::Transfer,
             m_Image,
             m_Format,
             VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
@@ -104,10 +108,17 @@ namespace Cortex {
     }
 
     Texture2D::~Texture2D() {
-        vulkan_destroy_sampler_2D(m_GraphicsDevice, m_Sampler);
-        vkDestroyImageView(m_GraphicsDevice->Device, m_ImageView, nullptr);
-        vkFreeMemory(m_GraphicsDevice->Device, m_ImageMemory, nullptr);
-        vkDestroyImage(m_GraphicsDevice->Device, m_Image, nullptr);
+        VkDevice device = m_GraphicsDevice->Device;
+        VkSampler sampler = m_Sampler.Sampler;
+        VkImageView view = m_ImageView;
+        VkDeviceMemory memory = m_ImageMemory;
+        VkImage image = m_Image;
+        m_GraphicsDevice->PendingDeletions.Push([=]() {
+            vkDestroySampler(device, sampler, nullptr);
+            vkDestroyImageView(device, view, nullptr);
+            vkFreeMemory(device, memory, nullptr);
+            vkDestroyImage(device, image, nullptr);
+        });
     }
 
     VulkanTexture2D vulkan_create_texture_2D(const std::shared_ptr<GraphicsDevice> device, const std::string& path) {
@@ -140,6 +151,7 @@ namespace Cortex {
         void* data;
         vkMapMemory(device->Device, stagingMemory, 0, imageSize, 0, &data);
         memcpy(data, px, static_cast<size_t>(imageSize));
+        device->Counters.BytesUploaded += imageSize;
         vkUnmapMemory(device->Device, stagingMemory);
 
         stbi_image_free(px);
@@ -165,8 +177,9 @@ namespace Cortex {
 
         vulkan_transition_image_layout(
             device->Device, 
-            device->TransferCommandPool, 
-            device->Queues.Transfer,
+            *device->TransferCommands, 
+            *device->Sync,
+            QueueType::Transfer,
             texture.Image,
             texture.Format,
             VK_IMAGE_LAYOUT_UNDEFINED,
@@ -175,8 +188,9 @@ namespace Cortex {
 
         vulkan_copy_buffer_to_image(
             device->Device,
-            device->TransferCommandPool,
-            device->Queues.Transfer,
+            *device->TransferCommands,
+            *device->Sync,
+            QueueType::Transfer,
             stagingBuffer,
             texture.Image,
             texture.Width,
@@ -185,8 +199,9 @@ namespace Cortex {
 
         vulkan_transition_image_layout(
             device->Device, 
-            device->TransferCommandPool, 
-            device->Queues.Transfer,
+            *device->TransferCommands, 
+            *device->Sync,
+            QueueType::Transfer,
             texture.Image,
             texture.Format,
             VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
@@ -208,9 +223,13 @@ namespace Cortex {
     }
 
     VulkanSampler2D vulkan_create_sampler_2D(const std::shared_ptr<GraphicsDevice> device) {
+        return vulkan_create_sampler_2D(device, VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_REPEAT, true);
+    }
+
+    VulkanSampler2D vulkan_create_sampler_2D(const std::shared_ptr<GraphicsDevice> device, VkFilter filter, VkSamplerAddressMode addressMode, bool anisotropy) {
         VulkanSampler2D sampler = {};
-        sampler.MagnificationFilter = VK_FILTER_LINEAR;
-        sampler.MinificationFilter = VK_FILTER_LINEAR;
+        sampler.MagnificationFilter = filter;
+        sampler.MinificationFilter = filter;
 
         VkPhysicalDeviceProperties props;
         vkGetPhysicalDeviceProperties(device->PhysicalDevice, &props);
@@ -219,11 +238,11 @@ namespace Cortex {
         createInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
         createInfo.magFilter = sampler.MagnificationFilter;
         createInfo.minFilter = sampler.MinificationFilter;
-        createInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-        createInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-        createInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-        createInfo.anisotropyEnable = VK_TRUE;
-        createInfo.maxAnisotropy = props.limits.maxSamplerAnisotropy;
+        createInfo.addressModeU = addressMode;
+        createInfo.addressModeV = addressMode;
+        createInfo.addressModeW = addressMode;
+        createInfo.anisotropyEnable = anisotropy ? VK_TRUE : VK_FALSE;
+        createInfo.maxAnisotropy = anisotropy ? props.limits.maxSamplerAnisotropy : 1.0f;
         createInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
         createInfo.unnormalizedCoordinates = VK_FALSE;
         createInfo.compareEnable = VK_FALSE;
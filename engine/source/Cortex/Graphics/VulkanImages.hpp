@@ -45,6 +45,7 @@ namespace Cortex {
 
     VulkanTexture2D vulkan_create_texture_2D(const std::shared_ptr<GraphicsDevice> device, const std::string& path);
     VulkanSampler2D vulkan_create_sampler_2D(const std::shared_ptr<GraphicsDevice> device);
+    VulkanSampler2D vulkan_create_sampler_2D(const std::shared_ptr<GraphicsDevice> device, VkFilter filter, VkSamplerAddressMode addressMode, bool anisotropy);
 
     void vulkan_destroy_texture_2D(const std::shared_ptr<GraphicsDevice> device, VulkanTexture2D& texture);
     void vulkan_destroy_sampler_2D(const std::shared_ptr<GraphicsDevice> device, VulkanSampler2D& sampler);
@@ -24,11 +24,14 @@
 #include <numeric>
 #include <chrono>
 #include <unordered_map>
+#include <algorithm>
+#include <cstring>
 
 
 namespace Cortex {
 
-    #define MAX_FRAMES_IN_FLIGHT 2
+    #define DEFAULT_FRAMES_IN_FLIGHT 2
+    #define MAX_FRAMES_IN_FLIGHT_LIMIT 4 // upper bound for the runtime frames-in-flight setting
     #define VULKAN_QUEUE_NOT_FOUND_INDEX std::numeric_limits<u32>::max()
 
     using VulkanIndex = u32;
@@ -38,8 +41,6 @@ namespace Cortex {
         glm::vec3 Normal;
         glm::vec3 Color;
         glm::vec2 TexCoord;
-        static std::vector<VkVertexInputBindingDescription> BindingDescriptions();
-        static std::vector<VkVertexInputAttributeDescription> AttributeDescriptions();
     };
 
     struct VulkanQueueIndices {
@@ -71,7 +72,15 @@ namespace Cortex {
 
     struct VulkanDeviceDetails {
         VkSampleCountFlagBits MaxMultisamplingCount;
+        VkSampleCountFlags SupportedMultisamplingCounts;
         VkFormat DepthFormat;
+        f32 TimestampPeriod;        // nanoseconds per timestamp tick
+        u32 TimestampValidBits;     // low bits of a graphics queue timestamp that count; the rest are garbage
+        bool TimestampsSupported;   // graphics queue can write timestamps
+        bool PresentWaitSupported;  // VK_KHR_present_id and VK_KHR_present_wait enabled
+        bool AsyncComputeSupported; // Compute is a different queue from Graphics, so submissions can overlap
+        bool PipelineStatisticsSupported; // pipelineStatisticsQuery enabled
+        bool MemoryBudgetSupported; // VK_EXT_memory_budget enabled
     };
 
     struct VulkanSwapchainProperties {
@@ -80,34 +89,32 @@ namespace Cortex {
         std::vector<VkPresentModeKHR> PresentModes;
     };
 
+    struct VulkanPresentConfig {
+        VkPresentModeKHR PresentMode = VK_PRESENT_MODE_MAILBOX_KHR; // falls back to MAILBOX, then FIFO
+        u32 ImageCount = 0;         // 0 picks one more than the surface minimum
+        bool PresentWait = false;   // pace frames on VK_KHR_present_wait where supported
+        u32 PresentWaitLag = 1;     // presents allowed in the queue before BeginFrame blocks
+    };
+
     struct VulkanSwapchainSpecification {
         VkSurfaceFormatKHR SurfaceFormat;
         VkPresentModeKHR PresentMode;
         VkExtent2D Extent;
         VkSurfaceTransformFlagBitsKHR CurrentTransform;
         u32 ImageCount;
-        VkSampleCountFlagBits MultisamplingCount;
         VkFormat DepthFormat;
     };
 
-    struct VulkanDepthResources {
-        VkImage Image;
-        VkDeviceMemory ImageMemory;
-        VkImageView ImageView;
-    };
-
-    struct VulkanColorResources {
-        VkImage Image;
-        VkDeviceMemory ImageMemory;
-        VkImageView ImageView;    
-    };
-
     struct VulkanFrameResources {
         VkSemaphore ImageAvailableSemaphore;
         VkSemaphore RenderFinishSemaphore;
-        VkFence InFlightFence;
-        VkCommandPool CommandPool;
-        VkCommandBuffer CommandBuffer;
+    };
+
+    // Stands in for a swapchain image when rendering headless.
+    struct VulkanOffscreenTarget {
+        VkImage Image;
+        VkDeviceMemory Memory;
+        VkImageView View;
     };
 
     ////////////////////////////////////////////////////
@@ -116,7 +123,8 @@ namespace Cortex {
 
     enum ShaderType {
         VERTEX,
-        FRAGMENT
+        FRAGMENT,
+        COMPUTE
     };
 
     struct VulkanDescriptorSpec {
@@ -132,6 +140,7 @@ namespace Cortex {
 
     struct VulkanPushConstantSpec {
         std::string Name;
+        u32 Size;
     };
 
     struct VulkanShaderSpec {
@@ -144,12 +153,14 @@ namespace Cortex {
     // UNIFORMS ////////////////////////////////////////
     ////////////////////////////////////////////////////
     
+    // Per draw, so every entity can be drawn with its own transform inside one frame's commands.
     struct VulkanPushData {
         glm::mat4 ModelMatrix;
+        glm::vec4 Color;
     };
 
+    // Per frame.
     struct VulkanCameraUniformData {
-        alignas(16) glm::mat4 ModelToWorldSpace;
         alignas(16) glm::mat4 WorldToClipSpace;
     };
 
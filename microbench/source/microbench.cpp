@@ -0,0 +1,669 @@
+#include "Cortex/Base/Base.hpp"
+#include "Cortex/Core/Events.hpp"
+#include "Cortex/Core/Frustum.hpp"
+#include "Cortex/Core/Scene.hpp"
+#include "Cortex/Core/SoftwareOcclusion.hpp"
+#include "Cortex/Core/Window.hpp"
+#include "Cortex/Graphics/GraphicsContext.hpp"
+#include "Cortex/Graphics/MeshCache.hpp"
+#include "Cortex/Graphics/MeshOptimizer.hpp"
+#include "Cortex/Graphics/MeshSimplifier.hpp"
+#include "Cortex/Graphics/ObjParser.hpp"
+#include "Cortex/Graphics/Renderer.hpp"
+#include "Cortex/Graphics/Shader.hpp"
+#include "Cortex/Graphics/VertexLayout.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <sstream>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+// Times the engine's CPU hot paths in isolation, each as a loop of identical operations, and writes
+// nanoseconds per operation as JSON. Passing a previous run's output with --compare fails the run
+// when any benchmark's median got slower than the threshold, so it can gate a change. Run it from a
+// directory inside the build tree, like the testbed, so the relative asset paths resolve.
+//
+// Each benchmark first finds an iteration count that makes one sample take about --sample-ms, runs a
+// few unrecorded samples to settle caches and clocks, then records --samples samples. The median is
+// what gets compared; the spread is reported so a noisy machine is obvious.
+
+using namespace Cortex;
+
+#define MICROBENCH_OBJ_PATH "../../testbed/assets/models/viking/viking_room.obj"
+#define MICROBENCH_TEXTURE_PATH "../../testbed/assets/models/viking/viking_room.png"
+#define MICROBENCH_TRANSFORM_COUNT 10000
+#define MICROBENCH_TRANSFORM_CHAIN 8        // entities per parent chain in the transform benchmark
+#define MICROBENCH_BOUNDS_COUNT 10000
+#define MICROBENCH_OCCLUDER_COUNT 16
+#define MICROBENCH_SHADER_NAMES 64
+#define MICROBENCH_MAX_ITERATIONS (1ull << 32)
+
+struct MicrobenchOptions {
+    std::string Filter;         // only benchmarks whose name contains this; empty runs everything
+    u32 Samples = 20;
+    u32 Warmup = 3;             // samples run and discarded before recording
+    f64 SampleMilliseconds = 10.0;
+    bool Gpu = true;            // benchmarks that need a device: uniform, descriptor and shader library
+    std::string Output = "cortex_microbench.json";
+    std::string Compare;        // a previous run's output to check against, empty for none
+    f64 Threshold = 5.0;        // percent slower than the baseline median that counts as a regression
+};
+
+struct Microbench {
+    std::string Name;
+    std::function<void(u64 iterations)> Run;
+};
+
+struct MicrobenchResult {
+    std::string Name;
+    u64 Iterations = 0;         // per sample
+    u32 Samples = 0;
+    f64 Median = 0.0;           // the rest are nanoseconds per iteration
+    f64 Mean = 0.0;
+    f64 StdDev = 0.0;
+    f64 Min = 0.0;
+    f64 Max = 0.0;
+};
+
+// Everything the device-side benchmarks touch. Members are destroyed in reverse, so the context,
+// and with it the device, goes last.
+struct MicrobenchGpu {
+    std::unique_ptr<GraphicsContext> Context;
+    std::shared_ptr<ShaderLibrary> Library;
+    std::shared_ptr<Texture2D> Texture;
+    std::vector<VulkanUniformBuffer> UniformBuffers;
+    VkDescriptorSet DescriptorSet = VK_NULL_HANDLE;
+    std::vector<std::string> ShaderNames;
+
+    ~MicrobenchGpu() {
+        if (!Context) {
+            return;
+        }
+        VkDevice device = Context->GetDevice()->Device;
+        vkDeviceWaitIdle(device);
+        for (const auto& buffer : UniformBuffers) {
+            vkUnmapMemory(device, buffer.UniformBufferMemory);
+            vkDestroyBuffer(device, buffer.UniformBuffer, nullptr);
+            vkFreeMemory(device, buffer.UniformBufferMemory, nullptr);
+        }
+    }
+};
+
+// Keeps the compiler from discarding a result the benchmark never otherwise uses.
+template <typename T>
+static inline void microbench_keep(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Small and deterministic, so the generated bounds are the same on every run and every platform.
+static inline u64 microbench_random(u64& state) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+static inline f32 microbench_random_range(u64& state, f32 min, f32 max) {
+    return min + (max - min) * ((f32)(microbench_random(state) >> 40) / (f32)(1ull << 24));
+}
+
+// Points stdout at /dev/null for its lifetime, for benchmarking the logger without measuring the
+// terminal.
+class MicrobenchSilenceStdout {
+    public:
+        MicrobenchSilenceStdout() {
+            fflush(stdout);
+            m_Saved = dup(STDOUT_FILENO);
+            i32 null = open("/dev/null", O_WRONLY);
+            dup2(null, STDOUT_FILENO);
+            close(null);
+        }
+        ~MicrobenchSilenceStdout() {
+            fflush(stdout);
+            dup2(m_Saved, STDOUT_FILENO);
+            close(m_Saved);
+        }
+    private:
+        i32 m_Saved;
+};
+
+static void microbench_print_usage() {
+    LOG_INFO("Usage: CortexMicrobench [--filter text] [--samples N] [--warmup N] [--sample-ms MS] [--no-gpu] [--output path] [--compare baseline.json] [--threshold percent]");
+}
+
+static bool microbench_parse_options(i32 argc, char** argv, MicrobenchOptions& options) {
+    for (i32 i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--no-gpu") {
+            options.Gpu = false;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            LOG_ERROR("Missing value for %s.", arg.c_str());
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--filter") {
+            options.Filter = value;
+        } else if (arg == "--samples") {
+            options.Samples = (u32)std::stoul(value);
+        } else if (arg == "--warmup") {
+            options.Warmup = (u32)std::stoul(value);
+        } else if (arg == "--sample-ms") {
+            options.SampleMilliseconds = std::stod(value);
+        } else if (arg == "--output") {
+            options.Output = value;
+        } else if (arg == "--compare") {
+            options.Compare = value;
+        } else if (arg == "--threshold") {
+            options.Threshold = std::stod(value);
+        } else {
+            LOG_ERROR("Unknown option %s.", arg.c_str());
+            return false;
+        }
+    }
+    return options.Samples > 0 && options.SampleMilliseconds > 0.0 && options.Threshold >= 0.0;
+}
+
+static f64 microbench_time(const Microbench& bench, u64 iterations) {
+    auto start = std::chrono::steady_clock::now();
+    bench.Run(iterations);
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<f64, std::nano>(end - start).count();
+}
+
+static MicrobenchResult microbench_run(const Microbench& bench, const MicrobenchOptions& options) {
+    MicrobenchResult result;
+    result.Name = bench.Name;
+
+    // Grow the iteration count until one sample fills the target time, aiming straight for it once a
+    // sample is long enough for its timing to mean something.
+    f64 target = options.SampleMilliseconds * 1e6;
+    u64 iterations = 1;
+    while (iterations < MICROBENCH_MAX_ITERATIONS) {
+        f64 elapsed = microbench_time(bench, iterations);
+        if (elapsed >= target) {
+            break;
+        }
+        u64 next = iterations * 2;
+        if (elapsed > target / 100.0) {
+            next = std::max(next, (u64)((f64)iterations * target / elapsed * 1.1));
+        }
+        iterations = std::min<u64>(next, MICROBENCH_MAX_ITERATIONS);
+    }
+
+    for (u32 i = 0; i < options.Warmup; i++) {
+        microbench_time(bench, iterations);
+    }
+
+    std::vector<f64> samples(options.Samples);
+    for (u32 i = 0; i < options.Samples; i++) {
+        samples[i] = microbench_time(bench, iterations) / (f64)iterations;
+    }
+    std::sort(samples.begin(), samples.end());
+
+    f64 sum = 0.0;
+    for (f64 sample : samples) {
+        sum += sample;
+    }
+    f64 mean = sum / (f64)samples.size();
+    f64 variance = 0.0;
+    for (f64 sample : samples) {
+        variance += (sample - mean) * (sample - mean);
+    }
+    u64 middle = samples.size() / 2;
+
+    result.Iterations = iterations;
+    result.Samples = options.Samples;
+    result.Median = samples.size() % 2 ? samples[middle] : 0.5 * (samples[middle - 1] + samples[middle]);
+    result.Mean = mean;
+    result.StdDev = samples.size() > 1 ? std::sqrt(variance / (f64)(samples.size() - 1)) : 0.0;
+    result.Min = samples.front();
+    result.Max = samples.back();
+    return result;
+}
+
+template <typename T>
+static inline bool microbench_same_bits(const std::vector<T>& a, const std::vector<T>& b) {
+    return a.size() == b.size() && (a.empty() || memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+}
+
+// Whether two OBJ reads agree exactly, floats compared by their bits.
+static bool microbench_same_obj(const tinyobj::attrib_t& a, const std::vector<tinyobj::shape_t>& aShapes, const tinyobj::attrib_t& b, const std::vector<tinyobj::shape_t>& bShapes) {
+    if (!microbench_same_bits(a.vertices, b.vertices) || !microbench_same_bits(a.colors, b.colors) || !microbench_same_bits(a.normals, b.normals) || !microbench_same_bits(a.texcoords, b.texcoords) || aShapes.size() != bShapes.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < aShapes.size(); i++) {
+        const tinyobj::mesh_t& am = aShapes[i].mesh;
+        const tinyobj::mesh_t& bm = bShapes[i].mesh;
+        if (aShapes[i].name != bShapes[i].name || !microbench_same_bits(am.indices, bm.indices) || !microbench_same_bits(am.num_face_vertices, bm.num_face_vertices) || !microbench_same_bits(am.material_ids, bm.material_ids) || !microbench_same_bits(am.smoothing_group_ids, bm.smoothing_group_ids)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// CPU-only benchmarks. The captured state lives in the returned closures.
+static void microbench_add_cpu(std::vector<Microbench>& benches) {
+    if (std::ifstream(MICROBENCH_OBJ_PATH).good()) {
+        benches.push_back({"obj/parse", [](u64 iterations) {
+            for (u64 i = 0; i < iterations; i++) {
+                tinyobj::attrib_t attrib;
+                std::vector<tinyobj::shape_t> shapes;
+                vulkan_read_obj(MICROBENCH_OBJ_PATH, attrib, shapes);
+                microbench_keep(shapes.size());
+            }
+        }});
+
+        auto attrib = std::make_shared<tinyobj::attrib_t>();
+        auto shapes = std::make_shared<std::vector<tinyobj::shape_t>>();
+        vulkan_read_obj(MICROBENCH_OBJ_PATH, *attrib, *shapes);
+
+        // Timed against obj/parse, and checked against it first, since a faster parse that reads
+        // anything differently is no improvement.
+        for (u32 threads : {0u, WorkerPool::DefaultThreadCount()}) {
+            auto parser = std::make_shared<ObjParser>(threads);
+            tinyobj::attrib_t parsedAttrib;
+            std::vector<tinyobj::shape_t> parsedShapes;
+            if (!parser->Parse(MICROBENCH_OBJ_PATH, parsedAttrib, parsedShapes) || !microbench_same_obj(parsedAttrib, parsedShapes, *attrib, *shapes)) {
+                LOG_WARN("ObjParser does not read %s as tinyobj does.", MICROBENCH_OBJ_PATH);
+            }
+            std::string name = threads == 0 ? "obj/parse_parallel_1_thread" : "obj/parse_parallel";
+            benches.push_back({name, [parser](u64 iterations) {
+                for (u64 i = 0; i < iterations; i++) {
+                    tinyobj::attrib_t attrib;
+                    std::vector<tinyobj::shape_t> shapes;
+                    parser->Parse(MICROBENCH_OBJ_PATH, attrib, shapes);
+                    microbench_keep(shapes.size());
+                }
+            }});
+        }
+        benches.push_back({"obj/build_vertices", [attrib, shapes](u64 iterations) {
+            for (u64 i = 0; i < iterations; i++) {
+                std::vector<VulkanVertex> vertices;
+                std::vector<VulkanIndex> indices;
+                vulkan_build_obj_vertices(*attrib, *shapes, vertices, indices);
+                microbench_keep(vertices.data());
+            }
+        }});
+
+        auto vertices = std::make_shared<std::vector<VulkanVertex>>();
+        auto indices = std::make_shared<std::vector<VulkanIndex>>();
+        vulkan_build_obj_vertices(*attrib, *shapes, *vertices, *indices);
+        benches.push_back({"mesh/build_lods", [vertices, indices](u64 iterations) {
+            for (u64 i = 0; i < iterations; i++) {
+                std::vector<VulkanIndex> lodIndices = *indices;
+                std::vector<MeshLod> lods;
+                mesh_build_lods(*vertices, lodIndices, lods);
+                microbench_keep(lods.data());
+            }
+        }});
+        benches.push_back({"mesh/optimize_vertex_cache", [vertices, indices](u64 iterations) {
+            for (u64 i = 0; i < iterations; i++) {
+                std::vector<VulkanIndex> optimized = *indices;
+                mesh_optimize_vertex_cache(optimized.data(), static_cast<u32>(optimized.size()), static_cast<u32>(vertices->size()));
+                microbench_keep(optimized.data());
+            }
+        }});
+        benches.push_back({"mesh/optimize_overdraw", [vertices, indices](u64 iterations) {
+            std::vector<VulkanIndex> cacheOrder = *indices;
+            mesh_optimize_vertex_cache(cacheOrder.data(), static_cast<u32>(cacheOrder.size()), static_cast<u32>(vertices->size()));
+            for (u64 i = 0; i < iterations; i++) {
+                std::vector<VulkanIndex> optimized = cacheOrder;
+                mesh_optimize_overdraw(optimized.data(), static_cast<u32>(optimized.size()), *vertices, MeshImportSettings{}.OverdrawThreshold);
+                microbench_keep(optimized.data());
+            }
+        }});
+        benches.push_back({"mesh/encode_quantized", [vertices](u64 iterations) {
+            for (u64 i = 0; i < iterations; i++) {
+                glm::mat4 vertexToModel;
+                std::vector<u8> encoded = vertex_encode(VertexLayout::Quantized, *vertices, vertexToModel);
+                microbench_keep(encoded.data());
+            }
+        }});
+
+        // Its own cache file, so the one the testbed keeps beside the asset is left alone.
+        std::string cachePath = std::string(MICROBENCH_OBJ_PATH) + ".microbench" + MESH_CACHE_EXTENSION;
+        ModelStorage storage;
+        ModelData encoded = model_encode(*vertices, *indices, {}, VertexLayout::Quantized, storage);
+        if (mesh_cache_write(cachePath, MICROBENCH_OBJ_PATH, MeshImportSettings{}, encoded)) {
+            benches.push_back({"mesh/cache_read", [cachePath](u64 iterations) {
+                for (u64 i = 0; i < iterations; i++) {
+                    ModelData data;
+                    std::unique_ptr<MappedFile> cache = mesh_cache_read(cachePath, MICROBENCH_OBJ_PATH, MeshImportSettings{}, data);
+                    microbench_keep(data.Vertices);
+                }
+            }});
+        }
+    } else {
+        LOG_WARN("Skipping the OBJ benchmarks: %s not found.", MICROBENCH_OBJ_PATH);
+    }
+
+    benches.push_back({"log/corelog", [](u64 iterations) {
+        MicrobenchSilenceStdout silence;
+        for (u64 i = 0; i < iterations; i++) {
+            LOG_INFO("Frame %llu: %u draws, %.3f ms", (unsigned long long)i, 42u, 16.667);
+        }
+    }});
+
+    // The same path a GLFW callback takes: build the Event, hand it to the window's callback, which
+    // switches on the tag the way App::OnEvent does.
+    auto state = std::make_shared<WindowState>();
+    auto handled = std::make_shared<u64>(0);
+    state->Callback = [handled](Event& e) {
+        switch (e.Tag) {
+            case EventTag::KeyEvent:
+                *handled += e.KeyEvent.Action == KEY_PRESS ? e.KeyEvent.KeyCode : 0;
+                break;
+            case EventTag::MouseMoveEvent:
+                *handled += (u64)e.MouseMoveEvent.X;
+                break;
+            default:
+                break;
+        }
+        return true;
+    };
+    benches.push_back({"events/dispatch", [state, handled](u64 iterations) {
+        for (u64 i = 0; i < iterations; i++) {
+            if (i & 1) {
+                Event e{};
+                e.Tag = EventTag::KeyEvent;
+                e.KeyEvent.KeyCode = (i32)(i & 0xFF);
+                e.KeyEvent.Action = KEY_PRESS;
+                state->Callback(e);
+            } else {
+                Event e{};
+                e.Tag = EventTag::MouseMoveEvent;
+                e.MouseMoveEvent.X = (f64)i;
+                e.MouseMoveEvent.Y = (f64)i;
+                state->Callback(e);
+            }
+        }
+        microbench_keep(*handled);
+    }});
+
+    auto scene = std::make_shared<Scene>();
+    scene->Entities.reserve(MICROBENCH_TRANSFORM_COUNT);
+    for (u32 i = 0; i < MICROBENCH_TRANSFORM_COUNT; i++) {
+        Entity entity = Entity::Create();
+        entity.Transform.LocalMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(0.1f, 0.0f, 0.0f));
+        entity.Transform.LocalMatrix = glm::rotate(entity.Transform.LocalMatrix, 0.01f * (f32)i, glm::vec3(0.0f, 1.0f, 0.0f));
+        entity.Transform.ModelMatrix = entity.Transform.LocalMatrix;
+        if (i % MICROBENCH_TRANSFORM_CHAIN != 0) {
+            entity.Transform.Parent = i - 1;
+        }
+        scene->Entities.push_back(entity);
+    }
+    benches.push_back({"scene/update_transforms_10k", [scene](u64 iterations) {
+        for (u64 i = 0; i < iterations; i++) {
+            scene->UpdateTransforms();
+            microbench_keep(scene->Entities.back().Transform.ModelMatrix[3][0]);
+        }
+    }});
+
+    Camera camera;
+    camera.SetPerspectiveProjection(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+    camera.SetView({0.0f, 0.0f, -10.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f});
+    glm::mat4 worldToClip = camera.ProjectionMatrix * camera.ViewMatrix;
+    benches.push_back({"frustum/extract", [worldToClip](u64 iterations) {
+        for (u64 i = 0; i < iterations; i++) {
+            Frustum frustum = Frustum::FromMatrix(worldToClip);
+            microbench_keep(frustum.Planes[0]);
+        }
+    }});
+
+    // Bounds spread around the view so roughly half are visible, keeping the branches unpredictable.
+    auto centers = std::make_shared<std::vector<glm::vec4>>(MICROBENCH_BOUNDS_COUNT);
+    u64 random = 0x2545F4914F6CDD1Dull;
+    for (auto& center : *centers) {
+        center = {
+            microbench_random_range(random, -40.0f, 40.0f),
+            microbench_random_range(random, -25.0f, 25.0f),
+            microbench_random_range(random, -20.0f, 120.0f),
+            microbench_random_range(random, 0.1f, 2.0f)
+        };
+    }
+    Frustum frustum = Frustum::FromMatrix(worldToClip);
+    benches.push_back({"frustum/spheres_10k", [frustum, centers](u64 iterations) {
+        for (u64 i = 0; i < iterations; i++) {
+            u32 visible = 0;
+            for (const auto& center : *centers) {
+                visible += frustum.IntersectsSphere(glm::vec3(center), center.w);
+            }
+            microbench_keep(visible);
+        }
+    }});
+    benches.push_back({"frustum/boxes_10k", [frustum, centers](u64 iterations) {
+        for (u64 i = 0; i < iterations; i++) {
+            u32 visible = 0;
+            for (const auto& center : *centers) {
+                glm::vec3 extent(center.w);
+                visible += frustum.IntersectsBox(glm::vec3(center) - extent, glm::vec3(center) + extent);
+            }
+            microbench_keep(visible);
+        }
+    }});
+
+    // Walls scattered across the near half of the same bounds, facing the camera.
+    auto wall = std::make_shared<OccluderMesh>();
+    wall->Positions = {{-.5f, -.5f, .0f}, {+.5f, -.5f, .0f}, {+.5f, +.5f, .0f}, {-.5f, +.5f, .0f}};
+    wall->Indices = {0, 1, 2, 2, 3, 0};
+    auto occluders = std::make_shared<std::vector<SoftwareOccluder>>();
+    for (u32 i = 0; i < MICROBENCH_OCCLUDER_COUNT; i++) {
+        glm::vec3 position = {microbench_random_range(random, -20.0f, 20.0f), microbench_random_range(random, -12.0f, 12.0f), microbench_random_range(random, 0.0f, 40.0f)};
+        glm::vec3 size = {microbench_random_range(random, 4.0f, 16.0f), microbench_random_range(random, 3.0f, 10.0f), 1.0f};
+        occluders->push_back({wall.get(), glm::translate(glm::mat4(1.0f), position) * glm::scale(glm::mat4(1.0f), size)});
+    }
+    auto visibility = std::make_shared<std::vector<u8>>();
+    for (u32 threads : {0u, WorkerPool::DefaultThreadCount()}) {
+        auto culler = std::make_shared<SoftwareOcclusionCuller>(threads);
+        std::string name = threads == 0 ? "occlusion/cpu_cull_10k_1_thread" : "occlusion/cpu_cull_10k";
+        benches.push_back({name, [worldToClip, wall, occluders, centers, visibility, culler](u64 iterations) {
+            for (u64 i = 0; i < iterations; i++) {
+                culler->Cull(worldToClip, *occluders, *centers, *visibility);
+                microbench_keep(culler->GetStats().OcclusionCulled);
+            }
+        }});
+    }
+}
+
+static void microbench_add_gpu(std::vector<Microbench>& benches, MicrobenchGpu& gpu) {
+    gpu.Context = GraphicsContext::Create(VkExtent2D{64, 64});
+    std::shared_ptr<GraphicsDevice> device = gpu.Context->GetDevice();
+
+    // One compiled shader under many names, so lookups hash and compare realistic keys without
+    // compiling the same source dozens of times.
+    gpu.Library = ShaderLibrary::Create(device);
+    std::shared_ptr<Shader> shader = gpu.Library->Load("basic", "../../testbed/assets/shaders/basic.vert", "../../testbed/assets/shaders/basic.frag");
+    for (u32 i = 0; i < MICROBENCH_SHADER_NAMES; i++) {
+        gpu.ShaderNames.push_back("material_" + std::to_string(i));
+        gpu.Library->Add(gpu.ShaderNames.back(), shader);
+    }
+
+    gpu.Texture = Texture2D::Create(device, MICROBENCH_TEXTURE_PATH);
+    gpu.UniformBuffers = vulkan_create_uniform_buffers(device, 1);
+    gpu.DescriptorSet = vulkan_create_descriptor_sets(device->Device, shader->m_DescriptorPool, 1, shader->m_DescriptorSetLayouts[0], gpu.Texture, gpu.UniformBuffers)[0];
+
+    MicrobenchGpu* state = &gpu;
+    benches.push_back({"uniform/update", [state](u64 iterations) {
+        void* mapped = state->UniformBuffers[0].UniformBufferMapped;
+        VulkanCameraUniformData data = {glm::mat4(1.0f)};
+        for (u64 i = 0; i < iterations; i++) {
+            data.WorldToClipSpace[3][0] = (f32)i;
+            memcpy(mapped, &data, sizeof(data));
+        }
+        microbench_keep(mapped);
+    }});
+
+    benches.push_back({"descriptor/update", [state](u64 iterations) {
+        VkDevice device = state->Context->GetDevice()->Device;
+        VkDescriptorBufferInfo bufferInfo = {};
+        bufferInfo.buffer = state->UniformBuffers[0].UniformBuffer;
+        bufferInfo.offset = 0;
+        bufferInfo.range = state->UniformBuffers[0].Size;
+
+        VkWriteDescriptorSet writes[2] = {};
+        writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[0].dstSet = state->DescriptorSet;
+        writes[0].dstBinding = 0;
+        writes[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        writes[0].descriptorCount = 1;
+        writes[0].pBufferInfo = &bufferInfo;
+        writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[1].dstSet = state->DescriptorSet;
+        writes[1].dstBinding = 1;
+        writes[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writes[1].descriptorCount = 1;
+        writes[1].pImageInfo = &state->Texture->GetDescriptor();
+
+        for (u64 i = 0; i < iterations; i++) {
+            vkUpdateDescriptorSets(device, 2, writes, 0, nullptr);
+        }
+    }});
+
+    benches.push_back({"shaders/lookup", [state](u64 iterations) {
+        const auto& names = state->ShaderNames;
+        for (u64 i = 0; i < iterations; i++) {
+            std::shared_ptr<Shader> shader = state->Library->Get(names[i % names.size()]);
+            microbench_keep(shader.get());
+        }
+    }});
+}
+
+// Reads back the fields this program writes. Each benchmark is a single line of the output, so this
+// only has to find the keys on that line rather than parse JSON in general.
+static std::string microbench_json_string(const std::string& line, const std::string& key) {
+    std::string pattern = "\"" + key + "\": \"";
+    size_t start = line.find(pattern);
+    if (start == std::string::npos) {
+        return "";
+    }
+    start += pattern.size();
+    return line.substr(start, line.find('"', start) - start);
+}
+
+static f64 microbench_json_number(const std::string& line, const std::string& key) {
+    std::string pattern = "\"" + key + "\": ";
+    size_t start = line.find(pattern);
+    return start == std::string::npos ? 0.0 : std::strtod(line.c_str() + start + pattern.size(), nullptr);
+}
+
+static bool microbench_read_baseline(const std::string& path, std::map<std::string, MicrobenchResult>& outBaseline) {
+    std::ifstream in(path);
+    if (!in) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        std::string name = microbench_json_string(line, "name");
+        if (name.empty()) {
+            continue;
+        }
+        MicrobenchResult& result = outBaseline[name];
+        result.Name = name;
+        result.Iterations = (u64)microbench_json_number(line, "iterations");
+        result.Samples = (u32)microbench_json_number(line, "samples");
+        result.Median = microbench_json_number(line, "median_ns");
+        result.Mean = microbench_json_number(line, "mean_ns");
+        result.StdDev = microbench_json_number(line, "stddev_ns");
+        result.Min = microbench_json_number(line, "min_ns");
+        result.Max = microbench_json_number(line, "max_ns");
+    }
+    return true;
+}
+
+// Returns the number of regressions.
+static u32 microbench_compare(const std::vector<MicrobenchResult>& results, const std::map<std::string, MicrobenchResult>& baseline, f64 threshold) {
+    u32 regressions = 0;
+    for (const MicrobenchResult& result : results) {
+        auto it = baseline.find(result.Name);
+        if (it == baseline.end() || it->second.Median <= 0.0) {
+            LOG_INFO("%-30s %12.1f ns  (not in baseline)", result.Name.c_str(), result.Median);
+            continue;
+        }
+        f64 change = 100.0 * (result.Median - it->second.Median) / it->second.Median;
+        if (change > threshold) {
+            regressions++;
+            LOG_ERROR("%-30s %12.1f ns  was %12.1f ns  %+7.1f%%  REGRESSION", result.Name.c_str(), result.Median, it->second.Median, change);
+        } else {
+            LOG_INFO("%-30s %12.1f ns  was %12.1f ns  %+7.1f%%", result.Name.c_str(), result.Median, it->second.Median, change);
+        }
+    }
+    return regressions;
+}
+
+int main(int argc, char** argv) {
+    MicrobenchOptions options;
+    if (!microbench_parse_options(argc, argv, options)) {
+        microbench_print_usage();
+        return EXIT_FAILURE;
+    }
+
+    // Read the baseline before spending minutes benchmarking, so a bad path fails straight away.
+    std::map<std::string, MicrobenchResult> baseline;
+    if (!options.Compare.empty() && !microbench_read_baseline(options.Compare, baseline)) {
+        LOG_ERROR("Could not read baseline %s.", options.Compare.c_str());
+        return EXIT_FAILURE;
+    }
+
+    std::vector<Microbench> benches;
+    microbench_add_cpu(benches);
+    MicrobenchGpu gpu;
+    if (options.Gpu) {
+        microbench_add_gpu(benches, gpu);
+    }
+
+    std::vector<MicrobenchResult> results;
+    for (const Microbench& bench : benches) {
+        if (!options.Filter.empty() && bench.Name.find(options.Filter) == std::string::npos) {
+            continue;
+        }
+        MicrobenchResult result = microbench_run(bench, options);
+        LOG_INFO("%-30s median %12.1f ns, mean %12.1f ns, stddev %5.1f%%, min %12.1f ns (%llu x %u)",
+            result.Name.c_str(), result.Median, result.Mean, 100.0 * result.StdDev / result.Mean, result.Min, (unsigned long long)result.Iterations, result.Samples);
+        results.push_back(result);
+    }
+
+    std::ofstream out(options.Output);
+    if (!out) {
+        LOG_ERROR("Could not open %s for writing.", options.Output.c_str());
+        return EXIT_FAILURE;
+    }
+    out.setf(std::ios::fixed);
+    out.precision(2);
+    out << "{\n";
+    out << "  \"samples\": " << options.Samples << ",\n";
+    out << "  \"warmup\": " << options.Warmup << ",\n";
+    out << "  \"sample_ms\": " << options.SampleMilliseconds << ",\n";
+    out << "  \"benchmarks\": [";
+    for (u32 i = 0; i < results.size(); i++) {
+        const MicrobenchResult& result = results[i];
+        out << (i == 0 ? "\n" : ",\n");
+        out << "    {\"name\": \"" << result.Name << "\""
+            << ", \"iterations\": " << result.Iterations
+            << ", \"samples\": " << result.Samples
+            << ", \"median_ns\": " << result.Median
+            << ", \"mean_ns\": " << result.Mean
+            << ", \"stddev_ns\": " << result.StdDev
+            << ", \"min_ns\": " << result.Min
+            << ", \"max_ns\": " << result.Max << "}";
+    }
+    out << "\n  ]\n";
+    out << "}\n";
+    out.close();
+    LOG_INFO("%zu benchmarks written to %s.", results.size(), options.Output.c_str());
+
+    if (!options.Compare.empty()) {
+        u32 regressions = microbench_compare(results, baseline, options.Threshold);
+        if (regressions > 0) {
+            LOG_ERROR("%u of %zu benchmarks regressed by more than %.1f%% against %s.", regressions, results.size(), options.Threshold, options.Compare.c_str());
+            return EXIT_FAILURE;
+        }
+        LOG_INFO("No regressions beyond %.1f%% against %s.", options.Threshold, options.Compare.c_str());
+    }
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
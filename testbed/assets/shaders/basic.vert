@@ -1,22 +1,53 @@
 #version 450
 
+// The vertex layout picks the inputs: VERTEX_OCTAHEDRAL_NORMAL for normals packed into two components,
+// VERTEX_COLOR when vertices carry a colour. Quantized positions arrive normalised to the mesh's
+// bounding box, which the model matrix scales back out.
 layout(location = 0) in vec3 v_Position;
+#ifdef VERTEX_OCTAHEDRAL_NORMAL
+layout(location = 1) in vec2 v_Normal;
+#else
 layout(location = 1) in vec3 v_Normal;
+#endif
+#ifdef VERTEX_COLOR
 layout(location = 2) in vec3 v_Color;
+#endif
 layout(location = 3) in vec2 v_TexCoord;
 
 layout(location = 0) out vec3 f_Normal;
 layout(location = 1) out vec3 f_Color;
 layout(location = 2) out vec2 f_TexCoord;
 
+// Must match depth.vert exactly, or the forward pass's EQUAL depth test misses the prepass depth.
+invariant gl_Position;
+
 layout(set = 0, binding = 0) uniform Camera {
     mat4 WorldToClipSpace;
-    mat4 ModelToWorldSpace;
 } u_Camera;
 
+layout(push_constant) uniform Object {
+    mat4 ModelToWorldSpace;
+    vec4 Color;
+} u_Object;
+
+vec3 octahedral_decode(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += mix(vec2(t), vec2(-t), greaterThanEqual(n.xy, vec2(0.0)));
+    return normalize(n);
+}
+
 void main() {
-    gl_Position = u_Camera.ModelToWorldSpace * u_Camera.WorldToClipSpace * vec4(v_Position, 1.0);
+    gl_Position = u_Camera.WorldToClipSpace * u_Object.ModelToWorldSpace * vec4(v_Position, 1.0);
+#ifdef VERTEX_OCTAHEDRAL_NORMAL
+    f_Normal = octahedral_decode(v_Normal);
+#else
     f_Normal = v_Normal;
-    f_Color = v_Color;
+#endif
+#ifdef VERTEX_COLOR
+    f_Color = v_Color * u_Object.Color.rgb;
+#else
+    f_Color = u_Object.Color.rgb;
+#endif
     f_TexCoord = v_TexCoord;
 }
@@ -0,0 +1,19 @@
+#version 450
+
+layout(location = 0) in vec3 v_Position;
+
+layout(set = 0, binding = 0) uniform Camera {
+    mat4 WorldToClipSpace;
+} u_Camera;
+
+// Same block as basic.vert, so one push per entity serves both passes' layouts.
+layout(push_constant) uniform Object {
+    mat4 ModelToWorldSpace;
+    vec4 Color;
+} u_Object;
+
+invariant gl_Position;
+
+void main() {
+    gl_Position = u_Camera.WorldToClipSpace * u_Object.ModelToWorldSpace * vec4(v_Position, 1.0);
+}
@@ -0,0 +1,37 @@
+#version 450
+
+layout(location = 0) in vec2 f_TexCoord;
+
+layout(set = 0, binding = 0) uniform sampler2D u_SceneColor;
+
+layout(push_constant) uniform Upscale {
+    vec2 UVScale;       // rendered region / full texture size
+    vec2 TexelSize;     // 1 / full texture size
+    float Sharpness;    // 0 = plain bilinear
+} u_Upscale;
+
+layout(location = 0) out vec4 o_Color;
+
+void main() {
+    // Keep the bilinear footprint inside the rendered region so we never pull in stale texels.
+    vec2 maxUV = u_Upscale.UVScale - 0.5 * u_Upscale.TexelSize;
+    vec2 uv = min(f_TexCoord * u_Upscale.UVScale, maxUV);
+    vec3 color = texture(u_SceneColor, uv).rgb;
+
+    if (u_Upscale.Sharpness > 0.0) {
+        // Contrast-adaptive sharpening: push away from the cross-shaped neighbourhood average,
+        // backing off where the neighbourhood already has strong contrast to avoid ringing.
+        vec3 n = texture(u_SceneColor, clamp(uv + vec2(0.0, -u_Upscale.TexelSize.y), vec2(0.0), maxUV)).rgb;
+        vec3 s = texture(u_SceneColor, clamp(uv + vec2(0.0, u_Upscale.TexelSize.y), vec2(0.0), maxUV)).rgb;
+        vec3 w = texture(u_SceneColor, clamp(uv + vec2(-u_Upscale.TexelSize.x, 0.0), vec2(0.0), maxUV)).rgb;
+        vec3 e = texture(u_SceneColor, clamp(uv + vec2(u_Upscale.TexelSize.x, 0.0), vec2(0.0), maxUV)).rgb;
+
+        vec3 minRGB = min(color, min(min(n, s), min(w, e)));
+        vec3 maxRGB = max(color, max(max(n, s), max(w, e)));
+        vec3 amplitude = sqrt(clamp(min(minRGB, 1.0 - maxRGB) / max(maxRGB, 1e-4), 0.0, 1.0));
+        vec3 weight = -amplitude * mix(0.125, 0.2, u_Upscale.Sharpness);
+        color = clamp((color + (n + s + w + e) * weight) / (1.0 + 4.0 * weight), 0.0, 1.0);
+    }
+
+    o_Color = vec4(color, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,9 @@
+#version 450
+
+layout(location = 0) out vec2 f_TexCoord;
+
+void main() {
+    // Single triangle covering the screen; no vertex buffer needed.
+    f_TexCoord = vec2((gl_VertexIndex << 1) & 2, gl_VertexIndex & 2);
+    gl_Position = vec4(f_TexCoord * 2.0 - 1.0, 0.0, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,253 @@
+#include "Cortex/Base/Base.hpp"
+#include "Cortex/Graphics/ObjParser.hpp"
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+// Parses randomly generated OBJ files, and any given as arguments, with ObjParser on one thread and
+// on many, and checks both give exactly what tinyobj::LoadObj gives, down to the bits of every float.
+// The generator mixes every number form tinyobj accepts or half-accepts, relative and out-of-range
+// indices, faces of one to four corners, groups, objects, smoothing groups, ignored lines and all
+// three line endings. Files that fail are kept in the working directory to reproduce with; the run
+// exits non-zero if any did.
+
+using namespace Cortex;
+
+#define OBJ_TEST_FILE_COUNT 48
+#define OBJ_TEST_LINE_COUNT 6000
+#define OBJ_TEST_SEED 0x2545F4914F6CDD1Dull
+
+static u64 obj_test_next(u64& state) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+// Uniform in [0, count).
+static u32 obj_test_below(u64& state, u32 count) {
+    return static_cast<u32>((obj_test_next(state) >> 32) % count);
+}
+
+static f64 obj_test_uniform(u64& state, f64 minimum, f64 maximum) {
+    return minimum + (maximum - minimum) * static_cast<f64>(obj_test_next(state) >> 11) / static_cast<f64>(1ull << 53);
+}
+
+template<typename T, size_t N>
+static const T& obj_test_pick(u64& state, const T (&choices)[N]) {
+    return choices[obj_test_below(state, N)];
+}
+
+static std::string obj_test_format(const char* format, ...) {
+    char buffer[128];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    return buffer;
+}
+
+static std::string obj_test_number(u64& state) {
+    static const char* malformed[] = {"abc", "1e", "+", "-.", "1.5x", "12345678901234567.25", "0000000000000000001.5", "3E+2", "7.", "1e-"};
+    switch (obj_test_below(state, 8)) {
+        case 0: return obj_test_format("%.6f", obj_test_uniform(state, -100.0, 100.0));
+        case 1: return obj_test_format("%d", static_cast<i32>(obj_test_below(state, 101)) - 50);
+        case 2: return obj_test_format("%.4e", obj_test_uniform(state, -1e3, 1e3));
+        case 3: return obj_test_format("%s.%u", obj_test_below(state, 2) ? "-" : "", obj_test_below(state, 100000));
+        case 4: return obj_test_format("%.12f1234", obj_test_uniform(state, -1e6, 1e6));
+        case 5: return obj_test_format("-%.9f", obj_test_uniform(state, 0.0, 1.0));
+        case 6: return obj_test_pick(state, malformed);
+        default: return "0";
+    }
+}
+
+// A positive index up to a few past the end, or a relative one, which tinyobj resolves or rejects.
+static i32 obj_test_index(u64& state, u32 count, u32 overshoot) {
+    if (obj_test_below(state, 10) < 7) {
+        return static_cast<i32>(obj_test_below(state, count + overshoot)) + 1;
+    }
+    return -static_cast<i32>(obj_test_below(state, count)) - 1;
+}
+
+static std::string obj_test_generate(u64 seed) {
+    static const char* endings[] = {"\n", "\r\n", "\n", "\r"};
+    static const char* faceStarts[] = {"f ", "  f\t"};
+    static const char* faceEnds[] = {"", "", " ", "\t"};
+    static const u32 cornerCounts[] = {1, 2, 3, 3, 3, 4, 4};
+    static const char* smoothing[] = {"s 1", "s off", "s 5", "s -3", "s", "s  ", "s 12x"};
+    static const char* ignored[] = {"# comment", "", "   ", "usemtl foo", "mtllib x.mtl", "vp 1 2", "x y"};
+
+    u64 state = seed;
+    const char* ending = obj_test_pick(state, endings);
+    u32 positions = 0, normals = 0, texCoords = 0;
+    std::string text;
+    for (u32 i = 0; i < OBJ_TEST_LINE_COUNT; i++) {
+        if (i > 0) {
+            text += ending;
+        }
+        f64 kind = obj_test_uniform(state, 0.0, 1.0);
+        if (kind < 0.3) {
+            text += "v " + obj_test_number(state) + " " + obj_test_number(state) + " " + obj_test_number(state) + " ";
+            static const u32 colorCounts[] = {0, 3, 2};
+            u32 colors = obj_test_pick(state, colorCounts);
+            for (u32 c = 0; c < colors; c++) {
+                text += (c ? " " : "") + obj_test_number(state);
+            }
+            positions++;
+        } else if (kind < 0.4) {
+            text += "vn " + obj_test_number(state) + " " + obj_test_number(state) + " " + obj_test_number(state);
+            normals++;
+        } else if (kind < 0.5) {
+            text += "vt " + obj_test_number(state) + "  " + obj_test_number(state);
+            texCoords++;
+        } else if (kind < 0.8 && positions > 0) {
+            u32 corners = obj_test_pick(state, cornerCounts);
+            u32 form = obj_test_below(state, 4);
+            text += obj_test_pick(state, faceStarts);
+            for (u32 c = 0; c < corners; c++) {
+                i32 position = obj_test_index(state, positions, 4);
+                i32 texCoord = texCoords ? obj_test_index(state, texCoords, 0) : 0;
+                i32 normal = normals ? obj_test_index(state, normals, 0) : 0;
+                text += c ? " " : "";
+                if (form == 0 || texCoords == 0 || normals == 0) {
+                    text += obj_test_format("%d", position);
+                } else if (form == 1) {
+                    text += obj_test_format("%d/%d", position, texCoord);
+                } else if (form == 2) {
+                    text += obj_test_format("%d//%d", position, normal);
+                } else {
+                    text += obj_test_format("%d/%d/%d", position, texCoord, normal);
+                }
+            }
+            text += obj_test_pick(state, faceEnds);
+        } else if (kind < 0.84) {
+            const std::string groups[] = {"g", obj_test_format("g grp%u", i), "g a b  c", "g  ", obj_test_format("o obj %u ", i), "o "};
+            text += obj_test_pick(state, groups);
+        } else if (kind < 0.88) {
+            text += obj_test_pick(state, smoothing);
+        } else if (kind < 0.92) {
+            text += obj_test_pick(state, ignored);
+        } else {
+            text += "v 1 2 3";
+            positions++;
+        }
+    }
+    if (obj_test_below(state, 2)) {
+        text += ending;
+    }
+    return text;
+}
+
+template<typename T>
+static bool obj_test_same_bits(const std::vector<T>& a, const std::vector<T>& b) {
+    return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+}
+
+// Logs the first difference between what ObjParser and tinyobj read.
+static bool obj_test_compare(const char* parser, const tinyobj::attrib_t& attrib, const std::vector<tinyobj::shape_t>& shapes,
+                             const tinyobj::attrib_t& expectedAttrib, const std::vector<tinyobj::shape_t>& expectedShapes) {
+    const std::pair<const char*, std::pair<const std::vector<f32>*, const std::vector<f32>*>> attributes[] = {
+        {"positions", {&attrib.vertices, &expectedAttrib.vertices}},
+        {"colors", {&attrib.colors, &expectedAttrib.colors}},
+        {"normals", {&attrib.normals, &expectedAttrib.normals}},
+        {"texture coordinates", {&attrib.texcoords, &expectedAttrib.texcoords}}
+    };
+    for (const auto& attribute : attributes) {
+        if (!obj_test_same_bits(*attribute.second.first, *attribute.second.second)) {
+            LOG_ERROR("%s: %zu %s, tinyobj has %zu or they differ.", parser, attribute.second.first->size(), attribute.first, attribute.second.second->size());
+            return false;
+        }
+    }
+    if (shapes.size() != expectedShapes.size()) {
+        LOG_ERROR("%s: %zu shapes, tinyobj has %zu.", parser, shapes.size(), expectedShapes.size());
+        return false;
+    }
+    for (size_t i = 0; i < shapes.size(); i++) {
+        const tinyobj::mesh_t& mesh = shapes[i].mesh;
+        const tinyobj::mesh_t& expected = expectedShapes[i].mesh;
+        if (shapes[i].name != expectedShapes[i].name) {
+            LOG_ERROR("%s: shape %zu is named '%s', tinyobj has '%s'.", parser, i, shapes[i].name.c_str(), expectedShapes[i].name.c_str());
+            return false;
+        }
+        bool sameIndices = mesh.indices.size() == expected.indices.size();
+        for (size_t k = 0; sameIndices && k < mesh.indices.size(); k++) {
+            sameIndices = mesh.indices[k].vertex_index == expected.indices[k].vertex_index &&
+                          mesh.indices[k].normal_index == expected.indices[k].normal_index &&
+                          mesh.indices[k].texcoord_index == expected.indices[k].texcoord_index;
+        }
+        if (!sameIndices) {
+            LOG_ERROR("%s: shape %zu has different indices.", parser, i);
+            return false;
+        }
+        if (!obj_test_same_bits(mesh.num_face_vertices, expected.num_face_vertices) || !obj_test_same_bits(mesh.material_ids, expected.material_ids) ||
+            !obj_test_same_bits(mesh.smoothing_group_ids, expected.smoothing_group_ids)) {
+            LOG_ERROR("%s: shape %zu has different faces.", parser, i);
+            return false;
+        }
+    }
+    return true;
+}
+
+// ObjParser may refuse a file, since callers fall back to tinyobj, but never disagree with it.
+static bool obj_test_file(ObjParser& threaded, ObjParser& serial, const std::string& path, u32& parsed) {
+    tinyobj::attrib_t expectedAttrib;
+    std::vector<tinyobj::shape_t> expectedShapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string warn, err;
+    bool expectedOk = tinyobj::LoadObj(&expectedAttrib, &expectedShapes, &materials, &warn, &err, path.c_str());
+
+    bool passed = true;
+    for (auto parser : {std::make_pair("threaded", &threaded), std::make_pair("serial", &serial)}) {
+        tinyobj::attrib_t attrib;
+        std::vector<tinyobj::shape_t> shapes;
+        if (!parser.second->Parse(path, attrib, shapes)) {
+            continue;
+        }
+        if (!expectedOk) {
+            LOG_ERROR("%s: parsed %s, which tinyobj rejects.", parser.first, path.c_str());
+            passed = false;
+        } else if (!obj_test_compare(parser.first, attrib, shapes, expectedAttrib, expectedShapes)) {
+            LOG_ERROR("%s: differs from tinyobj.", path.c_str());
+            passed = false;
+        } else {
+            parsed++;
+        }
+    }
+    return passed;
+}
+
+int main(int argc, char** argv) {
+    ObjParser threaded;
+    ObjParser serial(0);
+    u32 failed = 0, parsed = 0, tested = 0;
+
+    for (u32 i = 0; i < OBJ_TEST_FILE_COUNT; i++) {
+        std::string path = obj_test_format("obj_parser_test_%u.obj", i);
+        std::string text = obj_test_generate(OBJ_TEST_SEED + i);
+        std::ofstream(path, std::ios::binary).write(text.data(), text.size());
+        if (obj_test_file(threaded, serial, path, parsed)) {
+            std::remove(path.c_str());
+        } else {
+            failed++;
+        }
+        tested++;
+    }
+    for (int i = 1; i < argc; i++) {
+        failed += obj_test_file(threaded, serial, argv[i], parsed) ? 0 : 1;
+        tested++;
+    }
+
+    // Nearly every generated file is one ObjParser takes on; if most were refused, little was compared.
+    if (parsed < tested) {
+        LOG_ERROR("ObjParser took on only %u of %u parses.", parsed, tested * 2);
+        failed++;
+    }
+    if (failed) {
+        LOG_ERROR("%u of %u OBJ files differ from tinyobj.", failed, tested);
+        return 1;
+    }
+    LOG_INFO("ObjParser matches tinyobj on %u OBJ files (%u chunk bytes).", tested, OBJ_CHUNK_SIZE);
+    return 0;
+}
\ No newline at end of file
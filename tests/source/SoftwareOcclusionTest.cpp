@@ -0,0 +1,170 @@
+#include "Cortex/Base/Base.hpp"
+#include "Cortex/Core/SoftwareOcclusion.hpp"
+
+#include <cstring>
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+// Rasterizes known occluders with SoftwareOcclusionCuller and checks which of a set of known spheres
+// it keeps, without a GPU. The same source is built once per instruction set the host can run; the
+// first argument, when given, is the set the build is expected to have picked. Exits non-zero on the
+// first mismatch, and with OCCLUSION_TEST_SKIPPED when the CPU cannot run the build's instructions.
+
+using namespace Cortex;
+
+#define OCCLUSION_TEST_SKIPPED 77           // ctest's SKIP_RETURN_CODE
+#define OCCLUSION_TEST_RANDOM_COUNT 2000    // random spheres compared between one and many threads
+
+struct OcclusionTestCase {
+    const char* Name;
+    glm::vec4 Sphere;
+    u8 InFrustum;
+    u8 Visible;
+};
+
+static f32 occlusion_test_random_range(u64& state, f32 minimum, f32 maximum) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return minimum + (maximum - minimum) * static_cast<f32>(state >> 40) / static_cast<f32>(1ull << 24);
+}
+
+// Whether this CPU runs what the build was compiled for; only the AVX2 build can ask for more than x86-64 has.
+static bool occlusion_test_cpu_supported() {
+#if defined(__AVX2__) && (defined(__GNUC__) || defined(__clang__))
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#elif defined(__AVX2__) && defined(_MSC_VER)
+    int info[4];
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return true;
+#endif
+}
+
+static bool occlusion_test_check_stats(const SoftwareOcclusionCuller& culler, const std::vector<u8>& visible) {
+    const SoftwareOcclusionStats& stats = culler.GetStats();
+    u32 kept = 0;
+    for (u8 v : visible) {
+        kept += v;
+    }
+    if (stats.Tested != visible.size() || stats.FrustumCulled + stats.OcclusionCulled + kept != stats.Tested) {
+        LOG_ERROR("Stats do not add up: %u tested, %u frustum culled, %u occlusion culled, %u visible.", stats.Tested, stats.FrustumCulled, stats.OcclusionCulled, kept);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (!occlusion_test_cpu_supported()) {
+        LOG_WARN("This CPU cannot run the %s build; skipping.", SoftwareOcclusionCuller::GetInstructionSet());
+        return OCCLUSION_TEST_SKIPPED;
+    }
+    LOG_INFO("Software occlusion test (%s).", SoftwareOcclusionCuller::GetInstructionSet());
+    if (argc > 1 && std::strcmp(argv[1], SoftwareOcclusionCuller::GetInstructionSet()) != 0) {
+        LOG_ERROR("Expected the %s path but the culler was built for %s.", argv[1], SoftwareOcclusionCuller::GetInstructionSet());
+        return 1;
+    }
+
+    // The buffer's own aspect, looking down -z from the origin, projected like Camera does.
+    glm::mat4 projection = glm::perspective(glm::radians(60.0f), 2.0f, 0.1f, 100.0f);
+    projection[1][1] *= -1;
+    glm::mat4 worldToClip = projection * glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    // A 10x10 wall facing the camera 10 units away, and a floor a unit below the eye that starts
+    // behind the camera, so it has to be clipped to the near plane.
+    OccluderMesh quad;
+    quad.Positions = {{-.5f, -.5f, .0f}, {+.5f, -.5f, .0f}, {+.5f, +.5f, .0f}, {-.5f, +.5f, .0f}};
+    quad.Indices = {0, 1, 2, 2, 3, 0};
+    glm::mat4 wall = glm::translate(glm::mat4(1.0f), {0.0f, 0.0f, -10.0f}) * glm::scale(glm::mat4(1.0f), {10.0f, 10.0f, 1.0f});
+    glm::mat4 floor = glm::translate(glm::mat4(1.0f), {0.0f, -1.0f, -22.5f}) * glm::rotate(glm::mat4(1.0f), glm::radians(-90.0f), {1.0f, 0.0f, 0.0f}) *
+                      glm::scale(glm::mat4(1.0f), {100.0f, 55.0f, 1.0f});
+    std::vector<SoftwareOccluder> occluders = {{&quad, wall}, {&quad, floor}};
+
+    const std::vector<OcclusionTestCase> cases = {
+        {"in front of the wall", {0.0f, 0.0f, -5.0f, 1.0f}, 1, 1},
+        {"just in front of the wall", {0.0f, 0.0f, -9.0f, 0.5f}, 1, 1},
+        {"behind the wall", {0.0f, 0.0f, -20.0f, 1.0f}, 1, 0},
+        {"behind the wall, off centre", {2.0f, 2.0f, -30.0f, 1.0f}, 1, 0},
+        {"behind the wall but poking out above it", {0.0f, 0.0f, -20.0f, 8.0f}, 1, 1},
+        {"beside the wall", {15.0f, 0.0f, -20.0f, 1.0f}, 1, 1},
+        {"under the floor", {-15.0f, -4.0f, -20.0f, 1.0f}, 1, 0},
+        {"around the camera", {0.0f, 0.0f, 0.0f, 1.0f}, 1, 1},
+        {"behind the camera", {0.0f, 0.0f, 10.0f, 1.0f}, 0, 0},
+        {"beyond the far plane", {0.0f, 0.0f, -200.0f, 1.0f}, 0, 0},
+        {"left of the frustum", {-100.0f, 0.0f, -20.0f, 1.0f}, 0, 0}
+    };
+    std::vector<glm::vec4> spheres;
+    for (const auto& testCase : cases) {
+        spheres.push_back(testCase.Sphere);
+    }
+
+    SoftwareOcclusionCuller culler(0);
+    SoftwareOcclusionCuller threadedCuller(WorkerPool::DefaultThreadCount());
+    std::vector<u8> visible, threadedVisible;
+    bool passed = true;
+
+    culler.Cull(worldToClip, occluders, spheres, visible);
+    for (size_t i = 0; i < cases.size(); i++) {
+        if (visible[i] != cases[i].Visible) {
+            LOG_ERROR("Sphere %s was %s.", cases[i].Name, visible[i] ? "kept" : "culled");
+            passed = false;
+        }
+    }
+    passed = occlusion_test_check_stats(culler, visible) && passed;
+    if (culler.GetStats().Occluders != occluders.size() || culler.GetStats().TrianglesRasterized == 0) {
+        LOG_ERROR("Rasterized %u triangles from %u occluders.", culler.GetStats().TrianglesRasterized, culler.GetStats().Occluders);
+        passed = false;
+    }
+
+    // The wall is drawn in the middle of the buffer; the top corners see nothing.
+    const std::vector<f32>& depth = culler.GetDepth();
+    f32 centre = depth[(SOFTWARE_OCCLUSION_HEIGHT / 2) * SOFTWARE_OCCLUSION_WIDTH + SOFTWARE_OCCLUSION_WIDTH / 2];
+    if (!(centre > 0.0f && centre < 1.0f) || depth[0] != 1.0f || depth[SOFTWARE_OCCLUSION_WIDTH - 1] != 1.0f) {
+        LOG_ERROR("Unexpected depth: %f at the centre, %f and %f in the top corners.", centre, depth[0], depth[SOFTWARE_OCCLUSION_WIDTH - 1]);
+        passed = false;
+    }
+
+    // Without occluders only the frustum culls.
+    culler.Cull(worldToClip, {}, spheres, visible);
+    for (size_t i = 0; i < cases.size(); i++) {
+        if (visible[i] != cases[i].InFrustum) {
+            LOG_ERROR("Without occluders, sphere %s was %s.", cases[i].Name, visible[i] ? "kept" : "culled");
+            passed = false;
+        }
+    }
+    if (culler.GetStats().OcclusionCulled != 0) {
+        LOG_ERROR("%u spheres were occlusion culled without occluders.", culler.GetStats().OcclusionCulled);
+        passed = false;
+    }
+
+    // Splitting the work across threads must not change a single answer.
+    u64 random = 0x9E3779B97F4A7C15ull;
+    spheres.resize(OCCLUSION_TEST_RANDOM_COUNT);
+    for (auto& sphere : spheres) {
+        sphere = {
+            occlusion_test_random_range(random, -40.0f, 40.0f),
+            occlusion_test_random_range(random, -20.0f, 20.0f),
+            occlusion_test_random_range(random, -110.0f, 5.0f),
+            occlusion_test_random_range(random, 0.1f, 3.0f)
+        };
+    }
+    culler.Cull(worldToClip, occluders, spheres, visible);
+    threadedCuller.Cull(worldToClip, occluders, spheres, threadedVisible);
+    if (visible != threadedVisible || std::memcmp(culler.GetDepth().data(), threadedCuller.GetDepth().data(), depth.size() * sizeof(f32)) != 0) {
+        LOG_ERROR("One thread and %u threads disagree.", WorkerPool::DefaultThreadCount() + 1);
+        passed = false;
+    }
+    passed = occlusion_test_check_stats(threadedCuller, threadedVisible) && passed;
+    if (culler.GetStats().OcclusionCulled == 0 || culler.GetStats().FrustumCulled == 0 || culler.GetStats().OcclusionCulled + culler.GetStats().FrustumCulled == spheres.size()) {
+        LOG_ERROR("Random spheres should be kept, frustum culled and occlusion culled, got %u and %u culled of %u.", culler.GetStats().FrustumCulled, culler.GetStats().OcclusionCulled, culler.GetStats().Tested);
+        passed = false;
+    }
+
+    if (passed) {
+        LOG_INFO("All software occlusion checks passed (%s).", SoftwareOcclusionCuller::GetInstructionSet());
+    }
+    return passed ? 0 : 1;
+}
\ No newline at end of file